@@ -14,6 +14,75 @@
 #include "fsm.h"
 #include "debug_util.h"
 
+/****************************************************************************//*
+ * Private code prototypes
+ ******************************************************************************/
+
+/**
+ * @brief Get the ancestor states of a state, from the top level state to the
+ * parent. The table of the state is used if it is defined, otherwise the
+ * parent pointers are walked to fill the buffer.
+ *
+ * @param[in] p_state Pointer to the state.
+ * @param[out] p_buffer Buffer of FSM_STATE_LEVEL_MAX + 1 states, used if the
+ * state has no table.
+ *
+ * @return Table of ancestor states, with the level of the state as length.
+ */
+static const fsm_state_t * const * fsm_get_path(const fsm_state_t * p_state,
+                                                const fsm_state_t ** p_buffer);
+
+/**
+ * @brief Tell whether the ancestors of a state are given by a table, a top
+ * level state needs none.
+ *
+ * @param[in] p_state Pointer to the state.
+ *
+ * @retval true The state has a table or it is a top level state.
+ * @retval false The parent pointers must be walked.
+ */
+static inline bool fsm_has_path(const fsm_state_t * p_state);
+
+/**
+ * @brief Switch between states comparing their ancestor tables from the top
+ * level state. Both states must have a table.
+ *
+ * @param[in] p_fsm Pointer to the state machine instance.
+ * @param[in] p_state_source Current state.
+ * @param[in] p_state_target Target state.
+ */
+static void fsm_traverse_path(fsm_t * const p_fsm,
+                              const fsm_state_t * p_state_source,
+                              const fsm_state_t * p_state_target);
+
+/**
+ * @brief Switch between states walking the parent pointers from both states
+ * until the common ancestor.
+ *
+ * @param[in] p_fsm Pointer to the state machine instance.
+ * @param[in] p_state_source Current state.
+ * @param[in] p_state_target Target state.
+ */
+static void fsm_traverse_parent(fsm_t * const p_fsm,
+                                const fsm_state_t * p_state_source,
+                                const fsm_state_t * p_state_target);
+
+/**
+ * @brief Execute the entry handler of a state if it is defined.
+ *
+ * @param[in] p_fsm Pointer to the state machine instance.
+ * @param[in] p_state Pointer to the state.
+ */
+static void fsm_entry(fsm_t * const p_fsm, const fsm_state_t * p_state);
+
+/**
+ * @brief Execute the exit handler of a state if it is defined.
+ *
+ * @param[in] p_fsm Pointer to the state machine instance.
+ * @param[in] p_state Pointer to the state.
+ */
+static void fsm_exit(fsm_t * const p_fsm, const fsm_state_t * p_state);
+
 /****************************************************************************//*
  * Public code
  ******************************************************************************/
@@ -24,31 +93,22 @@ fsm_init (fsm_t * const p_fsm, const fsm_state_t * p_state_init)
     DEBUG_ASSERT(NULL != p_fsm);
     DEBUG_ASSERT(p_state_init != NULL);
 
-    const fsm_state_t * p_state_path[FSM_STATE_LEVEL_MAX + 1];
-    size_t              index = 0;
+    const fsm_state_t *         p_buffer[FSM_STATE_LEVEL_MAX + 1];
+    const fsm_state_t * const * p_path;
 
     p_fsm->p_state    = p_state_init;
     p_fsm->events     = 0;
     p_fsm->tick_count = 0;
 
-    // Loop until we reach top level
-    do
-    {
-        p_state_path[index++] = p_state_init;
-        p_state_init          = p_state_init->p_parent;
-    } while (NULL != p_state_init);
+    p_path = fsm_get_path(p_state_init, p_buffer);
 
-    // Check for array out of bounds
-    DEBUG_ASSERT(index <= FSM_STATE_LEVEL_MAX + 1);
-
-    // Process states from parent to child until one state detects the event
-    do
+    // Enter states from parent to child
+    for (size_t index = 0; index < p_state_init->level; index++)
     {
-        if (NULL != p_state_path[--index]->handler_entry)
-        {
-            p_state_path[index]->handler_entry(p_fsm);
-        }
-    } while (index > 0u);
+        fsm_entry(p_fsm, p_path[index]);
+    }
+
+    fsm_entry(p_fsm, p_state_init);
 }
 
 bool
@@ -58,7 +118,8 @@ fsm_process (fsm_t * const p_fsm, uint32_t events)
     DEBUG_ASSERT(NULL != p_fsm->p_state);
     DEBUG_ASSERT(0 != events);
 
-    bool ret;
+    const fsm_state_t * p_state = p_fsm->p_state;
+    bool                ret     = false;
 
     // Fill new events
     p_fsm->events = events;
@@ -77,36 +138,27 @@ fsm_process (fsm_t * const p_fsm, uint32_t events)
     }
 #endif // NDEBUG
 
-    // If current state is top level
-    if (0u == p_fsm->p_state->level)
+    // If current state is not top level
+    if (0u != p_state->level)
     {
-        DEBUG_ASSERT(NULL != p_fsm->p_state->handler_state);
+        const fsm_state_t *         p_buffer[FSM_STATE_LEVEL_MAX + 1];
+        const fsm_state_t * const * p_path = fsm_get_path(p_state, p_buffer);
+        size_t                      index  = 0;
 
-        ret = p_fsm->p_state->handler_state(p_fsm);
-    }
-    else
-    {
-        const fsm_state_t * p_state_path[FSM_STATE_LEVEL_MAX + 1];
-        const fsm_state_t * p_state = p_fsm->p_state;
-        size_t              index   = 0;
-
-        // Loop until we reach top level
+        // Process states from parent to child until one state detects the event
         do
         {
-            DEBUG_ASSERT(NULL != p_state->handler_state);
+            DEBUG_ASSERT(NULL != p_path[index]->handler_state);
 
-            p_state_path[index++] = p_state;
-            p_state               = p_state->p_parent;
-        } while (NULL != p_state);
+            ret = p_path[index]->handler_state(p_fsm);
+        } while (!ret && (++index < p_state->level));
+    }
 
-        // Check for array out of bounds
-        DEBUG_ASSERT(index <= FSM_STATE_LEVEL_MAX + 1);
+    if (!ret)
+    {
+        DEBUG_ASSERT(NULL != p_state->handler_state);
 
-        // Process states from parent to child until one state detects the event
-        do
-        {
-            ret = p_state_path[--index]->handler_state(p_fsm);
-        } while (!ret && (index > 0u));
+        ret = p_state->handler_state(p_fsm);
     }
 
     // Clear events
@@ -126,68 +178,143 @@ fsm_switch (fsm_t * const p_fsm, const fsm_state_t * p_state_target)
     p_fsm->p_state    = p_state_target;
     p_fsm->tick_count = 0;
 
-    if (NULL != p_state_source->handler_exit)
+    fsm_exit(p_fsm, p_state_source);
+    fsm_entry(p_fsm, p_state_target);
+}
+
+void
+fsm_traverse (fsm_t * const p_fsm, const fsm_state_t * p_state_target)
+{
+    DEBUG_ASSERT(NULL != p_fsm);
+    DEBUG_ASSERT(NULL != p_state_target);
+
+    const fsm_state_t * p_state_source = p_fsm->p_state;
+
+    p_fsm->p_state    = p_state_target;
+    p_fsm->tick_count = 0;
+
+    // Without tables, the walk stops at the common ancestor instead of
+    // building the whole paths
+    if (fsm_has_path(p_state_source) && fsm_has_path(p_state_target))
     {
-#ifndef NDEBUG
-        if (p_fsm->b_debug_enable)
+        fsm_traverse_path(p_fsm, p_state_source, p_state_target);
+    }
+    else
+    {
+        fsm_traverse_parent(p_fsm, p_state_source, p_state_target);
+    }
+}
+
+/****************************************************************************//*
+ * Private code
+ ******************************************************************************/
+
+static const fsm_state_t * const *
+fsm_get_path (const fsm_state_t * p_state, const fsm_state_t ** p_buffer)
+{
+    const fsm_state_t * const * p_path = p_state->p_path;
+    size_t                      index  = p_state->level;
+
+    // Check for array out of bounds
+    DEBUG_ASSERT(index <= FSM_STATE_LEVEL_MAX);
+
+    if (NULL != p_path)
+    {
+        DEBUG_ASSERT(0u != index);
+        DEBUG_ASSERT(p_path[index - 1u] == p_state->p_parent);
+
+        return p_path;
+    }
+
+    // Loop until we reach top level
+    while (index > 0u)
+    {
+        p_state           = p_state->p_parent;
+        p_buffer[--index] = p_state;
+
+        DEBUG_ASSERT((NULL != p_state) && (p_state->level == index));
+    }
+
+    DEBUG_ASSERT(NULL == p_state->p_parent);
+
+    return (const fsm_state_t * const *)p_buffer;
+}
+
+static inline bool
+fsm_has_path (const fsm_state_t * p_state)
+{
+    return (0u == p_state->level) || (NULL != p_state->p_path);
+}
+
+static void
+fsm_traverse_path (fsm_t * const p_fsm, const fsm_state_t * p_state_source,
+                   const fsm_state_t * p_state_target)
+{
+    const fsm_state_t *         p_buffer_source[FSM_STATE_LEVEL_MAX + 1];
+    const fsm_state_t *         p_buffer_target[FSM_STATE_LEVEL_MAX + 1];
+    const fsm_state_t * const * p_path_source;
+    const fsm_state_t * const * p_path_target;
+    size_t                      common = 0;
+    size_t                      index;
+
+    p_path_source = fsm_get_path(p_state_source, p_buffer_source);
+    p_path_target = fsm_get_path(p_state_target, p_buffer_target);
+
+    // Count the common ancestors of the source state and the target parent,
+    // as the target state is always entered
+    while ((common < p_state_target->level)
+           && (common <= p_state_source->level))
+    {
+        const fsm_state_t * p_state = (common < p_state_source->level)
+                                      ? p_path_source[common]
+                                      : p_state_source;
+
+        if (p_state != p_path_target[common])
         {
-            debug_printf("FSM %s, exit %s\r\n", p_fsm->name,
-                         p_state_source->name);
+            break;
         }
-#endif // NDEBUG
 
-        p_state_source->handler_exit(p_fsm);
+        common++;
     }
 
-    if (NULL != p_state_target->handler_entry)
+    // Exit states from child to parent until the common ancestor
+    if (p_state_source->level >= common)
     {
-#ifndef NDEBUG
-        if (p_fsm->b_debug_enable)
+        fsm_exit(p_fsm, p_state_source);
+
+        for (index = p_state_source->level; index > common; index--)
         {
-            debug_printf("FSM %s, entry %s\r\n", p_fsm->name,
-                         p_state_target->name);
+            fsm_exit(p_fsm, p_path_source[index - 1u]);
         }
-#endif // NDEBUG
+    }
 
-        p_state_target->handler_entry(p_fsm);
+    // Enter states from parent to child until the target state
+    for (index = common; index < p_state_target->level; index++)
+    {
+        fsm_entry(p_fsm, p_path_target[index]);
     }
+
+    fsm_entry(p_fsm, p_state_target);
 }
 
-void
-fsm_traverse (fsm_t * const p_fsm, const fsm_state_t * p_state_target)
+static void
+fsm_traverse_parent (fsm_t * const p_fsm, const fsm_state_t * p_state_source,
+                     const fsm_state_t * p_state_target)
 {
-    DEBUG_ASSERT(NULL != p_fsm);
-    DEBUG_ASSERT(NULL != p_state_target);
-
-    const fsm_state_t * p_state_source = p_fsm->p_state;
     const fsm_state_t * p_state_path[FSM_STATE_LEVEL_MAX + 1];
-    size_t              index          = 0;
-
-    p_fsm->p_state    = p_state_target;
-    p_fsm->tick_count = 0;
+    size_t              index = 0;
 
     // Loop until we reach a common parent
     do
     {
         DEBUG_ASSERT(NULL != p_state_target);
+        DEBUG_ASSERT(index <= FSM_STATE_LEVEL_MAX);
 
-        // Loop until surpass target level
+        // Exit states from child to parent until surpass target level
         while ((NULL != p_state_source)
                && (p_state_source->level >= p_state_target->level))
         {
-            if (NULL != p_state_source->handler_exit)
-            {
-#ifndef NDEBUG
-                if (p_fsm->b_debug_enable)
-                {
-                    debug_printf("FSM %s, exit %s\r\n", p_fsm->name,
-                                 p_state_source->name);
-                }
-#endif // NDEBUG
-
-                p_state_source->handler_exit(p_fsm);
-            }
-
+            fsm_exit(p_fsm, p_state_source);
             p_state_source = p_state_source->p_parent;
         }
 
@@ -195,21 +322,43 @@ fsm_traverse (fsm_t * const p_fsm, const fsm_state_t * p_state_target)
         p_state_target        = p_state_target->p_parent;
     } while (p_state_source != p_state_target);
 
+    // Enter states from parent to child until the target state
     do
     {
-        if (NULL != p_state_path[--index]->handler_entry)
-        {
+        fsm_entry(p_fsm, p_state_path[--index]);
+    } while (index > 0u);
+}
+
+static void
+fsm_entry (fsm_t * const p_fsm, const fsm_state_t * p_state)
+{
+    if (NULL != p_state->handler_entry)
+    {
 #ifndef NDEBUG
-            if (p_fsm->b_debug_enable)
-            {
-                debug_printf("FSM %s, entry %s\r\n", p_fsm->name,
-                             p_state_path[index]->name);
-            }
+        if (p_fsm->b_debug_enable)
+        {
+            debug_printf("FSM %s, entry %s\r\n", p_fsm->name, p_state->name);
+        }
 #endif // NDEBUG
 
-            p_state_path[index]->handler_entry(p_fsm);
+        p_state->handler_entry(p_fsm);
+    }
+}
+
+static void
+fsm_exit (fsm_t * const p_fsm, const fsm_state_t * p_state)
+{
+    if (NULL != p_state->handler_exit)
+    {
+#ifndef NDEBUG
+        if (p_fsm->b_debug_enable)
+        {
+            debug_printf("FSM %s, exit %s\r\n", p_fsm->name, p_state->name);
         }
-    } while (index > 0u);
+#endif // NDEBUG
+
+        p_state->handler_exit(p_fsm);
+    }
 }
 
 /** @} */
@@ -79,12 +79,25 @@ struct fsm_state_t
     /** State hierarchy level. */
     uint8_t level;
 
+    /** Optional table of the ancestor states, from the top level state to the
+     * parent, with @ref level entries. It is built at compile time with
+     * @ref FSM_STATE_PATH, so the events do not walk the parent pointers. A
+     * transition compares the tables only if both states have one, a top
+     * level state needs none. */
+    const fsm_state_t * const * const p_path;
+
 #ifndef NDEBUG
     /** Name of the state for debugging purposes. */
     const char * const name;
 #endif // NDEBUG
 };
 
+/**
+ * @brief Build the table of ancestor states of a state at compile time, e.g.
+ * `.p_path = FSM_STATE_PATH(&state_top, &state_parent)`.
+ */
+#define FSM_STATE_PATH(...) ((const fsm_state_t * const []){__VA_ARGS__})
+
 /** @brief Finite state machine type. */
 struct fsm_t
 {
@@ -100,6 +113,9 @@ struct fsm_t
     /** Number of ticks passed in the current state. */
     uint32_t tick_count;
 
+    /** Data of the event processed from the event queue, NULL otherwise. */
+    void * p_data;
+
 #ifndef NDEBUG
     /** Name of the state for debugging purposes. */
     const char * const name;
@@ -138,7 +154,9 @@ bool fsm_process(fsm_t * const p_fsm, uint32_t events);
 void fsm_switch(fsm_t * const p_fsm, const fsm_state_t * p_state_target);
 
 /**
- * @brief Switch to a state traversing hierarchical states.
+ * @brief Switch to a state traversing hierarchical states. The states are
+ * exited up to the common ancestor of the current state and the parent of the
+ * target state, and entered down to the target state.
  *
  * @param[in] p_fsm Pointer to the state machine instance.
  * @param[in] p_state_target Target state.
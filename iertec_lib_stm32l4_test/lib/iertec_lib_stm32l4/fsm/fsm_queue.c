@@ -0,0 +1,194 @@
+/*******************************************************************************
+ * @file fsm_queue.c
+ * @author juanmanuel.fernandez@iertec.com
+ * @date 19 Oct 2026
+ * @brief Event queue of a Finite State Machine.
+ * @ingroup fsm_queue
+ ******************************************************************************/
+
+/**
+ * @addtogroup fsm_queue
+ * @{
+ */
+
+#include "fsm_queue.h"
+#include "debug_util.h"
+
+/****************************************************************************//*
+ * Private code prototypes
+ ******************************************************************************/
+
+/**
+ * @brief Take the oldest event of a ring, if it has been published.
+ *
+ * @param[in] p_ring Pointer to the ring.
+ * @param[out] p_events Events taken.
+ * @param[out] pp_data Data of the events taken.
+ *
+ * @retval true An event has been taken.
+ * @retval false The ring is empty or its oldest event is being posted.
+ */
+static bool fsm_queue_take(fsm_queue_ring_t * p_ring, uint32_t * p_events,
+                           void ** pp_data);
+
+/****************************************************************************//*
+ * Public code
+ ******************************************************************************/
+
+void
+fsm_queue_init (fsm_queue_t * const p_queue, fsm_t * const p_fsm,
+                fsm_queue_slot_t * p_slot, uint32_t size,
+                fsm_queue_notify_t notify)
+{
+    DEBUG_ASSERT(NULL != p_queue);
+    DEBUG_ASSERT(NULL != p_fsm);
+    DEBUG_ASSERT(NULL != p_slot);
+    DEBUG_ASSERT((size >= 2u) && (0u == (size & (size - 1u))));
+
+    p_queue->p_fsm  = p_fsm;
+    p_queue->notify = notify;
+    p_queue->lost   = 0;
+    p_queue->b_busy = false;
+
+    for (uint32_t prio = 0; prio < FSM_QUEUE_PRIO_COUNT; prio++)
+    {
+        fsm_queue_ring_t * p_ring = &p_queue->ring[prio];
+
+        p_ring->p_slot = &p_slot[prio * size];
+        p_ring->mask   = size - 1u;
+        p_ring->head   = 0;
+        p_ring->tail   = 0;
+
+        // A slot is free when its sequence number is its position
+        for (uint32_t i = 0; i < size; i++)
+        {
+            p_ring->p_slot[i].seq = i;
+        }
+    }
+}
+
+bool
+fsm_queue_post (fsm_queue_t * const p_queue, uint32_t events, void * p_data,
+                uint8_t prio)
+{
+    DEBUG_ASSERT(NULL != p_queue);
+    DEBUG_ASSERT(0u != events);
+    DEBUG_ASSERT(prio < FSM_QUEUE_PRIO_COUNT);
+
+    fsm_queue_ring_t * p_ring = &p_queue->ring[prio];
+    fsm_queue_slot_t * p_slot;
+    uint32_t           pos    = __atomic_load_n(&p_ring->tail,
+                                                __ATOMIC_RELAXED);
+
+    // Claim the slot at the tail, another context may claim it first
+    for (;;)
+    {
+        p_slot = &p_ring->p_slot[pos & p_ring->mask];
+
+        int32_t diff = (int32_t)(__atomic_load_n(&p_slot->seq,
+                                                 __ATOMIC_ACQUIRE) - pos);
+
+        if (0 == diff)
+        {
+            if (__atomic_compare_exchange_n(&p_ring->tail, &pos, pos + 1u,
+                                            true, __ATOMIC_RELAXED,
+                                            __ATOMIC_RELAXED))
+            {
+                break;
+            }
+        }
+        else if (diff < 0)
+        {
+            // The slot still holds the event of the previous round
+            (void)__atomic_fetch_add(&p_queue->lost, 1u, __ATOMIC_RELAXED);
+
+            return false;
+        }
+        else
+        {
+            pos = __atomic_load_n(&p_ring->tail, __ATOMIC_RELAXED);
+        }
+    }
+
+    // Publish the event
+    p_slot->events = events;
+    p_slot->p_data = p_data;
+    __atomic_store_n(&p_slot->seq, pos + 1u, __ATOMIC_RELEASE);
+
+    if (NULL != p_queue->notify)
+    {
+        p_queue->notify();
+    }
+
+    return true;
+}
+
+uint32_t
+fsm_queue_dispatch (fsm_queue_t * const p_queue)
+{
+    DEBUG_ASSERT(NULL != p_queue);
+
+    uint32_t count = 0;
+    uint32_t events;
+    void *   p_data;
+    uint32_t prio;
+
+    // Events are not processed from the handlers, each one runs to completion
+    DEBUG_ASSERT(!p_queue->b_busy);
+    p_queue->b_busy = true;
+
+    do
+    {
+        // Take the event of the highest priority
+        prio = FSM_QUEUE_PRIO_COUNT;
+
+        while ((prio > 0u)
+               && !fsm_queue_take(&p_queue->ring[prio - 1u], &events, &p_data))
+        {
+            prio--;
+        }
+
+        if (prio > 0u)
+        {
+            p_queue->p_fsm->p_data = p_data;
+            (void)fsm_process(p_queue->p_fsm, events);
+            p_queue->p_fsm->p_data = NULL;
+            count++;
+        }
+    } while (prio > 0u);
+
+    p_queue->b_busy = false;
+
+    return count;
+}
+
+/****************************************************************************//*
+ * Private code
+ ******************************************************************************/
+
+static bool
+fsm_queue_take (fsm_queue_ring_t * p_ring, uint32_t * p_events,
+                void ** pp_data)
+{
+    fsm_queue_slot_t * p_slot = &p_ring->p_slot[p_ring->head & p_ring->mask];
+
+    // The slot is published with the sequence number of the next position
+    if (__atomic_load_n(&p_slot->seq, __ATOMIC_ACQUIRE) != (p_ring->head + 1u))
+    {
+        return false;
+    }
+
+    *p_events = p_slot->events;
+    *pp_data  = p_slot->p_data;
+
+    // Free the slot for the next round
+    __atomic_store_n(&p_slot->seq, p_ring->head + p_ring->mask + 1u,
+                     __ATOMIC_RELEASE);
+    p_ring->head++;
+
+    return true;
+}
+
+/** @} */
+
+/******************************** End of file *********************************/
@@ -0,0 +1,135 @@
+/*******************************************************************************
+ * @file fsm_queue.h
+ * @author juanmanuel.fernandez@iertec.com
+ * @date 19 Oct 2026
+ * @brief Event queue of a Finite State Machine.
+ * @ingroup fsm_queue
+ ******************************************************************************/
+
+/**
+ * @defgroup fsm_queue fsm_queue
+ * @brief Event queue of a Finite State Machine.
+ *
+ * The events given to @ref fsm_process are a bitmask, so several occurrences
+ * of an event are merged and they carry no data. With the event queue each
+ * posted event is kept with its data until it is processed, and handled alone
+ * by the state machine, with the data in @ref fsm_t::p_data.
+ *
+ * There is a ring of events per priority. @ref fsm_queue_dispatch processes
+ * the events one at a time, each one until the handlers return, taking the
+ * oldest event of the highest priority. The events posted meanwhile, also from
+ * the handlers, wait for the current event to complete.
+ *
+ * @ref fsm_queue_post does not disable the interrupts, so the events can be
+ * posted from interrupts of any priority and from other tasks. A slot of the
+ * ring is claimed with an atomic operation and published once it is filled,
+ * and the dispatch stops at a slot not published yet. Only one context, the
+ * state machine task, may call @ref fsm_queue_dispatch.
+ * @{
+ */
+
+#ifndef FSM_QUEUE_H
+#define FSM_QUEUE_H
+
+#include "fsm.h"
+
+#include <stdbool.h>
+#include <stdint.h>
+
+#ifndef FSM_QUEUE_PRIO_COUNT
+/** Number of event priorities, 0 being the lowest one. */
+#define FSM_QUEUE_PRIO_COUNT (2u)
+#endif // FSM_QUEUE_PRIO_COUNT
+
+/** @brief Function that wakes up the state machine task. */
+typedef void (* fsm_queue_notify_t)(void);
+
+/** @brief Slot of the event rings. */
+typedef struct
+{
+    /** Sequence number, tells whether the slot is free or published. */
+    uint32_t seq;
+
+    /** Events to be processed. */
+    uint32_t events;
+
+    /** Data of the events. */
+    void * p_data;
+} fsm_queue_slot_t;
+
+/** @brief Ring of events of a priority. */
+typedef struct
+{
+    /** Slots of the ring. */
+    fsm_queue_slot_t * p_slot;
+
+    /** Number of slots minus one. */
+    uint32_t mask;
+
+    /** Position of the next event to be processed. */
+    uint32_t head;
+
+    /** Position of the next slot to be claimed. */
+    uint32_t tail;
+} fsm_queue_ring_t;
+
+/** @brief Event queue type. */
+typedef struct
+{
+    /** State machine that processes the events. */
+    fsm_t * p_fsm;
+
+    /** Function that wakes up the state machine task, NULL if none. */
+    fsm_queue_notify_t notify;
+
+    /** Rings of events, indexed by priority. */
+    fsm_queue_ring_t ring[FSM_QUEUE_PRIO_COUNT];
+
+    /** Number of events not posted because the ring was full. */
+    uint32_t lost;
+
+    /** An event is being processed. */
+    bool b_busy;
+} fsm_queue_t;
+
+/**
+ * @brief Initialize an event queue.
+ *
+ * @param[in] p_queue Pointer to the event queue instance.
+ * @param[in] p_fsm State machine that processes the events.
+ * @param[in] p_slot Slots of the rings, FSM_QUEUE_PRIO_COUNT * size entries.
+ * @param[in] size Number of slots of each ring, a power of 2 not less than 2.
+ * @param[in] notify Function called after each event is posted, NULL if none.
+ */
+void fsm_queue_init(fsm_queue_t * const p_queue, fsm_t * const p_fsm,
+                    fsm_queue_slot_t * p_slot, uint32_t size,
+                    fsm_queue_notify_t notify);
+
+/**
+ * @brief Post an event to the queue. It can be called from interrupts.
+ *
+ * @param[in] p_queue Pointer to the event queue instance.
+ * @param[in] events Events to be processed, not 0.
+ * @param[in] p_data Data of the events, it must be valid until processed.
+ * @param[in] prio Priority of the events, less than FSM_QUEUE_PRIO_COUNT.
+ *
+ * @retval true The event has been posted.
+ * @retval false The ring of the priority is full, the event is lost.
+ */
+bool fsm_queue_post(fsm_queue_t * const p_queue, uint32_t events,
+                    void * p_data, uint8_t prio);
+
+/**
+ * @brief Process the queued events until the queue is empty.
+ *
+ * @param[in] p_queue Pointer to the event queue instance.
+ *
+ * @return Number of events processed.
+ */
+uint32_t fsm_queue_dispatch(fsm_queue_t * const p_queue);
+
+#endif // FSM_QUEUE_H
+
+/** @} */
+
+/******************************** End of file *********************************/
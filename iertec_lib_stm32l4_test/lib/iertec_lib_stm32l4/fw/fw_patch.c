@@ -0,0 +1,485 @@
+/*******************************************************************************
+ * @file fw_patch.c
+ * @author juanmanuel.fernandez@iertec.com
+ * @date 19 Oct 2026
+ * @brief Differential firmware patch applier. The new image is built from the
+ * running image and a patch streamed in chunks, and it is written into the
+ * inactive slot through @ref fw_update.
+ * @ingroup fw_patch
+ ******************************************************************************/
+
+/**
+ * @addtogroup fw_patch
+ * @{
+ */
+
+#include "fw_patch.h"
+#include "fw_update.h"
+#include "itf_flash.h"
+#include "crypt_crc32.h"
+#include "debug_util.h"
+
+#include <string.h>
+
+/****************************************************************************//*
+ * Constants and macros
+ ******************************************************************************/
+
+/** Maximum number of arguments of an operation. */
+#define FW_PATCH_ARG_MAX   (2u)
+
+/** Maximum shift of a LEB128 coded 32 bits integer. */
+#define FW_PATCH_SHIFT_MAX (28u)
+
+/****************************************************************************//*
+ * Private data types
+ ******************************************************************************/
+
+/** @brief Patch parser states. */
+typedef enum
+{
+    FW_PATCH_STATE_HEADER,
+    FW_PATCH_STATE_OP,
+    FW_PATCH_STATE_ARG,
+    FW_PATCH_STATE_DATA,
+    FW_PATCH_STATE_END,
+    FW_PATCH_STATE_ERROR,
+} fw_patch_state_t;
+
+/** @brief Patch application context. */
+typedef struct
+{
+    /** Parser state. */
+    fw_patch_state_t state;
+
+    /** Received header. */
+    uint8_t header[FW_PATCH_HEADER_SIZE];
+
+    /** Number of bytes of the header received. */
+    size_t header_len;
+
+    /** Operation in progress. */
+    fw_patch_op_t op;
+
+    /** Arguments of the operation. */
+    uint32_t arg[FW_PATCH_ARG_MAX];
+
+    /** Number of arguments of the operation. */
+    uint8_t arg_count;
+
+    /** Argument being parsed. */
+    uint8_t arg_idx;
+
+    /** Shift of the next LEB128 group. */
+    uint8_t arg_shift;
+
+    /** Offset of the old image used by the operation in progress. */
+    uint32_t src;
+
+    /** Bytes pending of the operation in progress. */
+    uint32_t remaining;
+
+    /** Starting address of the old image. */
+    uint32_t old_address;
+
+    /** Size of the old image. */
+    uint32_t old_size;
+
+    /** Size of the new image. */
+    uint32_t new_size;
+
+    /** CRC32 of the new image. */
+    uint32_t new_crc;
+
+    /** Number of bytes of the new image already generated. */
+    uint32_t out_size;
+} fw_patch_t;
+
+/****************************************************************************//*
+ * Private data
+ ******************************************************************************/
+
+/** Patch application context. */
+static fw_patch_t patch;
+
+/** Buffer used to read the old image. */
+static uint8_t patch_buf[FW_PATCH_BUF_SIZE];
+
+/****************************************************************************//*
+ * Private code prototypes
+ ******************************************************************************/
+
+/**
+ * @brief Get a little endian 32 bits integer of the header.
+ *
+ * @param[in] offset Offset of the integer in the header.
+ *
+ * @return The integer value.
+ */
+static uint32_t fw_patch_get_u32(size_t offset);
+
+/**
+ * @brief Parse the header, check that the patch applies to the running image
+ * and start the update.
+ *
+ * @return true if the patch can be applied, false otherwise.
+ */
+static bool fw_patch_start(void);
+
+/**
+ * @brief Read a block of the old image.
+ *
+ * @param[in] offset Offset of the old image.
+ * @param[in] length Number of bytes, up to @ref FW_PATCH_BUF_SIZE.
+ *
+ * @return true on success, false otherwise.
+ */
+static bool fw_patch_read_old(uint32_t offset, size_t length);
+
+/**
+ * @brief Write a block of the new image, erasing the pages it needs first. The
+ * copy operations produce the new image from the old one, not from the link,
+ * so there is no reception time to erase the pages meanwhile.
+ *
+ * @param[in] data Block data.
+ * @param[in] length Number of bytes.
+ *
+ * @return true on success, false otherwise.
+ */
+static bool fw_patch_output(const uint8_t * data, size_t length);
+
+/**
+ * @brief Process a parsed operation.
+ *
+ * @return true on success, false if the operation is not valid.
+ */
+static bool fw_patch_op(void);
+
+/**
+ * @brief Process the data bytes of an insert or add operation.
+ *
+ * @param[in] data Data bytes.
+ * @param[in] length Number of data bytes.
+ *
+ * @return true on success, false otherwise.
+ */
+static bool fw_patch_data(const uint8_t * data, size_t length);
+
+/****************************************************************************//*
+ * Public code
+ ******************************************************************************/
+
+void
+fw_patch_begin (void)
+{
+    DEBUG_ASSERT_STATIC((FW_PATCH_BUF_SIZE % 4u) == 0u);
+
+    (void)memset(&patch, 0, sizeof(patch));
+    patch.state = FW_PATCH_STATE_HEADER;
+}
+
+bool
+fw_patch_write (const uint8_t * data, size_t length)
+{
+    DEBUG_ASSERT(NULL != data);
+
+    size_t i = 0;
+
+    while ((i < length) && (FW_PATCH_STATE_ERROR != patch.state))
+    {
+        bool ret = true;
+
+        switch (patch.state)
+        {
+            case FW_PATCH_STATE_HEADER:
+                patch.header[patch.header_len++] = data[i++];
+
+                if (FW_PATCH_HEADER_SIZE == patch.header_len)
+                {
+                    ret         = fw_patch_start();
+                    patch.state = FW_PATCH_STATE_OP;
+                }
+                break;
+
+            case FW_PATCH_STATE_OP:
+                patch.op        = (fw_patch_op_t)data[i++];
+                patch.arg_idx   = 0;
+                patch.arg_shift = 0;
+                patch.arg[0]    = 0;
+                patch.arg[1]    = 0;
+
+                if (FW_PATCH_OP_END == patch.op)
+                {
+                    patch.state = FW_PATCH_STATE_END;
+                }
+                else if (FW_PATCH_OP_INSERT == patch.op)
+                {
+                    patch.arg_count = 1;
+                    patch.state     = FW_PATCH_STATE_ARG;
+                }
+                else if ((FW_PATCH_OP_COPY == patch.op)
+                         || (FW_PATCH_OP_ADD == patch.op))
+                {
+                    patch.arg_count = 2;
+                    patch.state     = FW_PATCH_STATE_ARG;
+                }
+                else
+                {
+                    ret = false;
+                }
+                break;
+
+            case FW_PATCH_STATE_ARG:
+            {
+                uint8_t byte = data[i++];
+
+                patch.arg[patch.arg_idx] |= (uint32_t)(byte & 0x7Fu)
+                                            << patch.arg_shift;
+                patch.arg_shift          += 7u;
+
+                if ((byte & 0x80u) == 0u)
+                {
+                    patch.arg_shift = 0;
+                    patch.arg_idx++;
+
+                    if (patch.arg_idx == patch.arg_count)
+                    {
+                        ret = fw_patch_op();
+                    }
+                }
+                else if (patch.arg_shift > FW_PATCH_SHIFT_MAX)
+                {
+                    ret = false;
+                }
+                break;
+            }
+
+            case FW_PATCH_STATE_DATA:
+            {
+                size_t len = length - i;
+
+                if (len > patch.remaining)
+                {
+                    len = patch.remaining;
+                }
+
+                ret = fw_patch_data(&data[i], len);
+                i  += len;
+
+                if (0u == patch.remaining)
+                {
+                    patch.state = FW_PATCH_STATE_OP;
+                }
+                break;
+            }
+
+            default:
+                // No data is expected after the end of the patch
+                ret = false;
+                break;
+        }
+
+        if (!ret)
+        {
+            patch.state = FW_PATCH_STATE_ERROR;
+            fw_update_abort();
+        }
+    }
+
+    return FW_PATCH_STATE_ERROR != patch.state;
+}
+
+bool
+fw_patch_finish (void)
+{
+    bool ret = (FW_PATCH_STATE_END == patch.state)
+               && (patch.out_size == patch.new_size);
+
+    if (ret)
+    {
+        ret = fw_update_finish(patch.new_crc);
+    }
+    else
+    {
+        fw_update_abort();
+    }
+
+    patch.state = FW_PATCH_STATE_ERROR;
+
+    return ret;
+}
+
+void
+fw_patch_abort (void)
+{
+    patch.state = FW_PATCH_STATE_ERROR;
+    fw_update_abort();
+}
+
+/****************************************************************************//*
+ * Private code
+ ******************************************************************************/
+
+static uint32_t
+fw_patch_get_u32 (size_t offset)
+{
+    return (uint32_t)patch.header[offset]
+           | ((uint32_t)patch.header[offset + 1u] << 8)
+           | ((uint32_t)patch.header[offset + 2u] << 16)
+           | ((uint32_t)patch.header[offset + 3u] << 24);
+}
+
+static bool
+fw_patch_start (void)
+{
+    uint32_t old_crc = CRYPT_CRC32_INIT_VAL;
+
+    patch.old_address = fw_update_get_slot_address(fw_update_get_slot());
+    patch.old_size    = fw_patch_get_u32(4);
+    patch.new_size    = fw_patch_get_u32(12);
+    patch.new_crc     = fw_patch_get_u32(16);
+
+    if ((fw_patch_get_u32(0) != FW_PATCH_MAGIC)
+        || (patch.old_size > FW_UPDATE_SLOT_SIZE))
+    {
+        return false;
+    }
+
+    // The patch must be applied over the same image it was generated from
+    for (uint32_t offset = 0; offset < patch.old_size;
+         offset += FW_PATCH_BUF_SIZE)
+    {
+        size_t len = patch.old_size - offset;
+
+        if (len > FW_PATCH_BUF_SIZE)
+        {
+            len = FW_PATCH_BUF_SIZE;
+        }
+
+        if (!fw_patch_read_old(offset, len))
+        {
+            return false;
+        }
+
+        old_crc = crypt_crc32(patch_buf, len, old_crc);
+    }
+
+    return (old_crc == fw_patch_get_u32(8)) && fw_update_begin(patch.new_size);
+}
+
+static bool
+fw_patch_read_old (uint32_t offset, size_t length)
+{
+    DEBUG_ASSERT(length <= FW_PATCH_BUF_SIZE);
+
+    // The FLASH is read by whole words
+    return itf_flash_read(patch.old_address + offset, patch_buf,
+                          (length + 3u) & ~(size_t)3u);
+}
+
+static bool
+fw_patch_output (const uint8_t * data, size_t length)
+{
+    bool ret = true;
+
+    while (ret && (fw_update_get_writable() < length))
+    {
+        size_t writable = fw_update_get_writable();
+
+        // No progress means that the block exceeds the image size
+        ret = fw_update_erase_step() && (fw_update_get_writable() > writable);
+    }
+
+    return ret && fw_update_write(data, length);
+}
+
+static bool
+fw_patch_op (void)
+{
+    uint32_t len = (FW_PATCH_OP_INSERT == patch.op) ? patch.arg[0]
+                                                    : patch.arg[1];
+
+    patch.src       = (FW_PATCH_OP_INSERT == patch.op) ? 0u : patch.arg[0];
+    patch.remaining = len;
+    patch.state     = (len > 0u) ? FW_PATCH_STATE_DATA : FW_PATCH_STATE_OP;
+
+    // Overflow safe checks of the old and new image ranges
+    if ((len > (patch.new_size - patch.out_size))
+        || ((FW_PATCH_OP_INSERT != patch.op)
+            && ((patch.src > patch.old_size)
+                || (len > (patch.old_size - patch.src)))))
+    {
+        return false;
+    }
+
+    if (FW_PATCH_OP_COPY == patch.op)
+    {
+        // The copy does not need patch data
+        patch.state = FW_PATCH_STATE_OP;
+
+        while (patch.remaining > 0u)
+        {
+            size_t chunk = patch.remaining;
+
+            if (chunk > FW_PATCH_BUF_SIZE)
+            {
+                chunk = FW_PATCH_BUF_SIZE;
+            }
+
+            if (!fw_patch_read_old(patch.src, chunk)
+                || !fw_patch_output(patch_buf, chunk))
+            {
+                return false;
+            }
+
+            patch.src       += chunk;
+            patch.remaining -= chunk;
+            patch.out_size  += chunk;
+        }
+    }
+
+    return true;
+}
+
+static bool
+fw_patch_data (const uint8_t * data, size_t length)
+{
+    bool ret = true;
+
+    if (FW_PATCH_OP_INSERT == patch.op)
+    {
+        ret = fw_patch_output(data, length);
+    }
+    else
+    {
+        for (size_t i = 0; ret && (i < length); i += FW_PATCH_BUF_SIZE)
+        {
+            size_t chunk = length - i;
+
+            if (chunk > FW_PATCH_BUF_SIZE)
+            {
+                chunk = FW_PATCH_BUF_SIZE;
+            }
+
+            ret = fw_patch_read_old(patch.src + i, chunk);
+
+            for (size_t j = 0; ret && (j < chunk); j++)
+            {
+                patch_buf[j] = (uint8_t)(patch_buf[j] + data[i + j]);
+            }
+
+            ret = ret && fw_patch_output(patch_buf, chunk);
+        }
+
+        patch.src += length;
+    }
+
+    patch.remaining -= length;
+    patch.out_size  += length;
+
+    return ret;
+}
+
+/** @} */
+
+/******************************** End of file *********************************/
@@ -0,0 +1,91 @@
+/*******************************************************************************
+ * @file fw_patch.h
+ * @author juanmanuel.fernandez@iertec.com
+ * @date 19 Oct 2026
+ * @brief Differential firmware patch applier. The new image is built from the
+ * running image and a patch streamed in chunks, and it is written into the
+ * inactive slot through @ref fw_update.
+ * @ingroup fw_patch
+ ******************************************************************************/
+
+/**
+ * @defgroup fw_patch fw_patch
+ * @brief Differential firmware patch applier.
+ *
+ * Patch format, all the integers are little endian:
+ * - Header: magic "FWP1", old image size, old image CRC32, new image size and
+ *   new image CRC32, 4 bytes each.
+ * - Operations, one byte code followed by its arguments coded as LEB128:
+ *   - @ref FW_PATCH_OP_COPY, old offset and length: copy bytes of the old
+ *     image.
+ *   - @ref FW_PATCH_OP_INSERT, length and bytes: insert new bytes.
+ *   - @ref FW_PATCH_OP_ADD, old offset, length and bytes: add the bytes to the
+ *     ones of the old image, as the bsdiff diff blocks.
+ *   - @ref FW_PATCH_OP_END: end of the patch.
+ * @{
+ */
+
+#ifndef FW_PATCH_H
+#define FW_PATCH_H
+
+#include <stdbool.h>
+#include <stdint.h>
+#include <stddef.h>
+
+/** Size of the buffer used to read the old image. It must be multiple of 4. */
+#ifndef FW_PATCH_BUF_SIZE
+#define FW_PATCH_BUF_SIZE    (256u)
+#endif
+
+/** Magic number of the patch header, "FWP1". */
+#define FW_PATCH_MAGIC       (0x31505746ul)
+
+/** Size of the patch header. */
+#define FW_PATCH_HEADER_SIZE (20u)
+
+/** @brief Patch operation codes. */
+typedef enum
+{
+    FW_PATCH_OP_END = 0,
+    FW_PATCH_OP_COPY,
+    FW_PATCH_OP_INSERT,
+    FW_PATCH_OP_ADD,
+} fw_patch_op_t;
+
+/**
+ * @brief Start the application of a patch over the running image.
+ */
+void fw_patch_begin(void);
+
+/**
+ * @brief Apply the next chunk of the patch. The chunks can have any length, so
+ * they can be passed as they are received. The pages of the new image that
+ * are not erased yet by @ref fw_update_erase_step are erased here.
+ *
+ * @param[in] data Chunk data.
+ * @param[in] length Chunk length.
+ *
+ * @retval true Operation executed correctly.
+ * @retval false The patch is not valid, it does not apply to the running image
+ * or the new image could not be written. The update is aborted.
+ */
+bool fw_patch_write(const uint8_t * data, size_t length);
+
+/**
+ * @brief Finish the application of the patch, validating the new image.
+ *
+ * @retval true The new image is selected to be booted.
+ * @retval false The patch is not complete or the new image is not valid.
+ */
+bool fw_patch_finish(void);
+
+/**
+ * @brief Abort the application of the patch.
+ */
+void fw_patch_abort(void);
+
+#endif // FW_PATCH_H
+
+/** @} */
+
+/******************************** End of file *********************************/
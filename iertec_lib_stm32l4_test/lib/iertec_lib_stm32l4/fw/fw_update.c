@@ -0,0 +1,632 @@
+/*******************************************************************************
+ * @file fw_update.c
+ * @author juanmanuel.fernandez@iertec.com
+ * @date 19 Oct 2026
+ * @brief A/B firmware update engine. The new image is streamed into the
+ * inactive slot while it is received, and two metadata pages keep the slot
+ * to boot and the number of boot attempts of a non confirmed image.
+ * @ingroup fw_update
+ ******************************************************************************/
+
+/**
+ * @addtogroup fw_update
+ * @{
+ */
+
+#include "fw_update.h"
+#include "itf_flash.h"
+#include "crypt_crc32.h"
+#include "debug_util.h"
+
+#include <string.h>
+
+/****************************************************************************//*
+ * Constants and macros
+ ******************************************************************************/
+
+/** Size of a double word, the FLASH programming unit. */
+#define FW_UPDATE_DWORD_BYTES     (8u)
+
+/** Size of the buffer used to verify the image stored in FLASH. */
+#define FW_UPDATE_VERIFY_BYTES    (64u)
+
+/** Magic number that identifies a metadata record. */
+#define FW_UPDATE_RECORD_MAGIC    (0x50555746ul)
+
+/** Number of metadata pages. */
+#define FW_UPDATE_META_PAGES      (2u)
+
+/** Value of the erased bytes. */
+#define FW_UPDATE_ERASED          (0xFFu)
+
+/** The image of the record has been confirmed. */
+#define FW_UPDATE_STATE_CONFIRMED (0x01u)
+
+/** The image of the record is pending of confirmation. */
+#define FW_UPDATE_STATE_PENDING   (0x02u)
+
+/****************************************************************************//*
+ * Private data types
+ ******************************************************************************/
+
+/**
+ * @brief Metadata record. The records are appended to the metadata pages and
+ * the valid one with the highest sequence number selects the slot to boot.
+ */
+typedef struct
+{
+    /** Magic number. */
+    uint32_t magic;
+
+    /** Selected slot. */
+    uint8_t slot;
+
+    /** State of the image of the selected slot. */
+    uint8_t state;
+
+    /** Number of times the image has been booted while pending. */
+    uint16_t attempts;
+
+    /** Size of the image. */
+    uint32_t size;
+
+    /** CRC32 of the image. */
+    uint32_t crc;
+
+    /** Sequence number, incremented on each appended record. */
+    uint32_t seq;
+
+    /** CRC32 of the previous fields, used to discard torn records. */
+    uint32_t check;
+} fw_update_record_t;
+
+/** @brief State of the update in progress. */
+typedef struct
+{
+    /** An update is in progress. */
+    bool b_active;
+
+    /** Slot being written. */
+    fw_update_slot_t slot;
+
+    /** Starting address of the slot being written. */
+    uint32_t address;
+
+    /** Size of the image. */
+    uint32_t size;
+
+    /** Number of bytes already programmed. */
+    uint32_t write_offset;
+
+    /** Number of bytes already erased. */
+    uint32_t erase_offset;
+
+    /** Running CRC32 of the received data. */
+    uint32_t crc;
+
+    /** Received bytes pending to be programmed. */
+    union
+    {
+        uint64_t dword;
+        uint8_t  bytes[FW_UPDATE_DWORD_BYTES];
+    } buffer;
+
+    /** Number of bytes in the buffer. */
+    size_t buffer_len;
+} fw_update_state_t;
+
+/****************************************************************************//*
+ * Private data
+ ******************************************************************************/
+
+/** Last valid record, it selects the slot to boot. */
+static fw_update_record_t record_active;
+
+/** Last confirmed record. */
+static fw_update_record_t record_confirmed;
+
+/** Metadata page where the records are appended. */
+static uint32_t meta_page;
+
+/** Offset of the next free record in the metadata page. */
+static uint32_t meta_offset;
+
+/** Update in progress. */
+static fw_update_state_t update;
+
+/****************************************************************************//*
+ * Private code prototypes
+ ******************************************************************************/
+
+/**
+ * @brief Calculate the integrity check of a record.
+ *
+ * @param[in] record Record.
+ *
+ * @return The CRC32 of the record fields previous to the check.
+ */
+static uint32_t fw_update_record_check(const fw_update_record_t * record);
+
+/**
+ * @brief Fill the magic and check fields of a record.
+ *
+ * @param[in,out] record Record.
+ */
+static void fw_update_record_seal(fw_update_record_t * record);
+
+/**
+ * @brief Check if a record is valid.
+ *
+ * @param[in] record Record.
+ *
+ * @return true if the record is complete and selects a valid slot, false
+ * otherwise.
+ */
+static bool fw_update_record_is_valid(const fw_update_record_t * record);
+
+/**
+ * @brief Check if a record is newer than another one. The sequence numbers are
+ * compared modulo 2^32.
+ *
+ * @param[in] record Record.
+ * @param[in] other Record to compare with.
+ *
+ * @return true if the record is newer, false otherwise.
+ */
+static bool fw_update_record_is_newer(const fw_update_record_t * record,
+                                      const fw_update_record_t * other);
+
+/**
+ * @brief Check if a record is erased.
+ *
+ * @param[in] record Record.
+ *
+ * @return true if all the bytes of the record are erased, false otherwise.
+ */
+static bool fw_update_record_is_erased(const fw_update_record_t * record);
+
+/**
+ * @brief Write a record at the next free position of the metadata page.
+ *
+ * @param[in] record Record.
+ *
+ * @retval true Operation executed correctly.
+ * @retval false An error occurred.
+ */
+static bool fw_update_record_write(const fw_update_record_t * record);
+
+/**
+ * @brief Append a new record to the metadata page, selecting it as the active
+ * one. If the page is full, the records continue in the other page: it is
+ * erased, the last confirmed record is copied and then the new record is
+ * written. The full page is not erased until the next switch, so a power loss
+ * at any point keeps either the previous or the new record as the active one,
+ * and the confirmed record is never lost.
+ *
+ * @param[in,out] record Record. The magic, sequence and check fields are
+ * filled.
+ *
+ * @retval true Operation executed correctly.
+ * @retval false An error occurred.
+ */
+static bool fw_update_record_append(fw_update_record_t * record);
+
+/**
+ * @brief Program the buffered double word at the write pointer.
+ *
+ * @retval true Operation executed correctly.
+ * @retval false An error occurred.
+ */
+static bool fw_update_program(void);
+
+/**
+ * @brief Calculate the CRC32 of the image stored in the slot being written.
+ *
+ * @return The CRC32 of the stored image.
+ */
+static uint32_t fw_update_stored_crc(void);
+
+/****************************************************************************//*
+ * Public code
+ ******************************************************************************/
+
+bool
+fw_update_init (void)
+{
+    DEBUG_ASSERT_STATIC((sizeof(fw_update_record_t) % FW_UPDATE_DWORD_BYTES)
+                        == 0u);
+
+    fw_update_record_t record;
+    uint32_t           used[FW_UPDATE_META_PAGES] = {0};
+    bool               b_active    = false;
+    bool               b_confirmed = false;
+    bool               ret         = true;
+
+    // Without metadata the slot A is the confirmed one, the record is complete
+    // so it can be copied as any other one when the pages are switched
+    (void)memset(&record_confirmed, 0, sizeof(record_confirmed));
+    record_confirmed.slot  = FW_UPDATE_SLOT_A;
+    record_confirmed.state = FW_UPDATE_STATE_CONFIRMED;
+    fw_update_record_seal(&record_confirmed);
+    record_active          = record_confirmed;
+    meta_page              = 0;
+    update.b_active        = false;
+
+    for (uint32_t page = 0; ret && (page < FW_UPDATE_META_PAGES); page++)
+    {
+        for (uint32_t offset = 0;
+             ret && ((offset + sizeof(record)) <= FW_UPDATE_PAGE_SIZE);
+             offset += sizeof(record))
+        {
+            ret = itf_flash_read(FW_UPDATE_META_ADDRESS
+                                 + (page * FW_UPDATE_PAGE_SIZE) + offset,
+                                 (uint8_t *)&record, sizeof(record));
+
+            if (!ret || fw_update_record_is_erased(&record))
+            {
+                break;
+            }
+
+            // Torn records are skipped, but their position is not reused
+            used[page] = offset + sizeof(record);
+
+            if (fw_update_record_is_valid(&record)
+                && (!b_active
+                    || fw_update_record_is_newer(&record, &record_active)))
+            {
+                record_active = record;
+                meta_page     = page;
+                b_active      = true;
+            }
+
+            if (fw_update_record_is_valid(&record)
+                && (FW_UPDATE_STATE_CONFIRMED == record.state)
+                && (!b_confirmed
+                    || fw_update_record_is_newer(&record, &record_confirmed)))
+            {
+                record_confirmed = record;
+                b_confirmed      = true;
+            }
+        }
+    }
+
+    // The records are appended to the page of the active one
+    meta_offset = used[meta_page];
+
+    return ret;
+}
+
+bool
+fw_update_boot (fw_update_slot_t * slot)
+{
+    DEBUG_ASSERT(NULL != slot);
+
+    fw_update_record_t record = record_active;
+    bool               ret    = true;
+
+    if (FW_UPDATE_STATE_PENDING == record.state)
+    {
+        if (record.attempts >= FW_UPDATE_ATTEMPTS_MAX)
+        {
+            // The new image has not been confirmed, roll back
+            record = record_confirmed;
+        }
+        else
+        {
+            record.attempts++;
+        }
+
+        ret = fw_update_record_append(&record);
+    }
+
+    *slot = (fw_update_slot_t)record.slot;
+
+    return ret;
+}
+
+bool
+fw_update_confirm (void)
+{
+    fw_update_record_t record = record_active;
+    bool               ret    = true;
+
+    if (FW_UPDATE_STATE_CONFIRMED != record.state)
+    {
+        record.state = FW_UPDATE_STATE_CONFIRMED;
+        ret          = fw_update_record_append(&record);
+    }
+
+    return ret;
+}
+
+fw_update_slot_t
+fw_update_get_slot (void)
+{
+    return (fw_update_slot_t)record_active.slot;
+}
+
+uint32_t
+fw_update_get_slot_address (fw_update_slot_t slot)
+{
+    DEBUG_ASSERT(slot < FW_UPDATE_SLOT_COUNT);
+
+    return (FW_UPDATE_SLOT_A == slot) ? FW_UPDATE_SLOT_A_ADDRESS
+                                      : FW_UPDATE_SLOT_B_ADDRESS;
+}
+
+bool
+fw_update_begin (size_t size)
+{
+    // The running image can not be overwritten, neither the confirmed one
+    if ((0u == size) || (size > FW_UPDATE_SLOT_SIZE)
+        || (FW_UPDATE_STATE_CONFIRMED != record_active.state))
+    {
+        return false;
+    }
+
+    update.slot         = (FW_UPDATE_SLOT_A == record_active.slot)
+                          ? FW_UPDATE_SLOT_B : FW_UPDATE_SLOT_A;
+    update.address      = fw_update_get_slot_address(update.slot);
+    update.size         = size;
+    update.write_offset = 0;
+    update.erase_offset = 0;
+    update.crc          = CRYPT_CRC32_INIT_VAL;
+    update.buffer_len   = 0;
+    update.b_active     = true;
+
+    return true;
+}
+
+bool
+fw_update_erase_step (void)
+{
+    uint32_t end = ((update.size + FW_UPDATE_PAGE_SIZE - 1u)
+                    / FW_UPDATE_PAGE_SIZE) * FW_UPDATE_PAGE_SIZE;
+    bool     ret = update.b_active;
+
+    if (ret && (update.erase_offset < end))
+    {
+        ret = itf_flash_erase(update.address + update.erase_offset,
+                              FW_UPDATE_PAGE_SIZE);
+        update.erase_offset += FW_UPDATE_PAGE_SIZE;
+    }
+
+    if (!ret)
+    {
+        update.b_active = false;
+    }
+
+    return ret;
+}
+
+size_t
+fw_update_get_writable (void)
+{
+    uint32_t limit = (update.erase_offset < update.size) ? update.erase_offset
+                                                         : update.size;
+
+    return update.b_active
+           ? (size_t)(limit - (update.write_offset + update.buffer_len)) : 0u;
+}
+
+bool
+fw_update_write (const uint8_t * data, size_t length)
+{
+    DEBUG_ASSERT(NULL != data);
+
+    // Only the erased pages can be programmed
+    bool ret = update.b_active && (length <= fw_update_get_writable());
+
+    if (ret)
+    {
+        update.crc = crypt_crc32(data, length, update.crc);
+    }
+
+    for (size_t i = 0; ret && (i < length); i++)
+    {
+        update.buffer.bytes[update.buffer_len++] = data[i];
+
+        if (FW_UPDATE_DWORD_BYTES == update.buffer_len)
+        {
+            ret = fw_update_program();
+        }
+    }
+
+    if (!ret)
+    {
+        update.b_active = false;
+    }
+
+    return ret;
+}
+
+bool
+fw_update_finish (uint32_t crc)
+{
+    bool ret = update.b_active
+               && ((update.write_offset + update.buffer_len) == update.size)
+               && (update.crc == crc);
+
+    if (ret && (update.buffer_len > 0u))
+    {
+        // Pad the last double word
+        (void)memset(&update.buffer.bytes[update.buffer_len], FW_UPDATE_ERASED,
+                     FW_UPDATE_DWORD_BYTES - update.buffer_len);
+        ret = fw_update_program();
+    }
+
+    if (ret)
+    {
+        ret = fw_update_stored_crc() == crc;
+    }
+
+    if (ret)
+    {
+        fw_update_record_t record;
+
+        (void)memset(&record, 0, sizeof(record));
+        record.slot  = (uint8_t)update.slot;
+        record.state = FW_UPDATE_STATE_PENDING;
+        record.size  = update.size;
+        record.crc   = crc;
+        ret          = fw_update_record_append(&record);
+    }
+
+    update.b_active = false;
+
+    return ret;
+}
+
+void
+fw_update_abort (void)
+{
+    update.b_active = false;
+}
+
+/****************************************************************************//*
+ * Private code
+ ******************************************************************************/
+
+static uint32_t
+fw_update_record_check (const fw_update_record_t * record)
+{
+    return crypt_crc32((const uint8_t *)record,
+                       offsetof(fw_update_record_t, check),
+                       CRYPT_CRC32_INIT_VAL);
+}
+
+static void
+fw_update_record_seal (fw_update_record_t * record)
+{
+    record->magic = FW_UPDATE_RECORD_MAGIC;
+    record->check = fw_update_record_check(record);
+}
+
+static bool
+fw_update_record_is_valid (const fw_update_record_t * record)
+{
+    return (FW_UPDATE_RECORD_MAGIC == record->magic)
+           && (fw_update_record_check(record) == record->check)
+           && (record->slot < FW_UPDATE_SLOT_COUNT);
+}
+
+static bool
+fw_update_record_is_newer (const fw_update_record_t * record,
+                           const fw_update_record_t * other)
+{
+    return (int32_t)(record->seq - other->seq) > 0;
+}
+
+static bool
+fw_update_record_is_erased (const fw_update_record_t * record)
+{
+    const uint8_t * bytes = (const uint8_t *)record;
+
+    for (size_t i = 0; i < sizeof(fw_update_record_t); i++)
+    {
+        if (FW_UPDATE_ERASED != bytes[i])
+        {
+            return false;
+        }
+    }
+
+    return true;
+}
+
+static bool
+fw_update_record_write (const fw_update_record_t * record)
+{
+    uint32_t address = FW_UPDATE_META_ADDRESS
+                       + (meta_page * FW_UPDATE_PAGE_SIZE) + meta_offset;
+    bool     ret     = itf_flash_write(address, (const uint8_t *)record,
+                                       sizeof(*record));
+
+    // On failure the position may be partially programmed, so skip it
+    meta_offset += sizeof(*record);
+
+    return ret;
+}
+
+static bool
+fw_update_record_append (fw_update_record_t * record)
+{
+    bool ret = true;
+
+    record->seq = record_active.seq + 1u;
+    fw_update_record_seal(record);
+
+    if ((meta_offset + sizeof(*record)) > FW_UPDATE_PAGE_SIZE)
+    {
+        // The full page keeps the active record until the new one is written
+        meta_page   = (meta_page + 1u) % FW_UPDATE_META_PAGES;
+        meta_offset = 0;
+        ret         = itf_flash_erase(FW_UPDATE_META_ADDRESS
+                                      + (meta_page * FW_UPDATE_PAGE_SIZE),
+                                      FW_UPDATE_PAGE_SIZE);
+
+        // Keep the confirmed image in case the new record selects another one.
+        // The copy has an older sequence number, so it does not become active.
+        if (ret && (FW_UPDATE_STATE_CONFIRMED != record->state))
+        {
+            ret = fw_update_record_write(&record_confirmed);
+        }
+    }
+
+    if (ret)
+    {
+        ret = fw_update_record_write(record);
+    }
+
+    if (ret)
+    {
+        record_active = *record;
+
+        if (FW_UPDATE_STATE_CONFIRMED == record->state)
+        {
+            record_confirmed = *record;
+        }
+    }
+
+    return ret;
+}
+
+static bool
+fw_update_program (void)
+{
+    bool ret = itf_flash_write(update.address + update.write_offset,
+                               update.buffer.bytes, FW_UPDATE_DWORD_BYTES);
+
+    update.write_offset += update.buffer_len;
+    update.buffer_len    = 0;
+
+    return ret;
+}
+
+static uint32_t
+fw_update_stored_crc (void)
+{
+    uint8_t  buffer[FW_UPDATE_VERIFY_BYTES];
+    uint32_t crc = CRYPT_CRC32_INIT_VAL;
+
+    for (uint32_t offset = 0; offset < update.size;
+         offset += FW_UPDATE_VERIFY_BYTES)
+    {
+        size_t length = update.size - offset;
+
+        if (length > FW_UPDATE_VERIFY_BYTES)
+        {
+            length = FW_UPDATE_VERIFY_BYTES;
+        }
+
+        // The slot is read by whole words, the padding is not included
+        (void)itf_flash_read(update.address + offset, buffer,
+                             FW_UPDATE_VERIFY_BYTES);
+        crc = crypt_crc32(buffer, length, crc);
+    }
+
+    return crc;
+}
+
+/** @} */
+
+/******************************** End of file *********************************/
@@ -0,0 +1,187 @@
+/*******************************************************************************
+ * @file fw_update.h
+ * @author juanmanuel.fernandez@iertec.com
+ * @date 19 Oct 2026
+ * @brief A/B firmware update engine. The new image is streamed into the
+ * inactive slot while it is received, and two metadata pages keep the slot
+ * to boot and the number of boot attempts of a non confirmed image.
+ * @ingroup fw_update
+ ******************************************************************************/
+
+/**
+ * @defgroup fw_update fw_update
+ * @brief A/B firmware update engine.
+ * @{
+ */
+
+#ifndef FW_UPDATE_H
+#define FW_UPDATE_H
+
+#include <stdbool.h>
+#include <stdint.h>
+#include <stddef.h>
+
+/** Size of a FLASH page. */
+#ifndef FW_UPDATE_PAGE_SIZE
+#define FW_UPDATE_PAGE_SIZE      (0x800ul)
+#endif
+
+/** Starting address of the slot A. It must be page aligned. */
+#ifndef FW_UPDATE_SLOT_A_ADDRESS
+#define FW_UPDATE_SLOT_A_ADDRESS (0x08008000ul)
+#endif
+
+/** Starting address of the slot B. It must be page aligned. */
+#ifndef FW_UPDATE_SLOT_B_ADDRESS
+#define FW_UPDATE_SLOT_B_ADDRESS (0x08042800ul)
+#endif
+
+/** Size of each slot. It must be a multiple of the page size. */
+#ifndef FW_UPDATE_SLOT_SIZE
+#define FW_UPDATE_SLOT_SIZE      (0x3A800ul)
+#endif
+
+/**
+ * Address of the two consecutive pages used to store the update metadata. The
+ * records are appended to one page and, when it is full, they continue in the
+ * other one.
+ */
+#ifndef FW_UPDATE_META_ADDRESS
+#define FW_UPDATE_META_ADDRESS   (0x0807F000ul)
+#endif
+
+/**
+ * Number of times a non confirmed image is booted before rolling back to the
+ * last confirmed one.
+ */
+#ifndef FW_UPDATE_ATTEMPTS_MAX
+#define FW_UPDATE_ATTEMPTS_MAX   (3u)
+#endif
+
+/** @brief Firmware slots. */
+typedef enum
+{
+    FW_UPDATE_SLOT_A = 0,
+    FW_UPDATE_SLOT_B,
+    FW_UPDATE_SLOT_COUNT,
+} fw_update_slot_t;
+
+/**
+ * @brief Initialize the update engine loading the metadata stored in FLASH. If
+ * no metadata is found, the slot A is considered the confirmed one.
+ *
+ * @retval true Operation executed correctly.
+ * @retval false An error occurred.
+ */
+bool fw_update_init(void);
+
+/**
+ * @brief Register a boot of the selected image. It must be called once on
+ * each boot, before jumping to the image. If the selected image has not been
+ * confirmed after @ref FW_UPDATE_ATTEMPTS_MAX boots, the last confirmed image
+ * is selected again.
+ *
+ * @param[out] slot The slot that must be booted.
+ *
+ * @retval true Operation executed correctly.
+ * @retval false An error occurred updating the metadata.
+ */
+bool fw_update_boot(fw_update_slot_t * slot);
+
+/**
+ * @brief Confirm that the running image works properly, so it is not rolled
+ * back anymore.
+ *
+ * @retval true Operation executed correctly.
+ * @retval false An error occurred updating the metadata.
+ */
+bool fw_update_confirm(void);
+
+/**
+ * @brief Get the slot that is selected to be booted.
+ *
+ * @return The selected slot.
+ */
+fw_update_slot_t fw_update_get_slot(void);
+
+/**
+ * @brief Get the starting address of a slot.
+ *
+ * @param[in] slot Slot.
+ *
+ * @return The starting address of the slot.
+ */
+uint32_t fw_update_get_slot_address(fw_update_slot_t slot);
+
+/**
+ * @brief Start the update of a new image. It is written into the slot that is
+ * not selected to be booted. No page is erased here, see
+ * @ref fw_update_erase_step.
+ *
+ * @param[in] size Size of the image in bytes.
+ *
+ * @retval true Operation executed correctly.
+ * @retval false The image does not fit in the slot or the selected image is
+ * pending of confirmation.
+ */
+bool fw_update_begin(size_t size);
+
+/**
+ * @brief Erase the next page of the image, ahead of the write pointer. A page
+ * erase stalls the FLASH for about 22 ms, so it is not done by
+ * @ref fw_update_write: this function is called from a low priority context or
+ * while the next chunk is received, until the whole image is erased.
+ *
+ * @retval true A page has been erased or all the pages are already erased.
+ * @retval false No update is in progress or the FLASH could not be erased. The
+ * update is aborted.
+ */
+bool fw_update_erase_step(void);
+
+/**
+ * @brief Get the number of bytes that can be written without erasing more
+ * pages.
+ *
+ * @return The number of bytes that @ref fw_update_write accepts, 0 if no
+ * update is in progress.
+ */
+size_t fw_update_get_writable(void);
+
+/**
+ * @brief Write the next chunk of the image. The chunks can have any length, so
+ * they can be passed as they are received from the communication link. The
+ * chunk is only programmed, its pages must have been erased by
+ * @ref fw_update_erase_step.
+ *
+ * @param[in] data Chunk data.
+ * @param[in] length Chunk length.
+ *
+ * @retval true Operation executed correctly.
+ * @retval false No update is in progress, the chunk exceeds the erased pages
+ * or the image size, or the FLASH could not be written. The update is aborted.
+ */
+bool fw_update_write(const uint8_t * data, size_t length);
+
+/**
+ * @brief Finish the update. The image is validated against its CRC32 both as it
+ * was received and as it is stored in FLASH. On success, the new image is
+ * selected to be booted, pending of confirmation.
+ *
+ * @param[in] crc Expected CRC32 of the image.
+ *
+ * @retval true The new image is selected to be booted.
+ * @retval false The image is not complete, the validation failed or the
+ * metadata could not be updated.
+ */
+bool fw_update_finish(uint32_t crc);
+
+/**
+ * @brief Abort the update in progress. The selected image is not modified.
+ */
+void fw_update_abort(void);
+
+#endif // FW_UPDATE_H
+
+/** @} */
+
+/******************************** End of file *********************************/
@@ -13,6 +13,12 @@
 
 #include "itf_clk.h"
 
+#include "FreeRTOS.h"
+#include "task.h"
+
+#include <stddef.h>
+#include <string.h>
+
 /****************************************************************************//*
  * Private data
  ******************************************************************************/
@@ -20,6 +26,88 @@
 // Board configuration
 extern const itf_bsp_init_ll_t itf_clk_init_ll;
 
+/** MSI range of each clock level. */
+static const uint32_t itf_clk_msi_range[ITF_CLK_LEVEL_COUNT] =
+{
+    ITF_CLK_LEVEL_LOW_MSI_RANGE,
+    ITF_CLK_LEVEL_MID_MSI_RANGE,
+    ITF_CLK_LEVEL_HIGH_MSI_RANGE,
+};
+
+/** Current clock level, @ref ITF_CLK_LEVEL_COUNT if the governor is not
+ * active. */
+static volatile itf_clk_level_t itf_clk_level = ITF_CLK_LEVEL_COUNT;
+
+/** Clock level set by the board clock configuration, @ref ITF_CLK_LEVEL_COUNT
+ * if the governor is not active. */
+static itf_clk_level_t itf_clk_level_board = ITF_CLK_LEVEL_COUNT;
+
+/** Clock level used when no subsystem requests a higher one. */
+static itf_clk_level_t itf_clk_idle = ITF_CLK_LEVEL_IDLE;
+
+/** Clock level requested by each subsystem. */
+static itf_clk_level_t itf_clk_request_level[ITF_CLK_HANDLE_MAX];
+
+/** Next handler to be assigned. */
+static uint8_t h_itf_clk_index;
+
+/** Clock change notification functions. */
+static itf_clk_notify_t itf_clk_notify[ITF_CLK_NOTIFY_MAX];
+
+/** Number of clock change notification functions. */
+static size_t itf_clk_notify_count;
+
+/** Clock used to measure the time spent in each clock level. */
+static itf_clk_clock_t itf_clk_clock;
+
+/** Clock level statistics. */
+static itf_clk_stats_t itf_clk_stats;
+
+/** Clock value of the last clock level change. */
+static uint32_t itf_clk_mark;
+
+/****************************************************************************//*
+ * Private code prototypes
+ ******************************************************************************/
+
+/**
+ * @brief Apply the highest of the requested levels and the idle level. It must
+ * be called with the scheduler suspended.
+ *
+ * @retval true If the clock runs at the needed level.
+ * @retval false If the governor is not active or an error occurs.
+ */
+static bool itf_clk_update_level(void);
+
+/**
+ * @brief Change the clock level, keeping the voltage scaling range and the
+ * flash latency valid for the core frequency at every step.
+ *
+ * @param[in] level New clock level.
+ *
+ * @retval true If the clock level is changed.
+ * @retval false If an error occurs.
+ */
+static bool itf_clk_set_level(itf_clk_level_t level);
+
+/**
+ * @brief Change the MSI range used as system clock. The flash latency and the
+ * HAL time base are updated for the new frequency.
+ *
+ * @param[in] msi_range New MSI range.
+ *
+ * @retval true If the MSI range is changed.
+ * @retval false If an error occurs.
+ */
+static bool itf_clk_set_msi_range(uint32_t msi_range);
+
+/**
+ * @brief Account the time spent in the current clock level since the last
+ * mark and start a new measurement. It must be called with the scheduler
+ * suspended.
+ */
+static void itf_clk_update_stats(void);
+
 /****************************************************************************//*
  * Public code
  ******************************************************************************/
@@ -38,6 +126,28 @@ itf_clk_init (void)
         return false;
     }
 
+    // The governor is only active if the board runs on one of the levels
+    itf_clk_level = ITF_CLK_LEVEL_COUNT;
+
+    if (__HAL_RCC_GET_SYSCLK_SOURCE() == RCC_SYSCLKSOURCE_STATUS_MSI)
+    {
+        for (size_t i = 0; i < ITF_CLK_LEVEL_COUNT; i++)
+        {
+            if (__HAL_RCC_GET_MSI_RANGE() == itf_clk_msi_range[i])
+            {
+                itf_clk_level = (itf_clk_level_t)i;
+            }
+        }
+    }
+
+    itf_clk_level_board = itf_clk_level;
+
+    if ((ITF_CLK_LEVEL_COUNT != itf_clk_level)
+        && (itf_clk_idle != itf_clk_level))
+    {
+        return itf_clk_set_level(itf_clk_idle);
+    }
+
     return true;
 }
 
@@ -48,9 +158,257 @@ itf_clk_deinit (void)
 
     ret = HAL_RCC_DeInit() == HAL_OK;
 
+    itf_clk_level = ITF_CLK_LEVEL_COUNT;
+
+    return ret;
+}
+
+uint8_t
+itf_clk_register (void)
+{
+    uint8_t handle = H_ITF_CLK_NONE;
+
+    vTaskSuspendAll();
+
+    if (h_itf_clk_index < ITF_CLK_HANDLE_MAX)
+    {
+        handle                        = h_itf_clk_index++;
+        itf_clk_request_level[handle] = ITF_CLK_LEVEL_LOW;
+    }
+
+    (void)xTaskResumeAll();
+
+    return handle;
+}
+
+bool
+itf_clk_request (uint8_t h_itf_clk, itf_clk_level_t level)
+{
+    bool ret;
+
+    configASSERT(h_itf_clk < h_itf_clk_index);
+    configASSERT(level < ITF_CLK_LEVEL_COUNT);
+
+    // The scheduler is suspended, and not the interrupts, because the clock
+    // change waits for the oscillator and the HAL time base must keep running
+    vTaskSuspendAll();
+    itf_clk_request_level[h_itf_clk] = level;
+    ret                              = itf_clk_update_level();
+    (void)xTaskResumeAll();
+
+    return ret;
+}
+
+bool
+itf_clk_set_idle (itf_clk_level_t level)
+{
+    bool ret;
+
+    configASSERT(level < ITF_CLK_LEVEL_COUNT);
+
+    vTaskSuspendAll();
+    itf_clk_idle = level;
+    ret          = itf_clk_update_level();
+    (void)xTaskResumeAll();
+
     return ret;
 }
 
+itf_clk_level_t
+itf_clk_get_level (void)
+{
+    return itf_clk_level;
+}
+
+uint32_t
+itf_clk_get_board_freq (uint32_t freq)
+{
+    itf_clk_level_t level = itf_clk_level;
+    uint32_t        board = freq;
+
+    // The clocks derived from the core clock scale with the MSI frequency
+    if ((ITF_CLK_LEVEL_COUNT != level)
+        && (ITF_CLK_LEVEL_COUNT != itf_clk_level_board))
+    {
+        uint32_t range       = itf_clk_msi_range[level];
+        uint32_t range_board = itf_clk_msi_range[itf_clk_level_board];
+        uint32_t msi         = MSIRangeTable[range >> RCC_CR_MSIRANGE_Pos];
+        uint32_t msi_board   = MSIRangeTable[range_board
+                                             >> RCC_CR_MSIRANGE_Pos];
+
+        board = (uint32_t)(((uint64_t)freq * msi_board) / msi);
+    }
+
+    return board;
+}
+
+bool
+itf_clk_add_notify (itf_clk_notify_t notify)
+{
+    bool ret = false;
+
+    vTaskSuspendAll();
+
+    for (size_t i = 0; i < itf_clk_notify_count; i++)
+    {
+        if (itf_clk_notify[i] == notify)
+        {
+            ret = true;
+        }
+    }
+
+    if (!ret && (itf_clk_notify_count < ITF_CLK_NOTIFY_MAX))
+    {
+        itf_clk_notify[itf_clk_notify_count++] = notify;
+        ret                                    = true;
+    }
+
+    (void)xTaskResumeAll();
+
+    return ret;
+}
+
+void
+itf_clk_set_clock (itf_clk_clock_t clock)
+{
+    vTaskSuspendAll();
+
+    itf_clk_clock = clock;
+    (void)memset(&itf_clk_stats, 0, sizeof(itf_clk_stats));
+
+    if (NULL != itf_clk_clock)
+    {
+        itf_clk_mark = itf_clk_clock();
+    }
+
+    (void)xTaskResumeAll();
+}
+
+void
+itf_clk_get_stats (itf_clk_stats_t * stats)
+{
+    vTaskSuspendAll();
+    itf_clk_update_stats();
+    *stats = itf_clk_stats;
+    (void)xTaskResumeAll();
+}
+
+/****************************************************************************//*
+ * Private code
+ ******************************************************************************/
+
+static bool
+itf_clk_update_level (void)
+{
+    bool ret = true;
+
+    if (ITF_CLK_LEVEL_COUNT == itf_clk_level)
+    {
+        ret = false;
+    }
+    else
+    {
+        itf_clk_level_t target = itf_clk_idle;
+
+        for (size_t i = 0; i < h_itf_clk_index; i++)
+        {
+            if (itf_clk_request_level[i] > target)
+            {
+                target = itf_clk_request_level[i];
+            }
+        }
+
+        if (target != itf_clk_level)
+        {
+            ret = itf_clk_set_level(target);
+        }
+    }
+
+    return ret;
+}
+
+static bool
+itf_clk_set_level (itf_clk_level_t level)
+{
+    uint32_t msi_range = itf_clk_msi_range[level];
+    bool     ret       = true;
+
+    if (msi_range > ITF_CLK_RANGE_2_MSI_MAX)
+    {
+        // The voltage is raised before the frequency. It waits for the
+        // regulator to be ready
+        ret = HAL_PWREx_ControlVoltageScaling(PWR_REGULATOR_VOLTAGE_SCALE1)
+              == HAL_OK;
+        ret = ret && itf_clk_set_msi_range(msi_range);
+    }
+    else if (HAL_PWREx_GetVoltageRange() == PWR_REGULATOR_VOLTAGE_SCALE1)
+    {
+        // The frequency is lowered before the voltage. The flash latency set
+        // for the range 1 may be too short for the range 2, so the longest one
+        // is used until the latency for the new range is computed
+        ret = itf_clk_set_msi_range(msi_range);
+
+        if (ret)
+        {
+            __HAL_FLASH_SET_LATENCY(FLASH_LATENCY_3);
+            ret = __HAL_FLASH_GET_LATENCY() == FLASH_LATENCY_3;
+        }
+
+        ret = ret
+              && (HAL_PWREx_ControlVoltageScaling(PWR_REGULATOR_VOLTAGE_SCALE2)
+                  == HAL_OK);
+        ret = ret && itf_clk_set_msi_range(msi_range);
+    }
+    else
+    {
+        ret = itf_clk_set_msi_range(msi_range);
+    }
+
+    if (ret)
+    {
+        itf_clk_update_stats();
+        itf_clk_level = level;
+        itf_clk_stats.count[level]++;
+
+        // The drivers derive their settings from the new clock
+        for (size_t i = 0; i < itf_clk_notify_count; i++)
+        {
+            itf_clk_notify[i]();
+        }
+    }
+
+    return ret;
+}
+
+static bool
+itf_clk_set_msi_range (uint32_t msi_range)
+{
+    RCC_OscInitTypeDef osc_init = {0};
+
+    // The current calibration is kept
+    osc_init.OscillatorType      = RCC_OSCILLATORTYPE_MSI;
+    osc_init.MSIState            = RCC_MSI_ON;
+    osc_init.MSICalibrationValue = READ_BIT(RCC->ICSCR, RCC_ICSCR_MSITRIM)
+                                   >> RCC_ICSCR_MSITRIM_Pos;
+    osc_init.MSIClockRange       = msi_range;
+    osc_init.PLL.PLLState        = RCC_PLL_NONE;
+
+    return HAL_RCC_OscConfig(&osc_init) == HAL_OK;
+}
+
+static void
+itf_clk_update_stats (void)
+{
+    if ((NULL != itf_clk_clock) && (itf_clk_level < ITF_CLK_LEVEL_COUNT))
+    {
+        uint32_t now = itf_clk_clock();
+
+        itf_clk_stats.residency[itf_clk_level] += (uint32_t)(now
+                                                             - itf_clk_mark);
+        itf_clk_mark                            = now;
+    }
+}
+
 /** @} */
 
 /******************************** End of file *********************************/
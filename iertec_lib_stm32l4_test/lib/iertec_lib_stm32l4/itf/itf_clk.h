@@ -9,6 +9,15 @@
 /**
  * @defgroup itf_clk itf_clk
  * @brief System clocks initialization.
+ *
+ * Besides the initialization, the module governs the core clock level. The
+ * subsystems register a handle and request the minimum clock level they need,
+ * and the core runs at the highest requested level. Each level selects an MSI
+ * range and the lowest voltage scaling range that supports it. The drivers
+ * whose settings depend on the core clock are notified after each change.
+ *
+ * The governor is only active when the board clock configuration uses the MSI
+ * as system clock with the range of one of the levels.
  * @{
  */
 
@@ -18,8 +27,77 @@
 #include "itf_bsp.h"
 #include "stm32l4xx_hal.h"
 
+#include <stdint.h>
 #include <stdbool.h>
 
+/** Invalid handler value. */
+#define H_ITF_CLK_NONE               (0xFFu)
+
+/** Maximum number of subsystems requesting a clock level. It must be lower
+ * than @ref H_ITF_CLK_NONE. */
+#ifndef ITF_CLK_HANDLE_MAX
+#define ITF_CLK_HANDLE_MAX           (16u)
+#endif
+
+/** Maximum number of clock change notification functions. */
+#ifndef ITF_CLK_NOTIFY_MAX
+#define ITF_CLK_NOTIFY_MAX           (8u)
+#endif
+
+/** MSI range of the low clock level, 4 MHz. */
+#ifndef ITF_CLK_LEVEL_LOW_MSI_RANGE
+#define ITF_CLK_LEVEL_LOW_MSI_RANGE  (RCC_MSIRANGE_6)
+#endif
+
+/** MSI range of the medium clock level, 24 MHz. */
+#ifndef ITF_CLK_LEVEL_MID_MSI_RANGE
+#define ITF_CLK_LEVEL_MID_MSI_RANGE  (RCC_MSIRANGE_9)
+#endif
+
+/** MSI range of the high clock level, 48 MHz. */
+#ifndef ITF_CLK_LEVEL_HIGH_MSI_RANGE
+#define ITF_CLK_LEVEL_HIGH_MSI_RANGE (RCC_MSIRANGE_11)
+#endif
+
+/** Highest MSI range supported by the voltage scaling range 2, 24 MHz. */
+#define ITF_CLK_RANGE_2_MSI_MAX      (RCC_MSIRANGE_9)
+
+/** Initial clock level used when no subsystem requests a higher one, see
+ * @ref itf_clk_set_idle. By default it is the high level, the one set by the
+ * board clock configuration, so the clock is only scaled down when the
+ * application lowers it. */
+#ifndef ITF_CLK_LEVEL_IDLE
+#define ITF_CLK_LEVEL_IDLE           (ITF_CLK_LEVEL_HIGH)
+#endif
+
+/** @brief Available clock levels, from the lowest to the highest. */
+typedef enum
+{
+    ITF_CLK_LEVEL_LOW,
+    ITF_CLK_LEVEL_MID,
+    ITF_CLK_LEVEL_HIGH,
+    ITF_CLK_LEVEL_COUNT,
+} itf_clk_level_t;
+
+/** @brief Function called after a clock level change. It is called with the
+ * scheduler suspended, so it must not block. */
+typedef void (*itf_clk_notify_t)(void);
+
+/** @brief Clock used to measure the time spent in each clock level. It returns
+ * a free running tick count that is allowed to wrap around. */
+typedef uint32_t (*itf_clk_clock_t)(void);
+
+/** @brief Clock level statistics. The times are given in ticks of the clock
+ * set with @ref itf_clk_set_clock, and include the time spent sleeping. */
+typedef struct
+{
+    /** Time spent in each clock level. */
+    uint64_t residency[ITF_CLK_LEVEL_COUNT];
+
+    /** Number of times each clock level has been entered. */
+    uint32_t count[ITF_CLK_LEVEL_COUNT];
+} itf_clk_stats_t;
+
 /**
  * @brief System clocks initialization.
  *
@@ -36,6 +114,84 @@ bool itf_clk_init(void);
  */
 bool itf_clk_deinit(void);
 
+/**
+ * @brief Register a subsystem that requests clock levels. Its initial request
+ * is the lowest level.
+ *
+ * @return Handler to request clock levels, or @ref H_ITF_CLK_NONE if there is
+ * no room for more subsystems.
+ */
+uint8_t itf_clk_register(void);
+
+/**
+ * @brief Set the minimum clock level needed by a subsystem. The clock is
+ * changed before returning. It must not be called from an ISR.
+ *
+ * @param[in] h_itf_clk Handler returned by @ref itf_clk_register.
+ * @param[in] level Minimum clock level.
+ *
+ * @return true If the clock runs at the needed level or higher.
+ * @return false If the clock level cannot be changed.
+ */
+bool itf_clk_request(uint8_t h_itf_clk, itf_clk_level_t level);
+
+/**
+ * @brief Set the clock level used when no subsystem requests a higher one.
+ * The clock is changed before returning. It must not be called from an ISR.
+ *
+ * @param[in] level Idle clock level.
+ *
+ * @return true If the clock runs at the new idle level or higher.
+ * @return false If the clock level cannot be changed.
+ */
+bool itf_clk_set_idle(itf_clk_level_t level);
+
+/**
+ * @brief Get the current clock level.
+ *
+ * @return Current clock level, @ref ITF_CLK_LEVEL_COUNT if the governor is not
+ * active.
+ */
+itf_clk_level_t itf_clk_get_level(void);
+
+/**
+ * @brief Get the frequency that a clock derived from the core clock has at the
+ * clock level set by the board clock configuration. The drivers use it to
+ * keep the frequencies of the board configuration whatever the current level.
+ *
+ * @param[in] freq Frequency of the clock at the current level in Hz.
+ *
+ * @return Frequency of the clock at the board level in Hz, freq if the governor
+ * is not active.
+ */
+uint32_t itf_clk_get_board_freq(uint32_t freq);
+
+/**
+ * @brief Add a function to be called after each clock level change. Adding a
+ * function already added has no effect.
+ *
+ * @param[in] notify Notification function.
+ *
+ * @return true If the function is added.
+ * @return false If there is no room for more functions.
+ */
+bool itf_clk_add_notify(itf_clk_notify_t notify);
+
+/**
+ * @brief Set the clock used to measure the time spent in each clock level. The
+ * statistics are cleared.
+ *
+ * @param[in] clock Clock function, or NULL to stop the accounting.
+ */
+void itf_clk_set_clock(itf_clk_clock_t clock);
+
+/**
+ * @brief Get the clock level statistics. The current level time is included.
+ *
+ * @param[out] stats Clock level statistics.
+ */
+void itf_clk_get_stats(itf_clk_stats_t * stats);
+
 #endif // ITF_CLK_H
 
 /** @} */
@@ -12,6 +12,7 @@
  */
 
 #include "itf_flash.h"
+#include "crypt_crc32.h"
 
 #include "stm32l4xx_hal.h"
 
@@ -22,10 +23,32 @@
  ******************************************************************************/
 
 /** Size of a word. */
-#define ITF_FLASH_WORD_BYTES  (4)
+#define ITF_FLASH_WORD_BYTES   (4)
 
 /** Size of a double word. */
-#define ITF_FLASH_DWORD_BYTES (8)
+#define ITF_FLASH_DWORD_BYTES  (8)
+
+/** Value of an erased double word. */
+#define ITF_FLASH_DWORD_ERASED (0xFFFFFFFFFFFFFFFFull)
+
+/****************************************************************************//*
+ * Private data types
+ ******************************************************************************/
+
+/** @brief Operations needed to update the contents of a page. */
+typedef enum
+{
+    ITF_FLASH_UPDATE_NONE,
+    ITF_FLASH_UPDATE_PROGRAM,
+    ITF_FLASH_UPDATE_ERASE,
+} itf_flash_update_t;
+
+/****************************************************************************//*
+ * Private data
+ ******************************************************************************/
+
+/** Contents of a page while it is erased and programmed again. */
+static uint64_t itf_flash_page_buf[FLASH_PAGE_SIZE / ITF_FLASH_DWORD_BYTES];
 
 /****************************************************************************//*
  * Private code prototypes
@@ -49,6 +72,60 @@ static uint32_t itf_flash_get_page(uint32_t addr);
  */
 static uint32_t itf_flash_get_bank(uint32_t addr);
 
+/**
+ * @brief Read a double word from the FLASH memory.
+ *
+ * @param[in] addr Address of the FLASH memory. It must be double word aligned.
+ *
+ * @return The double word value.
+ */
+static uint64_t itf_flash_read_dword(uint32_t addr);
+
+/**
+ * @brief Compare a region inside a page with the data to write on it.
+ *
+ * @param[in] address Starting address of the region.
+ * @param[in] data Data to write.
+ * @param[in] length Number of bytes of the region. The region can not exceed
+ * the page limits.
+ *
+ * @return The operations needed to update the region.
+ */
+static itf_flash_update_t itf_flash_get_update(uint32_t address,
+                                               const uint8_t * data,
+                                               size_t length);
+
+/**
+ * @brief Program only the double words whose content differs from the data.
+ * The differing double words must be erased.
+ *
+ * @param[in] address Starting address to be written.
+ * @param[in] data Data to write.
+ * @param[in] length Number of bytes to write.
+ *
+ * @retval true Operation executed correctly.
+ * @retval false An error occurred.
+ */
+static bool itf_flash_program(uint32_t address, const uint8_t * data,
+                              size_t length);
+
+/**
+ * @brief Update a region inside a page that must be erased, keeping the rest of
+ * the page. The page is read into a RAM buffer, the region is replaced, and the
+ * page is erased and programmed again from the buffer.
+ *
+ * @param[in] page_addr Starting address of the page.
+ * @param[in] address Starting address of the region.
+ * @param[in] data Data to write.
+ * @param[in] length Number of bytes of the region. The region can not exceed
+ * the page limits.
+ *
+ * @retval true Operation executed correctly.
+ * @retval false An error occurred.
+ */
+static bool itf_flash_rewrite_page(uint32_t page_addr, uint32_t address,
+                                   const uint8_t * data, size_t length);
+
 /****************************************************************************//*
  * Public code
  ******************************************************************************/
@@ -81,7 +158,7 @@ itf_flash_erase (uint32_t address, size_t length)
         ret = HAL_FLASHEx_Erase(&erase_init_struct, &erase_error) == HAL_OK;
     }
 
-    ret = HAL_FLASH_Lock() == HAL_OK;
+    ret = (HAL_FLASH_Lock() == HAL_OK) && ret;
 
     return ret;
 }
@@ -101,7 +178,7 @@ itf_flash_write (uint32_t address, const uint8_t * data, size_t length)
                                 dword) == HAL_OK;
     }
 
-    ret = HAL_FLASH_Lock() == HAL_OK;
+    ret = (HAL_FLASH_Lock() == HAL_OK) && ret;
 
     return ret;
 }
@@ -119,6 +196,56 @@ itf_flash_read (uint32_t address, uint8_t * data, size_t length)
     return true;
 }
 
+bool
+itf_flash_update (uint32_t address, const uint8_t * data, size_t length,
+                  bool verify)
+{
+    bool   ret    = ((address % ITF_FLASH_DWORD_BYTES) == 0u)
+                    && ((length % ITF_FLASH_DWORD_BYTES) == 0u);
+    size_t offset = 0;
+
+    // Process the region page by page
+    while (ret && (offset < length))
+    {
+        uint32_t chunk_addr = address + offset;
+        uint32_t page_addr  = chunk_addr
+                              - ((chunk_addr - FLASH_BASE) % FLASH_PAGE_SIZE);
+        size_t   chunk_len  = (page_addr + FLASH_PAGE_SIZE) - chunk_addr;
+
+        if (chunk_len > (length - offset))
+        {
+            chunk_len = length - offset;
+        }
+
+        itf_flash_update_t update = itf_flash_get_update(chunk_addr,
+                                                         &data[offset],
+                                                         chunk_len);
+
+        if (ITF_FLASH_UPDATE_ERASE == update)
+        {
+            ret = itf_flash_rewrite_page(page_addr, chunk_addr, &data[offset],
+                                         chunk_len);
+        }
+        else if (ITF_FLASH_UPDATE_PROGRAM == update)
+        {
+            ret = itf_flash_program(chunk_addr, &data[offset], chunk_len);
+        }
+
+        offset += chunk_len;
+    }
+
+    if (ret && verify)
+    {
+        uint32_t crc_data  = crypt_crc32(data, length, CRYPT_CRC32_INIT_VAL);
+        uint32_t crc_flash = crypt_crc32((const uint8_t *)address, length,
+                                         CRYPT_CRC32_INIT_VAL);
+
+        ret = crc_data == crc_flash;
+    }
+
+    return ret;
+}
+
 /****************************************************************************//*
  * Private code
  ******************************************************************************/
@@ -171,6 +298,87 @@ itf_flash_get_bank (uint32_t addr)
     return bank;
 }
 
+static uint64_t
+itf_flash_read_dword (uint32_t addr)
+{
+    uint64_t dword;
+
+    (void)memcpy(&dword, (const void *)addr, ITF_FLASH_DWORD_BYTES);
+
+    return dword;
+}
+
+static itf_flash_update_t
+itf_flash_get_update (uint32_t address, const uint8_t * data, size_t length)
+{
+    itf_flash_update_t update = ITF_FLASH_UPDATE_NONE;
+
+    for (size_t i = 0; (i < length) && (ITF_FLASH_UPDATE_ERASE != update);
+         i += ITF_FLASH_DWORD_BYTES)
+    {
+        uint64_t dword_old = itf_flash_read_dword(address + i);
+        uint64_t dword_new;
+
+        (void)memcpy(&dword_new, &data[i], ITF_FLASH_DWORD_BYTES);
+
+        if (dword_old != dword_new)
+        {
+            // A double word can be programmed only if it is erased
+            update = (ITF_FLASH_DWORD_ERASED == dword_old)
+                     ? ITF_FLASH_UPDATE_PROGRAM : ITF_FLASH_UPDATE_ERASE;
+        }
+    }
+
+    return update;
+}
+
+static bool
+itf_flash_program (uint32_t address, const uint8_t * data, size_t length)
+{
+    bool ret;
+
+    ret = HAL_FLASH_Unlock() == HAL_OK;
+
+    for (size_t i = 0; ret && (i < length); i += ITF_FLASH_DWORD_BYTES)
+    {
+        uint64_t dword;
+
+        (void)memcpy(&dword, &data[i], ITF_FLASH_DWORD_BYTES);
+
+        // Skip the double words that already contain the data
+        if (itf_flash_read_dword(address + i) != dword)
+        {
+            ret = HAL_FLASH_Program(FLASH_TYPEPROGRAM_DOUBLEWORD, address + i,
+                                    dword) == HAL_OK;
+        }
+    }
+
+    ret = (HAL_FLASH_Lock() == HAL_OK) && ret;
+
+    return ret;
+}
+
+static bool
+itf_flash_rewrite_page (uint32_t page_addr, uint32_t address,
+                        const uint8_t * data, size_t length)
+{
+    uint8_t * page = (uint8_t *)itf_flash_page_buf;
+    bool      ret;
+
+    (void)memcpy(page, (const void *)page_addr, FLASH_PAGE_SIZE);
+    (void)memcpy(&page[address - page_addr], data, length);
+
+    ret = itf_flash_erase(page_addr, FLASH_PAGE_SIZE);
+
+    // The erased double words are skipped
+    if (ret)
+    {
+        ret = itf_flash_program(page_addr, page, FLASH_PAGE_SIZE);
+    }
+
+    return ret;
+}
+
 /** @} */
 
 /******************************** End of file *********************************/
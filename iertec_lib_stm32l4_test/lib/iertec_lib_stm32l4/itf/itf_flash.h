@@ -57,6 +57,30 @@ bool itf_flash_write(uint32_t address, const uint8_t * data, size_t length);
  */
 bool itf_flash_read(uint32_t address, uint8_t * data, size_t length);
 
+/**
+ * @brief Update a memory region with new data, programming only what differs
+ * from the current contents.
+ *
+ * Double words that already hold the new value are skipped. A page is erased
+ * only if any of its double words must change from a non erased value. The
+ * contents of the page out of the indicated region are kept in a RAM buffer
+ * while it is erased and programmed again, so they are lost if the power fails
+ * meanwhile. The function is not reentrant.
+ *
+ * @param address Starting address to be updated. It must be double word
+ * aligned.
+ * @param data Data to write.
+ * @param length Number of bytes to write. It must be a multiple of a double
+ * word.
+ * @param verify If true, the region is checked against the data with a CRC32
+ * after programming.
+ *
+ * @retval true Operation executed correctly.
+ * @retval false An error occurred or the verification failed.
+ */
+bool itf_flash_update(uint32_t address, const uint8_t * data, size_t length,
+                      bool verify);
+
 #endif // ITF_FLASH_H
 
 /** @} */
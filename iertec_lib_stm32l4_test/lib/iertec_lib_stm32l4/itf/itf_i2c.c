@@ -226,6 +226,12 @@ itf_i2c_transaction (h_itf_i2c_t h_itf_i2c, uint8_t slave_address,
     return ret;
 }
 
+uint8_t
+itf_i2c_get_pwr (h_itf_i2c_t h_itf_i2c)
+{
+    return itf_i2c_instance[h_itf_i2c].h_itf_pwr;
+}
+
 /****************************************************************************//*
  * Private code
  ******************************************************************************/
@@ -65,6 +65,15 @@ bool itf_i2c_transaction(h_itf_i2c_t h_itf_i2c, uint8_t slave_address,
                          const uint8_t * tx_data, size_t tx_count,
                          uint8_t * rx_data, size_t rx_count);
 
+/**
+ * @brief Get the handler used by the I2C interface in the power control system.
+ *
+ * @param[in] h_itf_i2c Handler of the I2C interface to use.
+ *
+ * @return Handler of @ref itf_pwr.
+ */
+uint8_t itf_i2c_get_pwr(h_itf_i2c_t h_itf_i2c);
+
 #endif // ITF_I2C_H
 
 /** @} */
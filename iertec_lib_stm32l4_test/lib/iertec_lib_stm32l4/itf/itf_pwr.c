@@ -16,12 +16,33 @@
 #include "FreeRTOS.h"
 #include "task.h"
 
+#include <string.h>
+
 /****************************************************************************//*
  * Constants and macros
  ******************************************************************************/
 
-/** Maximum number of peripherals supported by the power control system. */
-#define H_ITF_PWR_MAX (32u)
+/** Number of words of the peripheral bitmaps. */
+#define ITF_PWR_WORD_COUNT ((ITF_PWR_HANDLE_MAX + 31u) / 32u)
+
+/** Word of the bitmaps holding a peripheral. */
+#define ITF_PWR_WORD(H)    ((H) / 32u)
+
+/** Bit of the bitmap word holding a peripheral. */
+#define ITF_PWR_BIT(H)     (1ul << ((H) % 32u))
+
+/** Maximum number of nested constraints of a peripheral. */
+#define ITF_PWR_COUNT_MAX  (UINT16_MAX)
+
+/** Weight of the new samples in the restore time average, as a shift. */
+#define ITF_PWR_RESTORE_SHIFT (3u)
+
+/** Number of words of the NVIC registers holding the wake up sources. */
+#define ITF_PWR_IRQ_WORD_COUNT ((ITF_PWR_IRQ_COUNT + 31u) / 32u)
+
+#if ITF_PWR_HANDLE_MAX >= H_ITF_PWR_NONE
+#error "ITF_PWR_HANDLE_MAX must be lower than H_ITF_PWR_NONE"
+#endif
 
 /****************************************************************************//*
  * Private data
@@ -30,11 +51,39 @@
 /** Current number of peripherals registered. */
 static volatile uint8_t h_itf_pwr_index;
 
-/** Mask with the currently activated peripherals. */
-static volatile uint32_t itf_pwr_active_flag;
+/** Bitmap with the peripherals holding at least one active constraint. */
+static volatile uint32_t itf_pwr_active_flag[ITF_PWR_WORD_COUNT];
+
+/** Number of active constraints of each peripheral. */
+static volatile uint16_t itf_pwr_active_count[ITF_PWR_HANDLE_MAX];
+
+/** Bitmaps with the registered peripherals that prevent each power level. */
+static uint32_t itf_pwr_level_mask[ITF_PWR_LEVEL_COUNT][ITF_PWR_WORD_COUNT];
+
+/** Bitmap with the peripherals with a wake up latency constraint. */
+static volatile uint32_t itf_pwr_latency_mask[ITF_PWR_WORD_COUNT];
+
+/** Wake up latency constraint of each peripheral in us. */
+static volatile uint32_t itf_pwr_latency_us[ITF_PWR_HANDLE_MAX];
+
+/** Wake up time of each power level in us, without the clock restore. */
+static const uint32_t itf_pwr_wakeup_us[ITF_PWR_LEVEL_COUNT] =
+{
+    ITF_PWR_LEVEL_0_WAKEUP_US,
+    ITF_PWR_LEVEL_1_WAKEUP_US,
+    ITF_PWR_LEVEL_2_WAKEUP_US,
+};
+
+/** Minimum idle time of each power level in us to save energy. */
+static const uint32_t itf_pwr_break_even_us[ITF_PWR_LEVEL_COUNT] =
+{
+    0u,
+    ITF_PWR_LEVEL_1_BREAK_EVEN_US,
+    ITF_PWR_LEVEL_2_BREAK_EVEN_US,
+};
 
-/** Masks with the registered peripherals in each power level. */
-static volatile uint32_t itf_pwr_level_mask[ITF_PWR_LEVEL_COUNT];
+/** Average clock restore time of each power level in CPU cycles. */
+static volatile uint32_t itf_pwr_restore_cycles[ITF_PWR_LEVEL_COUNT];
 
 /** Backup value of the RCC->CR register stored while in stop mode. */
 static volatile uint32_t itf_pwr_rcc_cr_save;
@@ -49,6 +98,104 @@ static volatile uint8_t h_itf_pwr_min_run;
 
 #endif // configMIN_RUN_BETWEEN_DEEP_SLEEPS
 
+/** Clock used to measure the time spent in each power mode. */
+static volatile itf_pwr_clock_t itf_pwr_clock;
+
+/** Power statistics. */
+static itf_pwr_stats_t itf_pwr_stats;
+
+/** Time each peripheral has been preventing a deeper power level. */
+static uint64_t itf_pwr_blocking[ITF_PWR_HANDLE_MAX];
+
+/** Time each peripheral has been active. */
+static uint64_t itf_pwr_active_time[ITF_PWR_HANDLE_MAX];
+
+/** Clock value of the last activation of each peripheral. */
+static uint32_t itf_pwr_active_mark[ITF_PWR_HANDLE_MAX];
+
+/** Clock value of the last power mode change. */
+static uint32_t itf_pwr_mark;
+
+/** Power level selected for the current sleep. */
+static itf_pwr_level_t itf_pwr_sleep_level;
+
+/** Bitmap with the peripherals preventing a deeper level in the current
+ * sleep. */
+static uint32_t itf_pwr_blocking_mask[ITF_PWR_WORD_COUNT];
+
+/** Wake up histograms. */
+static itf_pwr_wake_stats_t itf_pwr_wake_stats;
+
+/** Wake up log. */
+static itf_pwr_wake_t itf_pwr_wake_log[ITF_PWR_WAKE_LOG_SIZE];
+
+/** Index of the wake up log where the next record is stored. */
+static size_t itf_pwr_wake_head;
+
+/** Number of records of the wake up log. */
+static size_t itf_pwr_wake_count;
+
+/****************************************************************************//*
+ * Private code prototypes
+ ******************************************************************************/
+
+/**
+ * @brief Clear the power statistics. It must be called inside a critical
+ * section.
+ */
+static void itf_pwr_clear_stats(void);
+
+/**
+ * @brief Get the time elapsed since the last power mode change and start a new
+ * measurement. It must be called inside a critical section.
+ *
+ * @return Elapsed time in clock ticks.
+ */
+static uint32_t itf_pwr_elapsed(void);
+
+/**
+ * @brief Account the time a peripheral has been active since its last mark
+ * and start a new measurement. It must be called inside a critical section.
+ *
+ * @param[in] h_itf_pwr Handler of the peripheral.
+ */
+static void itf_pwr_update_active(uint8_t h_itf_pwr);
+
+/**
+ * @brief Get the source of the current wake up. It must be called with the
+ * interrupts disabled, so the interrupt that woke the system up is still
+ * pending.
+ *
+ * @return Interrupt number of the highest priority pending interrupt, or
+ * @ref ITF_PWR_WAKE_UNKNOWN if there is none.
+ */
+static uint8_t itf_pwr_get_wake_source(void);
+
+/**
+ * @brief Account the current wake up in the histograms and in the log. It must
+ * be called with the interrupts disabled.
+ *
+ * @param[in] restore Clock restore time in CPU cycles.
+ */
+static void itf_pwr_log_wake(uint32_t restore);
+
+/**
+ * @brief Check if a power level is prevented by any active peripheral.
+ *
+ * @param[in] level Power level.
+ *
+ * @return true if the power level cannot be used, false otherwise.
+ */
+static bool itf_pwr_is_blocked(itf_pwr_level_t level);
+
+/**
+ * @brief Get the tightest wake up latency constraint of the active
+ * peripherals.
+ *
+ * @return Latency in us, or @ref ITF_PWR_LATENCY_NONE if there is none.
+ */
+static uint32_t itf_pwr_get_budget(void);
+
 /****************************************************************************//*
  * Public code
  ******************************************************************************/
@@ -56,14 +203,23 @@ static volatile uint8_t h_itf_pwr_min_run;
 bool
 itf_pwr_init (void)
 {
-    h_itf_pwr_index     = 0;
-    itf_pwr_active_flag = 0;
-
-    // The level masks are negated to optimize the comparison
-    for (size_t i = 0u; i < ITF_PWR_LEVEL_COUNT; i++)
-    {
-        itf_pwr_level_mask[i] = ~0u;
-    }
+    h_itf_pwr_index = 0;
+    itf_pwr_clock   = NULL;
+    itf_pwr_clear_stats();
+
+    (void)memset((void *)itf_pwr_active_flag, 0, sizeof(itf_pwr_active_flag));
+    (void)memset((void *)itf_pwr_active_count, 0,
+                 sizeof(itf_pwr_active_count));
+    (void)memset(itf_pwr_level_mask, 0, sizeof(itf_pwr_level_mask));
+    (void)memset((void *)itf_pwr_latency_mask, 0,
+                 sizeof(itf_pwr_latency_mask));
+    (void)memset((void *)itf_pwr_restore_cycles, 0,
+                 sizeof(itf_pwr_restore_cycles));
+
+    // The cycle counter is used to calibrate the clock restore time
+    CoreDebug->DEMCR |= CoreDebug_DEMCR_TRCENA_Msk;
+    DWT->CYCCNT       = 0u;
+    DWT->CTRL        |= DWT_CTRL_CYCCNTENA_Msk;
 
 #ifdef configMIN_RUN_BETWEEN_DEEP_SLEEPS
     h_itf_pwr_min_run = itf_pwr_register(ITF_PWR_LEVEL_0);
@@ -106,14 +262,20 @@ itf_pwr_register (itf_pwr_level_t level)
 {
     uint8_t handle;
 
-    if ((h_itf_pwr_index >= H_ITF_PWR_MAX) || (level >= ITF_PWR_LEVEL_COUNT))
+    if ((h_itf_pwr_index >= ITF_PWR_HANDLE_MAX)
+        || (level >= ITF_PWR_LEVEL_COUNT))
     {
         handle = H_ITF_PWR_NONE;
     }
     else
     {
-        handle                     = h_itf_pwr_index++;
-        itf_pwr_level_mask[level] &= ~(1u << handle);
+        handle = h_itf_pwr_index++;
+
+        // While active, the peripheral prevents the levels deeper than its own
+        for (size_t i = (size_t)level + 1u; i < ITF_PWR_LEVEL_COUNT; i++)
+        {
+            itf_pwr_level_mask[i][ITF_PWR_WORD(handle)] |= ITF_PWR_BIT(handle);
+        }
     }
 
     return handle;
@@ -121,38 +283,264 @@ itf_pwr_register (itf_pwr_level_t level)
 
 void
 itf_pwr_set_active (uint8_t h_itf_pwr)
+{
+    configASSERT(h_itf_pwr < h_itf_pwr_index);
+
+    // The interrupt mask is used so it can be called from tasks and ISRs
+    UBaseType_t uxSavedInterruptStatus = taskENTER_CRITICAL_FROM_ISR();
+
+    // An overflow would release the constraint before the last balanced call
+    configASSERT(itf_pwr_active_count[h_itf_pwr] < ITF_PWR_COUNT_MAX);
+
+    if (itf_pwr_active_count[h_itf_pwr] < ITF_PWR_COUNT_MAX)
+    {
+        if (itf_pwr_active_count[h_itf_pwr]++ == 0u)
+        {
+            itf_pwr_active_flag[ITF_PWR_WORD(h_itf_pwr)] |=
+                ITF_PWR_BIT(h_itf_pwr);
+
+            if (NULL != itf_pwr_clock)
+            {
+                itf_pwr_active_mark[h_itf_pwr] = itf_pwr_clock();
+            }
+        }
+    }
+
+    taskEXIT_CRITICAL_FROM_ISR(uxSavedInterruptStatus);
+}
+
+void
+itf_pwr_set_inactive (uint8_t h_itf_pwr)
+{
+    configASSERT(h_itf_pwr < h_itf_pwr_index);
+
+    // The interrupt mask is used so it can be called from tasks and ISRs
+    UBaseType_t uxSavedInterruptStatus = taskENTER_CRITICAL_FROM_ISR();
+
+    // An unbalanced call is ignored, so it cannot release other constraints
+    if (itf_pwr_active_count[h_itf_pwr] > 0u)
+    {
+        if (--itf_pwr_active_count[h_itf_pwr] == 0u)
+        {
+            itf_pwr_active_flag[ITF_PWR_WORD(h_itf_pwr)] &=
+                ~ITF_PWR_BIT(h_itf_pwr);
+            itf_pwr_update_active(h_itf_pwr);
+        }
+    }
+
+    taskEXIT_CRITICAL_FROM_ISR(uxSavedInterruptStatus);
+}
+
+uint16_t
+itf_pwr_get_count (uint8_t h_itf_pwr)
+{
+    configASSERT(h_itf_pwr < h_itf_pwr_index);
+
+    return itf_pwr_active_count[h_itf_pwr];
+}
+
+itf_pwr_level_t
+itf_pwr_get_level (void)
+{
+    itf_pwr_level_t level = ITF_PWR_LEVEL_0;
+
+    if (!itf_pwr_is_blocked(ITF_PWR_LEVEL_2))
+    {
+        level = ITF_PWR_LEVEL_2;
+    }
+    else if (!itf_pwr_is_blocked(ITF_PWR_LEVEL_1))
+    {
+        level = ITF_PWR_LEVEL_1;
+    }
+
+    return level;
+}
+
+void
+itf_pwr_set_latency (uint8_t h_itf_pwr, uint32_t latency_us)
+{
+    configASSERT(h_itf_pwr < h_itf_pwr_index);
+
+    UBaseType_t uxSavedInterruptStatus = taskENTER_CRITICAL_FROM_ISR();
+
+    itf_pwr_latency_us[h_itf_pwr] = latency_us;
+
+    if (ITF_PWR_LATENCY_NONE != latency_us)
+    {
+        itf_pwr_latency_mask[ITF_PWR_WORD(h_itf_pwr)] |= ITF_PWR_BIT(h_itf_pwr);
+    }
+    else
+    {
+        itf_pwr_latency_mask[ITF_PWR_WORD(h_itf_pwr)] &=
+            ~ITF_PWR_BIT(h_itf_pwr);
+    }
+
+    taskEXIT_CRITICAL_FROM_ISR(uxSavedInterruptStatus);
+}
+
+uint32_t
+itf_pwr_get_latency (itf_pwr_level_t level)
+{
+    configASSERT(level < ITF_PWR_LEVEL_COUNT);
+
+    // In kHz, the core clock may run below 1 MHz. The lowest MSI range is
+    // 100 kHz, so it is never 0
+    uint64_t clk_khz = SystemCoreClock / 1000u;
+    uint64_t cycles  = (uint64_t)itf_pwr_restore_cycles[level] * 1000u;
+
+    // Rounded up, so a calibrated restore always counts
+    return itf_pwr_wakeup_us[level]
+           + (uint32_t)((cycles + clk_khz - 1u) / clk_khz);
+}
+
+itf_pwr_level_t
+itf_pwr_get_sleep_level (uint32_t idle_us)
+{
+    itf_pwr_level_t level  = itf_pwr_get_level();
+    uint32_t        budget = itf_pwr_get_budget();
+
+    // Each level saves energy over the previous one only if the idle time pays
+    // back its transition, so the deepest worthy level is the cheapest one
+    while ((ITF_PWR_LEVEL_0 != level)
+           && ((idle_us < itf_pwr_break_even_us[level])
+               || (itf_pwr_get_latency(level) > budget)))
+    {
+        level = (itf_pwr_level_t)(level - 1);
+    }
+
+    return level;
+}
+
+void
+itf_pwr_set_clock (itf_pwr_clock_t clock)
 {
     taskENTER_CRITICAL();
-    itf_pwr_active_flag |= 1u << h_itf_pwr;
+    itf_pwr_clock = clock;
+    itf_pwr_clear_stats();
     taskEXIT_CRITICAL();
 }
 
 void
-itf_pwr_set_inactive (uint8_t h_itf_pwr)
+itf_pwr_get_stats (itf_pwr_stats_t * stats)
 {
     taskENTER_CRITICAL();
-    itf_pwr_active_flag &= ~(1u << h_itf_pwr);
+    itf_pwr_stats.run += itf_pwr_elapsed();
+    *stats             = itf_pwr_stats;
     taskEXIT_CRITICAL();
 }
 
+uint64_t
+itf_pwr_get_blocking (uint8_t h_itf_pwr)
+{
+    uint64_t blocking = 0u;
+
+    if (h_itf_pwr < ITF_PWR_HANDLE_MAX)
+    {
+        // 64 bits read is not atomic
+        taskENTER_CRITICAL();
+        blocking = itf_pwr_blocking[h_itf_pwr];
+        taskEXIT_CRITICAL();
+    }
+
+    return blocking;
+}
+
+uint64_t
+itf_pwr_get_active (uint8_t h_itf_pwr)
+{
+    uint64_t active = 0u;
+
+    if (h_itf_pwr < ITF_PWR_HANDLE_MAX)
+    {
+        taskENTER_CRITICAL();
+
+        // The current activation is included
+        if (itf_pwr_active_count[h_itf_pwr] > 0u)
+        {
+            itf_pwr_update_active(h_itf_pwr);
+        }
+
+        active = itf_pwr_active_time[h_itf_pwr];
+        taskEXIT_CRITICAL();
+    }
+
+    return active;
+}
+
 void
-itf_pwr_pre_sleep (void)
+itf_pwr_get_wake_stats (itf_pwr_wake_stats_t * stats)
 {
-    itf_pwr_level_t level;
+    taskENTER_CRITICAL();
+    *stats = itf_pwr_wake_stats;
+    taskEXIT_CRITICAL();
+}
+
+bool
+itf_pwr_get_wake (size_t index, itf_pwr_wake_t * wake)
+{
+    bool ret = false;
 
-    if ((itf_pwr_active_flag & itf_pwr_level_mask[ITF_PWR_LEVEL_2]) == 0u)
+    taskENTER_CRITICAL();
+
+    if (index < itf_pwr_wake_count)
+    {
+        *wake = itf_pwr_wake_log[(itf_pwr_wake_head + ITF_PWR_WAKE_LOG_SIZE
+                                  - 1u - index) % ITF_PWR_WAKE_LOG_SIZE];
+        ret   = true;
+    }
+
+    taskEXIT_CRITICAL();
+
+    return ret;
+}
+
+void
+itf_pwr_reset_stats (void)
+{
+    taskENTER_CRITICAL();
+    itf_pwr_clear_stats();
+    taskEXIT_CRITICAL();
+}
+
+void
+itf_pwr_pre_sleep (uint32_t idle_ticks)
+{
+    uint32_t idle_us = 0u;
+
+    // The current tick period is already partially elapsed
+    if (idle_ticks > 1u)
+    {
+        idle_us = (idle_ticks - 1u) * (1000000u / configTICK_RATE_HZ);
+    }
+
+    itf_pwr_level_t level = itf_pwr_get_sleep_level(idle_us);
+
+    if (ITF_PWR_LEVEL_2 == level)
     {
-        level = ITF_PWR_LEVEL_2;
         MODIFY_REG(PWR->CR1, PWR_CR1_LPMS, PWR_CR1_LPMS_STOP2);
     }
-    else if ((itf_pwr_active_flag & itf_pwr_level_mask[ITF_PWR_LEVEL_1]) == 0u)
+    else if (ITF_PWR_LEVEL_1 == level)
     {
-        level = ITF_PWR_LEVEL_1;
         MODIFY_REG(PWR->CR1, PWR_CR1_LPMS, PWR_CR1_LPMS_STOP1);
     }
-    else
+
+    // This function is called with the interrupts disabled, so the statistics
+    // can be updated without a critical section
+    itf_pwr_stats.run += itf_pwr_elapsed();
+    itf_pwr_stats.count[level]++;
+    itf_pwr_sleep_level = level;
+
+    for (size_t w = 0u; w < ITF_PWR_WORD_COUNT; w++)
     {
-        level = ITF_PWR_LEVEL_0;
+        if (ITF_PWR_LEVEL_2 != level)
+        {
+            itf_pwr_blocking_mask[w] = itf_pwr_active_flag[w]
+                                       & itf_pwr_level_mask[level + 1][w];
+        }
+        else
+        {
+            itf_pwr_blocking_mask[w] = 0u;
+        }
     }
 
     HAL_SuspendTick();
@@ -173,6 +561,25 @@ itf_pwr_pre_sleep (void)
 void
 itf_pwr_post_sleep (void)
 {
+    uint32_t start   = DWT->CYCCNT;
+    uint32_t elapsed = itf_pwr_elapsed();
+    uint32_t cycles  = 0u;
+
+    itf_pwr_stats.residency[itf_pwr_sleep_level] += elapsed;
+
+    for (size_t w = 0u; w < ITF_PWR_WORD_COUNT; w++)
+    {
+        uint32_t mask = itf_pwr_blocking_mask[w];
+
+        for (size_t h = w * 32u; mask != 0u; h++, mask >>= 1)
+        {
+            if ((mask & 1u) != 0u)
+            {
+                itf_pwr_blocking[h] += elapsed;
+            }
+        }
+    }
+
     if ((SCB->SCR & SCB_SCR_SLEEPDEEP_Msk) != 0u)
     {
 #ifdef configMIN_RUN_BETWEEN_DEEP_SLEEPS
@@ -186,8 +593,9 @@ itf_pwr_post_sleep (void)
 
         // Mark the "min-run" peripheral as being now in use so that we won't
         // attempt STOP mode until it's no longer in use. See SysTick_Handler()
-        // below.
-        itf_pwr_active_flag |= 1u << h_itf_pwr_min_run;
+        // below. Its flag is not reference counted.
+        itf_pwr_active_flag[ITF_PWR_WORD(h_itf_pwr_min_run)] |=
+            ITF_PWR_BIT(h_itf_pwr_min_run);
 #endif // configMIN_RUN_BETWEEN_DEEP_SLEEPS
 
         // We may have been in deep sleep. If we were, the hardware cleared
@@ -201,12 +609,22 @@ itf_pwr_post_sleep (void)
 
         SCB->SCR &= ~SCB_SCR_SLEEPDEEP_Msk;
 
+        // The restore time is averaged to calibrate the level latency
+        cycles = DWT->CYCCNT - start;
+
+        itf_pwr_restore_cycles[itf_pwr_sleep_level] +=
+            (cycles >> ITF_PWR_RESTORE_SHIFT)
+            - (itf_pwr_restore_cycles[itf_pwr_sleep_level]
+               >> ITF_PWR_RESTORE_SHIFT);
+
         // This application bypasses the RTC shadow registers, so we don't need
         // to clear the sync flag for those registers. They are always out of
         // sync when coming out of deep sleep.
         // RTC->ISR &= ~RTC_ISR_RSF;
     }
 
+    itf_pwr_log_wake(cycles);
+
     HAL_ResumeTick();
 }
 
@@ -223,12 +641,173 @@ SysTick_Handler (void)
 
     UBaseType_t uxSavedInterruptStatus = taskENTER_CRITICAL_FROM_ISR();
 
-    itf_pwr_active_flag &= ~(1u << h_itf_pwr_min_run);
+    itf_pwr_active_flag[ITF_PWR_WORD(h_itf_pwr_min_run)] &=
+        ~ITF_PWR_BIT(h_itf_pwr_min_run);
     taskEXIT_CRITICAL_FROM_ISR(uxSavedInterruptStatus);
 }
 
 #endif // configMIN_RUN_BETWEEN_DEEP_SLEEPS
 
+/****************************************************************************//*
+ * Private code
+ ******************************************************************************/
+
+static void
+itf_pwr_clear_stats (void)
+{
+    (void)memset(&itf_pwr_stats, 0, sizeof(itf_pwr_stats));
+    (void)memset(itf_pwr_blocking, 0, sizeof(itf_pwr_blocking));
+    (void)memset(itf_pwr_active_time, 0, sizeof(itf_pwr_active_time));
+    (void)memset(&itf_pwr_wake_stats, 0, sizeof(itf_pwr_wake_stats));
+    itf_pwr_wake_head  = 0u;
+    itf_pwr_wake_count = 0u;
+
+    if (NULL != itf_pwr_clock)
+    {
+        itf_pwr_mark = itf_pwr_clock();
+
+        for (size_t h = 0u; h < ITF_PWR_HANDLE_MAX; h++)
+        {
+            itf_pwr_active_mark[h] = itf_pwr_mark;
+        }
+    }
+}
+
+static uint32_t
+itf_pwr_elapsed (void)
+{
+    uint32_t elapsed = 0u;
+
+    if (NULL != itf_pwr_clock)
+    {
+        uint32_t now = itf_pwr_clock();
+
+        // With the interrupts disabled the clock can lag behind if its overflow
+        // interrupt is pending. The measurement is then kept open, so the time
+        // is accounted in the next one.
+        if ((int32_t)(now - itf_pwr_mark) > 0)
+        {
+            elapsed      = now - itf_pwr_mark;
+            itf_pwr_mark = now;
+        }
+    }
+
+    return elapsed;
+}
+
+static void
+itf_pwr_update_active (uint8_t h_itf_pwr)
+{
+    if (NULL != itf_pwr_clock)
+    {
+        uint32_t now = itf_pwr_clock();
+
+        // The measurement is kept open if the clock lags behind, see
+        // itf_pwr_elapsed
+        if ((int32_t)(now - itf_pwr_active_mark[h_itf_pwr]) > 0)
+        {
+            itf_pwr_active_time[h_itf_pwr] += now
+                                              - itf_pwr_active_mark[h_itf_pwr];
+            itf_pwr_active_mark[h_itf_pwr]  = now;
+        }
+    }
+}
+
+static uint8_t
+itf_pwr_get_wake_source (void)
+{
+    uint8_t  source   = ITF_PWR_WAKE_UNKNOWN;
+    uint32_t priority = UINT32_MAX;
+
+    for (size_t w = 0u; w < ITF_PWR_IRQ_WORD_COUNT; w++)
+    {
+        uint32_t mask = NVIC->ISPR[w] & NVIC->ISER[w];
+
+        for (size_t irq = w * 32u; (mask != 0u) && (irq < ITF_PWR_IRQ_COUNT);
+             irq++, mask >>= 1)
+        {
+            // The pending interrupt that runs first is the one attributed
+            if (((mask & 1u) != 0u)
+                && (NVIC_GetPriority((IRQn_Type)irq) < priority))
+            {
+                priority = NVIC_GetPriority((IRQn_Type)irq);
+                source   = (uint8_t)irq;
+            }
+        }
+    }
+
+    return source;
+}
+
+static void
+itf_pwr_log_wake (uint32_t restore)
+{
+    itf_pwr_wake_t * wake = &itf_pwr_wake_log[itf_pwr_wake_head];
+
+    wake->time    = (NULL != itf_pwr_clock) ? itf_pwr_clock() : 0u;
+    wake->restore = restore;
+    wake->source  = itf_pwr_get_wake_source();
+    wake->level   = itf_pwr_sleep_level;
+
+    // The oldest record is overwritten when the log is full
+    itf_pwr_wake_head = (itf_pwr_wake_head + 1u) % ITF_PWR_WAKE_LOG_SIZE;
+
+    if (itf_pwr_wake_count < ITF_PWR_WAKE_LOG_SIZE)
+    {
+        itf_pwr_wake_count++;
+    }
+
+    itf_pwr_wake_stats.source[wake->source]++;
+
+    if (ITF_PWR_LEVEL_0 != itf_pwr_sleep_level)
+    {
+        // Logarithmic bins, so short and long restores are both resolved
+        uint32_t bin = 31u - __CLZ(restore | 1u);
+
+        if (bin >= ITF_PWR_RESTORE_BIN_COUNT)
+        {
+            bin = ITF_PWR_RESTORE_BIN_COUNT - 1u;
+        }
+
+        itf_pwr_wake_stats.restore[bin]++;
+    }
+}
+
+static bool
+itf_pwr_is_blocked (itf_pwr_level_t level)
+{
+    for (size_t w = 0u; w < ITF_PWR_WORD_COUNT; w++)
+    {
+        if ((itf_pwr_active_flag[w] & itf_pwr_level_mask[level][w]) != 0u)
+        {
+            return true;
+        }
+    }
+
+    return false;
+}
+
+static uint32_t
+itf_pwr_get_budget (void)
+{
+    uint32_t budget = ITF_PWR_LATENCY_NONE;
+
+    for (size_t w = 0u; w < ITF_PWR_WORD_COUNT; w++)
+    {
+        uint32_t mask = itf_pwr_active_flag[w] & itf_pwr_latency_mask[w];
+
+        for (size_t h = w * 32u; mask != 0u; h++, mask >>= 1)
+        {
+            if (((mask & 1u) != 0u) && (itf_pwr_latency_us[h] < budget))
+            {
+                budget = itf_pwr_latency_us[h];
+            }
+        }
+    }
+
+    return budget;
+}
+
 /** @} */
 
 /******************************** End of file *********************************/
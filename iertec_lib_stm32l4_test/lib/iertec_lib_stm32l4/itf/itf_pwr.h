@@ -20,9 +20,67 @@
 
 #include <stdint.h>
 #include <stdbool.h>
+#include <stddef.h>
 
 /** Invalid handler value. */
-#define H_ITF_PWR_NONE (0xFFu)
+#define H_ITF_PWR_NONE     (0xFFu)
+
+/** Maximum number of peripherals supported by the power control system. It
+ * must be lower than @ref H_ITF_PWR_NONE. */
+#ifndef ITF_PWR_HANDLE_MAX
+#define ITF_PWR_HANDLE_MAX (64u)
+#endif
+
+/** Wake up time from the level 0 in us. */
+#ifndef ITF_PWR_LEVEL_0_WAKEUP_US
+#define ITF_PWR_LEVEL_0_WAKEUP_US     (1u)
+#endif
+
+/** Wake up time from the level 1 in us, without the clock restore time. */
+#ifndef ITF_PWR_LEVEL_1_WAKEUP_US
+#define ITF_PWR_LEVEL_1_WAKEUP_US     (5u)
+#endif
+
+/** Wake up time from the level 2 in us, without the clock restore time. */
+#ifndef ITF_PWR_LEVEL_2_WAKEUP_US
+#define ITF_PWR_LEVEL_2_WAKEUP_US     (9u)
+#endif
+
+/** Minimum idle time in us for the level 1 to save energy over the level 0. */
+#ifndef ITF_PWR_LEVEL_1_BREAK_EVEN_US
+#define ITF_PWR_LEVEL_1_BREAK_EVEN_US (200u)
+#endif
+
+/** Minimum idle time in us for the level 2 to save energy over the level 1. */
+#ifndef ITF_PWR_LEVEL_2_BREAK_EVEN_US
+#define ITF_PWR_LEVEL_2_BREAK_EVEN_US (1000u)
+#endif
+
+/** Value of a wake up latency constraint not set. */
+#define ITF_PWR_LATENCY_NONE          (UINT32_MAX)
+
+/** Number of device interrupts attributed as wake up sources. */
+#ifndef ITF_PWR_IRQ_COUNT
+#define ITF_PWR_IRQ_COUNT             ((uint8_t)FPU_IRQn + 1u)
+#endif
+
+/** Wake up source used when no pending interrupt is found. */
+#define ITF_PWR_WAKE_UNKNOWN          (ITF_PWR_IRQ_COUNT)
+
+/** Number of wake up sources, including @ref ITF_PWR_WAKE_UNKNOWN. */
+#define ITF_PWR_WAKE_SOURCE_COUNT     (ITF_PWR_IRQ_COUNT + 1u)
+
+/** Number of bins of the clock restore time histogram. The bin i counts the
+ * restores that took from 2^i to 2^(i+1) - 1 CPU cycles, and the last one
+ * also counts the longer ones. */
+#ifndef ITF_PWR_RESTORE_BIN_COUNT
+#define ITF_PWR_RESTORE_BIN_COUNT     (16u)
+#endif
+
+/** Number of wake ups kept in the wake up log. */
+#ifndef ITF_PWR_WAKE_LOG_SIZE
+#define ITF_PWR_WAKE_LOG_SIZE         (16u)
+#endif
 
 /** @brief Available power levels.
  * - Level 0: Sleep.
@@ -36,6 +94,51 @@ typedef enum
     ITF_PWR_LEVEL_COUNT,
 } itf_pwr_level_t;
 
+/** @brief Clock used to measure the time spent in each power mode. It returns
+ * a free running tick count that is allowed to wrap around. */
+typedef uint32_t (*itf_pwr_clock_t)(void);
+
+/** @brief Power statistics. The times are given in ticks of the clock set with
+ * @ref itf_pwr_set_clock. */
+typedef struct
+{
+    /** Time spent in run mode. */
+    uint64_t run;
+
+    /** Time spent in each power level. */
+    uint64_t residency[ITF_PWR_LEVEL_COUNT];
+
+    /** Number of times each power level has been entered. */
+    uint32_t count[ITF_PWR_LEVEL_COUNT];
+} itf_pwr_stats_t;
+
+/** @brief Wake up record. */
+typedef struct
+{
+    /** Clock value at the wake up, see @ref itf_pwr_set_clock. */
+    uint32_t time;
+
+    /** Clock restore time in CPU cycles, 0 when waking up from the level 0. */
+    uint32_t restore;
+
+    /** Interrupt number of the wake up source, or @ref ITF_PWR_WAKE_UNKNOWN. */
+    uint8_t source;
+
+    /** Power level the system woke up from. */
+    itf_pwr_level_t level;
+} itf_pwr_wake_t;
+
+/** @brief Wake up histograms. */
+typedef struct
+{
+    /** Number of wake ups of each source, indexed by interrupt number. */
+    uint32_t source[ITF_PWR_WAKE_SOURCE_COUNT];
+
+    /** Number of clock restores of each time bin, see
+     * @ref ITF_PWR_RESTORE_BIN_COUNT. */
+    uint32_t restore[ITF_PWR_RESTORE_BIN_COUNT];
+} itf_pwr_wake_stats_t;
+
 /**
  * @brief Power control system initialization.
  *
@@ -48,7 +151,8 @@ bool itf_pwr_init(void);
  * @brief Register a new peripheral in the power control system and return a
  * handler to be used in activate / deactivate operations.
  *
- * @param[in] level Lowest power level that can be used by the peripheral.
+ * @param[in] level Deepest power level that can be used while the peripheral is
+ * active.
  *
  * @retval H_ITF_PWR_NONE If an error occurs.
  * @return A handle to be used by the peripheral when it needs to modify the
@@ -57,23 +161,136 @@ bool itf_pwr_init(void);
 uint8_t itf_pwr_register(itf_pwr_level_t level);
 
 /**
- * @brief Mark as active the peripheral in the power control system.
+ * @brief Add an active constraint to the peripheral in the power control
+ * system. The constraints are reference counted, so the peripheral remains
+ * active until every call is balanced by a call to @ref itf_pwr_set_inactive.
+ * Up to UINT16_MAX nested constraints are supported. It can be called from
+ * ISRs.
  *
  * @param[in] h_itf_pwr Handler of the peripheral.
  */
 void itf_pwr_set_active(uint8_t h_itf_pwr);
 
 /**
- * @brief Mark as inactive the peripheral in the power control system.
+ * @brief Release an active constraint of the peripheral in the power control
+ * system. It can be called from ISRs.
  *
  * @param[in] h_itf_pwr Handler of the peripheral.
  */
 void itf_pwr_set_inactive(uint8_t h_itf_pwr);
 
+/**
+ * @brief Get the number of active constraints of a peripheral.
+ *
+ * @param[in] h_itf_pwr Handler of the peripheral.
+ *
+ * @return Number of active constraints.
+ */
+uint16_t itf_pwr_get_count(uint8_t h_itf_pwr);
+
+/**
+ * @brief Get the deepest power level allowed by the active peripherals.
+ *
+ * @return Power level.
+ */
+itf_pwr_level_t itf_pwr_get_level(void);
+
+/**
+ * @brief Set the maximum wake up latency tolerated by a peripheral while it is
+ * active.
+ *
+ * @param[in] h_itf_pwr Handler of the peripheral.
+ * @param[in] latency_us Maximum latency in us, or @ref ITF_PWR_LATENCY_NONE to
+ * remove the constraint.
+ */
+void itf_pwr_set_latency(uint8_t h_itf_pwr, uint32_t latency_us);
+
+/**
+ * @brief Get the wake up latency of a power level. It includes the clock
+ * restore time calibrated at runtime.
+ *
+ * @param[in] level Power level.
+ *
+ * @return Latency in us.
+ */
+uint32_t itf_pwr_get_latency(itf_pwr_level_t level);
+
+/**
+ * @brief Get the power level that minimizes the energy for an idle period,
+ * meeting the level and latency constraints of the active peripherals.
+ *
+ * @param[in] idle_us Expected idle time in us.
+ *
+ * @return Power level.
+ */
+itf_pwr_level_t itf_pwr_get_sleep_level(uint32_t idle_us);
+
+/**
+ * @brief Set the clock used to measure the time spent in each power mode. The
+ * statistics are reset. Until a clock is set no time is accounted.
+ *
+ * @param[in] clock Clock function, or NULL to stop the accounting.
+ */
+void itf_pwr_set_clock(itf_pwr_clock_t clock);
+
+/**
+ * @brief Get a snapshot of the power statistics since the last reset. The time
+ * elapsed in run mode up to this call is included.
+ *
+ * @param[out] stats Power statistics.
+ */
+void itf_pwr_get_stats(itf_pwr_stats_t * stats);
+
+/**
+ * @brief Get the time a peripheral has been preventing the system to enter a
+ * deeper power level while sleeping, since the last reset.
+ *
+ * @param[in] h_itf_pwr Handler of the peripheral.
+ *
+ * @return Time in ticks of the clock set with @ref itf_pwr_set_clock.
+ */
+uint64_t itf_pwr_get_blocking(uint8_t h_itf_pwr);
+
+/**
+ * @brief Get the time a peripheral has been active since the last reset.
+ *
+ * @param[in] h_itf_pwr Handler of the peripheral.
+ *
+ * @return Time in ticks of the clock set with @ref itf_pwr_set_clock.
+ */
+uint64_t itf_pwr_get_active(uint8_t h_itf_pwr);
+
+/**
+ * @brief Get a snapshot of the wake up histograms since the last reset.
+ *
+ * @param[out] stats Wake up histograms.
+ */
+void itf_pwr_get_wake_stats(itf_pwr_wake_stats_t * stats);
+
+/**
+ * @brief Get a record of the wake up log.
+ *
+ * @param[in] index Index of the record, 0 being the most recent wake up. Up to
+ * @ref ITF_PWR_WAKE_LOG_SIZE records are kept.
+ * @param[out] wake Wake up record.
+ *
+ * @retval true The record is returned.
+ * @retval false There are not so many wake ups since the last reset.
+ */
+bool itf_pwr_get_wake(size_t index, itf_pwr_wake_t * wake);
+
+/**
+ * @brief Reset the power statistics, including the wake up histograms and
+ * log.
+ */
+void itf_pwr_reset_stats(void);
+
 /**
  * @brief Function to be called before entering the active sleep mode.
+ *
+ * @param[in] idle_ticks Expected idle time in RTOS ticks.
  */
-void itf_pwr_pre_sleep(void);
+void itf_pwr_pre_sleep(uint32_t idle_ticks);
 
 /**
  * @brief Function to be called after exiting the active sleep mode.
@@ -13,6 +13,17 @@
 
 #include "itf_rtc.h"
 #include "itf_pwr.h"
+#include "itf_clk.h"
+
+#include "FreeRTOS.h"
+#include "task.h"
+
+/****************************************************************************//*
+ * Constants and macros
+ ******************************************************************************/
+
+/** Compare value of the seconds match. */
+#define ITF_RTC_SECONDS_CMP (ITF_RTC_CLK_FREQ - 2u)
 
 /****************************************************************************//*
  * Private data
@@ -27,6 +38,50 @@ static volatile itf_rtc_cb_t itf_rtc_cb = NULL;
 /** RTC seconds count. */
 static volatile uint32_t itf_rtc_seconds = 0u;
 
+/** Seconds elapsed since the timer start, not changed by
+ * @ref itf_rtc_set_time. */
+static volatile uint32_t itf_rtc_uptime = 0u;
+
+/** Handler of the power control system. */
+static uint8_t h_itf_rtc_pwr = H_ITF_PWR_NONE;
+
+/** Callback function to be called when the alarm fires. */
+static volatile itf_rtc_cb_t itf_rtc_alarm_cb = NULL;
+
+/** The alarm is programmed. */
+static volatile bool itf_rtc_alarm_on = false;
+
+/** Tick count of the alarm. */
+static uint32_t itf_rtc_alarm_tick;
+
+/** Current compare value, the seconds match or an alarm. */
+static uint32_t itf_rtc_cmp = ITF_RTC_SECONDS_CMP;
+
+/****************************************************************************//*
+ * Private code prototypes
+ ******************************************************************************/
+
+/**
+ * @brief Move the compare to the alarm if it falls in the current second, or
+ * to the seconds match otherwise. The compare is not changed if its match is
+ * pending or imminent, the interrupt moves it afterwards. It must be called
+ * with the interrupts masked.
+ *
+ * @param[in] from_isr It is called from the compare match interrupt.
+ */
+static void itf_rtc_arm(bool from_isr);
+
+/**
+ * @brief Read the seconds counts and the position in the current second
+ * consistently. It can be called from tasks and ISRs.
+ *
+ * @param[out] uptime Seconds elapsed since the timer start.
+ * @param[out] seconds RTC seconds count.
+ *
+ * @return Ticks elapsed in the current second.
+ */
+static uint32_t itf_rtc_read(uint32_t * uptime, uint32_t * seconds);
+
 /****************************************************************************//*
  * Public code
  ******************************************************************************/
@@ -46,21 +101,28 @@ itf_rtc_init (void)
     }
 
     // LPTIM2 instance does not support Stop 2 mode
-    uint8_t h_itf_pwr = itf_pwr_register(ITF_PWR_LEVEL_1);
+    h_itf_rtc_pwr = itf_pwr_register(ITF_PWR_LEVEL_1);
 
-    if (H_ITF_PWR_NONE == h_itf_pwr)
+    if (H_ITF_PWR_NONE == h_itf_rtc_pwr)
     {
         return false;
     }
 
-    itf_pwr_set_active(h_itf_pwr);
+    itf_pwr_set_active(h_itf_rtc_pwr);
+
+    itf_rtc_cmp = ITF_RTC_SECONDS_CMP;
 
     if (HAL_LPTIM_TimeOut_Start_IT(itf_rtc_config.handle, ITF_RTC_CLK_FREQ - 1u,
-                                   ITF_RTC_CLK_FREQ - 2u) != HAL_OK)
+                                   ITF_RTC_SECONDS_CMP) != HAL_OK)
     {
         return false;
     }
 
+    // The RTC ticks are used to measure the time spent in each power mode and
+    // in each clock level
+    itf_pwr_set_clock(itf_rtc_get_ticks);
+    itf_clk_set_clock(itf_rtc_get_ticks);
+
     return true;
 }
 
@@ -77,53 +139,176 @@ itf_rtc_set_time (uint32_t seconds, uint8_t cseconds)
 void
 itf_rtc_get_time (uint32_t * seconds, uint8_t * cseconds)
 {
-    LPTIM_TypeDef * lptim = itf_rtc_config.handle->Instance;
-    uint32_t        sec;
-    uint32_t        counter;
+    uint32_t uptime;
+    uint32_t counter = itf_rtc_read(&uptime, seconds);
 
-    // To read reliably the content of the LPTIM_CNT register, two successive
-    // read accesses must be performed and compared
-    do
-    {
-        counter = lptim->CNT;
+    *cseconds = counter * 100u / ITF_RTC_CLK_FREQ;
+}
 
-        // Performing the seconds read between the counter reads we can ensure
-        // that the seconds value is reliable and no critical section is needed
-        sec = itf_rtc_seconds;
-    } while (counter != lptim->CNT);
+void
+itf_rtc_get_time_frac (uint32_t * seconds, uint32_t * fraction)
+{
+    uint32_t uptime;
+    uint32_t counter = itf_rtc_read(&uptime, seconds);
 
-    // The timeout interrupt is generated one tick before the reload operation
-    counter += 1u;
+    // The clock frequency is a power of 2, so the fraction is exact
+    *fraction = (uint32_t)(((uint64_t)counter << 32) / ITF_RTC_CLK_FREQ);
+}
+
+uint32_t
+itf_rtc_get_ticks (void)
+{
+    return (uint32_t)itf_rtc_get_ticks64();
+}
 
-    *seconds = sec;
+uint64_t
+itf_rtc_get_ticks64 (void)
+{
+    uint32_t uptime;
+    uint32_t seconds;
+    uint32_t counter = itf_rtc_read(&uptime, &seconds);
 
-    if (counter >= ITF_RTC_CLK_FREQ)
+    return ((uint64_t)uptime * ITF_RTC_CLK_FREQ) + counter;
+}
+
+void
+itf_rtc_set_callback (itf_rtc_cb_t cb)
+{
+    itf_rtc_cb = cb;
+}
+
+void
+itf_rtc_set_alarm (uint32_t ticks)
+{
+    // The interrupt mask is used so it can be called from tasks and ISRs
+    UBaseType_t uxSavedInterruptStatus = taskENTER_CRITICAL_FROM_ISR();
+
+    itf_rtc_alarm_tick = ticks;
+    itf_rtc_alarm_on   = true;
+    itf_rtc_arm(false);
+
+    taskEXIT_CRITICAL_FROM_ISR(uxSavedInterruptStatus);
+}
+
+void
+itf_rtc_stop_alarm (void)
+{
+    UBaseType_t uxSavedInterruptStatus = taskENTER_CRITICAL_FROM_ISR();
+
+    itf_rtc_alarm_on = false;
+    itf_rtc_arm(false);
+
+    taskEXIT_CRITICAL_FROM_ISR(uxSavedInterruptStatus);
+}
+
+void
+itf_rtc_set_alarm_callback (itf_rtc_cb_t cb)
+{
+    itf_rtc_alarm_cb = cb;
+}
+
+uint8_t
+itf_rtc_get_pwr (void)
+{
+    return h_itf_rtc_pwr;
+}
+
+/****************************************************************************//*
+ * Private code
+ ******************************************************************************/
+
+static void
+itf_rtc_arm (bool from_isr)
+{
+    LPTIM_HandleTypeDef * h_lptim = itf_rtc_config.handle;
+    uint32_t              cmp     = ITF_RTC_SECONDS_CMP;
+    uint32_t              counter = h_lptim->Instance->CNT;
+
+    // Outside the interrupt, a pending or imminent match is left to it, so the
+    // event of the current compare is not lost. A count beyond the compare
+    // means that its match has already been served
+    bool pending = !from_isr
+                   && (__HAL_LPTIM_GET_FLAG(h_lptim, LPTIM_FLAG_CMPM)
+                       || ((counter <= itf_rtc_cmp)
+                           && ((counter + ITF_RTC_ALARM_MARGIN)
+                               >= itf_rtc_cmp)));
+
+    if (pending)
     {
-        *cseconds = 0u;
+        cmp = itf_rtc_cmp;
     }
-    else
+    else if (itf_rtc_alarm_on)
     {
-        *cseconds = counter * 100u / ITF_RTC_CLK_FREQ;
+        uint32_t now   = itf_rtc_get_ticks();
+        uint32_t pos   = now % ITF_RTC_CLK_FREQ;
+        int32_t  delta = (int32_t)(itf_rtc_alarm_tick - now);
+
+        // The alarms of the next seconds are checked at each seconds match
+        if (delta < (int32_t)(ITF_RTC_CLK_FREQ - pos))
+        {
+            // CMPM is set the count after the match, and the ticks are the
+            // count plus one. Past alarms fire as soon as possible
+            uint32_t alarm = pos + ITF_RTC_ALARM_MARGIN;
+
+            if (delta > (int32_t)(ITF_RTC_ALARM_MARGIN + 2u))
+            {
+                alarm = pos + (uint32_t)delta - 2u;
+            }
+
+            // Near the end of the second the seconds match delivers it
+            if (alarm <= (ITF_RTC_SECONDS_CMP - ITF_RTC_ALARM_GUARD))
+            {
+                cmp = alarm;
+            }
+        }
+    }
+
+    if (cmp != itf_rtc_cmp)
+    {
+        // Wait for the completion of the previous write to the CMP register
+        while (!__HAL_LPTIM_GET_FLAG(h_lptim, LPTIM_FLAG_CMPOK))
+        {
+            // Wait for the flag to be set, about 3 ticks
+        }
+
+        __HAL_LPTIM_CLEAR_FLAG(h_lptim, LPTIM_FLAG_CMPOK);
+        __HAL_LPTIM_COMPARE_SET(h_lptim, cmp);
+        itf_rtc_cmp = cmp;
     }
 }
 
-uint32_t
-itf_rtc_get_ticks (void)
+static uint32_t
+itf_rtc_read (uint32_t * uptime, uint32_t * seconds)
 {
-    LPTIM_TypeDef * lptim = itf_rtc_config.handle->Instance;
-    uint32_t        sec;
-    uint32_t        counter;
+    LPTIM_HandleTypeDef * h_lptim = itf_rtc_config.handle;
+    uint32_t              counter;
+    uint32_t              pending = 0u;
+
+    // The interrupt mask keeps the seconds counts and the match flag
+    // consistent, and it is used so it can be called from tasks and ISRs
+    UBaseType_t uxSavedInterruptStatus = taskENTER_CRITICAL_FROM_ISR();
 
     // To read reliably the content of the LPTIM_CNT register, two successive
     // read accesses must be performed and compared
     do
     {
-        counter = lptim->CNT;
+        counter = h_lptim->Instance->CNT;
+    } while (counter != h_lptim->Instance->CNT);
+
+    // A seconds match not served yet means that the counter has reached the
+    // end of the second. The flag is read after the counter, so a flag set
+    // just after the counter read is not taken into account
+    if ((ITF_RTC_SECONDS_CMP == itf_rtc_cmp)
+        && __HAL_LPTIM_GET_FLAG(h_lptim, LPTIM_FLAG_CMPM)
+        && (ITF_RTC_SECONDS_CMP != counter))
+    {
+        pending = 1u;
+    }
 
-        // Performing the seconds read between the counter reads we can ensure
-        // that the seconds value is reliable and no critical section is needed
-        sec = itf_rtc_seconds;
-    } while (counter != lptim->CNT);
+    *uptime  = itf_rtc_uptime + pending;
+    *seconds = itf_rtc_seconds + pending;
+
+    taskEXIT_CRITICAL_FROM_ISR(uxSavedInterruptStatus);
 
     // The timeout interrupt is generated one tick before the reload operation
     counter += 1u;
@@ -133,30 +318,46 @@ itf_rtc_get_ticks (void)
         counter = 0u;
     }
 
-    return (sec * ITF_RTC_CLK_FREQ) + counter;
+    return counter;
 }
 
-void
-itf_rtc_set_callback (itf_rtc_cb_t cb)
-{
-    itf_rtc_cb = cb;
-}
-
-/****************************************************************************//*
- * Private code
- ******************************************************************************/
-
 void
 HAL_LPTIM_CompareMatchCallback (LPTIM_HandleTypeDef * h_lptim)
 {
     if (h_lptim == itf_rtc_config.handle)
     {
-        itf_rtc_seconds++;
+        bool seconds = itf_rtc_cmp == ITF_RTC_SECONDS_CMP;
+        bool alarm   = false;
+
+        UBaseType_t uxSavedInterruptStatus = taskENTER_CRITICAL_FROM_ISR();
 
-        if (itf_rtc_cb != NULL)
+        if (seconds)
+        {
+            itf_rtc_seconds++;
+            itf_rtc_uptime++;
+        }
+
+        // The alarm is checked at every match, it is never delivered early
+        if (itf_rtc_alarm_on
+            && ((int32_t)(itf_rtc_get_ticks() - itf_rtc_alarm_tick) >= 0))
+        {
+            itf_rtc_alarm_on = false;
+            alarm            = true;
+        }
+
+        itf_rtc_arm(true);
+
+        taskEXIT_CRITICAL_FROM_ISR(uxSavedInterruptStatus);
+
+        if (seconds && (itf_rtc_cb != NULL))
         {
             itf_rtc_cb();
         }
+
+        if (alarm && (itf_rtc_alarm_cb != NULL))
+        {
+            itf_rtc_alarm_cb();
+        }
     }
 }
 
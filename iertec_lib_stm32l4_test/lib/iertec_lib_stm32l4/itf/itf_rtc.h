@@ -9,6 +9,20 @@
 /**
  * @defgroup itf_rtc itf_rtc
  * @brief RTC interface driver.
+ *
+ * Besides the seconds interrupt, the driver provides a one-shot alarm in ticks
+ * of @ref itf_rtc_get_ticks, see @ref itf_rtc_set_alarm. The alarm shares the
+ * LPTIM compare with the seconds match: the compare is moved to the alarm when
+ * it falls in the current second, and it is moved back to the seconds match
+ * when the alarm fires. The alarms in the last @ref ITF_RTC_ALARM_GUARD ticks
+ * of a second are delivered by the seconds interrupt, so they may be up to
+ * that number of ticks late. The LPTIM interrupt must not be masked for longer
+ * than @ref ITF_RTC_ALARM_GUARD ticks, or a seconds match may be missed.
+ *
+ * The tick count is monotonic: it is not changed by @ref itf_rtc_set_time, and
+ * the timer keeps counting in the low power modes used by the system. The
+ * 64-bit count given by @ref itf_rtc_get_ticks64 does not wrap around in the
+ * life of the device, and @ref itf_rtc_get_ticks gives its lower 32 bits.
  * @{
  */
 
@@ -24,6 +38,18 @@
 /** Frequency of the clock used by the RTC (Hz). */
 #define ITF_RTC_CLK_FREQ (32768u)
 
+/** Minimum number of ticks between the current count and a compare value
+ * written to the timer, so the write completes before the match. */
+#ifndef ITF_RTC_ALARM_MARGIN
+#define ITF_RTC_ALARM_MARGIN (6u)
+#endif
+
+/** Number of ticks before the seconds match where no alarm compare is
+ * programmed, so the seconds match can be restored after it. */
+#ifndef ITF_RTC_ALARM_GUARD
+#define ITF_RTC_ALARM_GUARD  (64u)
+#endif
+
 /** @brief I2C interface hardware configuration type. */
 typedef struct
 {
@@ -59,12 +85,31 @@ void itf_rtc_set_time(uint32_t seconds, uint8_t cseconds);
 void itf_rtc_get_time(uint32_t * seconds, uint8_t * cseconds);
 
 /**
- * @brief Get the total number of ticks elapsed since the timer start.
+ * @brief Get the current time count with a sub-second fixed-point fraction.
+ * It can be called from tasks and ISRs.
  *
- * @return Number of ticks elapsed.
+ * @param[out] seconds Seconds count.
+ * @param[out] fraction Fraction of the current second, in units of 2^-32 s.
+ */
+void itf_rtc_get_time_frac(uint32_t * seconds, uint32_t * fraction);
+
+/**
+ * @brief Get the total number of ticks elapsed since the timer start. The
+ * count wraps around, so only the differences between two counts are valid.
+ * It can be called from tasks and ISRs.
+ *
+ * @return Number of ticks elapsed, lower 32 bits.
  */
 uint32_t itf_rtc_get_ticks(void);
 
+/**
+ * @brief Get the total number of ticks elapsed since the timer start, without
+ * wrap around. It can be called from tasks and ISRs.
+ *
+ * @return Number of ticks elapsed.
+ */
+uint64_t itf_rtc_get_ticks64(void);
+
 /**
  * @brief Set the callback to call each second.
  *
@@ -72,6 +117,38 @@ uint32_t itf_rtc_get_ticks(void);
  */
 void itf_rtc_set_callback(itf_rtc_cb_t cb);
 
+/**
+ * @brief Program the one-shot alarm, replacing the previous one. The alarm
+ * callback is called from the interrupt once the tick count reaches the alarm
+ * tick, never before. If the tick has already passed it is called as soon as
+ * possible. It can be called from tasks and ISRs.
+ *
+ * @param[in] ticks Tick count of the alarm, as returned by
+ * @ref itf_rtc_get_ticks.
+ */
+void itf_rtc_set_alarm(uint32_t ticks);
+
+/**
+ * @brief Cancel the alarm. A pending alarm interrupt may still be served, but
+ * the alarm callback is not called. It can be called from tasks and ISRs.
+ */
+void itf_rtc_stop_alarm(void);
+
+/**
+ * @brief Set the callback to call when the alarm fires.
+ *
+ * @param[in] cb Callback function to use.
+ */
+void itf_rtc_set_alarm_callback(itf_rtc_cb_t cb);
+
+/**
+ * @brief Get the handler used by the RTC in the power control system.
+ *
+ * @return Handler of @ref itf_pwr, @ref H_ITF_PWR_NONE if it is not
+ * initialized.
+ */
+uint8_t itf_rtc_get_pwr(void);
+
 #endif // ITF_RTC_H
 
 /** @} */
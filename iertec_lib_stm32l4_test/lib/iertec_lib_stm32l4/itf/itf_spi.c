@@ -14,6 +14,7 @@
 #include "itf_spi.h"
 #include "itf_io.h"
 #include "itf_pwr.h"
+#include "itf_clk.h"
 
 #include "FreeRTOS.h"
 #include "semphr.h"
@@ -30,6 +31,13 @@
 /** Chip Select off logic value. */
 #define ITF_SPI_CS_OFF (ITF_IO_HIGH)
 
+/** Highest value of the baud rate control field. */
+#define ITF_SPI_BR_MAX (SPI_CR1_BR_Msk >> SPI_CR1_BR_Pos)
+
+/** Range of the low speed SPI clock frequency in Hz. */
+#define ITF_SPI_FREQ_LOW_MIN (100000u)
+#define ITF_SPI_FREQ_LOW_MAX (400000u)
+
 /****************************************************************************//*
  * Type definitions
  ******************************************************************************/
@@ -42,6 +50,11 @@ typedef struct
     SemaphoreHandle_t   semaphore;
     uint8_t             h_itf_pwr;
     itf_spi_mode_t      mode;
+    uint32_t            freq;
+    uint32_t            freq_low;
+    uint32_t            prescaler;
+    uint32_t            prescaler_low;
+    bool                low_speed;
 } itf_spi_instance_t;
 
 /****************************************************************************//*
@@ -67,6 +80,41 @@ static volatile itf_spi_instance_t itf_spi_instance[H_ITF_SPI_COUNT];
  */
 static inline void itf_spi_give_semaphore(const SPI_HandleTypeDef * h_spi);
 
+/**
+ * @brief Get the frequency of the clock of a SPI peripheral.
+ *
+ * @param[in] h_spi Pointer to a SPI_HandleTypeDef structure that contains the
+ * configuration information for SPI module.
+ *
+ * @return Clock frequency in Hz.
+ */
+static uint32_t itf_spi_get_pclk(const SPI_HandleTypeDef * h_spi);
+
+/**
+ * @brief Get the lowest prescaler that keeps the SPI clock at or below a
+ * frequency.
+ *
+ * @param[in] pclk Frequency of the peripheral clock in Hz.
+ * @param[in] freq Maximum SPI clock frequency in Hz.
+ *
+ * @return Prescaler as a SPI_BAUDRATEPRESCALER_x value.
+ */
+static uint32_t itf_spi_get_prescaler(uint32_t pclk, uint32_t freq);
+
+/**
+ * @brief Write the prescaler of the current speed to the peripheral if it has
+ * changed. It must be called while no transfer is in progress.
+ *
+ * @param[in] instance SPI instance properly initialized.
+ */
+static void itf_spi_set_prescaler(volatile itf_spi_instance_t * instance);
+
+/**
+ * @brief Clock level change notification. The prescalers are derived again so
+ * the SPI clocks keep their frequencies.
+ */
+static void itf_spi_clk_notify(void);
+
 /****************************************************************************//*
  * Public code
  ******************************************************************************/
@@ -142,6 +190,34 @@ itf_spi_init (h_itf_spi_t h_itf_spi)
         return false;
     }
 
+    // The SPI clock frequencies are the ones of the board configuration, and
+    // they are kept when the clock level changes. The core may already run at
+    // another level, so they are computed at the board level
+    uint32_t pclk       = itf_spi_get_pclk(instance->handle);
+    uint32_t pclk_board = itf_clk_get_board_freq(pclk);
+    uint32_t br         = instance->handle->Init.BaudRatePrescaler
+                          >> SPI_CR1_BR_Pos;
+    uint32_t freq_low   = pclk_board >> (ITF_SPI_BR_MAX + 1u);
+
+    // The low speed is the one given by the highest prescaler, within its
+    // range. The prescalers keep the clock at or below the frequency, so the
+    // top of the range is used when it is too low
+    if ((freq_low < ITF_SPI_FREQ_LOW_MIN) || (freq_low > ITF_SPI_FREQ_LOW_MAX))
+    {
+        freq_low = ITF_SPI_FREQ_LOW_MAX;
+    }
+
+    instance->freq          = pclk_board >> (br + 1u);
+    instance->freq_low      = freq_low;
+    instance->prescaler     = itf_spi_get_prescaler(pclk, instance->freq);
+    instance->prescaler_low = itf_spi_get_prescaler(pclk, freq_low);
+    instance->low_speed     = false;
+
+    if (!itf_clk_add_notify(itf_spi_clk_notify))
+    {
+        return false;
+    }
+
     return true;
 }
 
@@ -172,6 +248,9 @@ itf_spi_transaction (h_itf_spi_t h_itf_spi, const uint8_t * tx_data,
     volatile itf_spi_instance_t * instance = &itf_spi_instance[h_itf_spi];
     HAL_StatusTypeDef             status;
 
+    // Apply a prescaler change pending from a clock level change
+    itf_spi_set_prescaler(instance);
+
     itf_pwr_set_active(instance->h_itf_pwr);
 
     if ((NULL != tx_data) && (NULL != rx_data))
@@ -312,13 +391,12 @@ itf_spi_set_low_speed (h_itf_spi_t h_itf_spi)
 {
     volatile itf_spi_instance_t * instance = &itf_spi_instance[h_itf_spi];
 
-    // Disable SPI peripheral
-    __HAL_SPI_DISABLE(instance->handle);
-
-    // Set the clock baud rate to 48 MHz / 256 = 187.5 kHz
-    // The clock signal must be configured between 100 and 400 kHz
-    MODIFY_REG(instance->handle->Instance->CR1, SPI_BAUDRATEPRESCALER_256,
-               SPI_BAUDRATEPRESCALER_256);
+    // Set the clock baud rate to 48 MHz / 256 = 187.5 kHz, or the same
+    // frequency at other clock levels
+    // The clock signal must be configured between 100 and 400 kHz, the
+    // frequency is limited to that range at the initialization
+    instance->low_speed = true;
+    itf_spi_set_prescaler(instance);
 
     // Enable SPI peripheral
     __HAL_SPI_ENABLE(instance->handle);
@@ -329,17 +407,20 @@ itf_spi_set_high_speed (h_itf_spi_t h_itf_spi)
 {
     volatile itf_spi_instance_t * instance = &itf_spi_instance[h_itf_spi];
 
-    // Disable SPI peripheral
-    __HAL_SPI_DISABLE(instance->handle);
-
     // Restore the original clock baudrate
-    MODIFY_REG(instance->handle->Instance->CR1, SPI_BAUDRATEPRESCALER_256,
-               instance->handle->Init.BaudRatePrescaler);
+    instance->low_speed = false;
+    itf_spi_set_prescaler(instance);
 
     // Enable SPI peripheral
     __HAL_SPI_ENABLE(instance->handle);
 }
 
+uint8_t
+itf_spi_get_pwr (h_itf_spi_t h_itf_spi)
+{
+    return itf_spi_instance[h_itf_spi].h_itf_pwr;
+}
+
 /****************************************************************************//*
  * Private code
  ******************************************************************************/
@@ -392,6 +473,92 @@ itf_spi_give_semaphore (const SPI_HandleTypeDef * h_spi)
     portYIELD_FROM_ISR(b_yield);
 }
 
+static uint32_t
+itf_spi_get_pclk (const SPI_HandleTypeDef * h_spi)
+{
+    uint32_t pclk;
+
+    // SPI1 is the only one in the APB2 bus
+    if (SPI1 == h_spi->Instance)
+    {
+        pclk = HAL_RCC_GetPCLK2Freq();
+    }
+    else
+    {
+        pclk = HAL_RCC_GetPCLK1Freq();
+    }
+
+    return pclk;
+}
+
+static uint32_t
+itf_spi_get_prescaler (uint32_t pclk, uint32_t freq)
+{
+    uint32_t br = 0u;
+
+    // The prescaler divides by 2^(br + 1)
+    while ((br < ITF_SPI_BR_MAX) && ((pclk >> (br + 1u)) > freq))
+    {
+        br++;
+    }
+
+    return br << SPI_CR1_BR_Pos;
+}
+
+static void
+itf_spi_set_prescaler (volatile itf_spi_instance_t * instance)
+{
+    taskENTER_CRITICAL();
+
+    uint32_t prescaler = instance->low_speed ? instance->prescaler_low
+                                             : instance->prescaler;
+
+    instance->handle->Init.BaudRatePrescaler = instance->prescaler;
+
+    if ((instance->handle->Instance->CR1 & SPI_CR1_BR_Msk) != prescaler)
+    {
+        uint32_t enabled = instance->handle->Instance->CR1 & SPI_CR1_SPE;
+
+        // The baud rate can only be changed with the SPI peripheral disabled
+        __HAL_SPI_DISABLE(instance->handle);
+        MODIFY_REG(instance->handle->Instance->CR1, SPI_CR1_BR_Msk,
+                   prescaler);
+
+        if (0u != enabled)
+        {
+            __HAL_SPI_ENABLE(instance->handle);
+        }
+    }
+
+    taskEXIT_CRITICAL();
+}
+
+static void
+itf_spi_clk_notify (void)
+{
+    for (size_t i = 0; i < H_ITF_SPI_COUNT; i++)
+    {
+        volatile itf_spi_instance_t * instance = &itf_spi_instance[i];
+
+        if (NULL != instance->handle)
+        {
+            uint32_t pclk = itf_spi_get_pclk(instance->handle);
+
+            instance->prescaler     = itf_spi_get_prescaler(pclk,
+                                                            instance->freq);
+            instance->prescaler_low = itf_spi_get_prescaler(pclk,
+                                                            instance->freq_low);
+
+            // A transfer in progress ends with the previous prescaler, and the
+            // new one is written before the next transfer
+            if (HAL_SPI_GetState(instance->handle) == HAL_SPI_STATE_READY)
+            {
+                itf_spi_set_prescaler(instance);
+            }
+        }
+    }
+}
+
 /** @} */
 
 /******************************** End of file *********************************/
@@ -117,6 +117,15 @@ void itf_spi_set_low_speed(h_itf_spi_t h_itf_spi);
  */
 void itf_spi_set_high_speed(h_itf_spi_t h_itf_spi);
 
+/**
+ * @brief Get the handler used by the SPI interface in the power control system.
+ *
+ * @param[in] h_itf_spi Handler of the SPI interface to use.
+ *
+ * @return Handler of @ref itf_pwr.
+ */
+uint8_t itf_spi_get_pwr(h_itf_spi_t h_itf_spi);
+
 #endif // ITF_SPI_H
 
 /** @} */
@@ -14,6 +14,7 @@
 #include "itf_uart.h"
 #include "itf_pwr.h"
 #include "itf_io.h"
+#include "itf_clk.h"
 
 #include "FreeRTOS.h"
 #include "semphr.h"
@@ -60,6 +61,7 @@ typedef struct
     itf_uart_xts_state              rts_state;
     uint8_t                         h_itf_pwr_tx;
     uint8_t                         h_itf_pwr_rx;
+    bool                            b_read_enabled;
     const itf_uart_line_no_crlf_t * line_no_crlf;
     uint32_t                        break_brr;
 } itf_uart_instance_t;
@@ -109,6 +111,12 @@ static bool itf_uart_check_line_no_crlf(
 static void itf_uart_generate_break_baudrate(volatile itf_uart_instance_t * instance,
                                              uint32_t break_time);
 
+/**
+ * @brief Clock level change notification. The baud rate of the UART interfaces
+ * clocked from the core clock is derived again.
+ */
+static void itf_uart_clk_notify(void);
+
 /****************************************************************************//*
  * Public code
  ******************************************************************************/
@@ -136,11 +144,12 @@ itf_uart_init (h_itf_uart_t h_itf_uart)
     }
 
     // Save the UART instance to be used
-    instance->handle       = config->handle;
-    instance->buffer_tx    = NULL;
-    instance->len_tx       = 0;
-    instance->len_rx       = 0;
-    instance->line_no_crlf = config->line_no_crlf;
+    instance->handle         = config->handle;
+    instance->buffer_tx      = NULL;
+    instance->len_tx         = 0;
+    instance->len_rx         = 0;
+    instance->b_read_enabled = false;
+    instance->line_no_crlf   = config->line_no_crlf;
 
     // Create the transmission semaphore
     instance->sem_tx = xSemaphoreCreateBinary();
@@ -204,6 +213,11 @@ itf_uart_init (h_itf_uart_t h_itf_uart)
     // Compute the baudrate needed to generate a break of the desired time
     itf_uart_generate_break_baudrate(instance, config->break_time);
 
+    if (!itf_clk_add_notify(itf_uart_clk_notify))
+    {
+        return false;
+    }
+
     return true;
 }
 
@@ -282,9 +296,15 @@ void
 itf_uart_read_enable (h_itf_uart_t h_itf_uart)
 {
     volatile itf_uart_instance_t * instance = &itf_uart_instance[h_itf_uart];
+    bool                           b_change;
 
     taskENTER_CRITICAL();
 
+    // The power constraint is only taken when the reception is enabled, the
+    // function can be called again while it is enabled
+    b_change                 = !instance->b_read_enabled;
+    instance->b_read_enabled = true;
+
     // Computation of UART mask to apply to RDR register.
     UART_MASK_COMPUTATION(instance->handle);
 
@@ -323,16 +343,24 @@ itf_uart_read_enable (h_itf_uart_t h_itf_uart)
 
     itf_uart_clean_rx(instance);
 
-    itf_pwr_set_active(instance->h_itf_pwr_rx);
+    if (b_change)
+    {
+        itf_pwr_set_active(instance->h_itf_pwr_rx);
+    }
 }
 
 void
 itf_uart_read_disable (h_itf_uart_t h_itf_uart)
 {
     volatile itf_uart_instance_t * instance = &itf_uart_instance[h_itf_uart];
+    bool                           b_change;
 
     taskENTER_CRITICAL();
 
+    // The power constraint is only released when the reception is disabled
+    b_change                 = instance->b_read_enabled;
+    instance->b_read_enabled = false;
+
     // Disable the UART parity error and RXNE interrupts
     ATOMIC_CLEAR_BIT(instance->handle->Instance->CR1,
                      (USART_CR1_RXNEIE | USART_CR1_PEIE));
@@ -351,7 +379,10 @@ itf_uart_read_disable (h_itf_uart_t h_itf_uart)
 
     taskEXIT_CRITICAL();
 
-    itf_pwr_set_inactive(instance->h_itf_pwr_rx);
+    if (b_change)
+    {
+        itf_pwr_set_inactive(instance->h_itf_pwr_rx);
+    }
 }
 
 size_t
@@ -684,6 +715,14 @@ itf_uart_isr (h_itf_uart_t h_itf_uart)
     portYIELD_FROM_ISR(b_yield);
 }
 
+uint8_t
+itf_uart_get_pwr (h_itf_uart_t h_itf_uart, bool rx)
+{
+    volatile itf_uart_instance_t * instance = &itf_uart_instance[h_itf_uart];
+
+    return rx ? instance->h_itf_pwr_rx : instance->h_itf_pwr_tx;
+}
+
 /****************************************************************************//*
  * Private code
  ******************************************************************************/
@@ -766,6 +805,34 @@ itf_uart_generate_break_baudrate (volatile itf_uart_instance_t * instance,
     }
 }
 
+static void
+itf_uart_clk_notify (void)
+{
+    for (size_t i = 0; i < H_ITF_UART_COUNT; i++)
+    {
+        volatile itf_uart_instance_t * instance     = &itf_uart_instance[i];
+        UART_ClockSourceTypeDef        clock_source = UART_CLOCKSOURCE_HSI;
+
+        if (NULL != instance->handle)
+        {
+            UART_GETCLOCKSOURCE(instance->handle, clock_source);
+        }
+
+        // The HSI and LSE clocks do not depend on the clock level
+        if ((UART_CLOCKSOURCE_HSI != clock_source)
+            && (UART_CLOCKSOURCE_LSE != clock_source))
+        {
+            // The baud rate can only be changed with the UART disabled
+            __HAL_UART_DISABLE(instance->handle);
+            (void)UART_SetConfig(instance->handle);
+            __HAL_UART_ENABLE(instance->handle);
+
+            itf_uart_generate_break_baudrate(instance,
+                                             itf_uart_config[i].break_time);
+        }
+    }
+}
+
 /** @} */
 
 /******************************** End of file *********************************/
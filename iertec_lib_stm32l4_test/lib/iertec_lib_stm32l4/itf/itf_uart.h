@@ -84,14 +84,15 @@ bool itf_uart_write(h_itf_uart_t h_itf_uart, const char * data);
 bool itf_uart_write_bin(h_itf_uart_t h_itf_uart, const char * data, size_t len);
 
 /**
- * @brief Enable the UART reception.
+ * @brief Enable the UART reception. The power control constraint is taken
+ * once, calling it again while the reception is enabled has no effect on it.
  *
  * @param[in] h_itf_uart Handler of the UART interface to use.
  */
 void itf_uart_read_enable(h_itf_uart_t h_itf_uart);
 
 /**
- * @brief Disable the UART reception.
+ * @brief Disable the UART reception, releasing its power control constraint.
  *
  * @param[in] h_itf_uart Handler of the UART interface to use.
  */
@@ -148,6 +149,18 @@ bool itf_uart_send_break(h_itf_uart_t h_itf_uart);
  */
 void itf_uart_isr(h_itf_uart_t h_itf_uart);
 
+/**
+ * @brief Get the handler used by the UART interface in the power control
+ * system.
+ *
+ * @param[in] h_itf_uart Handler of the UART interface to use.
+ * @param[in] rx true to get the reception handler, false to get the
+ * transmission one.
+ *
+ * @return Handler of @ref itf_pwr.
+ */
+uint8_t itf_uart_get_pwr(h_itf_uart_t h_itf_uart, bool rx);
+
 #endif // ITF_UART_H
 
 /** @} */
@@ -0,0 +1,798 @@
+/*******************************************************************************
+ * @file nvm_journal.c
+ * @author juanmanuel.fernandez@iertec.com
+ * @date 19 Oct 2026
+ * @brief Power fail safe journal of records stored in the internal FLASH.
+ * Several records can be updated atomically inside a transaction, which is
+ * committed with a single double word write.
+ * @ingroup nvm_journal
+ ******************************************************************************/
+
+/**
+ * @addtogroup nvm_journal
+ * @{
+ */
+
+#include "nvm_journal.h"
+#include "itf_flash.h"
+#include "crypt_crc32.h"
+#include "debug_util.h"
+
+#include <string.h>
+
+/****************************************************************************//*
+ * Constants and macros
+ ******************************************************************************/
+
+/** Size of a double word, the FLASH programming unit. */
+#define NVM_JOURNAL_DWORD_BYTES (8u)
+
+/** Magic number that identifies a formatted journal page. */
+#define NVM_JOURNAL_MAGIC       (0x4C4E524Aul)
+
+/** Entry type of a record. */
+#define NVM_JOURNAL_TYPE_DATA   (0x01u)
+
+/** Entry type of a transaction commit. */
+#define NVM_JOURNAL_TYPE_COMMIT (0x02u)
+
+/** Offset used to indicate that a record is not stored. */
+#define NVM_JOURNAL_OFFSET_NONE (0u)
+
+/** Number of journal pages. */
+#define NVM_JOURNAL_PAGE_COUNT  (2u)
+
+/** Size of the data of a record rounded up to double words. */
+#define NVM_JOURNAL_DATA_SIZE(len)                                   \
+        ((((len) + NVM_JOURNAL_DWORD_BYTES - 1u)                     \
+          / NVM_JOURNAL_DWORD_BYTES) * NVM_JOURNAL_DWORD_BYTES)
+
+/****************************************************************************//*
+ * Private data types
+ ******************************************************************************/
+
+/** @brief Header stored at the start of a journal page. */
+typedef struct
+{
+    /** Magic number. */
+    uint32_t magic;
+
+    /** Generation, incremented each time the records change of page. */
+    uint32_t generation;
+} nvm_journal_header_t;
+
+/** @brief Header of a record, followed by the record data. */
+typedef struct
+{
+    /** Entry type, @ref NVM_JOURNAL_TYPE_DATA. */
+    uint8_t type;
+
+    /** Transaction number. */
+    uint8_t tx;
+
+    /** Record identifier. */
+    uint16_t id;
+
+    /** Record length. */
+    uint16_t length;
+
+    /** Low half of the CRC32 of the identifier, length and data. */
+    uint16_t check;
+} nvm_journal_entry_t;
+
+/** @brief Transaction commit. */
+typedef struct
+{
+    /** Entry type, @ref NVM_JOURNAL_TYPE_COMMIT. */
+    uint8_t type;
+
+    /** Transaction number. */
+    uint8_t tx;
+
+    /** Number of records written in the transaction. */
+    uint16_t count;
+
+    /** CRC32 of the previous fields and the headers of the records. */
+    uint32_t check;
+} nvm_journal_commit_t;
+
+/** @brief State of a transaction. */
+typedef struct
+{
+    /** Transaction number. */
+    uint8_t tx;
+
+    /** Number of records written. */
+    uint16_t count;
+
+    /** Running CRC32 of the headers of the records. */
+    uint32_t crc;
+
+    /** Offset of the last record written for each identifier. */
+    uint32_t offset[NVM_JOURNAL_ID_MAX];
+} nvm_journal_tx_t;
+
+/****************************************************************************//*
+ * Private data
+ ******************************************************************************/
+
+/** Address of the journal pages. */
+static const uint32_t nvm_journal_page[NVM_JOURNAL_PAGE_COUNT] =
+{
+    NVM_JOURNAL_ADDRESS_0,
+    NVM_JOURNAL_ADDRESS_1,
+};
+
+/** Index of the page in use. */
+static uint8_t page_active;
+
+/** Generation of the page in use. */
+static uint32_t page_generation;
+
+/** Offset of the next free entry in the page in use. */
+static uint32_t write_offset;
+
+/** The page contains an interrupted write, so it can not be appended. */
+static bool b_dirty;
+
+/** A transaction is active. */
+static bool b_tx;
+
+/** Offset of the last committed record for each identifier. */
+static uint32_t committed[NVM_JOURNAL_ID_MAX];
+
+/** Active or pending transaction. */
+static nvm_journal_tx_t pending;
+
+/****************************************************************************//*
+ * Private code prototypes
+ ******************************************************************************/
+
+/**
+ * @brief Read a double word of a journal page.
+ *
+ * @param[in] page Page index.
+ * @param[in] offset Offset inside the page.
+ * @param[out] dword Read double word.
+ *
+ * @retval true Operation executed correctly.
+ * @retval false An error occurred.
+ */
+static bool nvm_journal_read_dword(uint8_t page, uint32_t offset,
+                                   uint8_t * dword);
+
+/**
+ * @brief Write a double word of a journal page.
+ *
+ * @param[in] page Page index.
+ * @param[in] offset Offset inside the page.
+ * @param[in] dword Double word to write.
+ *
+ * @retval true Operation executed correctly.
+ * @retval false An error occurred.
+ */
+static bool nvm_journal_write_dword(uint8_t page, uint32_t offset,
+                                    const void * dword);
+
+/**
+ * @brief Read the header of a journal page.
+ *
+ * @param[in] page Page index.
+ * @param[out] generation Generation of the page.
+ *
+ * @return true if the page is formatted, false otherwise.
+ */
+static bool nvm_journal_read_header(uint8_t page, uint32_t * generation);
+
+/**
+ * @brief Compute the check of a record.
+ *
+ * @param[in] entry Record header.
+ * @param[in] data Record data.
+ *
+ * @return The check of the record.
+ */
+static uint16_t nvm_journal_entry_check(const nvm_journal_entry_t * entry,
+                                        const uint8_t * data);
+
+/**
+ * @brief Verify the check of a record stored in the page in use.
+ *
+ * @param[in] entry Record header.
+ * @param[in] offset Offset of the record header.
+ *
+ * @return true if the record is complete, false otherwise.
+ */
+static bool nvm_journal_entry_verify(const nvm_journal_entry_t * entry,
+                                     uint32_t offset);
+
+/**
+ * @brief Clear a transaction and assign it a transaction number.
+ *
+ * @param[in] tx Transaction number.
+ */
+static void nvm_journal_tx_clear(uint8_t tx);
+
+/**
+ * @brief Register a record written in the pending transaction.
+ *
+ * @param[in] entry Record header.
+ * @param[in] offset Offset of the record header.
+ */
+static void nvm_journal_tx_add(const nvm_journal_entry_t * entry,
+                               uint32_t offset);
+
+/**
+ * @brief Build the commit of the pending transaction.
+ *
+ * @param[out] commit Commit entry.
+ */
+static void nvm_journal_tx_commit(nvm_journal_commit_t * commit);
+
+/**
+ * @brief Make visible the records of the pending transaction.
+ */
+static void nvm_journal_tx_merge(void);
+
+/**
+ * @brief Traverse the page in use recovering the committed records.
+ *
+ * @retval true Operation executed correctly.
+ * @retval false An error occurred.
+ */
+static bool nvm_journal_scan(void);
+
+/**
+ * @brief Copy a record from the page in use to another page.
+ *
+ * @param[in] dst Destination page index.
+ * @param[in,out] dst_offset Offset of the destination page. It is updated with
+ * the next free offset.
+ * @param[in] src_offset Offset of the record in the page in use.
+ * @param[in] tx Transaction number of the copy.
+ * @param[out] entry Header of the copied record.
+ *
+ * @retval true Operation executed correctly.
+ * @retval false An error occurred or the destination page is full.
+ */
+static bool nvm_journal_copy(uint8_t dst, uint32_t * dst_offset,
+                             uint32_t src_offset, uint8_t tx,
+                             nvm_journal_entry_t * entry);
+
+/**
+ * @brief Copy the committed records and the records of the active transaction
+ * to the other journal page, which becomes the page in use.
+ *
+ * @retval true Operation executed correctly.
+ * @retval false An error occurred.
+ */
+static bool nvm_journal_compact(void);
+
+/****************************************************************************//*
+ * Public code
+ ******************************************************************************/
+
+bool
+nvm_journal_init (void)
+{
+    DEBUG_ASSERT_STATIC(sizeof(nvm_journal_header_t) == NVM_JOURNAL_DWORD_BYTES);
+
+    uint32_t generation[NVM_JOURNAL_PAGE_COUNT];
+    bool     valid[NVM_JOURNAL_PAGE_COUNT];
+    bool     ret = true;
+
+    b_tx    = false;
+    b_dirty = false;
+
+    for (uint8_t i = 0; i < NVM_JOURNAL_PAGE_COUNT; i++)
+    {
+        valid[i] = nvm_journal_read_header(i, &generation[i]);
+    }
+
+    if (valid[0] && valid[1])
+    {
+        // An interrupted compaction, the newest page is the good one
+        page_active = ((int32_t)(generation[1] - generation[0]) > 0) ? 1u : 0u;
+    }
+    else if (valid[0] || valid[1])
+    {
+        page_active = valid[0] ? 0u : 1u;
+    }
+    else
+    {
+        nvm_journal_header_t header =
+        {
+            .magic      = NVM_JOURNAL_MAGIC,
+            .generation = 0,
+        };
+
+        page_active   = 0;
+        generation[0] = header.generation;
+        ret           = itf_flash_erase(nvm_journal_page[0],
+                                        NVM_JOURNAL_PAGE_SIZE);
+        ret           = ret && nvm_journal_write_dword(0, 0, &header);
+    }
+
+    page_generation = generation[page_active];
+
+    if (ret)
+    {
+        ret = nvm_journal_scan();
+    }
+
+    return ret;
+}
+
+bool
+nvm_journal_begin (void)
+{
+    if (b_tx)
+    {
+        return false;
+    }
+
+    nvm_journal_tx_clear(pending.tx + 1u);
+
+    // An interrupted write can not be appended, move to the other page
+    if (b_dirty && !nvm_journal_compact())
+    {
+        return false;
+    }
+
+    b_tx = true;
+
+    return true;
+}
+
+bool
+nvm_journal_write (uint16_t id, const uint8_t * data, size_t length)
+{
+    if (!b_tx || (id >= NVM_JOURNAL_ID_MAX) || (NULL == data)
+        || (length > NVM_JOURNAL_DATA_MAX))
+    {
+        return false;
+    }
+
+    // Room for the record and the commit
+    uint32_t size = sizeof(nvm_journal_entry_t) + NVM_JOURNAL_DATA_SIZE(length)
+                    + sizeof(nvm_journal_commit_t);
+
+    if ((write_offset + size) > NVM_JOURNAL_PAGE_SIZE)
+    {
+        if (!nvm_journal_compact()
+            || ((write_offset + size) > NVM_JOURNAL_PAGE_SIZE))
+        {
+            return false;
+        }
+    }
+
+    nvm_journal_entry_t entry =
+    {
+        .type   = NVM_JOURNAL_TYPE_DATA,
+        .tx     = pending.tx,
+        .id     = id,
+        .length = (uint16_t)length,
+    };
+    uint32_t offset = write_offset;
+    bool     ret;
+
+    entry.check = nvm_journal_entry_check(&entry, data);
+    ret         = nvm_journal_write_dword(page_active, offset, &entry);
+
+    for (size_t i = 0; ret && (i < length); i += NVM_JOURNAL_DWORD_BYTES)
+    {
+        uint8_t dword[NVM_JOURNAL_DWORD_BYTES];
+        size_t  len = length - i;
+
+        if (len > NVM_JOURNAL_DWORD_BYTES)
+        {
+            len = NVM_JOURNAL_DWORD_BYTES;
+        }
+
+        (void)memset(dword, 0xFF, sizeof(dword));
+        (void)memcpy(dword, &data[i], len);
+        ret = nvm_journal_write_dword(page_active,
+                                      offset + sizeof(entry) + i, dword);
+    }
+
+    write_offset += size - sizeof(nvm_journal_commit_t);
+
+    if (ret)
+    {
+        nvm_journal_tx_add(&entry, offset);
+    }
+    else
+    {
+        b_dirty = true;
+    }
+
+    return ret;
+}
+
+bool
+nvm_journal_commit (void)
+{
+    bool ret = b_tx && !b_dirty;
+
+    if (ret && (pending.count > 0u))
+    {
+        nvm_journal_commit_t commit;
+
+        nvm_journal_tx_commit(&commit);
+        ret           = nvm_journal_write_dword(page_active, write_offset,
+                                                &commit);
+        write_offset += sizeof(commit);
+
+        if (ret)
+        {
+            nvm_journal_tx_merge();
+        }
+        else
+        {
+            b_dirty = true;
+        }
+    }
+
+    b_tx = false;
+
+    return ret;
+}
+
+void
+nvm_journal_rollback (void)
+{
+    // The records stay in the page, but their transaction is never committed
+    b_tx = false;
+}
+
+bool
+nvm_journal_read (uint16_t id, uint8_t * data, size_t size, size_t * length)
+{
+    nvm_journal_entry_t entry;
+    uint8_t             dword[NVM_JOURNAL_DWORD_BYTES];
+    bool                ret;
+
+    if ((id >= NVM_JOURNAL_ID_MAX) || (NVM_JOURNAL_OFFSET_NONE == committed[id]))
+    {
+        return false;
+    }
+
+    ret = nvm_journal_read_dword(page_active, committed[id], dword);
+    (void)memcpy(&entry, dword, sizeof(entry));
+    ret = ret && (entry.length <= size);
+
+    for (size_t i = 0; ret && (i < entry.length); i += NVM_JOURNAL_DWORD_BYTES)
+    {
+        size_t len = entry.length - i;
+
+        if (len > NVM_JOURNAL_DWORD_BYTES)
+        {
+            len = NVM_JOURNAL_DWORD_BYTES;
+        }
+
+        ret = nvm_journal_read_dword(page_active,
+                                     committed[id] + sizeof(entry) + i, dword);
+        (void)memcpy(&data[i], dword, len);
+    }
+
+    if (ret && (NULL != length))
+    {
+        *length = entry.length;
+    }
+
+    return ret;
+}
+
+/****************************************************************************//*
+ * Private code
+ ******************************************************************************/
+
+static bool
+nvm_journal_read_dword (uint8_t page, uint32_t offset, uint8_t * dword)
+{
+    return itf_flash_read(nvm_journal_page[page] + offset, dword,
+                          NVM_JOURNAL_DWORD_BYTES);
+}
+
+static bool
+nvm_journal_write_dword (uint8_t page, uint32_t offset, const void * dword)
+{
+    uint64_t value;
+
+    // Aligned copy, as required by the FLASH driver
+    (void)memcpy(&value, dword, sizeof(value));
+
+    return itf_flash_write(nvm_journal_page[page] + offset,
+                           (const uint8_t *)&value, sizeof(value));
+}
+
+static bool
+nvm_journal_read_header (uint8_t page, uint32_t * generation)
+{
+    nvm_journal_header_t header;
+    uint8_t              dword[NVM_JOURNAL_DWORD_BYTES];
+
+    if (!nvm_journal_read_dword(page, 0, dword))
+    {
+        return false;
+    }
+
+    (void)memcpy(&header, dword, sizeof(header));
+    *generation = header.generation;
+
+    return NVM_JOURNAL_MAGIC == header.magic;
+}
+
+static uint16_t
+nvm_journal_entry_check (const nvm_journal_entry_t * entry,
+                         const uint8_t * data)
+{
+    uint32_t crc;
+
+    // The transaction number is not included, so a record can be copied
+    crc = crypt_crc32((const uint8_t *)&entry->id, sizeof(entry->id),
+                      CRYPT_CRC32_INIT_VAL);
+    crc = crypt_crc32((const uint8_t *)&entry->length, sizeof(entry->length),
+                      crc);
+    crc = crypt_crc32(data, entry->length, crc);
+
+    return (uint16_t)crc;
+}
+
+static bool
+nvm_journal_entry_verify (const nvm_journal_entry_t * entry, uint32_t offset)
+{
+    uint8_t  data[NVM_JOURNAL_DATA_SIZE(NVM_JOURNAL_DATA_MAX)];
+    uint32_t size = NVM_JOURNAL_DATA_SIZE(entry->length);
+
+    if ((entry->id >= NVM_JOURNAL_ID_MAX)
+        || (entry->length > NVM_JOURNAL_DATA_MAX)
+        || ((offset + sizeof(*entry) + size + sizeof(nvm_journal_commit_t))
+            > NVM_JOURNAL_PAGE_SIZE))
+    {
+        return false;
+    }
+
+    for (uint32_t i = 0; i < size; i += NVM_JOURNAL_DWORD_BYTES)
+    {
+        if (!nvm_journal_read_dword(page_active, offset + sizeof(*entry) + i,
+                                    &data[i]))
+        {
+            return false;
+        }
+    }
+
+    return nvm_journal_entry_check(entry, data) == entry->check;
+}
+
+static void
+nvm_journal_tx_clear (uint8_t tx)
+{
+    pending.tx    = tx;
+    pending.count = 0;
+    pending.crc   = CRYPT_CRC32_INIT_VAL;
+
+    for (size_t i = 0; i < NVM_JOURNAL_ID_MAX; i++)
+    {
+        pending.offset[i] = NVM_JOURNAL_OFFSET_NONE;
+    }
+}
+
+static void
+nvm_journal_tx_add (const nvm_journal_entry_t * entry, uint32_t offset)
+{
+    pending.offset[entry->id] = offset;
+    pending.count++;
+    pending.crc = crypt_crc32((const uint8_t *)entry, sizeof(*entry),
+                              pending.crc);
+}
+
+static void
+nvm_journal_tx_commit (nvm_journal_commit_t * commit)
+{
+    commit->type  = NVM_JOURNAL_TYPE_COMMIT;
+    commit->tx    = pending.tx;
+    commit->count = pending.count;
+    commit->check = crypt_crc32((const uint8_t *)commit,
+                                offsetof(nvm_journal_commit_t, check),
+                                pending.crc);
+}
+
+static void
+nvm_journal_tx_merge (void)
+{
+    for (size_t i = 0; i < NVM_JOURNAL_ID_MAX; i++)
+    {
+        if (NVM_JOURNAL_OFFSET_NONE != pending.offset[i])
+        {
+            committed[i] = pending.offset[i];
+        }
+    }
+
+    nvm_journal_tx_clear(pending.tx);
+}
+
+static bool
+nvm_journal_scan (void)
+{
+    uint8_t dword[NVM_JOURNAL_DWORD_BYTES];
+    uint8_t erased[NVM_JOURNAL_DWORD_BYTES];
+    bool    ret = true;
+
+    (void)memset(erased, 0xFF, sizeof(erased));
+
+    for (size_t i = 0; i < NVM_JOURNAL_ID_MAX; i++)
+    {
+        committed[i] = NVM_JOURNAL_OFFSET_NONE;
+    }
+
+    nvm_journal_tx_clear(0);
+    write_offset = sizeof(nvm_journal_header_t);
+
+    // Single pass, the records are kept as pending until their commit is found
+    while (ret && ((write_offset + NVM_JOURNAL_DWORD_BYTES)
+                   <= NVM_JOURNAL_PAGE_SIZE))
+    {
+        ret = nvm_journal_read_dword(page_active, write_offset, dword);
+
+        if (!ret || (memcmp(dword, erased, sizeof(dword)) == 0))
+        {
+            break;
+        }
+
+        if (NVM_JOURNAL_TYPE_DATA == dword[0])
+        {
+            nvm_journal_entry_t entry;
+
+            (void)memcpy(&entry, dword, sizeof(entry));
+
+            if (!nvm_journal_entry_verify(&entry, write_offset))
+            {
+                b_dirty = true;
+                break;
+            }
+
+            // A new transaction discards the previous uncommitted one
+            if ((entry.tx != pending.tx) || (0u == pending.count))
+            {
+                nvm_journal_tx_clear(entry.tx);
+            }
+
+            nvm_journal_tx_add(&entry, write_offset);
+            write_offset += sizeof(entry) + NVM_JOURNAL_DATA_SIZE(entry.length);
+        }
+        else if (NVM_JOURNAL_TYPE_COMMIT == dword[0])
+        {
+            nvm_journal_commit_t commit;
+            nvm_journal_commit_t commit_exp;
+
+            (void)memcpy(&commit, dword, sizeof(commit));
+            nvm_journal_tx_commit(&commit_exp);
+
+            if (memcmp(&commit, &commit_exp, sizeof(commit)) != 0)
+            {
+                b_dirty = true;
+                break;
+            }
+
+            nvm_journal_tx_merge();
+            write_offset += sizeof(commit);
+        }
+        else
+        {
+            b_dirty = true;
+            break;
+        }
+    }
+
+    return ret;
+}
+
+static bool
+nvm_journal_copy (uint8_t dst, uint32_t * dst_offset, uint32_t src_offset,
+                  uint8_t tx, nvm_journal_entry_t * entry)
+{
+    uint8_t  dword[NVM_JOURNAL_DWORD_BYTES];
+    uint32_t size;
+    bool     ret;
+
+    ret = nvm_journal_read_dword(page_active, src_offset, dword);
+    (void)memcpy(entry, dword, sizeof(*entry));
+    entry->tx = tx;
+    size      = sizeof(*entry) + NVM_JOURNAL_DATA_SIZE(entry->length);
+    ret       = ret && ((*dst_offset + size + sizeof(nvm_journal_commit_t))
+                        <= NVM_JOURNAL_PAGE_SIZE);
+    ret       = ret && nvm_journal_write_dword(dst, *dst_offset, entry);
+
+    for (uint32_t i = sizeof(*entry); ret && (i < size);
+         i += NVM_JOURNAL_DWORD_BYTES)
+    {
+        ret = nvm_journal_read_dword(page_active, src_offset + i, dword)
+              && nvm_journal_write_dword(dst, *dst_offset + i, dword);
+    }
+
+    *dst_offset += size;
+
+    return ret;
+}
+
+static bool
+nvm_journal_compact (void)
+{
+    uint8_t              dst    = page_active ^ 1u;
+    uint32_t             offset = sizeof(nvm_journal_header_t);
+    uint32_t             copied[NVM_JOURNAL_ID_MAX];
+    nvm_journal_tx_t     tx     = pending;
+    nvm_journal_entry_t  entry;
+    nvm_journal_commit_t commit;
+    nvm_journal_header_t header =
+    {
+        .magic      = NVM_JOURNAL_MAGIC,
+        .generation = page_generation + 1u,
+    };
+    bool ret;
+
+    ret = itf_flash_erase(nvm_journal_page[dst], NVM_JOURNAL_PAGE_SIZE);
+
+    // Copy the committed records as a single transaction
+    nvm_journal_tx_clear(tx.tx - 1u);
+
+    for (size_t i = 0; ret && (i < NVM_JOURNAL_ID_MAX); i++)
+    {
+        copied[i] = NVM_JOURNAL_OFFSET_NONE;
+
+        if (NVM_JOURNAL_OFFSET_NONE != committed[i])
+        {
+            copied[i] = offset;
+            ret       = nvm_journal_copy(dst, &offset, committed[i],
+                                         pending.tx, &entry);
+            nvm_journal_tx_add(&entry, copied[i]);
+        }
+    }
+
+    if (ret && (pending.count > 0u))
+    {
+        nvm_journal_tx_commit(&commit);
+        ret     = nvm_journal_write_dword(dst, offset, &commit);
+        offset += sizeof(commit);
+    }
+
+    // Copy the records of the active transaction, still pending of commit
+    nvm_journal_tx_clear(tx.tx);
+
+    for (size_t i = 0; ret && (i < NVM_JOURNAL_ID_MAX); i++)
+    {
+        if (NVM_JOURNAL_OFFSET_NONE != tx.offset[i])
+        {
+            uint32_t entry_offset = offset;
+
+            ret = nvm_journal_copy(dst, &offset, tx.offset[i], pending.tx,
+                                   &entry);
+            nvm_journal_tx_add(&entry, entry_offset);
+        }
+    }
+
+    // The header is written last, so an interrupted copy is never used
+    ret = ret && nvm_journal_write_dword(dst, 0, &header);
+
+    if (ret)
+    {
+        (void)memcpy(committed, copied, sizeof(committed));
+        (void)itf_flash_erase(nvm_journal_page[page_active],
+                              NVM_JOURNAL_PAGE_SIZE);
+        page_active     = dst;
+        page_generation = header.generation;
+        write_offset    = offset;
+        b_dirty         = false;
+    }
+    else
+    {
+        pending = tx;
+    }
+
+    return ret;
+}
+
+/** @} */
+
+/******************************** End of file *********************************/
@@ -0,0 +1,120 @@
+/*******************************************************************************
+ * @file nvm_journal.h
+ * @author juanmanuel.fernandez@iertec.com
+ * @date 19 Oct 2026
+ * @brief Power fail safe journal of records stored in the internal FLASH.
+ * Several records can be updated atomically inside a transaction, which is
+ * committed with a single double word write.
+ * @ingroup nvm_journal
+ ******************************************************************************/
+
+/**
+ * @defgroup nvm_journal nvm_journal
+ * @brief Power fail safe journal of records stored in the internal FLASH.
+ *
+ * The records are appended to a journal page, each one tagged with the
+ * transaction that wrote it. The transaction is committed by a double word
+ * that closes it. On start up the journal page is traversed once, keeping the
+ * last committed value of each record, so an interrupted transaction is
+ * discarded as a whole. When the page is full, the committed records are
+ * copied to the second page.
+ * @{
+ */
+
+#ifndef NVM_JOURNAL_H
+#define NVM_JOURNAL_H
+
+#include <stdbool.h>
+#include <stdint.h>
+#include <stddef.h>
+
+/** Size of a FLASH page. */
+#ifndef NVM_JOURNAL_PAGE_SIZE
+#define NVM_JOURNAL_PAGE_SIZE (0x800ul)
+#endif
+
+/** Address of the first journal page. */
+#ifndef NVM_JOURNAL_ADDRESS_0
+#define NVM_JOURNAL_ADDRESS_0 (0x0807E000ul)
+#endif
+
+/** Address of the second journal page. */
+#ifndef NVM_JOURNAL_ADDRESS_1
+#define NVM_JOURNAL_ADDRESS_1 (0x0807E800ul)
+#endif
+
+/** Number of record identifiers, from 0 to NVM_JOURNAL_ID_MAX - 1. */
+#ifndef NVM_JOURNAL_ID_MAX
+#define NVM_JOURNAL_ID_MAX    (16u)
+#endif
+
+/** Maximum length of a record. */
+#ifndef NVM_JOURNAL_DATA_MAX
+#define NVM_JOURNAL_DATA_MAX  (256u)
+#endif
+
+/**
+ * @brief Initialize the journal, recovering the last committed value of each
+ * record. If the journal pages are not formatted, they are formatted here.
+ *
+ * @retval true Operation executed correctly.
+ * @retval false An error occurred.
+ */
+bool nvm_journal_init(void);
+
+/**
+ * @brief Start a transaction. Only one transaction can be active.
+ *
+ * @retval true Operation executed correctly.
+ * @retval false A transaction is already active or the journal page could not
+ * be compacted.
+ */
+bool nvm_journal_begin(void);
+
+/**
+ * @brief Write a record inside the active transaction. The new value is not
+ * visible until the transaction is committed.
+ *
+ * @param[in] id Record identifier.
+ * @param[in] data Record data.
+ * @param[in] length Record length, up to @ref NVM_JOURNAL_DATA_MAX bytes.
+ *
+ * @retval true Operation executed correctly.
+ * @retval false No transaction is active, the arguments are not valid, there is
+ * no space for the record or the FLASH could not be written.
+ */
+bool nvm_journal_write(uint16_t id, const uint8_t * data, size_t length);
+
+/**
+ * @brief Commit the active transaction, making all its records visible at once.
+ *
+ * @retval true Operation executed correctly.
+ * @retval false No transaction is active or the FLASH could not be written. The
+ * transaction is discarded.
+ */
+bool nvm_journal_commit(void);
+
+/**
+ * @brief Discard the active transaction.
+ */
+void nvm_journal_rollback(void);
+
+/**
+ * @brief Read the last committed value of a record.
+ *
+ * @param[in] id Record identifier.
+ * @param[out] data Buffer where the record is copied.
+ * @param[in] size Size of the buffer.
+ * @param[out] length Length of the record. It can be NULL.
+ *
+ * @retval true Operation executed correctly.
+ * @retval false The record does not exist or it does not fit in the buffer.
+ */
+bool nvm_journal_read(uint16_t id, uint8_t * data, size_t size,
+                      size_t * length);
+
+#endif // NVM_JOURNAL_H
+
+/** @} */
+
+/******************************** End of file *********************************/
@@ -29,6 +29,8 @@ typedef struct
     uint8_t cseconds;   /**< Centiseconds. Range [0, 99]. */
     int8_t  delta_hour; /**< Local time deviation in hours from UTC. Range [-24,
                          * 24]. */
+    int8_t  delta_minutes; /**< Minutes of the local time deviation, with the
+                            * sign of delta_hour. Range [-59, 59]. */
 } datetime_t;
 
 #endif // DATETIME_H
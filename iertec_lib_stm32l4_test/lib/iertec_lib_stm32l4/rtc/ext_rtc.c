@@ -26,6 +26,18 @@ static volatile ext_rtc_cb_t ext_rtc_cb = NULL;
 /** RTC seconds count. */
 static volatile uint32_t ext_rtc_seconds = 0u;
 
+/** Clock used to interpolate the time inside the second. */
+static volatile ext_rtc_clock_t ext_rtc_clock = NULL;
+
+/** Clock value at the last pulse. */
+static volatile uint32_t ext_rtc_mark;
+
+/** The clock value at the last pulse is valid. */
+static volatile bool ext_rtc_mark_on = false;
+
+/** Clock ticks of the last valid second. */
+static volatile uint32_t ext_rtc_period = EXT_RTC_INTERP_FREQ;
+
 /****************************************************************************//*
  * Private code prototypes
  ******************************************************************************/
@@ -64,11 +76,43 @@ ext_rtc_set_time (uint32_t seconds, uint8_t cseconds)
 void
 ext_rtc_get_time (uint32_t * seconds, uint8_t * cseconds)
 {
-    // Access to uint32_t is atomic
-    *seconds = ext_rtc_seconds;
+    uint32_t fraction;
 
-    // Centiseconds not supported
-    *cseconds = 0;
+    ext_rtc_get_time_frac(seconds, &fraction);
+
+    *cseconds = (uint8_t)(((uint64_t)fraction * 100u) >> 32);
+}
+
+void
+ext_rtc_get_time_frac (uint32_t * seconds, uint32_t * fraction)
+{
+    ext_rtc_clock_t clock = ext_rtc_clock;
+    uint32_t        sec;
+    uint32_t        elapsed;
+    uint32_t        period;
+
+    // The values are read again if a pulse arrives in the middle, so no
+    // critical section is needed
+    do
+    {
+        sec     = ext_rtc_seconds;
+        elapsed = 0u;
+        period  = ext_rtc_period;
+
+        if ((NULL != clock) && ext_rtc_mark_on)
+        {
+            elapsed = clock() - ext_rtc_mark;
+        }
+    } while (sec != ext_rtc_seconds);
+
+    // A late pulse must not make the time go beyond the next second
+    if (elapsed >= period)
+    {
+        elapsed = period - 1u;
+    }
+
+    *seconds  = sec;
+    *fraction = (uint32_t)(((uint64_t)elapsed << 32) / period);
 }
 
 uint32_t
@@ -83,6 +127,14 @@ ext_rtc_set_callback (ext_rtc_cb_t cb)
     ext_rtc_cb = cb;
 }
 
+void
+ext_rtc_set_clock (ext_rtc_clock_t clock)
+{
+    ext_rtc_mark_on = false;
+    ext_rtc_period  = EXT_RTC_INTERP_FREQ;
+    ext_rtc_clock   = clock;
+}
+
 /****************************************************************************//*
  * Private code
  ******************************************************************************/
@@ -90,6 +142,25 @@ ext_rtc_set_callback (ext_rtc_cb_t cb)
 static void
 ext_rtc_tick_isr (void)
 {
+    ext_rtc_clock_t clock = ext_rtc_clock;
+
+    if (NULL != clock)
+    {
+        uint32_t now    = clock();
+        uint32_t period = now - ext_rtc_mark;
+
+        // Only the seconds close to the nominal one are used
+        if (ext_rtc_mark_on
+            && (period >= (EXT_RTC_INTERP_FREQ - EXT_RTC_INTERP_TOL))
+            && (period <= (EXT_RTC_INTERP_FREQ + EXT_RTC_INTERP_TOL)))
+        {
+            ext_rtc_period = period;
+        }
+
+        ext_rtc_mark    = now;
+        ext_rtc_mark_on = true;
+    }
+
     ext_rtc_seconds++;
 
     if (ext_rtc_cb != NULL)
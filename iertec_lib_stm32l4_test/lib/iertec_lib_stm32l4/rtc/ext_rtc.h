@@ -9,6 +9,13 @@
 /**
  * @defgroup ext_rtc ext_rtc
  * @brief External RTC driver.
+ *
+ * The external RTC only gives a pulse each second. The time inside the second
+ * is interpolated with a free running clock set with @ref ext_rtc_set_clock,
+ * usually @ref itf_rtc_get_ticks. The clock ticks between the last two pulses
+ * are measured at each pulse, so the interpolation follows the frequency
+ * error between both oscillators. Without clock the fraction of the second is
+ * always 0.
  * @{
  */
 
@@ -23,9 +30,26 @@
 /** Frequency of the clock used by the RTC (Hz). */
 #define EXT_RTC_CLK_FREQ (1u)
 
+/** Nominal frequency of the clock used to interpolate the time inside the
+ * second (Hz). */
+#ifndef EXT_RTC_INTERP_FREQ
+#define EXT_RTC_INTERP_FREQ (32768u)
+#endif
+
+/** Maximum difference between a measured second and the nominal frequency,
+ * in clock ticks. The longer or shorter seconds, caused by a lost or a spurious
+ * pulse, are not used to interpolate. */
+#ifndef EXT_RTC_INTERP_TOL
+#define EXT_RTC_INTERP_TOL  (EXT_RTC_INTERP_FREQ / 64u)
+#endif
+
 /** @brief Function prototype for the callback called each second. */
 typedef void (* ext_rtc_cb_t)(void);
 
+/** @brief Free running clock used to interpolate the time inside the second.
+ * It returns a tick count that is allowed to wrap around. */
+typedef uint32_t (* ext_rtc_clock_t)(void);
+
 /** @brief External RTC hardware configuration type. */
 typedef struct
 {
@@ -56,6 +80,14 @@ void ext_rtc_set_time(uint32_t seconds, uint8_t cseconds);
  */
 void ext_rtc_get_time(uint32_t * seconds, uint8_t * cseconds);
 
+/**
+ * @brief Get the current time count with a sub-second fixed-point fraction.
+ *
+ * @param[out] seconds Seconds count.
+ * @param[out] fraction Fraction of the current second, in units of 2^-32 s.
+ */
+void ext_rtc_get_time_frac(uint32_t * seconds, uint32_t * fraction);
+
 /**
  * @brief Get the total number of ticks elapsed since the timer start.
  *
@@ -70,6 +102,14 @@ uint32_t ext_rtc_get_ticks(void);
  */
 void ext_rtc_set_callback(ext_rtc_cb_t cb);
 
+/**
+ * @brief Set the clock used to interpolate the time inside the second. The
+ * interpolation starts at the next pulse.
+ *
+ * @param[in] clock Clock function, or NULL to stop the interpolation.
+ */
+void ext_rtc_set_clock(ext_rtc_clock_t clock);
+
 #endif // EXT_RTC_H
 
 /** @} */
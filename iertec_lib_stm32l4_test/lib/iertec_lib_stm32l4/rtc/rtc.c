@@ -12,12 +12,17 @@
  */
 
 #include "rtc.h"
+#include "sys_util.h"
 
-#ifdef RTC_USE_EXT
+#if defined(RTC_USE_SYNC)
+#include "rtc_sync.h"
+#elif defined(RTC_USE_EXT)
 #include "ext_rtc.h"
 #else
 #include "itf_rtc.h"
-#endif // RTC_USE_EXT
+#endif // RTC_USE_SYNC
+
+#include <stddef.h>
 
 /****************************************************************************//*
  * Constants and macros
@@ -38,6 +43,9 @@
 /** Total years needed to reach a leap year. */
 #define YEARS_LEAP          (4)
 
+/** Number of years of the cycle of leap years of the Gregorian calendar. */
+#define YEARS_GREGORIAN     (400)
+
 /** Number of months in a year. */
 #define MONTHS_YEAR         (12)
 
@@ -47,12 +55,6 @@
 /** Number of minutes in a hour. */
 #define MINUTES_HOUR        (60)
 
-/** Number of seconds in a quadrennium (with its leap year). */
-#define SECONDS_QUADRENNIUM (126230400UL)
-
-/** Number of seconds in a non leap year. */
-#define SECONDS_YEAR        (31536000UL)
-
 /** Number of seconds in a day. */
 #define SECONDS_DAY         (86400UL)
 
@@ -65,50 +67,141 @@
 /** Number of centiseconds in a second. */
 #define CSECONDS_SECOND     (100)
 
-/** Number of days form the beginning of a non leap year until 00:00 of the
- * first day of "i" month (range 1 to 12). */
-static const uint32_t days_until_month_no_leap[] =
-{
-    0,      // Not used
-    0,      // January
-    31,
-    59,
-    90,
-    120,
-    151,
-    181,
-    212,
-    243,
-    273,
-    304,
-    334,    // December
-};
-
-/** Number of days form the beginning of a leap year until 00:00 of the first
- * day of "i" month (range 1 to 12). */
-static const uint32_t days_until_month_leap[] =
-{
-    0,      // Not used
-    0,      // January
-    31,
-    60,
-    91,
-    121,
-    152,
-    182,
-    213,
-    244,
-    274,
-    305,
-    335,    // December
-};
+/** Precision of the timestamps given to the disciplined clock (us). */
+#define PRECISION_SECONDS   (1000000u)
+#define PRECISION_CSECONDS  (10000u)
+
+/** Number of days from 1st March of YEAR_BASE - 1, the first day of the
+ * computational year that contains 1st January of YEAR_BASE, to 1st January of
+ * YEAR_BASE. */
+#define DAYS_MAR_TO_BASE    (306UL)
+
+/** Number of days of a common year, and of a quadrennium and a century of
+ * computational years starting at 1st March until their last leap day. */
+#define DAYS_YEAR           (365UL)
+#define DAYS_QUADRENNIUM    (1460UL)
+#define DAYS_CENTURY        (36524UL)
+
+/** Number of months from March to January in a computational year. */
+#define MONTHS_MAR_TO_JAN   (10)
+
+/** Fields of the cached calendar date, packed in a single word so it is read
+ * and written atomically: the day number since YEAR_BASE, the year in system
+ * format, the month and the day. */
+#define DATE_CACHE_DAYS_POS   (16u)
+#define DATE_CACHE_YEAR_POS   (9u)
+#define DATE_CACHE_MONTH_POS  (5u)
+#define DATE_CACHE_YEAR_MSK   (0x7Fu)
+#define DATE_CACHE_MONTH_MSK  (0x0Fu)
+#define DATE_CACHE_DAY_MSK    (0x1Fu)
+
+/** Invalid cached date, as its day number is beyond any timestamp. */
+#define DATE_CACHE_NONE       (UINT32_MAX)
+
+/** Number of days in a week. */
+#define DAYS_WEEK           (7)
+
+/** Day of the week of 1st January of YEAR_BASE, 0 is Sunday. */
+#define WDAY_BASE           (1)
+
+/** Julian day of 1st March in a time zone rule, where 29th February is never
+ * counted. */
+#define TZ_JULIAN_MAR       (60)
+
+/** Week of a time zone rule that is the last one of the month. */
+#define TZ_WEEK_LAST        (5)
+
+/** Maximum hours of the offset and of the rule time of a time zone. */
+#define TZ_OFFSET_HOURS_MAX (24)
+#define TZ_TIME_HOURS_MAX   (167)
+
+/** Minimum length of a time zone name. */
+#define TZ_NAME_LEN_MIN     (3)
+
+/** Default time of the time zone rules (s). */
+#define TZ_TIME_DEFAULT     (2 * SECONDS_HOUR)
+
+/** Default time zone rules if only the name of the daylight saving time is
+ * given. */
+#define TZ_RULES_DEFAULT    ",M3.2.0,M11.1.0"
+
+/****************************************************************************//*
+ * Private data types
+ ******************************************************************************/
+
+/** @brief Formats of the date of a time zone rule. */
+typedef enum
+{
+    RTC_TZ_RULE_MONTH,  /**< Day of the week of a week of a month. */
+    RTC_TZ_RULE_JULIAN, /**< Julian day [1, 365], without 29th February. */
+    RTC_TZ_RULE_DAY,    /**< Day of the year [0, 365]. */
+} rtc_tz_rule_type_t;
+
+/** @brief Transition of a time zone, to or from daylight saving time. */
+typedef struct
+{
+    /** Format of the date. */
+    rtc_tz_rule_type_t type;
+
+    /** Month [1, 12], week [1, 5] and day of the week [0, 6], 0 is Sunday. */
+    uint8_t month;
+    uint8_t week;
+    uint8_t wday;
+
+    /** Julian day or day of the year. */
+    uint16_t day;
+
+    /** Local time of the transition from 00:00 of the date (s). */
+    int32_t time;
+} rtc_tz_rule_t;
+
+/** @brief Time zone. */
+typedef struct
+{
+    /** The time zone is used instead of the fixed deviation from UTC. */
+    bool on;
+
+    /** The time zone has daylight saving time. */
+    bool dst_on;
+
+    /** Deviation from UTC of the standard and the daylight saving time (s). */
+    int32_t std_offset;
+    int32_t dst_offset;
+
+    /** Transitions to and from daylight saving time. */
+    rtc_tz_rule_t dst_start;
+    rtc_tz_rule_t dst_end;
+} rtc_tz_t;
+
+/** @brief Transitions of a time zone in a year, as UTC timestamps. */
+typedef struct
+{
+    /** Beginning and end of the year in standard time. */
+    int64_t first;
+    int64_t last;
+
+    /** Beginning and end of the daylight saving time. */
+    int64_t dst_start;
+    int64_t dst_end;
+} rtc_tz_year_t;
 
 /****************************************************************************//*
  * Private data
  ******************************************************************************/
 
-/** Difference between local time and GMT in hours. Range [-24, 24]. */
-static int8_t rtc_delta_hour = 0;
+/** Difference between local time and GMT in seconds, if no time zone is set.
+ * Range [-24, 24] hours. */
+static int32_t rtc_delta_offset = 0;
+
+/** Time zone. */
+static rtc_tz_t rtc_tz;
+
+/** Transitions of the time zone in the last year used. */
+static rtc_tz_year_t rtc_tz_year;
+
+/** Calendar date of the last converted day. The date only changes once a day,
+ * so the consecutive reads of the time only compute the time of the day. */
+static volatile uint32_t rtc_date_cache = DATE_CACHE_NONE;
 
 /****************************************************************************//*
  * Private code prototypes
@@ -145,6 +238,134 @@ static uint8_t rtc_calendar_to_system_year(uint8_t year);
 static void rtc_timestamp_to_datetime(datetime_t * datetime,
                                       uint32_t timestamp);
 
+/**
+ * @brief Convert a number of days from 1st January of YEAR_BASE to a calendar
+ * date with the year in system format. The conversion has a constant time, as
+ * the days are counted in computational years starting at 1st March, so the
+ * leap day is the last day of the year and the months follow a linear pattern.
+ *
+ * @param[out] datetime Date time where the date is stored.
+ * @param[in] days Number of days to convert.
+ */
+static void rtc_days_to_date(datetime_t * datetime, uint32_t days);
+
+/**
+ * @brief Convert a calendar date with the year in system format to a number of
+ * days from 1st January of YEAR_BASE. Inverse of @ref rtc_days_to_date.
+ *
+ * @param[in] datetime Date time with the date to convert.
+ *
+ * @return Number of days.
+ */
+static uint32_t rtc_date_to_days(const datetime_t * datetime);
+
+/**
+ * @brief Get the deviation from UTC of a date/time.
+ *
+ * @param[in] datetime Date/time.
+ *
+ * @return Deviation from UTC in seconds.
+ */
+static int32_t rtc_datetime_offset(const datetime_t * datetime);
+
+/**
+ * @brief Get the deviation from UTC of the local time at a timestamp, from the
+ * time zone if it is set, or the fixed one if not. The transitions of the time
+ * zone are computed when the year changes.
+ *
+ * @param[in] timestamp Timestamp.
+ * @param[in] fmt_local true: the timestamp is in local time;
+ *                      false: the timestamp is in UTC time.
+ *
+ * @return Deviation from UTC in seconds.
+ */
+static int32_t rtc_tz_get_offset(uint32_t timestamp, bool fmt_local);
+
+/**
+ * @brief Compute the transitions of the time zone in the year of a timestamp.
+ * It must be called inside a critical section.
+ *
+ * @param[in] timestamp Timestamp in UTC time.
+ */
+static void rtc_tz_set_year(int64_t timestamp);
+
+/**
+ * @brief Get the local time of a time zone rule in a year.
+ *
+ * @param[in] rule Time zone rule.
+ * @param[in] year Year in system format.
+ *
+ * @return Local time as number of seconds from 00:00:00 of 1st January of
+ * YEAR_BASE.
+ */
+static int64_t rtc_tz_rule_time(const rtc_tz_rule_t * rule, uint8_t year);
+
+/**
+ * @brief Parse a POSIX TZ string.
+ *
+ * @param[out] tz Parsed time zone.
+ * @param[in] str Time zone string.
+ *
+ * @retval true If the string is valid.
+ * @retval false If the string is not valid.
+ */
+static bool rtc_tz_parse(rtc_tz_t * tz, const char * str);
+
+/**
+ * @brief Parse the name of a time zone, alphabetic or quoted by "<>".
+ *
+ * @param[in] str String to parse.
+ *
+ * @return Next character to parse, NULL if the name is not valid.
+ */
+static const char * rtc_tz_parse_name(const char * str);
+
+/**
+ * @brief Parse a time zone rule, with its optional time.
+ *
+ * @param[in] str String to parse.
+ * @param[out] rule Parsed rule.
+ *
+ * @return Next character to parse, NULL if the rule is not valid.
+ */
+static const char * rtc_tz_parse_rule(const char * str, rtc_tz_rule_t * rule);
+
+/**
+ * @brief Parse a time with format [+|-]hh[:mm[:ss]].
+ *
+ * @param[in] str String to parse.
+ * @param[out] time Parsed time (s).
+ * @param[in] hours_max Maximum number of hours.
+ *
+ * @return Next character to parse, NULL if the time is not valid.
+ */
+static const char * rtc_tz_parse_time(const char * str, int32_t * time,
+                                      uint32_t hours_max);
+
+/**
+ * @brief Parse a decimal number.
+ *
+ * @param[in] str String to parse.
+ * @param[out] value Parsed number.
+ * @param[in] min Minimum value.
+ * @param[in] max Maximum value.
+ *
+ * @return Next character to parse, NULL if there is no number or it is out
+ * of range.
+ */
+static const char * rtc_tz_parse_num(const char * str, uint32_t * value,
+                                     uint32_t min, uint32_t max);
+
+/**
+ * @brief Check if a year is a leap year.
+ *
+ * @param[in] year Year in system format.
+ *
+ * @retval true If it is a leap year.
+ * @retval false If it is not a leap year.
+ */
+static bool rtc_is_leap_year(uint8_t year);
+
 /**
  * @brief Convert a datetime_t format with the year in system format to a
  * timestamp that consists in the number of seconds from 00:00:00 of 1st January
@@ -195,21 +416,45 @@ static void rtc_convert_datetime(datetime_t * datetime_out,
 void
 rtc_get_timestamp (uint32_t * timestamp, uint8_t * centiseconds)
 {
-#ifdef RTC_USE_EXT
+#if defined(RTC_USE_SYNC)
+    uint32_t fraction;
+
+    rtc_sync_get_time(timestamp, &fraction);
+    *centiseconds = (uint8_t)(((uint64_t)fraction * CSECONDS_SECOND) >> 32);
+#elif defined(RTC_USE_EXT)
     ext_rtc_get_time(timestamp, centiseconds);
 #else
     itf_rtc_get_time(timestamp, centiseconds);
-#endif // RTC_USE_EXT
+#endif // RTC_USE_SYNC
 }
 
 void
-rtc_get_epoch_timestamp (uint32_t * timestamp, uint8_t * centiseconds)
+rtc_get_timestamp_frac (uint32_t * timestamp, uint32_t * fraction)
 {
-#ifdef RTC_USE_EXT
-    ext_rtc_get_time(timestamp, centiseconds);
+#if defined(RTC_USE_SYNC)
+    rtc_sync_get_time(timestamp, fraction);
+#elif defined(RTC_USE_EXT)
+    ext_rtc_get_time_frac(timestamp, fraction);
 #else
-    itf_rtc_get_time(timestamp, centiseconds);
-#endif // RTC_USE_EXT
+    itf_rtc_get_time_frac(timestamp, fraction);
+#endif // RTC_USE_SYNC
+}
+
+void
+rtc_get_timestamp_sub (uint32_t * timestamp, uint32_t * subseconds,
+                       uint32_t resolution)
+{
+    uint32_t fraction;
+
+    rtc_get_timestamp_frac(timestamp, &fraction);
+
+    *subseconds = (uint32_t)(((uint64_t)fraction * resolution) >> 32);
+}
+
+void
+rtc_get_epoch_timestamp (uint32_t * timestamp, uint8_t * centiseconds)
+{
+    rtc_get_timestamp(timestamp, centiseconds);
 
     *timestamp += EPOCH_BASE_TIME;
 }
@@ -217,11 +462,13 @@ rtc_get_epoch_timestamp (uint32_t * timestamp, uint8_t * centiseconds)
 void
 rtc_set_timestamp (uint32_t timestamp)
 {
-#ifdef RTC_USE_EXT
+#if defined(RTC_USE_SYNC)
+    (void)rtc_sync_set_time(timestamp, 0, PRECISION_SECONDS);
+#elif defined(RTC_USE_EXT)
     ext_rtc_set_time(timestamp, 0);
 #else
     itf_rtc_set_time(timestamp, 0);
-#endif // RTC_USE_EXT
+#endif // RTC_USE_SYNC
 }
 
 bool
@@ -234,14 +481,25 @@ rtc_set_datetime (const datetime_t * datetime, bool fmt_local)
 
     if (rtc_is_date_ok(&dt) && rtc_is_time_ok(&dt))
     {
-        rtc_datetime_to_timestamp(&ts, &dt, fmt_local);
-        rtc_delta_hour = datetime->delta_hour;
+        rtc_delta_offset = rtc_datetime_offset(&dt);
+        rtc_datetime_to_timestamp(&ts, &dt, false);
 
-#ifdef RTC_USE_EXT
+        if (fmt_local)
+        {
+            // Subtract the deviation from UTC of the time zone, or the one just
+            // set if there is no time zone
+            ts -= rtc_tz_get_offset(ts, true);
+        }
+
+#if defined(RTC_USE_SYNC)
+        (void)rtc_sync_set_time(ts, (uint32_t)(((uint64_t)datetime->cseconds
+                                                << 32) / CSECONDS_SECOND),
+                                PRECISION_CSECONDS);
+#elif defined(RTC_USE_EXT)
         ext_rtc_set_time(ts, datetime->cseconds);
 #else
         itf_rtc_set_time(ts, datetime->cseconds);
-#endif // RTC_USE_EXT
+#endif // RTC_USE_SYNC
 
         return true;
     }
@@ -255,11 +513,38 @@ rtc_get_datetime (datetime_t * datetime)
     uint32_t ts;
     uint8_t  tcs;
 
+    int32_t  offset;
+
     rtc_get_timestamp(&ts, &tcs);
-    datetime->delta_hour = rtc_delta_hour;
+    offset                  = rtc_tz_get_offset(ts, false);
+    datetime->delta_hour    = offset / (int32_t)SECONDS_HOUR;
+    datetime->delta_minutes = (offset % (int32_t)SECONDS_HOUR)
+                              / (int32_t)SECONDS_MINUTE;
     rtc_timestamp_to_datetime(datetime, ts);
-    datetime->year       = rtc_system_to_calendar_year(datetime->year);
-    datetime->cseconds   = tcs;
+    datetime->year          = rtc_system_to_calendar_year(datetime->year);
+    datetime->cseconds      = tcs;
+}
+
+bool
+rtc_set_tz (const char * tz)
+{
+    rtc_tz_t tz_new = {0};
+
+    if ((NULL != tz) && ('\0' != *tz) && !rtc_tz_parse(&tz_new, tz))
+    {
+        return false;
+    }
+
+    tz_new.on = (NULL != tz) && ('\0' != *tz);
+
+    // The transitions are computed again on the next conversion
+    SYS_ENTER_CRITICAL();
+    rtc_tz            = tz_new;
+    rtc_tz_year.first = 0;
+    rtc_tz_year.last  = 0;
+    SYS_EXIT_CRITICAL();
+
+    return true;
 }
 
 int64_t
@@ -318,53 +603,37 @@ rtc_calendar_to_system_year (uint8_t year)
 static void
 rtc_timestamp_to_datetime (datetime_t * datetime, uint32_t timestamp)
 {
-    uint32_t         day_julian;
-    uint32_t         year_quadrennium;
-    uint32_t         i;
-    const uint32_t * days_until_month;
+    uint32_t days;
+    uint32_t cache;
 
-    // Add the delta hour to set local time from UTC timestamp
-    timestamp += (int32_t)datetime->delta_hour * SECONDS_HOUR;
+    // Add the deviation from UTC to set local time from UTC timestamp
+    timestamp += rtc_datetime_offset(datetime);
 
-    // Get the number of complete quadrenniums (with its leap year) and remove
-    // them from the timestamp
-    datetime->year = (timestamp / SECONDS_QUADRENNIUM) * 4;
-    timestamp     %= SECONDS_QUADRENNIUM;
+    // The date is only converted when the day changes
+    days  = timestamp / SECONDS_DAY;
+    cache = rtc_date_cache;
 
-    // Get the rest of years that does not constitute a quadrennium. There is an
-    // abnormality with the 31th of December of the last year, because it is
-    // always leap. It will belong to the next year when dividing by
-    // SECONDS_YEAR, giving the abnormal result of 4. The abnormality is
-    // corrected here and the leap year will be taken into account later.
-    year_quadrennium = timestamp / SECONDS_YEAR;
+    if ((cache >> DATE_CACHE_DAYS_POS) != days)
+    {
+        rtc_days_to_date(datetime, days);
 
-    if (year_quadrennium == 4)
+        cache          = (days << DATE_CACHE_DAYS_POS)
+                         | ((uint32_t)datetime->year << DATE_CACHE_YEAR_POS)
+                         | ((uint32_t)datetime->month << DATE_CACHE_MONTH_POS)
+                         | (uint32_t)datetime->day;
+        rtc_date_cache = cache;
+    }
+    else
     {
-        year_quadrennium = 3;
+        datetime->year  = (cache >> DATE_CACHE_YEAR_POS) & DATE_CACHE_YEAR_MSK;
+        datetime->month = (cache >> DATE_CACHE_MONTH_POS)
+                          & DATE_CACHE_MONTH_MSK;
+        datetime->day   = cache & DATE_CACHE_DAY_MSK;
     }
 
-    // Add the number of additional years and remove them from the timestamp
-    datetime->year += year_quadrennium;
-    timestamp      -= year_quadrennium * SECONDS_YEAR;
-
-    // Select the correct days until month table
-    days_until_month = (datetime->year % 4 == 3)
-                       ? days_until_month_leap : days_until_month_no_leap;
-
-    // The remaining timestamp contains the number of seconds from the beginning
-    // of the current year. Get the Julian day and remove it from the timestamp.
     // The remaining timestamp contains the number of seconds of the current day
-    day_julian = timestamp / SECONDS_DAY + 1;
     timestamp %= SECONDS_DAY;
 
-    for (i = MONTHS_YEAR; day_julian <= days_until_month[i]; i--)
-    {
-        // Get the month through the Julian day
-    }
-
-    // Fill the remaining datetime structure
-    datetime->month   = i;
-    datetime->day     = day_julian - days_until_month[i];
     datetime->hour    = timestamp / SECONDS_HOUR;
     datetime->minutes = (timestamp % SECONDS_HOUR) / SECONDS_MINUTE;
     datetime->seconds = timestamp % SECONDS_MINUTE;
@@ -374,34 +643,379 @@ static void
 rtc_datetime_to_timestamp (uint32_t * timestamp, const datetime_t * datetime,
                            bool fmt_local)
 {
-    const uint32_t * days_until_month;
+    // Count the number of seconds of all previous days and of the current day
+    *timestamp = rtc_date_to_days(datetime) * SECONDS_DAY
+                 + (uint32_t)datetime->hour * SECONDS_HOUR
+                 + (uint32_t)datetime->minutes * SECONDS_MINUTE
+                 + (uint32_t)datetime->seconds;
+
+    if (fmt_local)
+    {
+        // Subtract the deviation from UTC to set UTC timestamp from local time
+        *timestamp -= rtc_datetime_offset(datetime);
+    }
+}
+
+static void
+rtc_days_to_date (datetime_t * datetime, uint32_t days)
+{
+    uint32_t day_era;
+    uint32_t year_era;
+    uint32_t day_year;
+    uint32_t month_mar;
+    uint32_t is_jan_feb;
+
+    // Days from 1st March of YEAR_BASE - 1. It is the beginning of the 400
+    // years cycle of the Gregorian calendar, and the timestamps never reach the
+    // next one
+    day_era = days + DAYS_MAR_TO_BASE;
+
+    // Years of the cycle, removing the leap days of the quadrenniums and adding
+    // the ones skipped in the centuries
+    year_era = (day_era - (day_era / DAYS_QUADRENNIUM)
+                + (day_era / DAYS_CENTURY)) / DAYS_YEAR;
+    day_year = day_era - ((year_era * DAYS_YEAR) + (year_era / YEARS_LEAP)
+                          - (year_era / YEARS_2_DIGIT));
+
+    // The months from March have 153 days each 5 months, and January and
+    // February belong to the next calendar year
+    month_mar  = ((5u * day_year) + 2u) / 153u;
+    is_jan_feb = month_mar / MONTHS_MAR_TO_JAN;
+
+    datetime->year  = year_era + is_jan_feb - 1u;
+    datetime->month = month_mar + 3u - (is_jan_feb * MONTHS_YEAR);
+    datetime->day   = day_year - (((153u * month_mar) + 2u) / 5u) + 1u;
+}
 
-    // Count the number of seconds of all previous years and the additional
-    // seconds of each previous leap year
-    *timestamp = (uint32_t)datetime->year * SECONDS_YEAR
-                 + (uint32_t)(datetime->year >> 2) * SECONDS_DAY;
+static uint32_t
+rtc_date_to_days (const datetime_t * datetime)
+{
+    uint32_t month_mar;
+    uint32_t year_era;
+    uint32_t day_era;
+
+    // Inverse steps of rtc_days_to_date
+    month_mar = ((uint32_t)datetime->month + MONTHS_YEAR - 3u) % MONTHS_YEAR;
+    year_era  = (uint32_t)datetime->year + 1u
+                - (month_mar / MONTHS_MAR_TO_JAN);
+    day_era   = (year_era * DAYS_YEAR) + (year_era / YEARS_LEAP)
+                - (year_era / YEARS_2_DIGIT)
+                + (((153u * month_mar) + 2u) / 5u) + datetime->day - 1u;
+
+    return day_era - DAYS_MAR_TO_BASE;
+}
 
-    // Select the correct days until month table
-    days_until_month = (datetime->year % 4 == 3)
-                       ? days_until_month_leap : days_until_month_no_leap;
+static int32_t
+rtc_datetime_offset (const datetime_t * datetime)
+{
+    return ((int32_t)datetime->delta_hour * (int32_t)SECONDS_HOUR)
+           + ((int32_t)datetime->delta_minutes * (int32_t)SECONDS_MINUTE);
+}
 
-    // Add the number of seconds of all days of the previous months of the
-    // current year
-    *timestamp += days_until_month[datetime->month] * SECONDS_DAY;
+static int32_t
+rtc_tz_get_offset (uint32_t timestamp, bool fmt_local)
+{
+    int64_t utc = timestamp;
+    int32_t offset;
 
-    // Add the number of seconds of all the previous days of the current month
-    *timestamp += (datetime->day - 1) * SECONDS_DAY;
+    SYS_ENTER_CRITICAL();
 
-    // Add the number of seconds of the current day
-    *timestamp += (uint32_t)datetime->hour * SECONDS_HOUR
-                  + (uint32_t)datetime->minutes * SECONDS_MINUTE
-                  + (uint32_t)datetime->seconds;
+    if (!rtc_tz.on)
+    {
+        offset = rtc_delta_offset;
+    }
+    else if (!rtc_tz.dst_on)
+    {
+        offset = rtc_tz.std_offset;
+    }
+    else
+    {
+        if (fmt_local)
+        {
+            // Taking the larger deviation, the skipped local times are moved
+            // after the transition and the repeated ones are taken before it
+            utc -= (rtc_tz.dst_offset > rtc_tz.std_offset)
+                   ? rtc_tz.dst_offset : rtc_tz.std_offset;
+        }
 
-    if (fmt_local)
+        if ((utc < rtc_tz_year.first) || (utc >= rtc_tz_year.last))
+        {
+            rtc_tz_set_year(utc);
+        }
+
+        // The daylight saving time wraps around the end of the year in the
+        // southern hemisphere
+        if (rtc_tz_year.dst_start < rtc_tz_year.dst_end)
+        {
+            offset = ((utc >= rtc_tz_year.dst_start)
+                      && (utc < rtc_tz_year.dst_end))
+                     ? rtc_tz.dst_offset : rtc_tz.std_offset;
+        }
+        else
+        {
+            offset = ((utc >= rtc_tz_year.dst_start)
+                      || (utc < rtc_tz_year.dst_end))
+                     ? rtc_tz.dst_offset : rtc_tz.std_offset;
+        }
+    }
+
+    SYS_EXIT_CRITICAL();
+
+    return offset;
+}
+
+static void
+rtc_tz_set_year (int64_t timestamp)
+{
+    int64_t    local = timestamp + rtc_tz.std_offset;
+    datetime_t date;
+
+    rtc_days_to_date(&date, (local > 0) ? (uint32_t)(local / SECONDS_DAY) : 0);
+    date.month = 1;
+    date.day   = 1;
+
+    // The start is given in standard time and the end in daylight saving time
+    rtc_tz_year.first     = ((int64_t)rtc_date_to_days(&date) * SECONDS_DAY)
+                            - rtc_tz.std_offset;
+    rtc_tz_year.dst_start = rtc_tz_rule_time(&rtc_tz.dst_start, date.year)
+                            - rtc_tz.std_offset;
+    rtc_tz_year.dst_end   = rtc_tz_rule_time(&rtc_tz.dst_end, date.year)
+                            - rtc_tz.dst_offset;
+    date.year++;
+    rtc_tz_year.last      = ((int64_t)rtc_date_to_days(&date) * SECONDS_DAY)
+                            - rtc_tz.std_offset;
+}
+
+static int64_t
+rtc_tz_rule_time (const rtc_tz_rule_t * rule, uint8_t year)
+{
+    datetime_t date = {.year = year, .month = 1, .day = 1};
+    uint32_t   days = rtc_date_to_days(&date);
+
+    if (RTC_TZ_RULE_MONTH == rule->type)
+    {
+        uint32_t days_next;
+
+        date.month = rule->month;
+        days       = rtc_date_to_days(&date);
+
+        // First day of the next month
+        date.year  += rule->month / MONTHS_YEAR;
+        date.month  = (rule->month % MONTHS_YEAR) + 1u;
+        days_next   = rtc_date_to_days(&date);
+
+        // First day of the week in the month, and then the week
+        days += (rule->wday + DAYS_WEEK - ((days + WDAY_BASE) % DAYS_WEEK))
+                % DAYS_WEEK;
+        days += (rule->week - 1u) * DAYS_WEEK;
+
+        // The fifth week is the last one, that can be the fourth
+        if (days >= days_next)
+        {
+            days -= DAYS_WEEK;
+        }
+    }
+    else if (RTC_TZ_RULE_JULIAN == rule->type)
+    {
+        days += rule->day - 1u;
+
+        if ((rule->day >= TZ_JULIAN_MAR) && rtc_is_leap_year(year))
+        {
+            days++;
+        }
+    }
+    else
+    {
+        days += rule->day;
+    }
+
+    return ((int64_t)days * SECONDS_DAY) + rule->time;
+}
+
+static bool
+rtc_tz_parse (rtc_tz_t * tz, const char * str)
+{
+    int32_t offset;
+
+    // Standard time, with the POSIX sign of the offset, positive to the west
+    str = rtc_tz_parse_name(str);
+    str = (NULL != str)
+          ? rtc_tz_parse_time(str, &offset, TZ_OFFSET_HOURS_MAX) : NULL;
+
+    if (NULL == str)
     {
-        // Subtract the delta hour to set UTC timestamp from local time
-        *timestamp -= (int32_t)datetime->delta_hour * SECONDS_HOUR;
+        return false;
     }
+
+    tz->std_offset = -offset;
+    tz->dst_offset = tz->std_offset + (int32_t)SECONDS_HOUR;
+    tz->dst_on     = ('\0' != *str);
+
+    if (!tz->dst_on)
+    {
+        return true;
+    }
+
+    // Daylight saving time, one hour ahead if no offset is given
+    str = rtc_tz_parse_name(str);
+
+    if ((NULL != str) && (',' != *str) && ('\0' != *str))
+    {
+        str            = rtc_tz_parse_time(str, &offset, TZ_OFFSET_HOURS_MAX);
+        tz->dst_offset = -offset;
+    }
+
+    if ((NULL != str) && ('\0' == *str))
+    {
+        str = TZ_RULES_DEFAULT;
+    }
+
+    if ((NULL == str) || (',' != *str))
+    {
+        return false;
+    }
+
+    str = rtc_tz_parse_rule(str + 1, &tz->dst_start);
+
+    if ((NULL == str) || (',' != *str))
+    {
+        return false;
+    }
+
+    str = rtc_tz_parse_rule(str + 1, &tz->dst_end);
+
+    return (NULL != str) && ('\0' == *str);
+}
+
+static const char *
+rtc_tz_parse_name (const char * str)
+{
+    const char * start;
+
+    if ('<' == *str)
+    {
+        start = ++str;
+
+        for (; (('A' <= *str) && (*str <= 'Z'))
+               || (('a' <= *str) && (*str <= 'z'))
+               || (('0' <= *str) && (*str <= '9'))
+               || ('+' == *str) || ('-' == *str); str++)
+        {
+            // Alphanumeric name with sign
+        }
+
+        if ('>' != *str)
+        {
+            return NULL;
+        }
+
+        return ((str - start) >= TZ_NAME_LEN_MIN) ? (str + 1) : NULL;
+    }
+
+    start = str;
+
+    for (; (('A' <= *str) && (*str <= 'Z'))
+           || (('a' <= *str) && (*str <= 'z')); str++)
+    {
+        // Alphabetic name
+    }
+
+    return ((str - start) >= TZ_NAME_LEN_MIN) ? str : NULL;
+}
+
+static const char *
+rtc_tz_parse_rule (const char * str, rtc_tz_rule_t * rule)
+{
+    uint32_t value;
+
+    if ('M' == *str)
+    {
+        rule->type  = RTC_TZ_RULE_MONTH;
+        str         = rtc_tz_parse_num(str + 1, &value, 1, MONTHS_YEAR);
+        rule->month = (uint8_t)value;
+        str         = ((NULL != str) && ('.' == *str))
+                      ? rtc_tz_parse_num(str + 1, &value, 1, TZ_WEEK_LAST)
+                      : NULL;
+        rule->week  = (uint8_t)value;
+        str         = ((NULL != str) && ('.' == *str))
+                      ? rtc_tz_parse_num(str + 1, &value, 0, DAYS_WEEK - 1)
+                      : NULL;
+        rule->wday  = (uint8_t)value;
+    }
+    else if ('J' == *str)
+    {
+        rule->type = RTC_TZ_RULE_JULIAN;
+        str        = rtc_tz_parse_num(str + 1, &value, 1, DAYS_YEAR);
+        rule->day  = (uint16_t)value;
+    }
+    else
+    {
+        rule->type = RTC_TZ_RULE_DAY;
+        str        = rtc_tz_parse_num(str, &value, 0, DAYS_YEAR);
+        rule->day  = (uint16_t)value;
+    }
+
+    rule->time = TZ_TIME_DEFAULT;
+
+    if ((NULL != str) && ('/' == *str))
+    {
+        str = rtc_tz_parse_time(str + 1, &rule->time, TZ_TIME_HOURS_MAX);
+    }
+
+    return str;
+}
+
+static const char *
+rtc_tz_parse_time (const char * str, int32_t * time, uint32_t hours_max)
+{
+    bool     negative = ('-' == *str);
+    uint32_t value;
+
+    if (('+' == *str) || ('-' == *str))
+    {
+        str++;
+    }
+
+    str   = rtc_tz_parse_num(str, &value, 0, hours_max);
+    *time = (int32_t)(value * SECONDS_HOUR);
+
+    // Optional minutes and seconds
+    for (uint32_t unit = SECONDS_MINUTE; (NULL != str) && (':' == *str)
+         && (unit > 0u); unit /= SECONDS_MINUTE)
+    {
+        str    = rtc_tz_parse_num(str + 1, &value, 0, MINUTES_HOUR - 1);
+        *time += (int32_t)(value * unit);
+    }
+
+    *time = negative ? -*time : *time;
+
+    return str;
+}
+
+static const char *
+rtc_tz_parse_num (const char * str, uint32_t * value, uint32_t min,
+                  uint32_t max)
+{
+    const char * start = str;
+
+    *value = 0;
+
+    for (; ('0' <= *str) && (*str <= '9') && (*value <= max); str++)
+    {
+        *value = (*value * 10u) + (uint32_t)(*str - '0');
+    }
+
+    return ((str != start) && (*value >= min) && (*value <= max)) ? str : NULL;
+}
+
+static bool
+rtc_is_leap_year (uint8_t year)
+{
+    uint32_t year_cal = (uint32_t)year + YEAR_BASE;
+
+    return ((year_cal % YEARS_LEAP) == 0)
+           && (((year_cal % YEARS_2_DIGIT) != 0)
+               || ((year_cal % YEARS_GREGORIAN) == 0));
 }
 
 static bool
@@ -431,7 +1045,7 @@ rtc_is_date_ok (const datetime_t * datetime)
           && ((datetime->day <= month_days[datetime->month - 1])
               || ((datetime->month == MONTH_FEB)
                   && (datetime->day == MONTH_FEB_LEAP_DAYS)
-                  && (datetime->year % YEARS_LEAP == YEARS_LEAP - 1)));
+                  && rtc_is_leap_year(datetime->year)));
 
     return ret;
 }
@@ -446,7 +1060,9 @@ rtc_is_time_ok (const datetime_t * datetime)
           && (datetime->seconds < SECONDS_MINUTE)
           && (datetime->cseconds < CSECONDS_SECOND)
           && (datetime->delta_hour >= -HOURS_DAY)
-          && (datetime->delta_hour <= HOURS_DAY);
+          && (datetime->delta_hour <= HOURS_DAY)
+          && (datetime->delta_minutes > -MINUTES_HOUR)
+          && (datetime->delta_minutes < MINUTES_HOUR);
 
     return ret;
 }
@@ -461,7 +1077,8 @@ rtc_convert_datetime (datetime_t * datetime_out, const datetime_t * datetime_in)
     datetime_out->minutes    = datetime_in->minutes;
     datetime_out->seconds    = datetime_in->seconds;
     datetime_out->cseconds   = datetime_in->cseconds;
-    datetime_out->delta_hour = datetime_in->delta_hour;
+    datetime_out->delta_hour    = datetime_in->delta_hour;
+    datetime_out->delta_minutes = datetime_in->delta_minutes;
 }
 
 /** @} */
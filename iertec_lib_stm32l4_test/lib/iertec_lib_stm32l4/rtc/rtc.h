@@ -9,6 +9,21 @@
 /**
  * @defgroup rtc rtc
  * @brief Real time clock and calendar.
+ *
+ * The time is kept by @ref itf_rtc, by @ref ext_rtc if RTC_USE_EXT is defined,
+ * or by @ref rtc_sync if RTC_USE_SYNC is defined. With the last one, setting
+ * the time gives a synchronization point to the disciplined clock, which
+ * slews the small offsets instead of stepping the time. The disciplined clock
+ * must be initialized with @ref rtc_sync_init before the time is used, which
+ * @ref itf_bsp_init does on @ref itf_rtc_get_ticks64.
+ *
+ * The local time is given by a fixed deviation from UTC, set with
+ * @ref rtc_set_datetime, or by a time zone with daylight saving time rules, set
+ * with @ref rtc_set_tz. The transitions of the time zone are computed once a
+ * year, so the conversions have a constant time.
+ *
+ * The date of the last day read is cached, so the consecutive reads of the
+ * date/time, as the ones of the log lines, only compute the time of the day.
  * @{
  */
 
@@ -27,6 +42,12 @@
  * 00:00:00). */
 #define EPOCH_BASE_TIME ((uint32_t)978307200)
 
+/** Sub-second resolution of milliseconds, see @ref rtc_get_timestamp_sub. */
+#define RTC_RES_MSEC    (1000u)
+
+/** Sub-second resolution of microseconds, see @ref rtc_get_timestamp_sub. */
+#define RTC_RES_USEC    (1000000u)
+
 /**
  * @brief Get the system timestamp that consists in the number of seconds from
  * 00:00:00 of 1st January of YEAR_BASE.
@@ -36,6 +57,27 @@
  */
 void rtc_get_timestamp(uint32_t * timestamp, uint8_t * centiseconds);
 
+/**
+ * @brief Get the system timestamp with a sub-second fixed-point fraction.
+ *
+ * @param[out] timestamp Current timestamp value.
+ * @param[out] fraction Fraction of the current second, in units of 2^-32 s.
+ */
+void rtc_get_timestamp_frac(uint32_t * timestamp, uint32_t * fraction);
+
+/**
+ * @brief Get the system timestamp with the sub-seconds in the given
+ * resolution. The sub-seconds are truncated, so they are always lower than
+ * the resolution.
+ *
+ * @param[out] timestamp Current timestamp value.
+ * @param[out] subseconds Sub-seconds of the current timestamp.
+ * @param[in] resolution Number of sub-seconds in a second, e.g.
+ * @ref RTC_RES_MSEC.
+ */
+void rtc_get_timestamp_sub(uint32_t * timestamp, uint32_t * subseconds,
+                           uint32_t resolution);
+
 /**
  * @brief Get the epoch timestamp that consists in the number of seconds from
  * 00:00:00 of 1st January of 1970.
@@ -54,7 +96,14 @@ void rtc_get_epoch_timestamp(uint32_t * timestamp, uint8_t * centiseconds);
 void rtc_set_timestamp(uint32_t timestamp);
 
 /**
- * @brief Set the current date/time of the system.
+ * @brief Set the current date/time of the system. If no time zone is set with
+ * @ref rtc_set_tz, the deviation from UTC of the date/time is kept for the
+ * local time.
+ *
+ * If a time zone is set, the deviation from UTC of the date/time is ignored,
+ * and a local time is converted with the time zone. A local time skipped by a
+ * transition is taken as the one after the transition, and a repeated local
+ * time as its first occurrence.
  *
  * @param[in] datetime Pointer to date/time to set.
  * @param[in] fmt_local true: input format is local time plus time zone;
@@ -66,12 +115,27 @@ void rtc_set_timestamp(uint32_t timestamp);
 bool rtc_set_datetime(const datetime_t * datetime, bool fmt_local);
 
 /**
- * @brief Get the current date/time of the system.
+ * @brief Get the current date/time of the system, in local time with its
+ * deviation from UTC.
  *
  * @param[out] datetime Pointer where to store the current date/time.
  */
 void rtc_get_datetime(datetime_t * datetime);
 
+/**
+ * @brief Set the time zone of the local time, as a POSIX TZ string, e.g.
+ * "CET-1CEST,M3.5.0,M10.5.0/3" or "<+0530>-5:30". The names are not used. If a
+ * daylight saving time name is given without rules, the rules are
+ * "M3.2.0,M11.1.0".
+ *
+ * @param[in] tz Time zone string. NULL or empty to use the fixed deviation
+ * from UTC of @ref rtc_set_datetime.
+ *
+ * @retval true If the time zone is set.
+ * @retval false If the string is not valid. The time zone is not changed.
+ */
+bool rtc_set_tz(const char * tz);
+
 /**
  * @brief Compare 2 dates.
  *
@@ -0,0 +1,367 @@
+/*******************************************************************************
+ * @file rtc_sync.c
+ * @author juanmanuel.fernandez@iertec.com
+ * @date 19 Oct 2026
+ * @brief Disciplined clock synchronized with an external time source.
+ * @ingroup rtc_sync
+ ******************************************************************************/
+
+/**
+ * @addtogroup rtc_sync
+ * @{
+ */
+
+#include "rtc_sync.h"
+#include "sys_util.h"
+#include "debug_util.h"
+
+#include <stddef.h>
+
+/****************************************************************************//*
+ * Constants and macros
+ ******************************************************************************/
+
+/** One second in the fixed-point format of the times and the rates. */
+#define RTC_SYNC_ONE            ((int64_t)1 << 32)
+
+/** Convert a rate from ppm to the fixed-point format. */
+#define RTC_SYNC_PPM(X)         ((int64_t)(X) * RTC_SYNC_ONE / 1000000)
+
+/** Maximum number of ticks between the reference point and the current tick
+ * count, so the time computation does not overflow. */
+#define RTC_SYNC_REBASE_TICKS   ((uint64_t)1 << 30)
+
+/****************************************************************************//*
+ * Private data
+ ******************************************************************************/
+
+/** Tick clock. */
+static rtc_sync_clock_t rtc_sync_clock;
+
+/** Tick count of the reference point. */
+static uint64_t rtc_sync_ref_ticks;
+
+/** Time at the reference point. The times are given in units of 2^-32 s. */
+static uint64_t rtc_sync_ref_time;
+
+/** Frequency error of the tick clock, in units of 2^-32. */
+static int32_t rtc_sync_freq;
+
+/** Bound of the frequency error estimation, in units of 2^-32. */
+static uint32_t rtc_sync_freq_err;
+
+/** The frequency error has been estimated. */
+static bool rtc_sync_freq_on;
+
+/** Slew rate in use, in units of 2^-32, 0 if no offset is being slewed. */
+static int32_t rtc_sync_slew;
+
+/** Ticks from the reference point until the end of the slew. */
+static uint64_t rtc_sync_slew_ticks;
+
+/** The time has been synchronized. */
+static bool rtc_sync_synced;
+
+/** Synchronization point used to estimate the frequency error. */
+static uint64_t rtc_sync_anchor_ticks;
+static uint64_t rtc_sync_anchor_time;
+static uint32_t rtc_sync_anchor_prec;
+
+/** Tick count and precision in us of the last synchronization point. */
+static uint64_t rtc_sync_last_ticks;
+static uint32_t rtc_sync_last_prec;
+
+/****************************************************************************//*
+ * Private code prototypes
+ ******************************************************************************/
+
+/**
+ * @brief Compute the time at a tick count. The reference point is moved
+ * forward at the end of the slew and when the tick count is too far from it.
+ * It must be called inside a critical section.
+ *
+ * @param[in] ticks Tick count, not before the reference point.
+ *
+ * @return Time at the tick count.
+ */
+static uint64_t rtc_sync_advance(uint64_t ticks);
+
+/**
+ * @brief Convert a number of ticks to time at the nominal frequency.
+ *
+ * @param[in] ticks Number of ticks.
+ *
+ * @return Time of the ticks.
+ */
+static uint64_t rtc_sync_ticks_to_time(uint64_t ticks);
+
+/**
+ * @brief Update the frequency error estimation with a new synchronization
+ * point. It must be called inside a critical section.
+ *
+ * @param[in] ticks Tick count of the synchronization point.
+ * @param[in] time Source time of the synchronization point.
+ * @param[in] precision_usec Maximum error of the source time in us.
+ */
+static void rtc_sync_estimate(uint64_t ticks, uint64_t time,
+                              uint32_t precision_usec);
+
+/****************************************************************************//*
+ * Public code
+ ******************************************************************************/
+
+void
+rtc_sync_init (rtc_sync_clock_t clock)
+{
+    DEBUG_ASSERT(clock != NULL);
+
+    SYS_ENTER_CRITICAL();
+
+    rtc_sync_clock      = clock;
+    rtc_sync_ref_ticks  = clock();
+    rtc_sync_ref_time   = 0u;
+    rtc_sync_freq       = 0;
+    rtc_sync_freq_err   = 0u;
+    rtc_sync_freq_on    = false;
+    rtc_sync_slew       = 0;
+    rtc_sync_slew_ticks = 0u;
+    rtc_sync_synced     = false;
+
+    SYS_EXIT_CRITICAL();
+}
+
+bool
+rtc_sync_set_time (uint32_t timestamp, uint32_t fraction,
+                   uint32_t precision_usec)
+{
+    uint64_t time    = ((uint64_t)timestamp << 32) | fraction;
+    bool     stepped = false;
+    uint64_t ticks;
+    int64_t  offset;
+
+    // Check that the module has been initialized
+    DEBUG_ASSERT(rtc_sync_clock != NULL);
+
+    SYS_ENTER_CRITICAL();
+
+    // The previous slew is replaced, as the new offset includes what is left
+    ticks               = rtc_sync_clock();
+    rtc_sync_ref_time   = rtc_sync_advance(ticks);
+    rtc_sync_ref_ticks  = ticks;
+    rtc_sync_slew       = 0;
+    rtc_sync_slew_ticks = 0u;
+    offset              = (int64_t)(time - rtc_sync_ref_time);
+
+    rtc_sync_estimate(ticks, time, precision_usec);
+
+    if (!rtc_sync_synced
+        || (offset >= ((int64_t)RTC_SYNC_STEP_MSEC * RTC_SYNC_ONE / 1000))
+        || (offset <= -((int64_t)RTC_SYNC_STEP_MSEC * RTC_SYNC_ONE / 1000)))
+    {
+        rtc_sync_ref_time = time;
+        stepped           = true;
+    }
+    else
+    {
+        uint64_t abs_offset = (offset < 0) ? (uint64_t)-offset
+                                           : (uint64_t)offset;
+
+        // The offsets shorter than a tick of slew are negligible
+        rtc_sync_slew_ticks = abs_offset * RTC_SYNC_CLK_FREQ
+                              / (uint64_t)RTC_SYNC_PPM(RTC_SYNC_SLEW_PPM);
+
+        if (rtc_sync_slew_ticks > 0u)
+        {
+            rtc_sync_slew = (int32_t)RTC_SYNC_PPM(RTC_SYNC_SLEW_PPM);
+            rtc_sync_slew = (offset < 0) ? -rtc_sync_slew : rtc_sync_slew;
+        }
+    }
+
+    rtc_sync_synced     = true;
+    rtc_sync_last_ticks = ticks;
+    rtc_sync_last_prec  = precision_usec;
+
+    SYS_EXIT_CRITICAL();
+
+    return stepped;
+}
+
+void
+rtc_sync_get_time (uint32_t * timestamp, uint32_t * fraction)
+{
+    uint64_t time;
+
+    // Check that the module has been initialized
+    DEBUG_ASSERT(rtc_sync_clock != NULL);
+
+    SYS_ENTER_CRITICAL();
+    time = rtc_sync_advance(rtc_sync_clock());
+    SYS_EXIT_CRITICAL();
+
+    *timestamp = (uint32_t)(time >> 32);
+    *fraction  = (uint32_t)time;
+}
+
+int32_t
+rtc_sync_get_freq (void)
+{
+    return (int32_t)((int64_t)rtc_sync_freq * 1000000000 / RTC_SYNC_ONE);
+}
+
+uint32_t
+rtc_sync_get_error (void)
+{
+    uint64_t error = UINT32_MAX;
+
+    SYS_ENTER_CRITICAL();
+
+    if (rtc_sync_synced)
+    {
+        uint64_t ticks     = rtc_sync_clock();
+        uint64_t freq_err  = rtc_sync_freq_on
+                             ? rtc_sync_freq_err
+                             : (uint64_t)RTC_SYNC_PPM(RTC_SYNC_FREQ_MAX_PPM);
+        uint64_t slew_left = 0u;
+
+        (void)rtc_sync_advance(ticks);
+
+        if (0 != rtc_sync_slew)
+        {
+            slew_left = (rtc_sync_slew_ticks - (ticks - rtc_sync_ref_ticks))
+                        * (uint64_t)RTC_SYNC_PPM(RTC_SYNC_SLEW_PPM)
+                        / RTC_SYNC_CLK_FREQ;
+        }
+
+        // Drift since the last point plus the offset not corrected yet. The
+        // time is converted to us in two steps, so it does not overflow
+        error = ((ticks - rtc_sync_last_ticks) * freq_err / RTC_SYNC_CLK_FREQ)
+                + slew_left;
+        error = (((error >> 12) * 1000000u) >> 20) + rtc_sync_last_prec;
+
+        if (error > UINT32_MAX)
+        {
+            error = UINT32_MAX;
+        }
+    }
+
+    SYS_EXIT_CRITICAL();
+
+    return (uint32_t)error;
+}
+
+/****************************************************************************//*
+ * Private code
+ ******************************************************************************/
+
+static uint64_t
+rtc_sync_advance (uint64_t ticks)
+{
+    uint64_t slope = (uint64_t)(RTC_SYNC_ONE + rtc_sync_freq + rtc_sync_slew);
+    uint64_t elapsed;
+
+    for (;;)
+    {
+        uint64_t step;
+
+        elapsed = ticks - rtc_sync_ref_ticks;
+
+        // The slope changes at the end of the slew, so the time is continuous
+        if ((0 != rtc_sync_slew) && (elapsed >= rtc_sync_slew_ticks))
+        {
+            step = rtc_sync_slew_ticks;
+        }
+        else if (elapsed > RTC_SYNC_REBASE_TICKS)
+        {
+            step = RTC_SYNC_REBASE_TICKS;
+        }
+        else
+        {
+            break;
+        }
+
+        rtc_sync_ref_time  += step * slope / RTC_SYNC_CLK_FREQ;
+        rtc_sync_ref_ticks += step;
+
+        if (0 != rtc_sync_slew)
+        {
+            rtc_sync_slew_ticks -= step;
+
+            if (0u == rtc_sync_slew_ticks)
+            {
+                rtc_sync_slew = 0;
+                slope         = (uint64_t)(RTC_SYNC_ONE + rtc_sync_freq);
+            }
+        }
+    }
+
+    return rtc_sync_ref_time + (elapsed * slope / RTC_SYNC_CLK_FREQ);
+}
+
+static uint64_t
+rtc_sync_ticks_to_time (uint64_t ticks)
+{
+    return ((ticks / RTC_SYNC_CLK_FREQ) << 32)
+           + (((ticks % RTC_SYNC_CLK_FREQ) << 32) / RTC_SYNC_CLK_FREQ);
+}
+
+static void
+rtc_sync_estimate (uint64_t ticks, uint64_t time, uint32_t precision_usec)
+{
+    uint64_t interval = ticks - rtc_sync_anchor_ticks;
+
+    // The anchor point is kept until the interval is long enough
+    if (rtc_sync_synced
+        && (interval < ((uint64_t)RTC_SYNC_INTERVAL_MIN * RTC_SYNC_CLK_FREQ)))
+    {
+        return;
+    }
+
+    if (rtc_sync_synced)
+    {
+        uint64_t local = rtc_sync_ticks_to_time(interval);
+        int64_t  diff  = (int64_t)(time - rtc_sync_anchor_time)
+                         - (int64_t)local;
+        int64_t  limit = (int64_t)(local
+                                   / (1000000u / RTC_SYNC_FREQ_MAX_PPM));
+
+        // A change of the source time would give an impossible frequency
+        // error, so it is discarded
+        if ((diff <= limit) && (diff >= -limit))
+        {
+            int64_t freq = diff * RTC_SYNC_CLK_FREQ / (int64_t)interval;
+            int64_t prec = (int64_t)precision_usec + rtc_sync_anchor_prec;
+            int64_t dev  = freq - rtc_sync_freq;
+
+            // Error of the estimation caused by the precision of both points
+            prec = ((prec * RTC_SYNC_ONE) / 1000000) * RTC_SYNC_CLK_FREQ
+                   / (int64_t)interval;
+
+            if (!rtc_sync_freq_on)
+            {
+                rtc_sync_freq     = (int32_t)freq;
+                rtc_sync_freq_err = (uint32_t)prec;
+                rtc_sync_freq_on  = true;
+            }
+            else
+            {
+                // The deviation of each estimation from the average is
+                // averaged too, as the bound of the frequency error
+                dev = (dev < 0) ? -dev : dev;
+                dev = (dev > prec) ? dev : prec;
+
+                rtc_sync_freq     += (int32_t)((freq - rtc_sync_freq)
+                                               / (1 << RTC_SYNC_FREQ_AVG_BITS));
+                rtc_sync_freq_err += (uint32_t)(
+                    (dev - rtc_sync_freq_err) / (1 << RTC_SYNC_FREQ_AVG_BITS));
+            }
+        }
+    }
+
+    rtc_sync_anchor_ticks = ticks;
+    rtc_sync_anchor_time  = time;
+    rtc_sync_anchor_prec  = precision_usec;
+}
+
+/** @} */
+
+/******************************** End of file *********************************/
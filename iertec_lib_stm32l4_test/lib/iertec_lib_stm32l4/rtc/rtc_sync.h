@@ -0,0 +1,123 @@
+/*******************************************************************************
+ * @file rtc_sync.h
+ * @author juanmanuel.fernandez@iertec.com
+ * @date 19 Oct 2026
+ * @brief Disciplined clock synchronized with an external time source.
+ * @ingroup rtc_sync
+ ******************************************************************************/
+
+/**
+ * @defgroup rtc_sync rtc_sync
+ * @brief Disciplined clock synchronized with an external time source.
+ *
+ * The time is derived from a monotonic tick count, usually
+ * @ref itf_rtc_get_ticks64, which is never changed. Each synchronization point
+ * given with @ref rtc_sync_set_time is used in two ways:
+ *
+ * - The frequency error of the tick clock is estimated from the time elapsed
+ *   between the synchronization points, as measured by the source and by the
+ *   tick count, and it is compensated from then on.
+ * - The time offset is corrected by slewing the time, running it faster or
+ *   slower at @ref RTC_SYNC_SLEW_PPM until the offset is cancelled. Only the
+ *   first point and the offsets above @ref RTC_SYNC_STEP_MSEC step the time.
+ *
+ * So the time only goes back on a step, and the tick count, and the timers of
+ * @ref rtc_timer that run on it, are not affected by the corrections. An
+ * estimated bound of the time error is given by @ref rtc_sync_get_error.
+ * @{
+ */
+
+#ifndef RTC_SYNC_H
+#define RTC_SYNC_H
+
+#include <stdint.h>
+#include <stdbool.h>
+
+/** Frequency of the tick clock (Hz). */
+#ifndef RTC_SYNC_CLK_FREQ
+#define RTC_SYNC_CLK_FREQ      (32768u)
+#endif
+
+/** Rate used to slew the time offsets (ppm). */
+#ifndef RTC_SYNC_SLEW_PPM
+#define RTC_SYNC_SLEW_PPM      (500u)
+#endif
+
+/** Minimum time offset that is stepped instead of slewed (ms). */
+#ifndef RTC_SYNC_STEP_MSEC
+#define RTC_SYNC_STEP_MSEC     (1000u)
+#endif
+
+/** Minimum time between the synchronization points used to estimate the
+ * frequency error (s). The closer points are only used to correct the time
+ * offset. */
+#ifndef RTC_SYNC_INTERVAL_MIN
+#define RTC_SYNC_INTERVAL_MIN  (600u)
+#endif
+
+/** Maximum frequency error of the tick clock (ppm). The estimations above it
+ * are discarded, as they come from a wrong synchronization point. It is also
+ * the error bound until the first estimation. */
+#ifndef RTC_SYNC_FREQ_MAX_PPM
+#define RTC_SYNC_FREQ_MAX_PPM  (200u)
+#endif
+
+/** Weight of the last estimation in the average of the frequency error, as a
+ * power of 2, i.e. 2 gives a weight of 1/4. */
+#ifndef RTC_SYNC_FREQ_AVG_BITS
+#define RTC_SYNC_FREQ_AVG_BITS (2u)
+#endif
+
+/** @brief Monotonic tick count at @ref RTC_SYNC_CLK_FREQ. */
+typedef uint64_t (* rtc_sync_clock_t)(void);
+
+/**
+ * @brief Initialize the disciplined clock. The time starts at 0 and the
+ * estimations are cleared.
+ *
+ * @param[in] clock Tick clock.
+ */
+void rtc_sync_init(rtc_sync_clock_t clock);
+
+/**
+ * @brief Give a synchronization point, the current time of the source.
+ *
+ * @param[in] timestamp Seconds of the source time.
+ * @param[in] fraction Fraction of the second, in units of 2^-32 s.
+ * @param[in] precision_usec Maximum error of the source time in us.
+ *
+ * @retval true If the time is stepped.
+ * @retval false If the time offset is slewed.
+ */
+bool rtc_sync_set_time(uint32_t timestamp, uint32_t fraction,
+                       uint32_t precision_usec);
+
+/**
+ * @brief Get the current disciplined time.
+ *
+ * @param[out] timestamp Seconds of the current time.
+ * @param[out] fraction Fraction of the second, in units of 2^-32 s.
+ */
+void rtc_sync_get_time(uint32_t * timestamp, uint32_t * fraction);
+
+/**
+ * @brief Get the estimated frequency error of the tick clock.
+ *
+ * @return Frequency error in ppb, positive if the clock runs slow.
+ */
+int32_t rtc_sync_get_freq(void);
+
+/**
+ * @brief Get the estimated bound of the current time error. It includes the
+ * precision of the last synchronization point, the offset not slewed yet and
+ * the drift since the last synchronization point.
+ *
+ * @return Time error bound in us, UINT32_MAX if the time is not synchronized.
+ */
+uint32_t rtc_sync_get_error(void);
+
+#endif // RTC_SYNC_H
+
+/** @} */
+
+/******************************** End of file *********************************/
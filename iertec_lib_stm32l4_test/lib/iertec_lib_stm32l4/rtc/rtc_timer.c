@@ -15,58 +15,914 @@
 #include "sys_util.h"
 #include "debug_util.h"
 
+#include <stddef.h>
+
+/****************************************************************************//*
+ * Constants and macros
+ ******************************************************************************/
+
+#if RTC_TIMER_USE_WHEEL
+
+/** Number of slots of each timer wheel level. */
+#define RTC_TIMER_WHEEL_SIZE  (1u << RTC_TIMER_WHEEL_BITS)
+
+/** Mask of the slot index of a timer wheel level. */
+#define RTC_TIMER_WHEEL_MASK  (RTC_TIMER_WHEEL_SIZE - 1u)
+
+/** Longest delay that fits in the timer wheel. */
+#define RTC_TIMER_WHEEL_RANGE \
+        ((1u << (RTC_TIMER_WHEEL_BITS * RTC_TIMER_WHEEL_LEVELS)) - 1u)
+
+#if (RTC_TIMER_WHEEL_BITS * RTC_TIMER_WHEEL_LEVELS) > 31u
+#error "The timer wheel range must fit in 31 bits"
+#endif
+
+#endif // RTC_TIMER_USE_WHEEL
+
+/** Deferred handler state: the timer is in the queue of deferred handlers. */
+#define RTC_TIMER_DEF_QUEUED  (0x01u)
+
+/** Deferred handler state: the handler has to be called. */
+#define RTC_TIMER_DEF_DUE     (0x02u)
+
 /****************************************************************************//*
  * Private data
  ******************************************************************************/
 
+#if RTC_TIMER_USE_WHEEL
+
+/** Slots of each timer wheel level, with the timers that reach them. */
+static rtc_timer_t * rtc_timer_wheel[RTC_TIMER_WHEEL_LEVELS]
+                                    [RTC_TIMER_WHEEL_SIZE];
+
+/** Number of ticks processed. */
+static uint32_t rtc_timer_now;
+
+/** Timers whose tolerance window has started. They expire with the next
+ * expiration of any timer. */
+static rtc_timer_t * rtc_timer_open;
+
+/** Tick at which the timers whose tolerance window has started must expire. */
+static uint32_t rtc_timer_open_end;
+
+#else
+
 /** List of active timers. */
 static rtc_timer_t * rtc_timer_list;
 
-/****************************************************************************//*
- * Public code
- ******************************************************************************/
+#endif // RTC_TIMER_USE_WHEEL
+
+/** Clock of the tickless mode, NULL in periodic mode. */
+static rtc_timer_clock_fn rtc_timer_clock;
+
+/** Alarm of the tickless mode. */
+static rtc_timer_alarm_fn rtc_timer_alarm;
+
+/** Alarm cancellation of the tickless mode. */
+static rtc_timer_cancel_fn rtc_timer_cancel;
+
+/** Clock tick count of the last processed tick. */
+static uint32_t rtc_timer_mark;
+
+/** The alarm is programmed. */
+static bool rtc_timer_alarm_on;
+
+/** Clock tick count of the programmed alarm. */
+static uint32_t rtc_timer_alarm_tick;
+
+/** Worker wake up function, NULL if the handlers are not deferred. */
+static rtc_timer_notify_fn rtc_timer_notify;
+
+/** Queue of deferred handlers, in reverse order. It is only modified with
+ * atomic operations. */
+static rtc_timer_t * rtc_timer_deferred;
+
+#if RTC_TIMER_STATS
+
+/** Global statistics. The fields updated by the handler calls are modified
+ * with atomic operations, as they are called from the tick context and from
+ * the worker. */
+static rtc_timer_stats_t rtc_timer_stats;
+
+/** Clock used to measure the duration of the handlers. */
+static rtc_timer_clock_fn rtc_timer_stats_clock;
+
+#endif // RTC_TIMER_STATS
+
+/****************************************************************************//*
+ * Private code prototypes
+ ******************************************************************************/
+
+/**
+ * @brief Insert a timer in the active timers. It must be called inside a
+ * critical section.
+ *
+ * @param[in] timer Timer instance.
+ * @param[in] ticks Number of ticks until the latest timer expiration.
+ *
+ * @return Number of ticks until the next tick that has to be processed because
+ * of the inserted timer, or an earlier one.
+ */
+static uint32_t rtc_timer_insert(rtc_timer_t * timer, uint32_t ticks);
+
+/**
+ * @brief Remove a timer from the active timers. It must be called inside a
+ * critical section.
+ *
+ * @param[in] timer Timer instance.
+ */
+static void rtc_timer_remove(rtc_timer_t * timer);
+
+/**
+ * @brief Update the active timers with a new tick, and remove the expired
+ * ones from them.
+ *
+ * @return List of expired timers linked by next_exp, NULL if none.
+ */
+static rtc_timer_t * rtc_timer_expire(void);
+
+/**
+ * @brief Get the number of ticks until the next tick that has to be processed.
+ *
+ * @return Number of ticks, or @ref RTC_TIMER_NEXT_NONE if there are no active
+ * timers.
+ */
+static uint32_t rtc_timer_next(void);
+
+/**
+ * @brief Move forward the active timers a number of ticks without processing
+ * them. There must be no tick to process among them.
+ *
+ * @param[in] ticks Number of ticks.
+ */
+static void rtc_timer_skip(uint32_t ticks);
+
+/**
+ * @brief Program the alarm if the indicated tick is earlier than the
+ * programmed one. It must be called inside a critical section.
+ *
+ * @param[in] ticks Number of ticks since the last processed tick.
+ */
+static void rtc_timer_program(uint32_t ticks);
+
+/**
+ * @brief Program the alarm for the next tick that has to be processed, or
+ * cancel it if there are no active timers. It must be called inside a critical
+ * section or from the context of the tick processing.
+ */
+static void rtc_timer_rearm(void);
+
+/**
+ * @brief Convert a number of ticks counted from now to ticks counted from the
+ * last processed tick. It must be called inside a critical section.
+ *
+ * @param[in] ticks Number of ticks from now.
+ *
+ * @return Number of ticks from the last processed tick.
+ */
+static uint32_t rtc_timer_from_now(uint32_t ticks);
+
+/**
+ * @brief Start a timer. It must be called inside a critical section or from
+ * the context of the tick processing.
+ *
+ * @param[in] timer Timer instance.
+ * @param[in] ticks Number of ticks until the timer expiration, at least 1.
+ * @param[in] slack Number of ticks the expiration can be delayed.
+ * @param[in] period Period of the timer, 0 for a one-shot timer.
+ */
+static void rtc_timer_schedule(rtc_timer_t * timer, uint32_t ticks,
+                               uint32_t slack, uint32_t period);
+
+/**
+ * @brief Start again an expired periodic timer, counting from its expiration
+ * tick. The periods already passed, by the ticks left to process or by the
+ * clock, are skipped and counted as missed. It must be called from the context
+ * of the tick processing.
+ *
+ * @param[in] timer Timer instance.
+ * @param[in] behind Number of ticks left to process until the current tick.
+ */
+static void rtc_timer_reload(rtc_timer_t * timer, uint32_t behind);
+
+/**
+ * @brief Queue the handler of an expired timer for the worker. It takes a
+ * constant time and does not need a critical section.
+ *
+ * @param[in] timer Timer instance.
+ */
+static void rtc_timer_defer(rtc_timer_t * timer);
+
+/**
+ * @brief Call the timeout handler of an expired timer, recording its
+ * statistics.
+ *
+ * @param[in] timer Timer instance.
+ * @param[in] behind Number of ticks left to process until the current tick.
+ */
+static void rtc_timer_call(rtc_timer_t * timer, uint32_t behind);
+
+/**
+ * @brief Cancel the deferred handler of a timer, if it has not been called
+ * yet.
+ *
+ * @param[in] timer Timer instance.
+ */
+static void rtc_timer_undefer(rtc_timer_t * timer);
+
+#if RTC_TIMER_STATS
+
+/**
+ * @brief Record the statistics of a handler call.
+ *
+ * @param[in] timer Timer instance.
+ * @param[in] late Lateness of the call (ticks).
+ * @param[in] run Duration of the handler.
+ */
+static void rtc_timer_stats_call(rtc_timer_t * timer, uint32_t late,
+                                 uint32_t run);
+
+/**
+ * @brief Update atomically a maximum value.
+ *
+ * @param[in] max Maximum value.
+ * @param[in] value New value.
+ */
+static void rtc_timer_stats_max(uint32_t * max, uint32_t value);
+
+#endif // RTC_TIMER_STATS
+
+#if RTC_TIMER_USE_WHEEL
+
+/**
+ * @brief Add a timer to the timer wheel slot where the indicated tick is
+ * resolved.
+ *
+ * @param[in] timer Timer instance.
+ * @param[in] tick Tick count at which the timer must be processed.
+ *
+ * @return Number of ticks until the slot is processed.
+ */
+static uint32_t rtc_timer_wheel_add(rtc_timer_t * timer, uint32_t tick);
+
+/**
+ * @brief Move to the lower levels the timers of the upper level slots reached
+ * by the current tick.
+ */
+static void rtc_timer_wheel_cascade(void);
+
+#else
+
+/**
+ * @brief Move to the expired list the active timers that can expire now
+ * because their tolerance window has started.
+ *
+ * @param[in] last Last timer of the expired list.
+ */
+static void rtc_timer_expire_slack(rtc_timer_t * last);
+
+#endif // RTC_TIMER_USE_WHEEL
+
+/****************************************************************************//*
+ * Public code
+ ******************************************************************************/
+
+void
+rtc_timer_init (void)
+{
+#if RTC_TIMER_USE_WHEEL
+    for (size_t i = 0; i < RTC_TIMER_WHEEL_LEVELS; i++)
+    {
+        for (size_t j = 0; j < RTC_TIMER_WHEEL_SIZE; j++)
+        {
+            rtc_timer_wheel[i][j] = NULL;
+        }
+    }
+
+    rtc_timer_now      = 0;
+    rtc_timer_open     = NULL;
+    rtc_timer_open_end = 0;
+#else
+    rtc_timer_list = NULL;
+#endif // RTC_TIMER_USE_WHEEL
+
+    rtc_timer_clock    = NULL;
+    rtc_timer_alarm    = NULL;
+    rtc_timer_cancel   = NULL;
+    rtc_timer_mark     = 0;
+    rtc_timer_alarm_on = false;
+    rtc_timer_notify   = NULL;
+    rtc_timer_deferred = NULL;
+
+#if RTC_TIMER_STATS
+    rtc_timer_stats       = (rtc_timer_stats_t){0};
+    rtc_timer_stats_clock = NULL;
+#endif
+}
+
+void
+rtc_timer_config (rtc_timer_t * timer, uint32_t id, rtc_timer_fn fn)
+{
+    DEBUG_ASSERT(timer != NULL);
+
+    SYS_ENTER_CRITICAL();
+
+    timer->active   = false;
+    timer->ticks    = 0;
+    timer->slack    = 0;
+    timer->period   = 0;
+    timer->missed   = 0;
+    timer->next     = NULL;
+    timer->next_exp = NULL;
+    timer->next_def = NULL;
+    timer->flags    = 0;
+    timer->deferred = 0;
+    timer->id       = id;
+    timer->fn       = fn;
+#if RTC_TIMER_USE_WHEEL
+    timer->pprev    = NULL;
+#endif
+#if RTC_TIMER_STATS
+    timer->stats    = (rtc_timer_stat_t){0};
+#endif
+
+    SYS_EXIT_CRITICAL();
+}
+
+void
+rtc_timer_set_flags (rtc_timer_t * timer, uint8_t flags)
+{
+    DEBUG_ASSERT(timer != NULL);
+
+    timer->flags = flags;
+}
+
+void
+rtc_timer_start (rtc_timer_t * timer, uint32_t ticks)
+{
+    rtc_timer_start_slack(timer, ticks, 0);
+}
+
+void
+rtc_timer_start_slack (rtc_timer_t * timer, uint32_t ticks, uint32_t slack)
+{
+    DEBUG_ASSERT(timer != NULL);
+
+    // At least 1 tick
+    if (0 == ticks)
+    {
+        ticks++;
+    }
+
+    SYS_ENTER_CRITICAL();
+
+    rtc_timer_undefer(timer);
+    rtc_timer_schedule(timer, rtc_timer_from_now(ticks), slack, 0);
+
+    SYS_EXIT_CRITICAL();
+}
+
+void
+rtc_timer_start_periodic (rtc_timer_t * timer, uint32_t ticks, uint32_t period)
+{
+    DEBUG_ASSERT(timer != NULL);
+    DEBUG_ASSERT(period > 0u);
+
+    // At least 1 tick
+    if (0 == ticks)
+    {
+        ticks++;
+    }
+
+    SYS_ENTER_CRITICAL();
+
+    timer->missed = 0;
+    rtc_timer_undefer(timer);
+    rtc_timer_schedule(timer, rtc_timer_from_now(ticks), 0, period);
+
+    SYS_EXIT_CRITICAL();
+}
+
+void
+rtc_timer_stop (rtc_timer_t * timer)
+{
+    DEBUG_ASSERT(timer != NULL);
+
+    SYS_ENTER_CRITICAL();
+
+    if (timer->active)
+    {
+        rtc_timer_remove(timer);
+
+        timer->ticks  = 0;
+        timer->active = false;
+
+#if RTC_TIMER_STATS
+        rtc_timer_stats.active--;
+#endif
+    }
+
+    // An expired periodic timer is not started again, and its deferred
+    // handler is not called
+    timer->period = 0;
+    rtc_timer_undefer(timer);
+
+    SYS_EXIT_CRITICAL();
+}
+
+void
+rtc_timer_tick (void)
+{
+    rtc_timer_advance(1);
+}
+
+void
+rtc_timer_advance (uint32_t ticks)
+{
+    bool notify = false;
+
+    while (ticks > 0u)
+    {
+        rtc_timer_t * list_exp;
+        uint32_t      step = 1;
+#if RTC_TIMER_STATS
+        uint32_t      expired = 0;
+#endif
+
+        // Skip the ticks until the next one to process
+        if (ticks > 1u)
+        {
+            step = rtc_timer_next();
+
+            if (step > ticks)
+            {
+                step = ticks;
+            }
+
+            rtc_timer_skip(step - 1u);
+        }
+
+        // The mark is updated first, so the timers started by the handlers
+        // are counted from the tick of their expiration
+        rtc_timer_mark += step;
+        ticks          -= step;
+        list_exp        = rtc_timer_expire();
+
+        // Now call to all the expired timer handlers
+        while (list_exp != NULL)
+        {
+#if RTC_TIMER_STATS
+            // The expired timers are inactive, even if an earlier handler has
+            // started them again
+            expired++;
+            rtc_timer_stats.active--;
+#endif
+
+            if ((list_exp->active == false) && (list_exp->fn != NULL))
+            {
+                if ((NULL != rtc_timer_notify)
+                    && (0u == (list_exp->flags & RTC_TIMER_FLAG_INLINE)))
+                {
+                    rtc_timer_defer(list_exp);
+                    notify = true;
+                }
+                else
+                {
+#if RTC_TIMER_STATS
+                    list_exp->stats.due = rtc_timer_mark;
+#endif
+                    rtc_timer_call(list_exp, ticks);
+                }
+            }
+
+            // The periodic timers not stopped or started again by the handlers
+            // are started again from the expiration tick
+            if ((list_exp->active == false) && (list_exp->period > 0u))
+            {
+                rtc_timer_reload(list_exp, ticks);
+            }
+
+            // Go to the next expired timer
+            list_exp = list_exp->next_exp;
+        }
+
+#if RTC_TIMER_STATS
+        if (expired > 0u)
+        {
+            rtc_timer_stats.ticks++;
+            rtc_timer_stats.expired += expired;
+
+            if (expired > rtc_timer_stats.expired_max)
+            {
+                rtc_timer_stats.expired_max = expired;
+            }
+        }
+#endif // RTC_TIMER_STATS
+    }
+
+    rtc_timer_rearm();
+
+    if (notify)
+    {
+        rtc_timer_notify();
+    }
+}
+
+uint32_t
+rtc_timer_get_next (void)
+{
+    uint32_t next;
+
+    SYS_ENTER_CRITICAL();
+    next = rtc_timer_next();
+    SYS_EXIT_CRITICAL();
+
+    return next;
+}
+
+void
+rtc_timer_set_tickless (rtc_timer_clock_fn clock, rtc_timer_alarm_fn alarm,
+                        rtc_timer_cancel_fn cancel)
+{
+    SYS_ENTER_CRITICAL();
+
+    if (rtc_timer_alarm_on)
+    {
+        rtc_timer_cancel();
+    }
+
+    rtc_timer_clock    = clock;
+    rtc_timer_alarm    = alarm;
+    rtc_timer_cancel   = cancel;
+    rtc_timer_alarm_on = false;
+
+    if (NULL != clock)
+    {
+        DEBUG_ASSERT((alarm != NULL) && (cancel != NULL));
+
+        // Program the alarm for the active timers
+        rtc_timer_mark = clock();
+        rtc_timer_rearm();
+    }
+
+    SYS_EXIT_CRITICAL();
+}
+
+void
+rtc_timer_update (void)
+{
+    if (NULL != rtc_timer_clock)
+    {
+        uint32_t now = rtc_timer_clock();
+
+        // The alarm is spent once its tick is reached
+        if ((int32_t)(now - rtc_timer_alarm_tick) >= 0)
+        {
+            rtc_timer_alarm_on = false;
+        }
+
+        rtc_timer_advance(now - rtc_timer_mark);
+    }
+}
+
+void
+rtc_timer_set_worker (rtc_timer_notify_fn notify)
+{
+    SYS_ENTER_CRITICAL();
+    rtc_timer_notify = notify;
+    SYS_EXIT_CRITICAL();
+}
+
+void
+rtc_timer_run_deferred (void)
+{
+    rtc_timer_t * list = __atomic_exchange_n(&rtc_timer_deferred, NULL,
+                                             __ATOMIC_ACQUIRE);
+    rtc_timer_t * fifo = NULL;
+
+    // The queue is in reverse order. The timers taken are still marked as
+    // queued, so the tick context does not link them again meanwhile
+    while (list != NULL)
+    {
+        rtc_timer_t * t_next = list->next_def;
+
+        list->next_def = fifo;
+        fifo           = list;
+        list           = t_next;
+    }
+
+    while (fifo != NULL)
+    {
+        rtc_timer_t * t = fifo;
+        uint8_t       state;
+
+        fifo  = t->next_def;
+        state = __atomic_exchange_n(&t->deferred, 0u, __ATOMIC_ACQ_REL);
+
+        if ((0u != (state & RTC_TIMER_DEF_DUE)) && (t->fn != NULL))
+        {
+            rtc_timer_call(t, 0);
+        }
+    }
+}
+
+#if RTC_TIMER_STATS
+
+void
+rtc_timer_stats_set_clock (rtc_timer_clock_fn clock)
+{
+    rtc_timer_stats_clock = clock;
+}
+
+void
+rtc_timer_stats_get (rtc_timer_stats_t * stats)
+{
+    DEBUG_ASSERT(stats != NULL);
+
+    SYS_ENTER_CRITICAL();
+    *stats = rtc_timer_stats;
+    SYS_EXIT_CRITICAL();
+}
+
+void
+rtc_timer_stats_reset (void)
+{
+    SYS_ENTER_CRITICAL();
+
+    rtc_timer_stats = (rtc_timer_stats_t)
+    {
+        .active     = rtc_timer_stats.active,
+        .active_max = rtc_timer_stats.active,
+    };
+
+    SYS_EXIT_CRITICAL();
+}
+
+void
+rtc_timer_stats_print (const rtc_timer_t * timer)
+{
+    rtc_timer_stats_t stats;
+
+    rtc_timer_stats_get(&stats);
+
+    debug_info("Timers:\r\n\tActive: %u, max: %u\r\n", stats.active,
+               stats.active_max);
+    debug_info("\tExpired: %u in %u ticks, max per tick: %u\r\n",
+               stats.expired, stats.ticks, stats.expired_max);
+    debug_info("\tLate max: %u, run max: %u\r\n\tLate histogram:",
+               stats.late_max, stats.run_max);
+
+    for (size_t i = 0; i < RTC_TIMER_STATS_BINS; i++)
+    {
+        debug_info(" %u", stats.late_hist[i]);
+    }
+
+    debug_info("\r\n");
+
+    if (timer != NULL)
+    {
+        debug_info("Timer %u:\r\n\tCalls: %u, missed: %u\r\n", timer->id,
+                   timer->stats.calls, timer->missed);
+        debug_info("\tLate max: %u, late sum: %u, run max: %u\r\n",
+                   timer->stats.late_max, timer->stats.late_sum,
+                   timer->stats.run_max);
+    }
+}
+
+#endif // RTC_TIMER_STATS
+
+/****************************************************************************//*
+ * Private code
+ ******************************************************************************/
+
+#if RTC_TIMER_USE_WHEEL
+
+static uint32_t
+rtc_timer_insert (rtc_timer_t * timer, uint32_t ticks)
+{
+    timer->ticks = rtc_timer_now + ticks;
+
+    // The timer is processed when its tolerance window starts
+    return rtc_timer_wheel_add(timer, timer->ticks - timer->slack);
+}
+
+static void
+rtc_timer_remove (rtc_timer_t * timer)
+{
+    *timer->pprev = timer->next;
+
+    if (timer->next != NULL)
+    {
+        timer->next->pprev = timer->pprev;
+    }
+
+    timer->next  = NULL;
+    timer->pprev = NULL;
+}
+
+static rtc_timer_t *
+rtc_timer_expire (void)
+{
+    rtc_timer_t *  list_exp = NULL;
+    rtc_timer_t ** tail     = &list_exp;
+    rtc_timer_t *  t;
+    bool           expire;
+
+    rtc_timer_now++;
+    rtc_timer_wheel_cascade();
+
+    // The timers whose window has started expire at the end of the earliest
+    // window. If that timer has been stopped, they expire earlier, but still
+    // inside their windows
+    expire = (rtc_timer_open != NULL) && (rtc_timer_open_end == rtc_timer_now);
+
+    // Process the timers of the current slot
+    t = rtc_timer_wheel[0][rtc_timer_now & RTC_TIMER_WHEEL_MASK];
+    rtc_timer_wheel[0][rtc_timer_now & RTC_TIMER_WHEEL_MASK] = NULL;
+
+    while (t != NULL)
+    {
+        rtc_timer_t * t_next = t->next;
+
+        if ((t->ticks - t->slack) != rtc_timer_now)
+        {
+            // The timer was beyond the wheel range, it is moved forward again
+            rtc_timer_wheel_add(t, t->ticks - t->slack);
+        }
+        else if (0u == t->slack)
+        {
+            // Append the expired timer to the expired list
+            t->active = false;
+            t->ticks  = 0;
+            t->next   = NULL;
+            t->pprev  = NULL;
+            *tail     = t;
+            tail      = &t->next_exp;
+            expire    = true;
+        }
+        else
+        {
+            // The tolerance window starts, the timer waits in the open list
+            if ((rtc_timer_open == NULL)
+                || ((int32_t)(t->ticks - rtc_timer_open_end) < 0))
+            {
+                rtc_timer_open_end = t->ticks;
+            }
+
+            t->next = rtc_timer_open;
+
+            if (rtc_timer_open != NULL)
+            {
+                rtc_timer_open->pprev = &t->next;
+            }
+
+            t->pprev       = &rtc_timer_open;
+            rtc_timer_open = t;
+        }
+
+        t = t_next;
+    }
+
+    // Share the wake up with the timers whose tolerance window has started
+    if (expire)
+    {
+        t              = rtc_timer_open;
+        rtc_timer_open = NULL;
+
+        while (t != NULL)
+        {
+            rtc_timer_t * t_next = t->next;
+
+            t->active = false;
+            t->ticks  = 0;
+            t->next   = NULL;
+            t->pprev  = NULL;
+            *tail     = t;
+            tail      = &t->next_exp;
+            t         = t_next;
+        }
+    }
+
+    *tail = NULL;
 
-void
-rtc_timer_init (void)
-{
-    rtc_timer_list = NULL;
+    return list_exp;
 }
 
-void
-rtc_timer_config (rtc_timer_t * timer, uint32_t id, rtc_timer_fn fn)
+static uint32_t
+rtc_timer_next (void)
 {
-    DEBUG_ASSERT(timer != NULL);
+    uint32_t next = RTC_TIMER_NEXT_NONE;
 
-    SYS_ENTER_CRITICAL();
+    if (rtc_timer_open != NULL)
+    {
+        next = rtc_timer_open_end - rtc_timer_now;
+    }
 
-    timer->active   = false;
-    timer->ticks    = 0;
-    timer->next     = NULL;
-    timer->next_exp = NULL;
-    timer->id       = id;
-    timer->fn       = fn;
+    // First non-empty slot of each level, the upper levels are processed when
+    // the lower ones wrap around
+    for (size_t level = 0; level < RTC_TIMER_WHEEL_LEVELS; level++)
+    {
+        uint32_t shift = RTC_TIMER_WHEEL_BITS * level;
+        uint32_t base  = (rtc_timer_now >> shift) << shift;
+        uint32_t k     = 1;
 
-    SYS_EXIT_CRITICAL();
+        while ((k <= RTC_TIMER_WHEEL_SIZE)
+               && (((base + (k << shift)) - rtc_timer_now) < next)
+               && (NULL == rtc_timer_wheel[level][((base >> shift) + k)
+                                                  & RTC_TIMER_WHEEL_MASK]))
+        {
+            k++;
+        }
+
+        if ((k <= RTC_TIMER_WHEEL_SIZE)
+            && (((base + (k << shift)) - rtc_timer_now) < next))
+        {
+            next = (base + (k << shift)) - rtc_timer_now;
+        }
+    }
+
+    return next;
 }
 
-void
-rtc_timer_start (rtc_timer_t * timer, uint32_t ticks)
+static void
+rtc_timer_skip (uint32_t ticks)
 {
-    DEBUG_ASSERT(timer != NULL);
+    rtc_timer_now += ticks;
+}
 
-    // At least 1 tick
-    if (0 == ticks)
+static uint32_t
+rtc_timer_wheel_add (rtc_timer_t * timer, uint32_t tick)
+{
+    uint32_t delta = tick - rtc_timer_now;
+    size_t   level = 0;
+    size_t   slot;
+
+    // Beyond the wheel range the timer is moved as far as possible
+    if (delta > RTC_TIMER_WHEEL_RANGE)
     {
-        ticks++;
+        delta = RTC_TIMER_WHEEL_RANGE;
+        tick  = rtc_timer_now + RTC_TIMER_WHEEL_RANGE;
     }
 
-    SYS_ENTER_CRITICAL();
+    // Find the lowest level whose range includes the delay
+    while ((level < (RTC_TIMER_WHEEL_LEVELS - 1u))
+           && ((delta >> (RTC_TIMER_WHEEL_BITS * (level + 1u))) != 0u))
+    {
+        level++;
+    }
 
-    if (timer->active)
+    slot = (tick >> (RTC_TIMER_WHEEL_BITS * level)) & RTC_TIMER_WHEEL_MASK;
+
+    // Link the timer at the beginning of the slot
+    timer->next = rtc_timer_wheel[level][slot];
+
+    if (timer->next != NULL)
     {
-        rtc_timer_stop(timer);
+        timer->next->pprev = &timer->next;
+    }
+
+    timer->pprev                 = &rtc_timer_wheel[level][slot];
+    rtc_timer_wheel[level][slot] = timer;
+
+    // The upper level slots are processed when the lower levels wrap around
+    return (tick & ~((1u << (RTC_TIMER_WHEEL_BITS * level)) - 1u))
+           - rtc_timer_now;
+}
+
+static void
+rtc_timer_wheel_cascade (void)
+{
+    size_t level = 1;
+    size_t slot  = rtc_timer_now & RTC_TIMER_WHEEL_MASK;
+
+    // A slot of a level is reached when the lower levels wrap around
+    while ((0u == slot) && (level < RTC_TIMER_WHEEL_LEVELS))
+    {
+        rtc_timer_t * t;
+
+        slot = (rtc_timer_now >> (RTC_TIMER_WHEEL_BITS * level))
+               & RTC_TIMER_WHEEL_MASK;
+        t    = rtc_timer_wheel[level][slot];
+
+        rtc_timer_wheel[level][slot] = NULL;
+
+        while (t != NULL)
+        {
+            rtc_timer_t * t_next = t->next;
+
+            rtc_timer_wheel_add(t, t->ticks - t->slack);
+            t = t_next;
+        }
+
+        level++;
     }
+}
 
+#else
+
+static uint32_t
+rtc_timer_insert (rtc_timer_t * timer, uint32_t ticks)
+{
     if (rtc_timer_list != NULL)
     {
         if (ticks < rtc_timer_list->ticks)
@@ -120,69 +976,58 @@ rtc_timer_start (rtc_timer_t * timer, uint32_t ticks)
         rtc_timer_list = timer;
     }
 
-    timer->active = true;
-
-    SYS_EXIT_CRITICAL();
+    return rtc_timer_list->ticks;
 }
 
-void
-rtc_timer_stop (rtc_timer_t * timer)
+static void
+rtc_timer_remove (rtc_timer_t * timer)
 {
-    DEBUG_ASSERT(timer != NULL);
-
-    SYS_ENTER_CRITICAL();
-
-    if (timer->active)
+    if (timer == rtc_timer_list)
     {
-        if (timer == rtc_timer_list)
-        {
-            rtc_timer_list = rtc_timer_list->next;
+        rtc_timer_list = rtc_timer_list->next;
 
-            if (rtc_timer_list != NULL)
-            {
-                // Add the stopped timer ticks to the next timer
-                rtc_timer_list->ticks += timer->ticks;
-            }
+        if (rtc_timer_list != NULL)
+        {
+            // Add the stopped timer ticks to the next timer
+            rtc_timer_list->ticks += timer->ticks;
         }
-        else
+    }
+    else
+    {
+        rtc_timer_t * t_prev = rtc_timer_list;
+
+        // Search the preceding timer
+        while ((t_prev != NULL) && (t_prev->next != timer))
         {
-            rtc_timer_t * t_prev = rtc_timer_list;
+            t_prev = t_prev->next;
+        }
 
-            // Search the preceding timer
-            while ((t_prev != NULL) && (t_prev->next != timer))
-            {
-                t_prev = t_prev->next;
-            }
+        // The following condition should be true always
+        if (t_prev != NULL)
+        {
+            t_prev->next = timer->next;
 
-            // The following condition should be true always
-            if (t_prev != NULL)
+            if (timer->next != NULL)
             {
-                t_prev->next = timer->next;
-
-                if (timer->next != NULL)
-                {
-                    // Add the stopped timer ticks to the next timer
-                    timer->next->ticks += timer->ticks;
-                }
+                // Add the stopped timer ticks to the next timer
+                timer->next->ticks += timer->ticks;
             }
         }
-
-        timer->ticks  = 0;
-        timer->active = false;
     }
-
-    SYS_EXIT_CRITICAL();
 }
 
-void
-rtc_timer_tick (void)
+static rtc_timer_t *
+rtc_timer_expire (void)
 {
+    rtc_timer_t * list_exp = NULL;
+
     // Check that an expiration has occurred
     if ((rtc_timer_list != NULL) && (--rtc_timer_list->ticks == 0))
     {
-        rtc_timer_t * list_exp = rtc_timer_list;
         rtc_timer_t * t;
 
+        list_exp = rtc_timer_list;
+
         // Compose an expired list with all the consecutive timers that have
         // their ticks equal to 0
         do
@@ -205,20 +1050,329 @@ rtc_timer_tick (void)
             }
         } while (t->next_exp != NULL);
 
-        // Now call to all the expired timer handlers
-        while (list_exp != NULL)
+        // Share the wake up with the timers whose tolerance window has started
+        rtc_timer_expire_slack(t);
+    }
+
+    return list_exp;
+}
+
+static uint32_t
+rtc_timer_next (void)
+{
+    uint32_t next = RTC_TIMER_NEXT_NONE;
+
+    if (rtc_timer_list != NULL)
+    {
+        next = rtc_timer_list->ticks;
+    }
+
+    return next;
+}
+
+static void
+rtc_timer_skip (uint32_t ticks)
+{
+    if (rtc_timer_list != NULL)
+    {
+        rtc_timer_list->ticks -= ticks;
+    }
+}
+
+static void
+rtc_timer_expire_slack (rtc_timer_t * last)
+{
+    rtc_timer_t * t_prev = NULL;
+    rtc_timer_t * t      = rtc_timer_list;
+    uint32_t      ticks  = 0;
+
+    while (t != NULL)
+    {
+        rtc_timer_t * t_next = t->next;
+
+        // Ticks left until the latest expiration of the timer
+        ticks += t->ticks;
+
+        if (ticks <= t->slack)
         {
-            if ((list_exp->active == false) && (list_exp->fn != NULL))
+            // Remove the timer from the timer list. The next timer takes its
+            // relative ticks
+            if (t_prev == NULL)
+            {
+                rtc_timer_list = t_next;
+            }
+            else
             {
-                list_exp->fn(list_exp);
+                t_prev->next = t_next;
             }
 
-            // Go to the next expired timer
-            list_exp = list_exp->next_exp;
+            if (t_next != NULL)
+            {
+                t_next->ticks += t->ticks;
+            }
+
+            ticks -= t->ticks;
+
+            // Append it to the expired list
+            t->ticks       = 0;
+            t->active      = false;
+            t->next_exp    = NULL;
+            last->next_exp = t;
+            last           = t;
+        }
+        else
+        {
+            t_prev = t;
+        }
+
+        t = t_next;
+    }
+}
+
+#endif // RTC_TIMER_USE_WHEEL
+
+static void
+rtc_timer_program (uint32_t ticks)
+{
+    uint32_t tick = rtc_timer_mark + ticks;
+
+    // A later alarm is kept, the tick is processed when it fires
+    if ((NULL != rtc_timer_clock)
+        && (!rtc_timer_alarm_on
+            || ((int32_t)(tick - rtc_timer_alarm_tick) < 0)))
+    {
+        rtc_timer_alarm_on   = true;
+        rtc_timer_alarm_tick = tick;
+        rtc_timer_alarm(tick);
+    }
+}
+
+static uint32_t
+rtc_timer_from_now (uint32_t ticks)
+{
+    // In tickless mode the ticks elapsed since the last processed tick are
+    // added, so the timer is counted from now
+    if (NULL != rtc_timer_clock)
+    {
+        uint32_t elapsed = rtc_timer_clock() - rtc_timer_mark;
+
+        ticks = (ticks > (UINT32_MAX - elapsed)) ? UINT32_MAX
+                                                 : (ticks + elapsed);
+    }
+
+    return ticks;
+}
+
+static void
+rtc_timer_schedule (rtc_timer_t * timer, uint32_t ticks, uint32_t slack,
+                    uint32_t period)
+{
+    if (timer->active)
+    {
+        rtc_timer_stop(timer);
+    }
+
+    // The timer is inserted at its latest expiration
+    if (slack > (UINT32_MAX - ticks))
+    {
+        slack = UINT32_MAX - ticks;
+    }
+
+    ticks += slack;
+
+    timer->slack  = slack;
+    timer->period = period;
+    rtc_timer_program(rtc_timer_insert(timer, ticks));
+    timer->active = true;
+
+#if RTC_TIMER_STATS
+    rtc_timer_stats.active++;
+
+    if (rtc_timer_stats.active > rtc_timer_stats.active_max)
+    {
+        rtc_timer_stats.active_max = rtc_timer_stats.active;
+    }
+#endif
+}
+
+static void
+rtc_timer_reload (rtc_timer_t * timer, uint32_t behind)
+{
+    uint32_t period = timer->period;
+    uint32_t missed;
+    uint32_t ticks  = UINT32_MAX;
+
+    // In tickless mode the clock may have gone further during the handlers
+    if ((NULL != rtc_timer_clock)
+        && ((rtc_timer_clock() - rtc_timer_mark) > behind))
+    {
+        behind = rtc_timer_clock() - rtc_timer_mark;
+    }
+
+    missed = behind / period;
+
+    // The next expiration is the first one after the current tick
+    if ((missed + 1u) <= (UINT32_MAX / period))
+    {
+        ticks = (missed + 1u) * period;
+    }
+
+    // Saturated count of the missed periods
+    if (missed > (UINT32_MAX - timer->missed))
+    {
+        missed = UINT32_MAX - timer->missed;
+    }
+
+    timer->missed += missed;
+
+    rtc_timer_schedule(timer, ticks, 0, period);
+}
+
+static void
+rtc_timer_defer (rtc_timer_t * timer)
+{
+    uint8_t state = __atomic_fetch_or(&timer->deferred,
+                                      RTC_TIMER_DEF_QUEUED | RTC_TIMER_DEF_DUE,
+                                      __ATOMIC_ACQ_REL);
+
+    // The previous expiration has not been handled yet
+    if ((0u != (state & RTC_TIMER_DEF_DUE)) && (timer->missed < UINT32_MAX))
+    {
+        timer->missed++;
+    }
+
+#if RTC_TIMER_STATS
+    // The lateness is counted from the first expiration not handled
+    if (0u == (state & RTC_TIMER_DEF_DUE))
+    {
+        timer->stats.due = rtc_timer_mark;
+    }
+#endif
+
+    // Link the timer at the beginning of the queue
+    if (0u == (state & RTC_TIMER_DEF_QUEUED))
+    {
+        rtc_timer_t * head = __atomic_load_n(&rtc_timer_deferred,
+                                             __ATOMIC_RELAXED);
+
+        do
+        {
+            timer->next_def = head;
+        } while (!__atomic_compare_exchange_n(&rtc_timer_deferred, &head,
+                                              timer, true, __ATOMIC_RELEASE,
+                                              __ATOMIC_RELAXED));
+    }
+}
+
+static void
+rtc_timer_call (rtc_timer_t * timer, uint32_t behind)
+{
+#if RTC_TIMER_STATS
+    uint32_t now   = (NULL != rtc_timer_clock) ? rtc_timer_clock()
+                                               : (rtc_timer_mark + behind);
+    uint32_t start = 0;
+    uint32_t run   = 0;
+
+    if (NULL != rtc_timer_stats_clock)
+    {
+        start = rtc_timer_stats_clock();
+    }
+
+    timer->fn(timer);
+
+    if (NULL != rtc_timer_stats_clock)
+    {
+        run = rtc_timer_stats_clock() - start;
+    }
+
+    rtc_timer_stats_call(timer, now - timer->stats.due, run);
+#else
+    (void)behind;
+
+    timer->fn(timer);
+#endif // RTC_TIMER_STATS
+}
+
+static void
+rtc_timer_undefer (rtc_timer_t * timer)
+{
+    (void)__atomic_fetch_and(&timer->deferred, (uint8_t)~RTC_TIMER_DEF_DUE,
+                             __ATOMIC_ACQ_REL);
+}
+
+static void
+rtc_timer_rearm (void)
+{
+    if (NULL != rtc_timer_clock)
+    {
+        uint32_t next = rtc_timer_next();
+
+        if (RTC_TIMER_NEXT_NONE != next)
+        {
+            rtc_timer_program(next);
+        }
+        else if (rtc_timer_alarm_on)
+        {
+            rtc_timer_alarm_on = false;
+            rtc_timer_cancel();
+        }
+        else
+        {
+            // No timers and no alarm
         }
     }
 }
 
+#if RTC_TIMER_STATS
+
+static void
+rtc_timer_stats_call (rtc_timer_t * timer, uint32_t late, uint32_t run)
+{
+    uint32_t bin = 0;
+
+    // The timer statistics are only modified by the context of its handler
+    timer->stats.calls++;
+    timer->stats.late_sum = (late > (UINT32_MAX - timer->stats.late_sum))
+                            ? UINT32_MAX : (timer->stats.late_sum + late);
+
+    if (late > timer->stats.late_max)
+    {
+        timer->stats.late_max = late;
+    }
+
+    if (run > timer->stats.run_max)
+    {
+        timer->stats.run_max = run;
+    }
+
+    // Bin of the highest bit of the lateness
+    if (late > 0u)
+    {
+        bin = 32u - (uint32_t)__builtin_clz(late);
+        bin = (bin < RTC_TIMER_STATS_BINS) ? bin : (RTC_TIMER_STATS_BINS - 1u);
+    }
+
+    (void)__atomic_fetch_add(&rtc_timer_stats.late_hist[bin], 1u,
+                             __ATOMIC_RELAXED);
+    rtc_timer_stats_max(&rtc_timer_stats.late_max, late);
+    rtc_timer_stats_max(&rtc_timer_stats.run_max, run);
+}
+
+static void
+rtc_timer_stats_max (uint32_t * max, uint32_t value)
+{
+    uint32_t old = __atomic_load_n(max, __ATOMIC_RELAXED);
+
+    while ((value > old)
+           && !__atomic_compare_exchange_n(max, &old, value, true,
+                                           __ATOMIC_RELAXED, __ATOMIC_RELAXED))
+    {
+        // Retry while the value is higher than the one set by other context
+    }
+}
+
+#endif // RTC_TIMER_STATS
+
 /** @} */
 
 /******************************** End of file *********************************/
@@ -9,6 +9,51 @@
 /**
  * @defgroup rtc_timer rtc_timer
  * @brief Generic timers that can use any tick interrupt source.
+ *
+ * By default the active timers are kept in a list sorted by expiration, with
+ * the ticks of each timer relative to its preceding one. Starting and stopping
+ * a timer walk the list inside a critical section, so their duration grows
+ * with the number of active timers.
+ *
+ * When @ref RTC_TIMER_USE_WHEEL is enabled the timers are kept in a
+ * hierarchical timer wheel instead. Each level has a slot per tick of its
+ * resolution, and the timers are moved to the lower level when the slots of
+ * the upper one are reached. Starting and stopping a timer take a constant
+ * time, and the tick processing takes a constant time plus the moved timers.
+ * The timers that expire in the same tick are called in no particular order.
+ *
+ * A periodic timer, see @ref rtc_timer_start_periodic, is started again after
+ * its timeout handler, counting from its expiration tick, so the handler
+ * duration does not accumulate. If a late tickless wake up has already passed
+ * the next periods, they are skipped and counted as missed, and the timer
+ * keeps its original phase.
+ *
+ * The timeout handlers are called from the tick context, usually an interrupt.
+ * With @ref rtc_timer_set_worker they are deferred instead: the tick context
+ * only links the expired timers in a lock-free queue, and a worker task calls
+ * the handlers from @ref rtc_timer_run_deferred, see task_timer. The timers
+ * with @ref RTC_TIMER_FLAG_INLINE keep their handlers in the tick context.
+ *
+ * When @ref RTC_TIMER_STATS is enabled, the lateness and the duration of the
+ * handlers are recorded for each timer and globally, with a histogram of the
+ * lateness, the number of expirations per tick and the number of active
+ * timers. The lateness is counted in ticks from the expiration tick until the
+ * handler is called, so it includes the late tickless wake ups and the time
+ * the deferred handlers wait for the worker. The statistics are printed
+ * through the debug interface with @ref rtc_timer_stats_print.
+ *
+ * The timers are updated by calling @ref rtc_timer_tick each period, or they
+ * can run in tickless mode, see @ref rtc_timer_set_tickless. In tickless mode
+ * the timer ticks are the ticks of a free running clock, and a one-shot alarm
+ * is programmed at the next tick that has to be processed, instead of waking
+ * up each period. After a late alarm the missed ticks are processed at once.
+ * With the RTC interface driver, at 32768 ticks per second:
+ *
+ * @code
+ * itf_rtc_set_alarm_callback(rtc_timer_update);
+ * rtc_timer_set_tickless(itf_rtc_get_ticks, itf_rtc_set_alarm,
+ *                        itf_rtc_stop_alarm);
+ * @endcode
  * @{
  */
 
@@ -18,6 +63,42 @@
 #include <stdbool.h>
 #include <stdint.h>
 
+/** Use the hierarchical timer wheel instead of the sorted list. */
+#ifndef RTC_TIMER_USE_WHEEL
+#define RTC_TIMER_USE_WHEEL    (0)
+#endif
+
+/** Number of bits of the tick count resolved by each timer wheel level. Each
+ * level has 2 ^ RTC_TIMER_WHEEL_BITS slots. */
+#ifndef RTC_TIMER_WHEEL_BITS
+#define RTC_TIMER_WHEEL_BITS   (6u)
+#endif
+
+/** Number of timer wheel levels. The timers that expire beyond the wheel range
+ * are moved through the upper level until they fit. */
+#ifndef RTC_TIMER_WHEEL_LEVELS
+#define RTC_TIMER_WHEEL_LEVELS (4u)
+#endif
+
+/** Record the timer statistics, see @ref rtc_timer_stats_get. */
+#ifndef RTC_TIMER_STATS
+#define RTC_TIMER_STATS        (0)
+#endif
+
+/** Number of bins of the lateness histogram. The bin 0 counts the handlers
+ * called on time, the bin i the ones called 2 ^ (i - 1) to 2 ^ i - 1 ticks
+ * late, and the last bin all the later ones. */
+#ifndef RTC_TIMER_STATS_BINS
+#define RTC_TIMER_STATS_BINS   (8u)
+#endif
+
+/** Value returned by @ref rtc_timer_get_next when there are no active timers. */
+#define RTC_TIMER_NEXT_NONE    (UINT32_MAX)
+
+/** Timer flag: the timeout handler is interrupt safe and it is called from the
+ * tick context even if there is a worker. */
+#define RTC_TIMER_FLAG_INLINE  (0x01u)
+
 // Forward declaration needed in the structure definition
 typedef struct rtc_timer_st rtc_timer_t;
 
@@ -28,26 +109,126 @@ typedef struct rtc_timer_st rtc_timer_t;
  */
 typedef void (* rtc_timer_fn)(rtc_timer_t * timer);
 
+/** @brief Clock used in tickless mode. It returns a free running tick count
+ * that is allowed to wrap around. */
+typedef uint32_t (* rtc_timer_clock_fn)(void);
+
+/**
+ * @brief Function that programs the one-shot alarm used in tickless mode,
+ * replacing the previous one. When the alarm fires @ref rtc_timer_update must
+ * be called. If the tick has already been reached, the alarm must fire as soon
+ * as possible.
+ *
+ * @param[in] tick Clock tick count of the alarm.
+ */
+typedef void (* rtc_timer_alarm_fn)(uint32_t tick);
+
+/** @brief Function that cancels the alarm used in tickless mode. */
+typedef void (* rtc_timer_cancel_fn)(void);
+
+/** @brief Function that wakes up the worker task. It is called from the tick
+ * context, once per tick processing with deferred handlers. */
+typedef void (* rtc_timer_notify_fn)(void);
+
+#if RTC_TIMER_STATS
+
+/** @brief Statistics of a timer. */
+typedef struct
+{
+    /** Number of handler calls. */
+    uint32_t calls;
+
+    /** Maximum and saturated sum of the lateness of the handler calls. */
+    uint32_t late_max;
+    uint32_t late_sum;
+
+    /** Maximum duration of the handler, in units of the statistics clock. */
+    uint32_t run_max;
+
+    /** Expiration tick of the pending handler call. */
+    uint32_t due;
+} rtc_timer_stat_t;
+
+/** @brief Global statistics of the timers. */
+typedef struct
+{
+    /** Number of processed ticks with expirations. */
+    uint32_t ticks;
+
+    /** Number of expirations, and maximum number of them in a tick. */
+    uint32_t expired;
+    uint32_t expired_max;
+
+    /** Number of active timers, and its maximum. It is the length of the
+     * sorted list, or the occupancy of the timer wheel. */
+    uint32_t active;
+    uint32_t active_max;
+
+    /** Maximum lateness of the handler calls. */
+    uint32_t late_max;
+
+    /** Maximum duration of a handler, in units of the statistics clock. */
+    uint32_t run_max;
+
+    /** Histogram of the lateness of the handler calls. */
+    uint32_t late_hist[RTC_TIMER_STATS_BINS];
+} rtc_timer_stats_t;
+
+#endif // RTC_TIMER_STATS
+
 /** @brief Timer instance structure. */
 typedef struct rtc_timer_st
 {
     /** Timer state. */
     bool active;
 
-    /** Timer ticks relative to its preceding timer. */
+    /** Timer ticks relative to its preceding timer. With the timer wheel,
+     * tick count of its latest expiration. */
     uint32_t ticks;
 
-    /** Timer that will expire next to this one. */
+    /** Ticks the expiration can be advanced to share a wake up with another
+     * timer. */
+    uint32_t slack;
+
+    /** Period of a periodic timer, 0 for a one-shot timer. */
+    uint32_t period;
+
+    /** Number of periods skipped because they had passed when the timer was
+     * started again. */
+    uint32_t missed;
+
+    /** Timer that will expire next to this one. With the timer wheel, next
+     * timer in the same slot. */
     rtc_timer_t * next;
 
+#if RTC_TIMER_USE_WHEEL
+    /** Link that points to this timer, so it can be removed from its slot
+     * without searching it. */
+    rtc_timer_t ** pprev;
+#endif
+
     /** Auxiliary variable used by the tick processing function. */
     rtc_timer_t * next_exp;
 
+    /** Next timer in the queue of deferred handlers. */
+    rtc_timer_t * next_def;
+
+    /** Timer flags, see @ref RTC_TIMER_FLAG_INLINE. */
+    uint8_t flags;
+
+    /** State of the deferred handler, only modified with atomic operations. */
+    uint8_t deferred;
+
     /** Timer identifier. It can be used in the timeout function. */
     uint32_t id;
 
     /** The function that will be called when the timer expires. */
     rtc_timer_fn fn;
+
+#if RTC_TIMER_STATS
+    /** Statistics of the timer, cleared by @ref rtc_timer_config. */
+    rtc_timer_stat_t stats;
+#endif
 } rtc_timer_t;
 
 /**
@@ -66,6 +247,15 @@ void rtc_timer_init(void);
  */
 void rtc_timer_config(rtc_timer_t * timer, uint32_t id, rtc_timer_fn fn);
 
+/**
+ * @brief Set the flags of a timer. It must not be called while its handler is
+ * deferred.
+ *
+ * @param[in] timer Timer instance.
+ * @param[in] flags Timer flags, see @ref RTC_TIMER_FLAG_INLINE.
+ */
+void rtc_timer_set_flags(rtc_timer_t * timer, uint8_t flags);
+
 /**
  * @brief Start a timer. It will expire when the indicated ticks have been
  * elapsed.
@@ -76,7 +266,34 @@ void rtc_timer_config(rtc_timer_t * timer, uint32_t id, rtc_timer_fn fn);
 void rtc_timer_start(rtc_timer_t * timer, uint32_t ticks);
 
 /**
- * @brief Stop a timer if it was in active mode.
+ * @brief Start a timer with a tolerance window. It will expire when the
+ * indicated ticks plus the slack ticks have been elapsed, or earlier, once the
+ * indicated ticks have been elapsed, when another timer expires. This way the
+ * timers with unrelated phases share their wake ups.
+ *
+ * @param[in] timer Timer instance.
+ * @param[in] ticks Minimum number of ticks until the timer expiration.
+ * @param[in] slack Number of ticks the expiration can be delayed.
+ */
+void rtc_timer_start_slack(rtc_timer_t * timer, uint32_t ticks,
+                           uint32_t slack);
+
+/**
+ * @brief Start a periodic timer. It will expire when the indicated ticks have
+ * been elapsed, and then each period, until it is stopped or started again.
+ * The missed periods counter is cleared.
+ *
+ * @param[in] timer Timer instance.
+ * @param[in] ticks Number of ticks until the first timer expiration.
+ * @param[in] period Number of ticks between expirations, at least 1.
+ */
+void rtc_timer_start_periodic(rtc_timer_t * timer, uint32_t ticks,
+                              uint32_t period);
+
+/**
+ * @brief Stop a timer if it was in active mode. A periodic timer stopped from
+ * its timeout handler is not started again. A deferred handler not called yet
+ * is cancelled, as it is when the timer is started again.
  *
  * @param[in] timer Timer instance.
  */
@@ -91,6 +308,102 @@ void rtc_timer_stop(rtc_timer_t * timer);
  */
 void rtc_timer_tick(void);
 
+/**
+ * @brief Update the active timers with several elapsed ticks at once. The
+ * ticks without expirations are skipped, and the timeout handlers are called
+ * in expiration order.
+ *
+ * A periodic timer expires once at most: the next periods that are also within
+ * the elapsed ticks are skipped and added to @ref rtc_timer_t::missed, and the
+ * timer keeps its phase. So it is not equivalent to calling
+ * @ref rtc_timer_tick for each tick, which calls the handler on every period.
+ *
+ * @param[in] ticks Number of elapsed ticks.
+ *
+ * @note It must be called from the same context as @ref rtc_timer_tick.
+ */
+void rtc_timer_advance(uint32_t ticks);
+
+/**
+ * @brief Get the number of ticks until the next tick that has to be processed.
+ * It is the next expiration, or an earlier tick at which the timer wheel moves
+ * the timers between its levels or opens a tolerance window.
+ *
+ * @return Number of ticks, at least 1, or @ref RTC_TIMER_NEXT_NONE if there
+ * are no active timers.
+ */
+uint32_t rtc_timer_get_next(void);
+
+/**
+ * @brief Switch to tickless mode, or back to the periodic mode. In tickless
+ * mode the ticks are counted by the clock, @ref rtc_timer_tick must not be
+ * called, and the alarm is programmed each time the next tick to process
+ * changes.
+ *
+ * @param[in] clock Clock used to count the ticks, NULL for periodic mode.
+ * @param[in] alarm Function that programs the alarm.
+ * @param[in] cancel Function that cancels the alarm.
+ */
+void rtc_timer_set_tickless(rtc_timer_clock_fn clock, rtc_timer_alarm_fn alarm,
+                            rtc_timer_cancel_fn cancel);
+
+/**
+ * @brief Update the active timers with the ticks elapsed since the last update
+ * and program the next alarm. In tickless mode it must be called when the
+ * alarm fires, and it can be called at any other time from the same context.
+ */
+void rtc_timer_update(void);
+
+/**
+ * @brief Defer the timeout handlers to a worker, or call them again from the
+ * tick context.
+ *
+ * @param[in] notify Function that wakes up the worker, NULL to call the
+ * handlers from the tick context.
+ */
+void rtc_timer_set_worker(rtc_timer_notify_fn notify);
+
+/**
+ * @brief Call the deferred timeout handlers, in expiration order. It must be
+ * called from a single worker context each time it is notified. If a periodic
+ * timer expires again before its handler is called, the expiration is counted
+ * as missed.
+ */
+void rtc_timer_run_deferred(void);
+
+#if RTC_TIMER_STATS
+
+/**
+ * @brief Set the clock used to measure the duration of the handlers, e.g. a
+ * CPU cycle counter. The durations are not measured without it.
+ *
+ * @param[in] clock Free running clock, NULL to not measure the durations.
+ */
+void rtc_timer_stats_set_clock(rtc_timer_clock_fn clock);
+
+/**
+ * @brief Get the global statistics of the timers.
+ *
+ * @param[out] stats Statistics.
+ */
+void rtc_timer_stats_get(rtc_timer_stats_t * stats);
+
+/**
+ * @brief Clear the global statistics of the timers, except the number of
+ * active timers.
+ */
+void rtc_timer_stats_reset(void);
+
+/**
+ * @brief Print the global statistics of the timers through the debug
+ * interface, and the statistics of a timer.
+ *
+ * @param[in] timer Timer instance, NULL to print only the global statistics.
+ */
+void rtc_timer_stats_print(const rtc_timer_t * timer);
+
+#endif // RTC_TIMER_STATS
+
 #endif // RTC_TIMER_H
 
 /** @} */
@@ -31,6 +31,14 @@
 #include "task.h"
 #include "stm32l4xx.h"
 
+//      When LPTIM_TICK_SIM is defined, the LPTIM registers, the interrupt masking, the sleep instructions and
+// the kernel hooks are redirected by the shim header lptimTick_shim.h, which the build provides.  The unit
+// tests use it to run this file against a host model of the LPTIM.
+//
+#ifdef LPTIM_TICK_SIM
+#include "lptimTick_shim.h"
+#endif
+
 //      This FreeRTOS port "extension" for STM32 uses LPTIM to generate the OS tick instead of the systick
 // timer.  The benefit of the LPTIM is that it continues running in "stop" mode as long as its clock source
 // does.  A typical clock source for the LPTIM is LSE (or LSI), which does keep running in stop mode.
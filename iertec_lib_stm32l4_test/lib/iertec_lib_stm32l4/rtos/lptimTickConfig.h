@@ -12,7 +12,7 @@
 
 // Ensure definitions are only used by the compiler, and not by the assembler.
 #if defined(__ICCARM__) || defined(__CC_ARM) || defined(__GNUC__)
-extern void itf_pwr_pre_sleep(void);
+extern void itf_pwr_pre_sleep(uint32_t idle_ticks);
 extern void itf_pwr_post_sleep(void);
 extern void vApplicationTraceTicksDropped(uint32_t ticks);
 #endif // defined(__ICCARM__) || defined(__CC_ARM) || defined(__GNUC__)
@@ -29,8 +29,9 @@ extern void vApplicationTraceTicksDropped(uint32_t ticks);
 
 // Without pre- and post-sleep processing, lptimTick.c uses only basic sleep mode during tickless idle.
 // To utilize the stop modes and their dramatic reduction in power consumption, we employ an ultra-low-power
-// driver to handle the pre- and post-sleep hooks.
-#define configPRE_SLEEP_PROCESSING(X)  itf_pwr_pre_sleep()
+// driver to handle the pre- and post-sleep hooks.  The expected idle time lets it skip the stop modes when
+// the gap is too short to pay back their wake-up cost.
+#define configPRE_SLEEP_PROCESSING(X)  itf_pwr_pre_sleep(X)
 #define configPOST_SLEEP_PROCESSING(X) itf_pwr_post_sleep()
 
 // Make sure the self-tests in our demo application capture tick-timing information as quickly as
@@ -0,0 +1,227 @@
+/*******************************************************************************
+ * @file task_flash.c
+ * @author juanmanuel.fernandez@iertec.com
+ * @date 19 Oct 2026
+ * @brief Background scheduler of FLASH erase and program operations. The
+ * operations are queued and executed by a low priority task in bounded slices,
+ * between the tasks of higher priority.
+ * @ingroup task_flash
+ ******************************************************************************/
+
+/**
+ * @addtogroup task_flash
+ * @{
+ */
+
+#include "task_flash.h"
+#include "itf_flash.h"
+#include "itf_pwr.h"
+#include "debug_util.h"
+
+#include "stm32l4xx_hal.h"
+#include "FreeRTOS.h"
+#include "task.h"
+#include "queue.h"
+
+/****************************************************************************//*
+ * Constants and macros
+ ******************************************************************************/
+
+/** FLASH task stack size in words. */
+#define TASK_FLASH_STACK_SIZE (256)
+
+/****************************************************************************//*
+ * Private data
+ ******************************************************************************/
+
+/** Queue of pending jobs. */
+static QueueHandle_t h_task_flash_queue;
+
+/** Power control handler. */
+static uint8_t h_task_flash_pwr;
+
+/****************************************************************************//*
+ * Private code prototypes
+ ******************************************************************************/
+
+/**
+ * @brief Queue a job.
+ *
+ * @param[in] job Job to queue.
+ *
+ * @retval true The job has been queued.
+ * @retval false The queue is full.
+ */
+static bool task_flash_queue(const task_flash_job_t * job);
+
+/**
+ * @brief Execute a job slice by slice. Higher priority tasks preempt the
+ * FLASH task between slices, and the yield lets the tasks of the same priority
+ * run.
+ *
+ * @param[in] job Job to execute.
+ *
+ * @retval true Operation executed correctly.
+ * @retval false An error occurred.
+ */
+static bool task_flash_run(const task_flash_job_t * job);
+
+/**
+ * @brief Task thread.
+ *
+ * @param[in] parameters Task arguments (ignored).
+ */
+static void task_flash_thread(void * parameters);
+
+/****************************************************************************//*
+ * Public code
+ ******************************************************************************/
+
+bool
+task_flash_init (void)
+{
+    DEBUG_ASSERT_STATIC((TASK_FLASH_WRITE_SLICE % 8u) == 0u);
+
+    BaseType_t task_ret;
+
+    // The device can sleep but not stop while a job is executed
+    h_task_flash_pwr = itf_pwr_register(ITF_PWR_LEVEL_0);
+
+    if (H_ITF_PWR_NONE == h_task_flash_pwr)
+    {
+        return false;
+    }
+
+    h_task_flash_queue = xQueueCreate(TASK_FLASH_QUEUE_LEN,
+                                      sizeof(task_flash_job_t));
+
+    if (NULL == h_task_flash_queue)
+    {
+        return false;
+    }
+
+    task_ret = xTaskCreate(task_flash_thread, "FLASH", TASK_FLASH_STACK_SIZE,
+                           NULL, TASK_FLASH_PRIORITY, NULL);
+
+    return pdPASS == task_ret;
+}
+
+bool
+task_flash_erase (uint32_t address, size_t length, task_flash_cb cb,
+                  void * arg)
+{
+    DEBUG_ASSERT(length > 0u);
+
+    task_flash_job_t job =
+    {
+        .op      = TASK_FLASH_OP_ERASE,
+        .address = address,
+        .data    = NULL,
+        .length  = length,
+        .cb      = cb,
+        .arg     = arg,
+    };
+
+    return task_flash_queue(&job);
+}
+
+bool
+task_flash_write (uint32_t address, const uint8_t * data, size_t length,
+                  task_flash_cb cb, void * arg)
+{
+    DEBUG_ASSERT(NULL != data);
+    DEBUG_ASSERT((address % 8u) == 0u);
+    DEBUG_ASSERT((length % 8u) == 0u);
+
+    task_flash_job_t job =
+    {
+        .op      = TASK_FLASH_OP_WRITE,
+        .address = address,
+        .data    = data,
+        .length  = length,
+        .cb      = cb,
+        .arg     = arg,
+    };
+
+    return task_flash_queue(&job);
+}
+
+/****************************************************************************//*
+ * Private code
+ ******************************************************************************/
+
+static bool
+task_flash_queue (const task_flash_job_t * job)
+{
+    DEBUG_ASSERT(NULL != h_task_flash_queue);
+
+    return xQueueSend(h_task_flash_queue, job, 0) == pdPASS;
+}
+
+static bool
+task_flash_run (const task_flash_job_t * job)
+{
+    bool ret = true;
+
+    if (TASK_FLASH_OP_ERASE == job->op)
+    {
+        uint32_t page = job->address
+                        - ((job->address - FLASH_BASE) % FLASH_PAGE_SIZE);
+
+        // One page per slice
+        for (; ret && (page < (job->address + job->length));
+             page += FLASH_PAGE_SIZE)
+        {
+            ret = itf_flash_erase(page, FLASH_PAGE_SIZE);
+            taskYIELD();
+        }
+    }
+    else
+    {
+        for (size_t offset = 0; ret && (offset < job->length);
+             offset += TASK_FLASH_WRITE_SLICE)
+        {
+            size_t length = job->length - offset;
+
+            if (length > TASK_FLASH_WRITE_SLICE)
+            {
+                length = TASK_FLASH_WRITE_SLICE;
+            }
+
+            ret = itf_flash_write(job->address + offset, &job->data[offset],
+                                  length);
+            taskYIELD();
+        }
+    }
+
+    return ret;
+}
+
+static void
+task_flash_thread (void * parameters)
+{
+    (void)parameters;
+
+    task_flash_job_t job;
+
+    for (;;)
+    {
+        if (xQueueReceive(h_task_flash_queue, &job, portMAX_DELAY) == pdPASS)
+        {
+            itf_pwr_set_active(h_task_flash_pwr);
+
+            bool ret = task_flash_run(&job);
+
+            itf_pwr_set_inactive(h_task_flash_pwr);
+
+            if (NULL != job.cb)
+            {
+                job.cb(&job, ret);
+            }
+        }
+    }
+}
+
+/** @} */
+
+/******************************** End of file *********************************/
@@ -0,0 +1,143 @@
+/*******************************************************************************
+ * @file task_flash.h
+ * @author juanmanuel.fernandez@iertec.com
+ * @date 19 Oct 2026
+ * @brief Background scheduler of FLASH erase and program operations. The
+ * operations are queued and executed by a low priority task in bounded slices,
+ * between the tasks of higher priority.
+ * @ingroup task_flash
+ ******************************************************************************/
+
+/**
+ * @defgroup task_flash task_flash
+ * @brief Background scheduler of FLASH erase and program operations.
+ *
+ * The jobs are split in slices, one page erase or
+ * @ref TASK_FLASH_WRITE_SLICE bytes programmed, so the application does not
+ * wait for the whole job. The task runs at @ref TASK_FLASH_PRIORITY: the
+ * tasks of higher priority preempt it between slices, and it shares the CPU
+ * in round robin with the tasks of the same priority, yielding after each
+ * slice. To run the jobs only when no application task is ready, every
+ * application task must have a higher priority.
+ *
+ * The slices do not hide the FLASH latency from the rest of the system. On
+ * single bank devices, as the STM32L452, the code is fetched from the FLASH
+ * that is being erased or programmed, so every instruction fetch, interrupts
+ * included, stalls until the slice ends: about 22 ms for a page erase and
+ * about 3 ms for a write slice of 256 bytes. A task or interrupt that becomes
+ * ready during a slice sees that stall whatever its priority. Code that can
+ * not tolerate it must run from RAM, or the jobs must be queued when the stall
+ * is acceptable.
+ * @{
+ */
+
+#ifndef TASK_FLASH_H
+#define TASK_FLASH_H
+
+#include <stdbool.h>
+#include <stdint.h>
+#include <stddef.h>
+
+/** Priority of the FLASH task. It shares the CPU with the application tasks
+ * of the same priority. */
+#ifndef TASK_FLASH_PRIORITY
+#define TASK_FLASH_PRIORITY     (1)
+#endif
+
+/** Maximum number of pending jobs. */
+#ifndef TASK_FLASH_QUEUE_LEN
+#define TASK_FLASH_QUEUE_LEN    (8u)
+#endif
+
+/** Number of bytes programmed in each slice. It must be a multiple of 8. */
+#ifndef TASK_FLASH_WRITE_SLICE
+#define TASK_FLASH_WRITE_SLICE  (256u)
+#endif
+
+/** @brief FLASH operations. */
+typedef enum
+{
+    TASK_FLASH_OP_ERASE,
+    TASK_FLASH_OP_WRITE,
+} task_flash_op_t;
+
+// Forward declaration needed in the callback definition
+typedef struct task_flash_job_st task_flash_job_t;
+
+/**
+ * @brief Job completion handler function prototype. It is called from the
+ * FLASH task context.
+ *
+ * @param[in] job Completed job.
+ * @param[in] result true if the operation was executed correctly, false
+ * otherwise.
+ */
+typedef void (* task_flash_cb)(const task_flash_job_t * job, bool result);
+
+/** @brief FLASH job. */
+typedef struct task_flash_job_st
+{
+    /** Operation. */
+    task_flash_op_t op;
+
+    /** Starting address. */
+    uint32_t address;
+
+    /** Data to write. It must remain valid until the job completes. */
+    const uint8_t * data;
+
+    /** Number of bytes. */
+    size_t length;
+
+    /** Completion handler. It can be NULL. */
+    task_flash_cb cb;
+
+    /** Argument of the completion handler. */
+    void * arg;
+} task_flash_job_t;
+
+/**
+ * @brief Initialize the FLASH task resources.
+ *
+ * @retval true On success.
+ * @retval false If an error occurs.
+ */
+bool task_flash_init(void);
+
+/**
+ * @brief Queue the erase of the pages that contain the indicated region.
+ *
+ * @param[in] address The region starting address.
+ * @param[in] length Number of bytes to erase.
+ * @param[in] cb Completion handler. It can be NULL.
+ * @param[in] arg Argument of the completion handler.
+ *
+ * @retval true The job has been queued.
+ * @retval false The queue is full.
+ */
+bool task_flash_erase(uint32_t address, size_t length, task_flash_cb cb,
+                      void * arg);
+
+/**
+ * @brief Queue the programming of a memory region. The region must be erased
+ * when the job is executed, for example by a previous erase job.
+ *
+ * @param[in] address Starting address to be written. It must be double word
+ * aligned.
+ * @param[in] data Data to write. It must remain valid until the job completes.
+ * @param[in] length Number of bytes to write. It must be a multiple of a
+ * double word.
+ * @param[in] cb Completion handler. It can be NULL.
+ * @param[in] arg Argument of the completion handler.
+ *
+ * @retval true The job has been queued.
+ * @retval false The queue is full.
+ */
+bool task_flash_write(uint32_t address, const uint8_t * data, size_t length,
+                      task_flash_cb cb, void * arg);
+
+#endif // TASK_FLASH_H
+
+/** @} */
+
+/******************************** End of file *********************************/
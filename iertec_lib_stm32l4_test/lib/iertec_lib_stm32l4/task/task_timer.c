@@ -0,0 +1,101 @@
+/*******************************************************************************
+ * @file task_timer.c
+ * @author juanmanuel.fernandez@iertec.com
+ * @date 19 Oct 2026
+ * @brief Worker task that calls the deferred rtc_timer timeout handlers, so
+ * the tick interrupt only queues the expired timers.
+ * @ingroup task_timer
+ ******************************************************************************/
+
+/**
+ * @addtogroup task_timer
+ * @{
+ */
+
+#include "task_timer.h"
+#include "rtc_timer.h"
+
+#include "FreeRTOS.h"
+#include "task.h"
+
+/****************************************************************************//*
+ * Private data
+ ******************************************************************************/
+
+/** Timer task handler. */
+static TaskHandle_t h_task_timer;
+
+/****************************************************************************//*
+ * Private code prototypes
+ ******************************************************************************/
+
+/**
+ * @brief Wake up the timer task. It can be called from tasks and ISRs.
+ */
+static void task_timer_notify(void);
+
+/**
+ * @brief Task thread.
+ *
+ * @param[in] parameters Task arguments (ignored).
+ */
+static void task_timer_thread(void * parameters);
+
+/****************************************************************************//*
+ * Public code
+ ******************************************************************************/
+
+bool
+task_timer_init (void)
+{
+    BaseType_t task_ret;
+
+    task_ret = xTaskCreate(task_timer_thread, "TIMER", TASK_TIMER_STACK_SIZE,
+                           NULL, TASK_TIMER_PRIORITY, &h_task_timer);
+
+    if (pdPASS != task_ret)
+    {
+        return false;
+    }
+
+    rtc_timer_set_worker(task_timer_notify);
+
+    return true;
+}
+
+/****************************************************************************//*
+ * Private code
+ ******************************************************************************/
+
+static void
+task_timer_notify (void)
+{
+    if (xPortIsInsideInterrupt())
+    {
+        BaseType_t higher_priority_task_woken = pdFALSE;
+
+        vTaskNotifyGiveFromISR(h_task_timer, &higher_priority_task_woken);
+        portYIELD_FROM_ISR(higher_priority_task_woken);
+    }
+    else
+    {
+        (void)xTaskNotifyGive(h_task_timer);
+    }
+}
+
+static void
+task_timer_thread (void * parameters)
+{
+    (void)parameters;
+
+    for (;;)
+    {
+        // The notifications given meanwhile are served by the same run
+        (void)ulTaskNotifyTake(pdTRUE, portMAX_DELAY);
+        rtc_timer_run_deferred();
+    }
+}
+
+/** @} */
+
+/******************************** End of file *********************************/
@@ -0,0 +1,50 @@
+/*******************************************************************************
+ * @file task_timer.h
+ * @author juanmanuel.fernandez@iertec.com
+ * @date 19 Oct 2026
+ * @brief Worker task that calls the deferred rtc_timer timeout handlers, so
+ * the tick interrupt only queues the expired timers.
+ * @ingroup task_timer
+ ******************************************************************************/
+
+/**
+ * @defgroup task_timer task_timer
+ * @brief Worker task that calls the deferred rtc_timer timeout handlers.
+ *
+ * Once initialized, the handlers of the timers without
+ * @ref RTC_TIMER_FLAG_INLINE are called from this task, so they can take
+ * their time and use the blocking RTOS functions without delaying the tick
+ * interrupt nor the other handlers of higher priority tasks.
+ * @{
+ */
+
+#ifndef TASK_TIMER_H
+#define TASK_TIMER_H
+
+#include <stdbool.h>
+
+/** Priority of the timer task. It must be higher than the priority of the
+ * tasks whose work is started by the timers. */
+#ifndef TASK_TIMER_PRIORITY
+#define TASK_TIMER_PRIORITY   (5)
+#endif
+
+/** Timer task stack size in words. The timeout handlers run on it. */
+#ifndef TASK_TIMER_STACK_SIZE
+#define TASK_TIMER_STACK_SIZE (256)
+#endif
+
+/**
+ * @brief Initialize the timer task resources and defer the rtc_timer timeout
+ * handlers to it.
+ *
+ * @retval true On success.
+ * @retval false If an error occurs.
+ */
+bool task_timer_init(void);
+
+#endif // TASK_TIMER_H
+
+/** @} */
+
+/******************************** End of file *********************************/
@@ -0,0 +1,219 @@
+/*******************************************************************************
+ * @file energy_util.c
+ * @author juanmanuel.fernandez@iertec.com
+ * @date 19 Oct 2026
+ * @brief Energy estimation utilities. The charge consumed by each subsystem is
+ * estimated from the power statistics of @ref itf_pwr and a current model.
+ * @ingroup energy_util
+ ******************************************************************************/
+
+/**
+ * @addtogroup energy_util
+ * @{
+ */
+
+#include "energy_util.h"
+
+#include <string.h>
+
+/****************************************************************************//*
+ * Constants and macros
+ ******************************************************************************/
+
+/** Charge of 1 nAh in tenths of uAs. */
+#define ENERGY_UTIL_NAH_UAS_10 (36u)
+
+/****************************************************************************//*
+ * Private data types
+ ******************************************************************************/
+
+/** @brief Accounted peripheral. */
+typedef struct
+{
+    /** Handler of the peripheral in itf_pwr. */
+    uint8_t h_itf_pwr;
+
+    /** Subsystem tag. */
+    uint8_t tag;
+
+    /** Active current in uA. */
+    uint32_t current_ua;
+} energy_util_channel_t;
+
+/****************************************************************************//*
+ * Private data
+ ******************************************************************************/
+
+/** Current model. */
+static const energy_util_model_t * energy_util_model;
+
+/** Accounted peripherals. */
+static energy_util_channel_t energy_util_channel[ENERGY_UTIL_HANDLE_MAX];
+
+/** Number of accounted peripherals. */
+static size_t energy_util_count;
+
+/** Sample at the start of the current window. */
+static energy_util_sample_t energy_util_window;
+
+/****************************************************************************//*
+ * Private code prototypes
+ ******************************************************************************/
+
+/**
+ * @brief Compute the charge consumed by a current during a time.
+ *
+ * @param[in] current_ua Current in uA.
+ * @param[in] time Time in clock ticks.
+ *
+ * @return Charge in tenths of uAs.
+ */
+static uint64_t energy_util_charge(uint32_t current_ua, uint64_t time);
+
+/**
+ * @brief Compute the difference between two accumulated times.
+ *
+ * @param[in] start Time at the start of the window.
+ * @param[in] end Time at the end of the window.
+ *
+ * @return Time difference, 0 if the time has been reset inside the window.
+ */
+static uint64_t energy_util_diff(uint64_t start, uint64_t end);
+
+/****************************************************************************//*
+ * Public code
+ ******************************************************************************/
+
+void
+energy_util_init (const energy_util_model_t * model)
+{
+    energy_util_model = model;
+    energy_util_count = 0;
+    (void)memset(&energy_util_window, 0, sizeof(energy_util_window));
+}
+
+bool
+energy_util_register (uint8_t h_itf_pwr, uint8_t tag, uint32_t current_ua)
+{
+    if ((energy_util_count >= ENERGY_UTIL_HANDLE_MAX)
+        || (tag >= ENERGY_UTIL_TAG_COUNT))
+    {
+        return false;
+    }
+
+    energy_util_channel[energy_util_count].h_itf_pwr  = h_itf_pwr;
+    energy_util_channel[energy_util_count].tag        = tag;
+    energy_util_channel[energy_util_count].current_ua = current_ua;
+    energy_util_count++;
+
+    return true;
+}
+
+void
+energy_util_sample (energy_util_sample_t * sample)
+{
+    itf_pwr_stats_t stats;
+
+    (void)memset(sample, 0, sizeof(*sample));
+    itf_pwr_get_stats(&stats);
+
+    sample->run = stats.run;
+
+    for (size_t i = 0; i < ITF_PWR_LEVEL_COUNT; i++)
+    {
+        sample->residency[i] = stats.residency[i];
+    }
+
+    for (size_t i = 0; i < energy_util_count; i++)
+    {
+        uint8_t h_itf_pwr = energy_util_channel[i].h_itf_pwr;
+
+        sample->active[i] = itf_pwr_get_active(h_itf_pwr);
+    }
+}
+
+void
+energy_util_compute (const energy_util_sample_t * start,
+                     const energy_util_sample_t * end,
+                     energy_util_report_t * report)
+{
+    uint64_t time = energy_util_diff(start->run, end->run);
+
+    (void)memset(report, 0, sizeof(*report));
+
+    if ((NULL == energy_util_model) || (0u == energy_util_model->clock_hz))
+    {
+        return;
+    }
+
+    // The charge is accumulated in tenths of uAs and then converted, so the
+    // rounding error is not accumulated
+
+    // The core consumption depends on the power mode
+    report->window                       = time;
+    report->charge[ENERGY_UTIL_TAG_CORE] = energy_util_charge(
+        energy_util_model->run_ua, time);
+
+    for (size_t i = 0; i < ITF_PWR_LEVEL_COUNT; i++)
+    {
+        time = energy_util_diff(start->residency[i], end->residency[i]);
+
+        report->window                       += time;
+        report->charge[ENERGY_UTIL_TAG_CORE] += energy_util_charge(
+            energy_util_model->level_ua[i], time);
+    }
+
+    // The peripherals consume while they are active, whatever the power mode
+    for (size_t i = 0; i < energy_util_count; i++)
+    {
+        time = energy_util_diff(start->active[i], end->active[i]);
+
+        report->charge[energy_util_channel[i].tag] += energy_util_charge(
+            energy_util_channel[i].current_ua, time);
+    }
+
+    for (size_t i = 0; i < ENERGY_UTIL_TAG_COUNT; i++)
+    {
+        report->charge[i] /= ENERGY_UTIL_NAH_UAS_10;
+    }
+}
+
+void
+energy_util_start (void)
+{
+    energy_util_sample(&energy_util_window);
+}
+
+void
+energy_util_get_report (energy_util_report_t * report)
+{
+    energy_util_sample_t sample;
+
+    energy_util_sample(&sample);
+    energy_util_compute(&energy_util_window, &sample, report);
+}
+
+/****************************************************************************//*
+ * Private code
+ ******************************************************************************/
+
+static uint64_t
+energy_util_charge (uint32_t current_ua, uint64_t time)
+{
+    uint64_t clock_hz = energy_util_model->clock_hz;
+
+    // The time is split in whole seconds and remainder to avoid overflows
+    // without losing precision
+    return ((uint64_t)current_ua * (time / clock_hz) * 10u)
+           + (((uint64_t)current_ua * (time % clock_hz) * 10u) / clock_hz);
+}
+
+static uint64_t
+energy_util_diff (uint64_t start, uint64_t end)
+{
+    return (end > start) ? (end - start) : 0u;
+}
+
+/** @} */
+
+/******************************** End of file *********************************/
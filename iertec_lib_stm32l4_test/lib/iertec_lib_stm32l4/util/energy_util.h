@@ -0,0 +1,140 @@
+/*******************************************************************************
+ * @file energy_util.h
+ * @author juanmanuel.fernandez@iertec.com
+ * @date 19 Oct 2026
+ * @brief Energy estimation utilities. The charge consumed by each subsystem is
+ * estimated from the power statistics of @ref itf_pwr and a current model.
+ * @ingroup energy_util
+ ******************************************************************************/
+
+/**
+ * @defgroup energy_util energy_util
+ * @brief Energy estimation utilities.
+ *
+ * The core current is charged to @ref ENERGY_UTIL_TAG_CORE according to the
+ * time spent in run mode and in each power level. The active current of each
+ * registered peripheral is charged to its subsystem tag according to the time
+ * the peripheral has been active. The estimation can be run over live samples
+ * of @ref itf_pwr or over recorded samples.
+ * @{
+ */
+
+#ifndef ENERGY_UTIL_H
+#define ENERGY_UTIL_H
+
+#include "itf_pwr.h"
+
+#include <stdint.h>
+#include <stdbool.h>
+
+/** Maximum number of peripherals accounted. */
+#ifndef ENERGY_UTIL_HANDLE_MAX
+#define ENERGY_UTIL_HANDLE_MAX (16u)
+#endif
+
+/** Number of subsystem tags. */
+#ifndef ENERGY_UTIL_TAG_COUNT
+#define ENERGY_UTIL_TAG_COUNT  (8u)
+#endif
+
+/** Subsystem tag of the core consumption. */
+#define ENERGY_UTIL_TAG_CORE   (0u)
+
+/** Convert a charge from nAh to uAh. */
+#define ENERGY_UTIL_NAH_TO_UAH(X) ((X) / 1000u)
+
+/** @brief Current model. */
+typedef struct
+{
+    /** Frequency of the clock used by the power statistics in Hz. */
+    uint32_t clock_hz;
+
+    /** Core current in run mode in uA. */
+    uint32_t run_ua;
+
+    /** Core current in each power level in uA. */
+    uint32_t level_ua[ITF_PWR_LEVEL_COUNT];
+} energy_util_model_t;
+
+/** @brief Power statistics sample. The times are given in clock ticks. */
+typedef struct
+{
+    /** Time spent in run mode. */
+    uint64_t run;
+
+    /** Time spent in each power level. */
+    uint64_t residency[ITF_PWR_LEVEL_COUNT];
+
+    /** Active time of each peripheral, in registration order. */
+    uint64_t active[ENERGY_UTIL_HANDLE_MAX];
+} energy_util_sample_t;
+
+/** @brief Energy report of a window. */
+typedef struct
+{
+    /** Window length in clock ticks. */
+    uint64_t window;
+
+    /** Estimated charge of each subsystem in nAh. */
+    uint64_t charge[ENERGY_UTIL_TAG_COUNT];
+} energy_util_report_t;
+
+/**
+ * @brief Energy estimation initialization. All the registered peripherals are
+ * removed.
+ *
+ * @param[in] model Current model. It must remain valid while it is used. The
+ * clock frequency must not be 0.
+ */
+void energy_util_init(const energy_util_model_t * model);
+
+/**
+ * @brief Register a peripheral to be accounted.
+ *
+ * @param[in] h_itf_pwr Handler of the peripheral in @ref itf_pwr.
+ * @param[in] tag Subsystem tag the peripheral consumption is charged to.
+ * @param[in] current_ua Current of the peripheral while it is active in uA.
+ *
+ * @retval true The peripheral is registered.
+ * @retval false There is no room or the tag is not valid.
+ */
+bool energy_util_register(uint8_t h_itf_pwr, uint8_t tag, uint32_t current_ua);
+
+/**
+ * @brief Take a sample of the power statistics of @ref itf_pwr.
+ *
+ * @param[out] sample Power statistics sample.
+ */
+void energy_util_sample(energy_util_sample_t * sample);
+
+/**
+ * @brief Estimate the charge consumed by each subsystem between two samples.
+ * It does not depend on the hardware, so it can be used with recorded samples.
+ *
+ * @param[in] start Sample at the start of the window.
+ * @param[in] end Sample at the end of the window.
+ * @param[out] report Energy report of the window.
+ */
+void energy_util_compute(const energy_util_sample_t * start,
+                         const energy_util_sample_t * end,
+                         energy_util_report_t * report);
+
+/**
+ * @brief Start a new estimation window.
+ */
+void energy_util_start(void);
+
+/**
+ * @brief Get the energy report of the window started with
+ * @ref energy_util_start up to now. The power statistics must not be reset
+ * inside the window.
+ *
+ * @param[out] report Energy report of the window.
+ */
+void energy_util_get_report(energy_util_report_t * report);
+
+#endif // ENERGY_UTIL_H
+
+/** @} */
+
+/******************************** End of file *********************************/
@@ -17,6 +17,9 @@
 #include "stm32l4xx_hal.h"
 #include "task.h"
 
+#include <stdbool.h>
+#include <stddef.h>
+
 /****************************************************************************//*
  * Constants and macros
  ******************************************************************************/
@@ -25,10 +28,37 @@
 #define SYS_TICKS_TO_USEC(X) ((uint32_t)((uint64_t)(X) * 1000000u \
                                          / ITF_RTC_CLK_FREQ))
 
+/** Convert a 64-bit time from system ticks to microseconds. The seconds are
+ * converted apart, so the product does not overflow. */
+#define SYS_TICKS64_TO_USEC(X) \
+        ((((uint64_t)(X) / ITF_RTC_CLK_FREQ) * 1000000u) \
+         + ((((uint64_t)(X) % ITF_RTC_CLK_FREQ) * 1000000u) / ITF_RTC_CLK_FREQ))
+
 /** Convert time from microseconds to system ticks. */
 #define SYS_USEC_TO_TICKS(X) ((uint32_t)((uint64_t)(X) * ITF_RTC_CLK_FREQ \
                                          / 1000000u))
 
+/****************************************************************************//*
+ * Private data types
+ ******************************************************************************/
+
+/** @brief Task sleeping with a slack window. */
+typedef struct
+{
+    /** Sleeping task, NULL if the entry is free. */
+    TaskHandle_t task;
+
+    /** Nominal wake up time, start of the slack window. */
+    TickType_t nominal;
+} sys_sleeper_t;
+
+/****************************************************************************//*
+ * Private data
+ ******************************************************************************/
+
+/** Tasks sleeping with a slack window. */
+static sys_sleeper_t sys_sleeper[SYS_SLACK_SLEEPER_MAX];
+
 /****************************************************************************//*
  * Public code
  ******************************************************************************/
@@ -83,9 +113,14 @@ sys_get_reset_source (uint32_t * code, const char ** str)
 uint32_t
 sys_get_timestamp (void)
 {
-    uint32_t usec = SYS_TICKS_TO_USEC(itf_rtc_get_ticks());
+    // The lower bits of the 64-bit timestamp, so it wraps around cleanly
+    return (uint32_t)sys_get_timestamp64();
+}
 
-    return usec;
+uint64_t
+sys_get_timestamp64 (void)
+{
+    return SYS_TICKS64_TO_USEC(itf_rtc_get_ticks64());
 }
 
 uint32_t
@@ -143,6 +178,84 @@ sys_sleep_until_msec (uint32_t * prev_ticks, uint32_t inc_msec)
     }
 }
 
+void
+sys_sleep_until_msec_slack (uint32_t * prev_ticks, uint32_t inc_msec,
+                            uint32_t slack_msec)
+{
+    if (inc_msec == 0u)
+    {
+        *prev_ticks = xTaskGetTickCount();
+    }
+    else
+    {
+        TickType_t nominal = *prev_ticks + SYS_MSEC_TO_TICKS(inc_msec);
+        TickType_t wait    = SYS_MSEC_TO_TICKS(slack_msec);
+        TickType_t end;
+        TickType_t now;
+        size_t     slot    = SYS_SLACK_SLEEPER_MAX;
+        bool       b_woken = false;
+
+        // Register the task, so the others can wake it up once its window
+        // has started
+        vTaskSuspendAll();
+
+        for (size_t i = 0; i < SYS_SLACK_SLEEPER_MAX; i++)
+        {
+            if ((SYS_SLACK_SLEEPER_MAX == slot)
+                && (NULL == sys_sleeper[i].task))
+            {
+                slot                   = i;
+                sys_sleeper[i].task    = xTaskGetCurrentTaskHandle();
+                sys_sleeper[i].nominal = nominal;
+            }
+        }
+
+        if (SYS_SLACK_SLEEPER_MAX == slot)
+        {
+            wait = 0;
+        }
+
+        (void)xTaskResumeAll();
+
+        // Sleep until the end of the window, unless another task wakes first.
+        // The notification is latched, so a wake up given before the task
+        // blocks is not lost. A notification taken before the window has
+        // started is left from a previous sleep, and it is discarded
+        end = nominal + wait;
+        now = xTaskGetTickCount();
+
+        while (!b_woken && ((int32_t)(end - now) > 0))
+        {
+            b_woken = (0u != ulTaskNotifyTake(pdTRUE, end - now));
+            now     = xTaskGetTickCount();
+            b_woken = b_woken && ((int32_t)(now - nominal) >= 0);
+        }
+
+        vTaskSuspendAll();
+
+        if (slot < SYS_SLACK_SLEEPER_MAX)
+        {
+            sys_sleeper[slot].task = NULL;
+        }
+
+        // Share the wake up with the tasks whose window has started
+        now = xTaskGetTickCount();
+
+        for (size_t i = 0; i < SYS_SLACK_SLEEPER_MAX; i++)
+        {
+            if ((NULL != sys_sleeper[i].task)
+                && ((int32_t)(now - sys_sleeper[i].nominal) >= 0))
+            {
+                (void)xTaskNotifyGive(sys_sleeper[i].task);
+            }
+        }
+
+        (void)xTaskResumeAll();
+
+        *prev_ticks = nominal;
+    }
+}
+
 void
 sys_reset (void)
 {
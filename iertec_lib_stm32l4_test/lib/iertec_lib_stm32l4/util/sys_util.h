@@ -37,6 +37,12 @@
 /** Exit from a citical section. */
 #define SYS_EXIT_CRITICAL    taskEXIT_CRITICAL
 
+/** Maximum number of tasks sleeping at the same time with
+ * @ref sys_sleep_until_msec_slack. */
+#ifndef SYS_SLACK_SLEEPER_MAX
+#define SYS_SLACK_SLEEPER_MAX (8u)
+#endif
+
 /**
  * @brief Get the reset cause.
  *
@@ -46,12 +52,21 @@
 void sys_get_reset_source(uint32_t * code, const char ** str);
 
 /**
- * @brief Get the current timestamp since uC start up.
+ * @brief Get the current timestamp since uC start up. It wraps around every
+ * 2^32 us, so only the differences between two timestamps are valid.
  *
- * @return Timestamp in us.
+ * @return Timestamp in us, lower 32 bits.
  */
 uint32_t sys_get_timestamp(void);
 
+/**
+ * @brief Get the current timestamp since uC start up, without wrap around. It
+ * is monotonic and it can be called from tasks and ISRs.
+ *
+ * @return Timestamp in us.
+ */
+uint64_t sys_get_timestamp64(void);
+
 /**
  * @brief Compute the time difference between calls done to this function.
  *
@@ -91,6 +106,29 @@ void sys_sleep_msec(uint32_t msec);
  */
 void sys_sleep_until_msec(uint32_t * prev_ticks, uint32_t inc_msec);
 
+/**
+ * @brief Delay a task until a specified time, allowing the wake up to be
+ * delayed up to a slack time. The task sleeps until the end of its slack
+ * window, and when any task sleeping with this function wakes up, the tasks
+ * whose window has already started are woken up too. So the periodic tasks
+ * share their wake ups, and the periods are kept from the nominal times.
+ *
+ * @param[in,out] prev_ticks Pointer to a variable that holds the nominal time
+ * of the last wake up. The variable must be initialized with the current tick
+ * prior to its first use. To do it, call this function with inc_msec equal to
+ * 0.
+ * @param[in] inc_msec The cycle time period in milliseconds.
+ * @param[in] slack_msec Maximum delay of the wake up in milliseconds.
+ *
+ * @note If there are more than @ref SYS_SLACK_SLEEPER_MAX tasks sleeping, the
+ * task wakes up at its nominal time.
+ *
+ * @note The wake ups are given with the task notification, so the calling task
+ * must not wait for notifications from other sources.
+ */
+void sys_sleep_until_msec_slack(uint32_t * prev_ticks, uint32_t inc_msec,
+                                uint32_t slack_msec);
+
 /**
  * @brief Reset the uC by software.
  */
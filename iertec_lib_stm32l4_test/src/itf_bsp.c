@@ -30,6 +30,10 @@
 #include "i2c.h"
 #include "usart.h"
 
+#if defined(RTC_USE_SYNC)
+#include "rtc_sync.h"
+#endif // RTC_USE_SYNC
+
 /****************************************************************************//*
  * itf_clk board configuration
  ******************************************************************************/
@@ -224,6 +228,10 @@ itf_bsp_init (void)
     bool ret = true;
 
     ret = itf_rtc_init() && ret;
+#if defined(RTC_USE_SYNC)
+    // The time of rtc is kept by the disciplined clock on the RTC ticks
+    rtc_sync_init(itf_rtc_get_ticks64);
+#endif // RTC_USE_SYNC
     ret = itf_spi_init(H_ITF_SPI_0) && ret;
     ret = itf_i2c_init(H_ITF_I2C_0) && ret;
     ret = itf_uart_init(H_ITF_UART_0) && ret;
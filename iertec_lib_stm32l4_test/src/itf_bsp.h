@@ -80,7 +80,8 @@ typedef enum
 bool itf_bsp_ll_init(void);
 
 /**
- * @brief Initialize the rest of specific board interfaces.
+ * @brief Initialize the rest of specific board interfaces, and the
+ * disciplined clock of @ref rtc if RTC_USE_SYNC is defined.
  *
  * @return true If the interfaces are initialized correctly.
  * @return false If an error occurs.
@@ -0,0 +1,221 @@
+/*******************************************************************************
+ * @file test_itf_clk.c
+ * @author juanmanuel.fernandez@iertec.com
+ * @date 19 Oct 2026
+ * @brief Test for the clock level governor of the system clocks interface.
+ ******************************************************************************/
+
+#include "itf_clk.h"
+#include "itf_rtc.h"
+#include "sys_util.h"
+
+#include "FreeRTOS.h"
+#include "task.h"
+
+#include "unity.h"
+
+/****************************************************************************//*
+ * Dependencies
+ ******************************************************************************/
+
+// System dependencies
+TEST_FILE("system_stm32l4xx.c")
+TEST_FILE("stm32l4xx_it.c")
+TEST_FILE("sysmem.c")
+
+// FreeRTOS dependencies
+TEST_FILE("croutine.c")
+TEST_FILE("event_groups.c")
+TEST_FILE("list.c")
+TEST_FILE("queue.c")
+TEST_FILE("stream_buffer.c")
+TEST_FILE("tasks.c")
+TEST_FILE("timers.c")
+TEST_FILE("port.c")
+TEST_FILE("heap_4.c")
+TEST_FILE("cmsis_os.c")
+TEST_FILE("lptimTick.c")
+TEST_FILE("rtos_util.c")
+
+// HAL dependencies
+TEST_FILE("stm32l4xx_hal.c")
+TEST_FILE("stm32l4xx_hal_msp.c")
+TEST_FILE("stm32l4xx_hal_cortex.c")
+TEST_FILE("stm32l4xx_hal_pwr_ex.c")
+TEST_FILE("stm32l4xx_hal_pwr.c")
+TEST_FILE("stm32l4xx_hal_rcc_ex.c")
+TEST_FILE("stm32l4xx_hal_rcc.c")
+TEST_FILE("stm32l4xx_hal_tim_ex.c")
+TEST_FILE("stm32l4xx_hal_tim.c")
+TEST_FILE("stm32l4xx_hal_timebase_tim.c")
+TEST_FILE("stm32l4xx_hal_dma_ex.c")
+TEST_FILE("stm32l4xx_hal_dma.c")
+TEST_FILE("stm32l4xx_hal_exti.c")
+TEST_FILE("stm32l4xx_hal_flash_ex.c")
+TEST_FILE("stm32l4xx_hal_flash_ramfunc.c")
+TEST_FILE("stm32l4xx_hal_flash.c")
+TEST_FILE("stm32l4xx_hal_lptim.c")
+TEST_FILE("stm32l4xx_hal_gpio.c")
+TEST_FILE("stm32l4xx_hal_i2c_ex.c")
+TEST_FILE("stm32l4xx_hal_i2c.c")
+TEST_FILE("stm32l4xx_hal_spi_ex.c")
+TEST_FILE("stm32l4xx_hal_spi.c")
+TEST_FILE("stm32l4xx_hal_uart_ex.c")
+TEST_FILE("stm32l4xx_hal_uart.c")
+TEST_FILE("dma.c")
+TEST_FILE("lptim.c")
+TEST_FILE("gpio.c")
+TEST_FILE("main.c")
+TEST_FILE("spi.c")
+TEST_FILE("i2c.c")
+TEST_FILE("usart.c")
+
+// Test support dependencies
+TEST_FILE("test_main.c")
+TEST_FILE("itf_clk.c")
+TEST_FILE("itf_io.c")
+TEST_FILE("itf_pwr.c")
+TEST_FILE("itf_bsp.c")
+TEST_FILE("itf_debug_none.c")
+TEST_FILE("debug_util.c")
+
+// Test dependencies
+TEST_FILE("itf_rtc.c")
+TEST_FILE("sys_util.c")
+
+/****************************************************************************//*
+ * Constants and macros
+ ******************************************************************************/
+
+/** Sleep time used to accumulate statistics in milliseconds. */
+#define TEST_SLEEP_MSEC  (100u)
+
+/** Accepted error of the accounted time in ticks. */
+#define TEST_TICKS_DELTA (ITF_RTC_CLK_FREQ / 100u)
+
+/****************************************************************************//*
+ * Private data
+ ******************************************************************************/
+
+const char test_file_name[] = __FILE_NAME__;
+
+static uint32_t notify_count;
+
+/****************************************************************************//*
+ * Private code
+ ******************************************************************************/
+
+static void notify_cb(void)
+{
+    notify_count++;
+}
+
+static void check_level(itf_clk_level_t level, uint32_t freq, uint32_t scale)
+{
+    TEST_ASSERT_EQUAL(level, itf_clk_get_level());
+    TEST_ASSERT_EQUAL_UINT32(freq, SystemCoreClock);
+    TEST_ASSERT_EQUAL_UINT32(freq, HAL_RCC_GetHCLKFreq());
+    TEST_ASSERT_EQUAL_UINT32(scale, HAL_PWREx_GetVoltageRange());
+}
+
+/****************************************************************************//*
+ * Tests
+ ******************************************************************************/
+
+void test_itf_clk_init(void)
+{
+    TEST_ASSERT_TRUE(itf_rtc_init());
+    TEST_ASSERT_TRUE(itf_clk_add_notify(notify_cb));
+    TEST_ASSERT_TRUE(itf_clk_add_notify(notify_cb));
+
+    // The board starts at the high level
+    check_level(ITF_CLK_LEVEL_HIGH, 48000000u, PWR_REGULATOR_VOLTAGE_SCALE1);
+}
+
+void test_itf_clk_request(void)
+{
+    uint8_t h_itf_clk_1 = itf_clk_register();
+    uint8_t h_itf_clk_2 = itf_clk_register();
+
+    TEST_ASSERT_NOT_EQUAL(H_ITF_CLK_NONE, h_itf_clk_1);
+    TEST_ASSERT_NOT_EQUAL(H_ITF_CLK_NONE, h_itf_clk_2);
+
+    TEST_ASSERT_TRUE(itf_clk_set_idle(ITF_CLK_LEVEL_LOW));
+    check_level(ITF_CLK_LEVEL_LOW, 4000000u, PWR_REGULATOR_VOLTAGE_SCALE2);
+    TEST_ASSERT_EQUAL_UINT32(FLASH_LATENCY_0, __HAL_FLASH_GET_LATENCY());
+
+    // The highest requested level is applied
+    TEST_ASSERT_TRUE(itf_clk_request(h_itf_clk_1, ITF_CLK_LEVEL_MID));
+    check_level(ITF_CLK_LEVEL_MID, 24000000u, PWR_REGULATOR_VOLTAGE_SCALE2);
+    TEST_ASSERT_EQUAL_UINT32(FLASH_LATENCY_3, __HAL_FLASH_GET_LATENCY());
+
+    TEST_ASSERT_TRUE(itf_clk_request(h_itf_clk_2, ITF_CLK_LEVEL_HIGH));
+    check_level(ITF_CLK_LEVEL_HIGH, 48000000u, PWR_REGULATOR_VOLTAGE_SCALE1);
+    TEST_ASSERT_EQUAL_UINT32(FLASH_LATENCY_2, __HAL_FLASH_GET_LATENCY());
+
+    TEST_ASSERT_TRUE(itf_clk_request(h_itf_clk_1, ITF_CLK_LEVEL_LOW));
+    check_level(ITF_CLK_LEVEL_HIGH, 48000000u, PWR_REGULATOR_VOLTAGE_SCALE1);
+
+    // From the range 1 to the range 2 the flash latency is increased
+    TEST_ASSERT_TRUE(itf_clk_request(h_itf_clk_2, ITF_CLK_LEVEL_MID));
+    check_level(ITF_CLK_LEVEL_MID, 24000000u, PWR_REGULATOR_VOLTAGE_SCALE2);
+    TEST_ASSERT_EQUAL_UINT32(FLASH_LATENCY_3, __HAL_FLASH_GET_LATENCY());
+
+    TEST_ASSERT_TRUE(itf_clk_request(h_itf_clk_2, ITF_CLK_LEVEL_LOW));
+    check_level(ITF_CLK_LEVEL_LOW, 4000000u, PWR_REGULATOR_VOLTAGE_SCALE2);
+
+    TEST_ASSERT_TRUE(itf_clk_set_idle(ITF_CLK_LEVEL_HIGH));
+    check_level(ITF_CLK_LEVEL_HIGH, 48000000u, PWR_REGULATOR_VOLTAGE_SCALE1);
+}
+
+void test_itf_clk_notify(void)
+{
+    uint8_t h_itf_clk = itf_clk_register();
+
+    TEST_ASSERT_NOT_EQUAL(H_ITF_CLK_NONE, h_itf_clk);
+
+    // The function is called once for each change
+    notify_count = 0;
+    TEST_ASSERT_TRUE(itf_clk_set_idle(ITF_CLK_LEVEL_LOW));
+    TEST_ASSERT_EQUAL_UINT32(1, notify_count);
+    TEST_ASSERT_TRUE(itf_clk_request(h_itf_clk, ITF_CLK_LEVEL_LOW));
+    TEST_ASSERT_EQUAL_UINT32(1, notify_count);
+    TEST_ASSERT_TRUE(itf_clk_request(h_itf_clk, ITF_CLK_LEVEL_HIGH));
+    TEST_ASSERT_EQUAL_UINT32(2, notify_count);
+    TEST_ASSERT_TRUE(itf_clk_request(h_itf_clk, ITF_CLK_LEVEL_LOW));
+    TEST_ASSERT_EQUAL_UINT32(3, notify_count);
+    TEST_ASSERT_TRUE(itf_clk_set_idle(ITF_CLK_LEVEL_HIGH));
+    TEST_ASSERT_EQUAL_UINT32(4, notify_count);
+}
+
+void test_itf_clk_stats(void)
+{
+    itf_clk_stats_t stats;
+    uint32_t start;
+    uint32_t elapsed;
+    uint64_t total;
+
+    itf_clk_set_clock(itf_rtc_get_ticks);
+    start = itf_rtc_get_ticks();
+
+    TEST_ASSERT_TRUE(itf_clk_set_idle(ITF_CLK_LEVEL_LOW));
+    sys_sleep_msec(TEST_SLEEP_MSEC);
+    TEST_ASSERT_TRUE(itf_clk_set_idle(ITF_CLK_LEVEL_HIGH));
+
+    itf_clk_get_stats(&stats);
+    elapsed = itf_rtc_get_ticks() - start;
+
+    // The kernel tick does not depend on the core clock, so the sleep time
+    // is kept at the low level
+    TEST_ASSERT_EQUAL_UINT32(1, stats.count[ITF_CLK_LEVEL_LOW]);
+    TEST_ASSERT_EQUAL_UINT32(1, stats.count[ITF_CLK_LEVEL_HIGH]);
+    TEST_ASSERT_EQUAL_UINT32(0, stats.count[ITF_CLK_LEVEL_MID]);
+    TEST_ASSERT_UINT32_WITHIN(TEST_TICKS_DELTA,
+                              TEST_SLEEP_MSEC * ITF_RTC_CLK_FREQ / 1000u,
+                              (uint32_t)stats.residency[ITF_CLK_LEVEL_LOW]);
+    total = stats.residency[ITF_CLK_LEVEL_LOW]
+            + stats.residency[ITF_CLK_LEVEL_HIGH];
+    TEST_ASSERT_UINT32_WITHIN(TEST_TICKS_DELTA, elapsed, (uint32_t)total);
+}
+
+/******************************** End of file *********************************/
@@ -77,6 +77,7 @@ TEST_FILE("itf_debug_none.c")
 TEST_FILE("debug_util.c")
 
 // Test dependencies
+TEST_FILE("crypt_crc32.c")
 
 /****************************************************************************//*
  * Constants and macros
@@ -100,6 +101,7 @@ static const char data_val[] = "0123456789ABCDEFGHIJKLMNOPQRSTUVWXYZabcdefghijkl
 static const size_t data_val_len = sizeof(data_val) - 1;
 static uint8_t wr_data[DATA_SIZE];
 static uint8_t rd_data[DATA_SIZE];
+static uint8_t keep_data[DATA_SIZE];
 
 /****************************************************************************//*
  * Tests
@@ -172,4 +174,71 @@ void test_itf_flash_erase_partly(void)
     }
 }
 
+void test_itf_flash_update_erased(void)
+{
+    size_t count = MEMORY_ADDRESS_2 - MEMORY_ADDRESS;
+
+    for (size_t len = 0; len < MEMORY_SIZE_2; len += DATA_SIZE)
+    {
+        for (size_t i = 0; i < DATA_SIZE; i++)
+        {
+            wr_data[i] = data_val[count++ % data_val_len];
+            rd_data[i] = 0;
+        }
+
+        TEST_ASSERT_TRUE(itf_flash_update(MEMORY_ADDRESS_2 + len, wr_data,
+                                          DATA_SIZE, true));
+        TEST_ASSERT_TRUE(itf_flash_read(MEMORY_ADDRESS_2 + len, rd_data, DATA_SIZE));
+        TEST_ASSERT_EQUAL_MEMORY(wr_data, rd_data, DATA_SIZE);
+    }
+}
+
+void test_itf_flash_update_unchanged(void)
+{
+    size_t count = 0;
+
+    for (size_t len = 0; len < MEMORY_SIZE; len += DATA_SIZE)
+    {
+        for (size_t i = 0; i < DATA_SIZE; i++)
+        {
+            wr_data[i] = data_val[count++ % data_val_len];
+        }
+
+        TEST_ASSERT_TRUE(itf_flash_update(MEMORY_ADDRESS + len, wr_data,
+                                          DATA_SIZE, true));
+    }
+}
+
+void test_itf_flash_update_changed(void)
+{
+    // The rest of the rewritten pages is kept
+    TEST_ASSERT_TRUE(itf_flash_read(MEMORY_ADDRESS_2 + (DATA_SIZE / 2),
+                                    keep_data, DATA_SIZE));
+
+    // Modify a region crossing a page boundary
+    for (size_t i = 0; i < DATA_SIZE; i++)
+    {
+        wr_data[i] = ~data_val[i % data_val_len];
+        rd_data[i] = 0;
+    }
+
+    TEST_ASSERT_TRUE(itf_flash_update(MEMORY_ADDRESS_2 - (DATA_SIZE / 2),
+                                      wr_data, DATA_SIZE, true));
+    TEST_ASSERT_TRUE(itf_flash_read(MEMORY_ADDRESS_2 - (DATA_SIZE / 2), rd_data,
+                                    DATA_SIZE));
+    TEST_ASSERT_EQUAL_MEMORY(wr_data, rd_data, DATA_SIZE);
+
+    TEST_ASSERT_TRUE(itf_flash_read(MEMORY_ADDRESS_2 + (DATA_SIZE / 2), rd_data,
+                                    DATA_SIZE));
+    TEST_ASSERT_EQUAL_MEMORY(keep_data, rd_data, DATA_SIZE);
+}
+
+void test_itf_flash_update_misaligned(void)
+{
+    TEST_ASSERT_FALSE(itf_flash_update(MEMORY_ADDRESS + 1, wr_data, DATA_SIZE,
+                                       false));
+    TEST_ASSERT_FALSE(itf_flash_update(MEMORY_ADDRESS, wr_data, DATA_SIZE - 1,
+                                       false));
+}
+
 /******************************** End of file *********************************/
@@ -0,0 +1,447 @@
+/*******************************************************************************
+ * @file test_itf_pwr.c
+ * @author juanmanuel.fernandez@iertec.com
+ * @date 19 Oct 2026
+ * @brief Test for the power control system interface.
+ ******************************************************************************/
+
+#include "itf_pwr.h"
+#include "itf_rtc.h"
+#include "sys_util.h"
+
+#include "FreeRTOS.h"
+#include "task.h"
+
+#include "unity.h"
+
+/****************************************************************************//*
+ * Dependencies
+ ******************************************************************************/
+
+// System dependencies
+TEST_FILE("system_stm32l4xx.c")
+TEST_FILE("stm32l4xx_it.c")
+TEST_FILE("sysmem.c")
+
+// FreeRTOS dependencies
+TEST_FILE("croutine.c")
+TEST_FILE("event_groups.c")
+TEST_FILE("list.c")
+TEST_FILE("queue.c")
+TEST_FILE("stream_buffer.c")
+TEST_FILE("tasks.c")
+TEST_FILE("timers.c")
+TEST_FILE("port.c")
+TEST_FILE("heap_4.c")
+TEST_FILE("cmsis_os.c")
+TEST_FILE("lptimTick.c")
+TEST_FILE("rtos_util.c")
+
+// HAL dependencies
+TEST_FILE("stm32l4xx_hal.c")
+TEST_FILE("stm32l4xx_hal_msp.c")
+TEST_FILE("stm32l4xx_hal_cortex.c")
+TEST_FILE("stm32l4xx_hal_pwr_ex.c")
+TEST_FILE("stm32l4xx_hal_pwr.c")
+TEST_FILE("stm32l4xx_hal_rcc_ex.c")
+TEST_FILE("stm32l4xx_hal_rcc.c")
+TEST_FILE("stm32l4xx_hal_tim_ex.c")
+TEST_FILE("stm32l4xx_hal_tim.c")
+TEST_FILE("stm32l4xx_hal_timebase_tim.c")
+TEST_FILE("stm32l4xx_hal_dma_ex.c")
+TEST_FILE("stm32l4xx_hal_dma.c")
+TEST_FILE("stm32l4xx_hal_exti.c")
+TEST_FILE("stm32l4xx_hal_flash_ex.c")
+TEST_FILE("stm32l4xx_hal_flash_ramfunc.c")
+TEST_FILE("stm32l4xx_hal_flash.c")
+TEST_FILE("stm32l4xx_hal_lptim.c")
+TEST_FILE("stm32l4xx_hal_gpio.c")
+TEST_FILE("stm32l4xx_hal_i2c_ex.c")
+TEST_FILE("stm32l4xx_hal_i2c.c")
+TEST_FILE("stm32l4xx_hal_spi_ex.c")
+TEST_FILE("stm32l4xx_hal_spi.c")
+TEST_FILE("stm32l4xx_hal_uart_ex.c")
+TEST_FILE("stm32l4xx_hal_uart.c")
+TEST_FILE("dma.c")
+TEST_FILE("lptim.c")
+TEST_FILE("gpio.c")
+TEST_FILE("main.c")
+TEST_FILE("spi.c")
+TEST_FILE("i2c.c")
+TEST_FILE("usart.c")
+
+// Test support dependencies
+TEST_FILE("test_main.c")
+TEST_FILE("itf_clk.c")
+TEST_FILE("itf_io.c")
+TEST_FILE("itf_pwr.c")
+TEST_FILE("itf_bsp.c")
+TEST_FILE("itf_debug_none.c")
+TEST_FILE("debug_util.c")
+
+// Test dependencies
+TEST_FILE("itf_rtc.c")
+TEST_FILE("sys_util.c")
+
+/****************************************************************************//*
+ * Constants and macros
+ ******************************************************************************/
+
+/** Sleep time used to accumulate statistics in milliseconds. */
+#define TEST_SLEEP_MSEC  (100u)
+
+/** Accepted error of the accounted time in ticks. */
+#define TEST_TICKS_DELTA (ITF_RTC_CLK_FREQ / 100u)
+
+/** Duration of the race test in milliseconds. */
+#define TEST_RACE_MSEC   (2500u)
+
+/** Stack size of the race test task in words (4 bytes). */
+#define TEST_STACK_SIZE  (256)
+
+/****************************************************************************//*
+ * Private data
+ ******************************************************************************/
+
+const char test_file_name[] = __FILE_NAME__;
+
+static uint8_t h_race;
+static volatile bool race_run;
+static volatile uint32_t race_isr_count;
+static volatile uint32_t race_task_count;
+
+/****************************************************************************//*
+ * Private code
+ ******************************************************************************/
+
+static uint64_t get_total(const itf_pwr_stats_t * stats)
+{
+    uint64_t total = stats->run;
+
+    for (size_t i = 0; i < ITF_PWR_LEVEL_COUNT; i++)
+    {
+        total += stats->residency[i];
+    }
+
+    return total;
+}
+
+static void race_isr_cb(void)
+{
+    itf_pwr_set_active(h_race);
+    race_isr_count++;
+    itf_pwr_set_inactive(h_race);
+}
+
+static void race_task_fn(void * parameters)
+{
+    (void)parameters;
+
+    while (race_run)
+    {
+        itf_pwr_set_active(h_race);
+        race_task_count++;
+        itf_pwr_set_inactive(h_race);
+        vTaskDelay(1);
+    }
+
+    vTaskDelete(NULL);
+}
+
+/****************************************************************************//*
+ * Tests
+ ******************************************************************************/
+
+void test_itf_pwr_init(void)
+{
+    TEST_ASSERT_TRUE(itf_rtc_init());
+}
+
+void test_itf_pwr_reset(void)
+{
+    itf_pwr_stats_t stats;
+
+    sys_sleep_msec(TEST_SLEEP_MSEC);
+    itf_pwr_reset_stats();
+    itf_pwr_get_stats(&stats);
+
+    TEST_ASSERT_UINT32_WITHIN(TEST_TICKS_DELTA, 0, stats.run);
+
+    for (size_t i = 0; i < ITF_PWR_LEVEL_COUNT; i++)
+    {
+        TEST_ASSERT_EQUAL_UINT32(0, stats.residency[i]);
+        TEST_ASSERT_EQUAL_UINT32(0, stats.count[i]);
+    }
+}
+
+void test_itf_pwr_residency(void)
+{
+    itf_pwr_stats_t stats;
+    uint32_t start;
+    uint32_t elapsed;
+
+    itf_pwr_reset_stats();
+    start = itf_rtc_get_ticks();
+    sys_sleep_msec(TEST_SLEEP_MSEC);
+    itf_pwr_get_stats(&stats);
+    elapsed = itf_rtc_get_ticks() - start;
+
+    // The whole time is accounted and most of it sleeping
+    TEST_ASSERT_UINT32_WITHIN(TEST_TICKS_DELTA, elapsed,
+                              (uint32_t)get_total(&stats));
+    TEST_ASSERT_TRUE(get_total(&stats) - stats.run > stats.run);
+    TEST_ASSERT_TRUE(stats.count[ITF_PWR_LEVEL_1] > 0u);
+    TEST_ASSERT_TRUE(stats.residency[ITF_PWR_LEVEL_1] > 0u);
+}
+
+void test_itf_pwr_blocking(void)
+{
+    itf_pwr_stats_t stats;
+    uint8_t h_itf_pwr = itf_pwr_register(ITF_PWR_LEVEL_0);
+
+    TEST_ASSERT_NOT_EQUAL(H_ITF_PWR_NONE, h_itf_pwr);
+
+    itf_pwr_set_active(h_itf_pwr);
+    itf_pwr_reset_stats();
+    sys_sleep_msec(TEST_SLEEP_MSEC);
+    itf_pwr_get_stats(&stats);
+    itf_pwr_set_inactive(h_itf_pwr);
+
+    // The peripheral has kept the system in sleep mode the whole time
+    TEST_ASSERT_TRUE(stats.count[ITF_PWR_LEVEL_0] > 0u);
+    TEST_ASSERT_EQUAL_UINT32(0, stats.count[ITF_PWR_LEVEL_1]);
+    TEST_ASSERT_UINT32_WITHIN(TEST_TICKS_DELTA,
+                              (uint32_t)stats.residency[ITF_PWR_LEVEL_0],
+                              (uint32_t)itf_pwr_get_blocking(h_itf_pwr));
+    TEST_ASSERT_EQUAL_UINT32(0, itf_pwr_get_blocking(H_ITF_PWR_NONE));
+}
+
+void test_itf_pwr_nesting(void)
+{
+    uint8_t h_itf_pwr = itf_pwr_register(ITF_PWR_LEVEL_0);
+
+    TEST_ASSERT_NOT_EQUAL(H_ITF_PWR_NONE, h_itf_pwr);
+    TEST_ASSERT_EQUAL(ITF_PWR_LEVEL_1, itf_pwr_get_level());
+
+    itf_pwr_set_active(h_itf_pwr);
+    itf_pwr_set_active(h_itf_pwr);
+    TEST_ASSERT_EQUAL(2, itf_pwr_get_count(h_itf_pwr));
+    TEST_ASSERT_EQUAL(ITF_PWR_LEVEL_0, itf_pwr_get_level());
+
+    // The constraint is kept until the last user releases it
+    itf_pwr_set_inactive(h_itf_pwr);
+    TEST_ASSERT_EQUAL(1, itf_pwr_get_count(h_itf_pwr));
+    TEST_ASSERT_EQUAL(ITF_PWR_LEVEL_0, itf_pwr_get_level());
+
+    itf_pwr_set_inactive(h_itf_pwr);
+    TEST_ASSERT_EQUAL(0, itf_pwr_get_count(h_itf_pwr));
+    TEST_ASSERT_EQUAL(ITF_PWR_LEVEL_1, itf_pwr_get_level());
+
+    // An unbalanced release is ignored
+    itf_pwr_set_inactive(h_itf_pwr);
+    TEST_ASSERT_EQUAL(0, itf_pwr_get_count(h_itf_pwr));
+    itf_pwr_set_active(h_itf_pwr);
+    TEST_ASSERT_EQUAL(ITF_PWR_LEVEL_0, itf_pwr_get_level());
+    itf_pwr_set_inactive(h_itf_pwr);
+
+    // More nested constraints than an 8-bit count holds
+    for (uint32_t i = 0; i < 300u; i++)
+    {
+        itf_pwr_set_active(h_itf_pwr);
+    }
+
+    TEST_ASSERT_EQUAL(300, itf_pwr_get_count(h_itf_pwr));
+
+    for (uint32_t i = 0; i < 299u; i++)
+    {
+        itf_pwr_set_inactive(h_itf_pwr);
+    }
+
+    TEST_ASSERT_EQUAL(ITF_PWR_LEVEL_0, itf_pwr_get_level());
+    itf_pwr_set_inactive(h_itf_pwr);
+    TEST_ASSERT_EQUAL(ITF_PWR_LEVEL_1, itf_pwr_get_level());
+}
+
+void test_itf_pwr_level(void)
+{
+    uint8_t h_itf_pwr_2 = itf_pwr_register(ITF_PWR_LEVEL_2);
+    uint8_t h_itf_pwr_0 = itf_pwr_register(ITF_PWR_LEVEL_0);
+
+    TEST_ASSERT_NOT_EQUAL(H_ITF_PWR_NONE, h_itf_pwr_2);
+    TEST_ASSERT_NOT_EQUAL(H_ITF_PWR_NONE, h_itf_pwr_0);
+
+    // A peripheral allows the levels up to its own one, so the RTC keeps
+    // limiting the level to Stop 1
+    itf_pwr_set_active(h_itf_pwr_2);
+    TEST_ASSERT_EQUAL(ITF_PWR_LEVEL_1, itf_pwr_get_level());
+
+    itf_pwr_set_active(h_itf_pwr_0);
+    TEST_ASSERT_EQUAL(ITF_PWR_LEVEL_0, itf_pwr_get_level());
+
+    itf_pwr_set_inactive(h_itf_pwr_0);
+    itf_pwr_set_inactive(h_itf_pwr_2);
+    TEST_ASSERT_EQUAL(ITF_PWR_LEVEL_1, itf_pwr_get_level());
+}
+
+void test_itf_pwr_race(void)
+{
+    uint32_t count = 0;
+
+    h_race = itf_pwr_register(ITF_PWR_LEVEL_0);
+    TEST_ASSERT_NOT_EQUAL(H_ITF_PWR_NONE, h_race);
+
+    race_run = true;
+    race_isr_count = 0;
+    race_task_count = 0;
+    itf_rtc_set_callback(race_isr_cb);
+    TEST_ASSERT_TRUE(pdPASS == xTaskCreate(race_task_fn, NULL,
+                                           TEST_STACK_SIZE, NULL,
+                                           tskIDLE_PRIORITY + 2, NULL));
+
+    // The constraint is shared with a higher priority task and an ISR
+    uint32_t start = sys_get_timestamp();
+
+    while ((sys_get_timestamp() - start) < (TEST_RACE_MSEC * 1000u))
+    {
+        itf_pwr_set_active(h_race);
+        TEST_ASSERT_TRUE(itf_pwr_get_count(h_race) > 0u);
+        TEST_ASSERT_EQUAL(ITF_PWR_LEVEL_0, itf_pwr_get_level());
+        itf_pwr_set_inactive(h_race);
+        count++;
+    }
+
+    race_run = false;
+    itf_rtc_set_callback(NULL);
+    sys_sleep_msec(10);
+
+//    TEST_PRINTF("%u, %u, %u", count, race_task_count, race_isr_count);
+
+    TEST_ASSERT_TRUE(race_isr_count > 0u);
+    TEST_ASSERT_TRUE(race_task_count > 0u);
+    TEST_ASSERT_TRUE(count > 0u);
+    TEST_ASSERT_EQUAL(0, itf_pwr_get_count(h_race));
+    TEST_ASSERT_EQUAL(ITF_PWR_LEVEL_1, itf_pwr_get_level());
+}
+
+void test_itf_pwr_sleep_level(void)
+{
+    // The RTC limits the level to Stop 1
+    TEST_ASSERT_EQUAL(ITF_PWR_LEVEL_0, itf_pwr_get_sleep_level(0));
+    TEST_ASSERT_EQUAL(ITF_PWR_LEVEL_0,
+                      itf_pwr_get_sleep_level(ITF_PWR_LEVEL_1_BREAK_EVEN_US
+                                              - 1u));
+    TEST_ASSERT_EQUAL(ITF_PWR_LEVEL_1,
+                      itf_pwr_get_sleep_level(ITF_PWR_LEVEL_1_BREAK_EVEN_US));
+    TEST_ASSERT_EQUAL(ITF_PWR_LEVEL_1,
+                      itf_pwr_get_sleep_level(ITF_PWR_LEVEL_2_BREAK_EVEN_US));
+}
+
+void test_itf_pwr_latency(void)
+{
+    const uint32_t IDLE_US = 1000000;
+    uint8_t h_itf_pwr = itf_pwr_register(ITF_PWR_LEVEL_2);
+
+    TEST_ASSERT_NOT_EQUAL(H_ITF_PWR_NONE, h_itf_pwr);
+
+    // The stop modes have been used, so the restore time is calibrated
+    TEST_ASSERT_TRUE(itf_pwr_get_latency(ITF_PWR_LEVEL_1)
+                     > ITF_PWR_LEVEL_1_WAKEUP_US);
+
+    // Below 1 MHz, with the lowest MSI range, the restore takes longer
+    uint32_t latency      = itf_pwr_get_latency(ITF_PWR_LEVEL_1);
+    uint32_t core_clock   = SystemCoreClock;
+    uint32_t latency_slow;
+
+    taskENTER_CRITICAL();
+    SystemCoreClock = 100000u;
+    latency_slow    = itf_pwr_get_latency(ITF_PWR_LEVEL_1);
+    SystemCoreClock = core_clock;
+    taskEXIT_CRITICAL();
+
+    TEST_ASSERT_TRUE(latency_slow > latency);
+
+    // The constraint only applies while the peripheral is active
+    itf_pwr_set_latency(h_itf_pwr,
+                        itf_pwr_get_latency(ITF_PWR_LEVEL_1) - 1u);
+    TEST_ASSERT_EQUAL(ITF_PWR_LEVEL_1, itf_pwr_get_sleep_level(IDLE_US));
+
+    itf_pwr_set_active(h_itf_pwr);
+    TEST_ASSERT_EQUAL(ITF_PWR_LEVEL_0, itf_pwr_get_sleep_level(IDLE_US));
+
+    itf_pwr_set_latency(h_itf_pwr, itf_pwr_get_latency(ITF_PWR_LEVEL_1));
+    TEST_ASSERT_EQUAL(ITF_PWR_LEVEL_1, itf_pwr_get_sleep_level(IDLE_US));
+
+    itf_pwr_set_latency(h_itf_pwr, 0);
+    TEST_ASSERT_EQUAL(ITF_PWR_LEVEL_0, itf_pwr_get_sleep_level(IDLE_US));
+
+    itf_pwr_set_latency(h_itf_pwr, ITF_PWR_LATENCY_NONE);
+    TEST_ASSERT_EQUAL(ITF_PWR_LEVEL_1, itf_pwr_get_sleep_level(IDLE_US));
+
+    itf_pwr_set_inactive(h_itf_pwr);
+}
+
+void test_itf_pwr_wake(void)
+{
+    itf_pwr_stats_t stats;
+    itf_pwr_wake_stats_t wake_stats;
+    itf_pwr_wake_t wake;
+    uint32_t wakes = 0;
+    uint32_t restores = 0;
+    uint32_t start;
+
+    itf_pwr_reset_stats();
+    TEST_ASSERT_FALSE(itf_pwr_get_wake(0, &wake));
+
+    start = itf_rtc_get_ticks();
+    sys_sleep_msec(TEST_SLEEP_MSEC);
+    itf_pwr_get_wake_stats(&wake_stats);
+    itf_pwr_get_stats(&stats);
+
+    for (size_t i = 0; i < ITF_PWR_WAKE_SOURCE_COUNT; i++)
+    {
+        wakes += wake_stats.source[i];
+    }
+
+    for (size_t i = 0; i < ITF_PWR_RESTORE_BIN_COUNT; i++)
+    {
+        restores += wake_stats.restore[i];
+    }
+
+    // Every sleep ends in a wake up, and the tick timer is one of the sources
+    TEST_ASSERT_EQUAL_UINT32(stats.count[ITF_PWR_LEVEL_0]
+                             + stats.count[ITF_PWR_LEVEL_1]
+                             + stats.count[ITF_PWR_LEVEL_2], wakes);
+    TEST_ASSERT_EQUAL_UINT32(stats.count[ITF_PWR_LEVEL_1]
+                             + stats.count[ITF_PWR_LEVEL_2], restores);
+    TEST_ASSERT_TRUE(wake_stats.source[LPTIM1_IRQn] > 0u);
+
+    // The most recent wake up is timestamped inside the sleep
+    TEST_ASSERT_TRUE(itf_pwr_get_wake(0, &wake));
+    TEST_ASSERT_TRUE((wake.time - start) <= (itf_rtc_get_ticks() - start));
+    TEST_ASSERT_TRUE(wake.source <= ITF_PWR_WAKE_UNKNOWN);
+    TEST_ASSERT_TRUE(wake.level < ITF_PWR_LEVEL_COUNT);
+    TEST_ASSERT_FALSE(itf_pwr_get_wake(ITF_PWR_WAKE_LOG_SIZE, &wake));
+}
+
+void test_itf_pwr_register_max(void)
+{
+    uint8_t h_itf_pwr;
+    uint8_t h_itf_pwr_last = H_ITF_PWR_NONE;
+
+    TEST_ASSERT_EQUAL(H_ITF_PWR_NONE, itf_pwr_register(ITF_PWR_LEVEL_COUNT));
+
+    while ((h_itf_pwr = itf_pwr_register(ITF_PWR_LEVEL_0)) != H_ITF_PWR_NONE)
+    {
+        h_itf_pwr_last = h_itf_pwr;
+    }
+
+    TEST_ASSERT_EQUAL(ITF_PWR_HANDLE_MAX - 1u, h_itf_pwr_last);
+
+    // The handles beyond the first bitmap word work the same way
+    itf_pwr_set_active(h_itf_pwr_last);
+    TEST_ASSERT_EQUAL(ITF_PWR_LEVEL_0, itf_pwr_get_level());
+    itf_pwr_set_inactive(h_itf_pwr_last);
+    TEST_ASSERT_EQUAL(ITF_PWR_LEVEL_1, itf_pwr_get_level());
+}
+
+/******************************** End of file *********************************/
@@ -86,6 +86,10 @@ const char test_file_name[] = __FILE_NAME__;
 
 static bool wait_flag;
 
+/** Tick count at which the alarm callback is called. */
+static volatile uint32_t alarm_ticks;
+static volatile bool alarm_flag;
+
 /****************************************************************************//*
  * Private code
  ******************************************************************************/
@@ -95,6 +99,38 @@ static void rtc_cb(void)
     wait_flag = true;
 }
 
+static void alarm_cb(void)
+{
+    alarm_ticks = itf_rtc_get_ticks();
+    alarm_flag  = true;
+}
+
+/**
+ * Program an alarm and wait for it.
+ *
+ * @param[in] ticks Tick count of the alarm.
+ *
+ * @return Ticks elapsed from the alarm tick until the alarm callback.
+ */
+static uint32_t wait_alarm(uint32_t ticks)
+{
+    uint32_t start = itf_rtc_get_ticks();
+
+    alarm_flag = false;
+    itf_rtc_set_alarm(ticks);
+
+    while (!alarm_flag)
+    {
+        // Wait for the alarm, at most 3 seconds
+        TEST_ASSERT_TRUE(itf_rtc_get_ticks() - start < 3u * ITF_RTC_CLK_FREQ);
+    }
+
+    // The alarm is never early
+    TEST_ASSERT_TRUE((int32_t)(alarm_ticks - ticks) >= 0);
+
+    return alarm_ticks - ticks;
+}
+
 /****************************************************************************//*
  * Tests
  ******************************************************************************/
@@ -181,4 +217,79 @@ void test_itf_rtc_tick_time(void)
     }
 }
 
+void test_itf_rtc_alarm(void)
+{
+    const uint32_t OFFSET[] = {20, 1000, 10000, 40000, 100000};
+    const uint32_t LATE_MAX = ITF_RTC_ALARM_MARGIN + 2u;
+    const uint32_t SEC_MAX  = ITF_RTC_ALARM_GUARD + ITF_RTC_ALARM_MARGIN;
+    uint32_t ticks;
+
+    itf_rtc_set_alarm_callback(alarm_cb);
+
+    // Alarms in the current second and in the next ones
+    for (size_t i = 0; i < sizeof(OFFSET) / sizeof(OFFSET[0]); i++)
+    {
+        ticks = wait_alarm(itf_rtc_get_ticks() + OFFSET[i]);
+//        TEST_PRINTF("%u: %u", OFFSET[i], ticks);
+        TEST_ASSERT_TRUE(ticks <= LATE_MAX);
+    }
+
+    // Alarm in the past
+    ticks = wait_alarm(itf_rtc_get_ticks() - 100u);
+    TEST_ASSERT_TRUE(ticks <= 100u + LATE_MAX);
+
+    // Alarm near the end of a second, delivered by the seconds match
+    ticks = itf_rtc_get_ticks();
+    ticks = wait_alarm(ticks - (ticks % ITF_RTC_CLK_FREQ) + ITF_RTC_CLK_FREQ
+                       - (ITF_RTC_ALARM_GUARD / 2u));
+    TEST_ASSERT_TRUE(ticks <= SEC_MAX);
+
+    // A stopped alarm is not called, and the seconds keep running
+    ticks      = itf_rtc_get_ticks() + 1000u;
+    wait_flag  = false;
+    alarm_flag = false;
+    itf_rtc_set_alarm(ticks);
+    itf_rtc_stop_alarm();
+
+    while (!wait_flag || ((int32_t)(itf_rtc_get_ticks() - ticks) < 100))
+    {
+        // Wait for the flag to be fired and the alarm tick to pass
+    }
+
+    TEST_ASSERT_FALSE(alarm_flag);
+
+    itf_rtc_set_alarm_callback(NULL);
+}
+
+void test_itf_rtc_ticks64(void)
+{
+    uint64_t start = itf_rtc_get_ticks64();
+    uint64_t prev  = start;
+    uint64_t now;
+    uint64_t usec;
+    uint32_t ticks;
+
+    // Monotonic across the seconds matches, with the 32-bit count as the
+    // lower bits
+    do
+    {
+        ticks = itf_rtc_get_ticks();
+        now   = itf_rtc_get_ticks64();
+        TEST_ASSERT_TRUE(now >= prev);
+        TEST_ASSERT_TRUE((uint32_t)now - ticks < ITF_RTC_CLK_FREQ);
+        prev  = now;
+    } while (now - start < (3u * ITF_RTC_CLK_FREQ));
+
+    // The time count does not change the tick count
+    now = itf_rtc_get_ticks64();
+    itf_rtc_set_time(1, 0);
+    TEST_ASSERT_TRUE(itf_rtc_get_ticks64() - now < 100u);
+
+    // The timestamps are given from the same count
+    now  = itf_rtc_get_ticks64();
+    usec = sys_get_timestamp64();
+    TEST_ASSERT_TRUE(usec - (now * 1000000u / ITF_RTC_CLK_FREQ) < 1000u);
+    TEST_ASSERT_TRUE(sys_get_timestamp() - (uint32_t)usec < 1000u);
+}
+
 /******************************** End of file *********************************/
@@ -14,6 +14,7 @@
 
 #include "itf_spi.h"
 #include "itf_io.h"
+#include "itf_clk.h"
 
 #include "unity.h"
 
@@ -234,6 +235,32 @@ void test_itf_spi_mode_change(void)
     }
 }
 
+void test_itf_spi_clk_level(void)
+{
+    uint32_t prescaler = READ_BIT(SPI1->CR1, SPI_CR1_BR);
+
+    for (int i = 0; i < DATA_SIZE; i++)
+    {
+        tx_data[i] = i;
+    }
+
+    // The prescaler is derived again to keep the SPI clock frequency: 48 MHz
+    // / 32 = 4 MHz / 4 = 1 MHz
+    TEST_ASSERT_EQUAL_UINT32(SPI_BAUDRATEPRESCALER_32, prescaler);
+    TEST_ASSERT_TRUE(itf_clk_set_idle(ITF_CLK_LEVEL_LOW));
+    TEST_ASSERT_EQUAL_UINT32(SPI_BAUDRATEPRESCALER_4,
+                             READ_BIT(SPI1->CR1, SPI_CR1_BR));
+
+    itf_spi_select(H_ITF_SPI_CHIP_MODE_0);
+    TEST_ASSERT_TRUE(itf_spi_transaction(H_ITF_SPI_0, tx_data, rx_data,
+                                         DATA_SIZE));
+    itf_spi_deselect(H_ITF_SPI_CHIP_MODE_0);
+
+    TEST_ASSERT_TRUE(itf_clk_set_idle(ITF_CLK_LEVEL_HIGH));
+    TEST_ASSERT_EQUAL_UINT32(prescaler, READ_BIT(SPI1->CR1, SPI_CR1_BR));
+    TEST_ASSERT_EQUAL_UINT8_ARRAY(tx_data, rx_data, DATA_SIZE);
+}
+
 void test_itf_spi_deinit(void)
 {
     TEST_ASSERT_FALSE(itf_spi_deinit(H_ITF_SPI_COUNT));
@@ -0,0 +1,273 @@
+/*******************************************************************************
+ * @file test_task_flash.c
+ * @author juanmanuel.fernandez@iertec.com
+ * @date 19 Oct 2026
+ * @brief Integration test for the background FLASH scheduler.
+ ******************************************************************************/
+
+#include "task_flash.h"
+#include "itf_flash.h"
+#include "itf_rtc.h"
+#include "sys_util.h"
+
+#include "stm32l4xx_hal.h"
+#include <FreeRTOS.h>
+#include <task.h>
+#include <semphr.h>
+
+#include "unity.h"
+#include "assert_test_helper.h"
+
+/****************************************************************************//*
+ * Dependencies
+ ******************************************************************************/
+
+
+// System dependencies
+TEST_FILE("system_stm32l4xx.c")
+TEST_FILE("stm32l4xx_it.c")
+TEST_FILE("sysmem.c")
+
+// FreeRTOS dependencies
+TEST_FILE("croutine.c")
+TEST_FILE("event_groups.c")
+TEST_FILE("list.c")
+TEST_FILE("queue.c")
+TEST_FILE("stream_buffer.c")
+TEST_FILE("tasks.c")
+TEST_FILE("timers.c")
+TEST_FILE("port.c")
+TEST_FILE("heap_4.c")
+TEST_FILE("cmsis_os.c")
+TEST_FILE("lptimTick.c")
+TEST_FILE("rtos_util.c")
+
+// HAL dependencies
+TEST_FILE("stm32l4xx_hal.c")
+TEST_FILE("stm32l4xx_hal_msp.c")
+TEST_FILE("stm32l4xx_hal_cortex.c")
+TEST_FILE("stm32l4xx_hal_pwr_ex.c")
+TEST_FILE("stm32l4xx_hal_pwr.c")
+TEST_FILE("stm32l4xx_hal_rcc_ex.c")
+TEST_FILE("stm32l4xx_hal_rcc.c")
+TEST_FILE("stm32l4xx_hal_tim_ex.c")
+TEST_FILE("stm32l4xx_hal_tim.c")
+TEST_FILE("stm32l4xx_hal_timebase_tim.c")
+TEST_FILE("stm32l4xx_hal_dma_ex.c")
+TEST_FILE("stm32l4xx_hal_dma.c")
+TEST_FILE("stm32l4xx_hal_exti.c")
+TEST_FILE("stm32l4xx_hal_flash_ex.c")
+TEST_FILE("stm32l4xx_hal_flash_ramfunc.c")
+TEST_FILE("stm32l4xx_hal_flash.c")
+TEST_FILE("stm32l4xx_hal_lptim.c")
+TEST_FILE("stm32l4xx_hal_gpio.c")
+TEST_FILE("stm32l4xx_hal_i2c_ex.c")
+TEST_FILE("stm32l4xx_hal_i2c.c")
+TEST_FILE("stm32l4xx_hal_spi_ex.c")
+TEST_FILE("stm32l4xx_hal_spi.c")
+TEST_FILE("stm32l4xx_hal_uart_ex.c")
+TEST_FILE("stm32l4xx_hal_uart.c")
+TEST_FILE("dma.c")
+TEST_FILE("lptim.c")
+TEST_FILE("gpio.c")
+TEST_FILE("main.c")
+TEST_FILE("spi.c")
+TEST_FILE("i2c.c")
+TEST_FILE("usart.c")
+
+// Test support dependencies
+TEST_FILE("test_main.c")
+TEST_FILE("itf_clk.c")
+TEST_FILE("itf_io.c")
+TEST_FILE("itf_pwr.c")
+TEST_FILE("itf_bsp.c")
+TEST_FILE("itf_debug.c")
+TEST_FILE("debug_util.c")
+
+// Test dependencies
+TEST_FILE("itf_uart.c")
+TEST_FILE("itf_rtc.c")
+TEST_FILE("itf_flash.c")
+TEST_FILE("crypt_crc32.c")
+TEST_FILE("sys_util.c")
+
+/****************************************************************************//*
+ * Constants and macros
+ ******************************************************************************/
+
+#define MEMORY_OFFSET   (FLASH_BANK_SIZE - (FLASH_PAGE_SIZE * 10))
+#define MEMORY_ADDRESS  (FLASH_BASE + MEMORY_OFFSET)
+#define MEMORY_PAGES    (8)
+#define MEMORY_SIZE     (FLASH_PAGE_SIZE * MEMORY_PAGES)
+
+#define DATA_SIZE       (1024)
+
+#define PROBE_PRIORITY   (3)
+#define PROBE_STACK_SIZE (256)
+
+/** Maximum delay of the probe task, one page erase plus some margin. */
+#define PROBE_DELAY_MAX_USEC (30000)
+
+/****************************************************************************//*
+ * Private data
+ ******************************************************************************/
+
+const char test_file_name[] = __FILE_NAME__;
+
+static SemaphoreHandle_t h_job_done;
+static volatile bool job_result;
+static volatile uint32_t job_count;
+
+static volatile bool probe_run;
+static volatile uint32_t probe_delay_max;
+
+static uint8_t wr_data[DATA_SIZE];
+static uint8_t rd_data[DATA_SIZE];
+
+/****************************************************************************//*
+ * Private code
+ ******************************************************************************/
+
+static void job_cb(const task_flash_job_t * job, bool result)
+{
+    TEST_ASSERT_EQUAL_PTR(&job_count, job->arg);
+
+    job_result = result;
+    job_count++;
+    (void)xSemaphoreGive(h_job_done);
+}
+
+static void probe_thread(void * parameters)
+{
+    (void)parameters;
+
+    uint32_t ticks = 0;
+
+    for (;;)
+    {
+        sys_sleep_msec(1);
+
+        uint32_t diff = sys_time_diff(&ticks, NULL);
+
+        if (probe_run && (diff > probe_delay_max))
+        {
+            probe_delay_max = diff;
+        }
+    }
+}
+
+static void util_wait_job(void)
+{
+    TEST_ASSERT_TRUE(xSemaphoreTake(h_job_done, pdMS_TO_TICKS(5000)) == pdPASS);
+    TEST_ASSERT_TRUE(job_result);
+}
+
+/****************************************************************************//*
+ * Tests
+ ******************************************************************************/
+
+void test_task_flash_init(void)
+{
+    // The queued jobs and the one being executed
+    h_job_done = xSemaphoreCreateCounting(TASK_FLASH_QUEUE_LEN + 1u, 0);
+    TEST_ASSERT_NOT_NULL(h_job_done);
+
+    TEST_ASSERT_TRUE(itf_rtc_init());
+    TEST_ASSERT_TRUE(task_flash_init());
+    TEST_ASSERT_TRUE(pdPASS == xTaskCreate(probe_thread, "PROBE",
+                                           PROBE_STACK_SIZE, NULL,
+                                           PROBE_PRIORITY, NULL));
+}
+
+void test_task_flash_erase(void)
+{
+    probe_delay_max = 0;
+    probe_run = true;
+
+    TEST_ASSERT_TRUE(task_flash_erase(MEMORY_ADDRESS, MEMORY_SIZE, job_cb,
+                                      (void *)&job_count));
+    util_wait_job();
+
+    probe_run = false;
+
+    TEST_PRINTF("Probe max delay: %u us", probe_delay_max);
+    TEST_ASSERT_LESS_THAN_UINT32(PROBE_DELAY_MAX_USEC, probe_delay_max);
+
+    for (size_t len = 0; len < MEMORY_SIZE; len += DATA_SIZE)
+    {
+        TEST_ASSERT_TRUE(itf_flash_read(MEMORY_ADDRESS + len, rd_data, DATA_SIZE));
+        TEST_ASSERT_EACH_EQUAL_HEX8(0xFF, rd_data, DATA_SIZE);
+    }
+}
+
+void test_task_flash_write(void)
+{
+    uint32_t count = job_count;
+
+    for (size_t i = 0; i < DATA_SIZE; i++)
+    {
+        wr_data[i] = (uint8_t)i;
+    }
+
+    // Several jobs queued at once are executed in order. The test task has
+    // the priority of the FLASH task, so the queue is filled and drained in
+    // batches
+    for (size_t batch = 0; batch < MEMORY_SIZE;
+         batch += DATA_SIZE * TASK_FLASH_QUEUE_LEN)
+    {
+        size_t queued = 0;
+
+        for (size_t len = batch;
+             (len < MEMORY_SIZE) && (queued < TASK_FLASH_QUEUE_LEN);
+             len += DATA_SIZE)
+        {
+            TEST_ASSERT_TRUE(task_flash_write(MEMORY_ADDRESS + len, wr_data,
+                                              DATA_SIZE, job_cb,
+                                              (void *)&job_count));
+            queued++;
+        }
+
+        for (size_t i = 0; i < queued; i++)
+        {
+            util_wait_job();
+        }
+    }
+
+    TEST_ASSERT_EQUAL_UINT32(count + (MEMORY_SIZE / DATA_SIZE), job_count);
+
+    for (size_t len = 0; len < MEMORY_SIZE; len += DATA_SIZE)
+    {
+        TEST_ASSERT_TRUE(itf_flash_read(MEMORY_ADDRESS + len, rd_data, DATA_SIZE));
+        TEST_ASSERT_EQUAL_MEMORY(wr_data, rd_data, DATA_SIZE);
+    }
+}
+
+void test_task_flash_queue_full(void)
+{
+    size_t queued = 0;
+
+    while (task_flash_erase(MEMORY_ADDRESS, FLASH_PAGE_SIZE, job_cb,
+                            (void *)&job_count))
+    {
+        queued++;
+        TEST_ASSERT_LESS_OR_EQUAL(TASK_FLASH_QUEUE_LEN + 1, queued);
+    }
+
+    for (size_t i = 0; i < queued; i++)
+    {
+        util_wait_job();
+    }
+}
+
+void test_task_flash_assert(void)
+{
+    TEST_ASSERT_FAIL_ASSERT(task_flash_write(MEMORY_ADDRESS + 1, wr_data, 8,
+                                             NULL, NULL));
+    TEST_ASSERT_FAIL_ASSERT(task_flash_write(MEMORY_ADDRESS, wr_data, 7, NULL,
+                                             NULL));
+    TEST_ASSERT_FAIL_ASSERT(task_flash_write(MEMORY_ADDRESS, NULL, 8, NULL,
+                                             NULL));
+    TEST_ASSERT_FAIL_ASSERT(task_flash_erase(MEMORY_ADDRESS, 0, NULL, NULL));
+}
+
+/******************************** End of file *********************************/
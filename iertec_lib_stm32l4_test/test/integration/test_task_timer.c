@@ -0,0 +1,215 @@
+/*******************************************************************************
+ * @file test_task_timer.c
+ * @author juanmanuel.fernandez@iertec.com
+ * @date 19 Oct 2026
+ * @brief Integration test for the worker task of the deferred timer handlers.
+ ******************************************************************************/
+
+#include "task_timer.h"
+#include "rtc_timer.h"
+#include "itf_rtc.h"
+#include "sys_util.h"
+
+#include <FreeRTOS.h>
+#include <task.h>
+#include <semphr.h>
+
+#include <string.h>
+
+#include "unity.h"
+
+/****************************************************************************//*
+ * Dependencies
+ ******************************************************************************/
+
+// System dependencies
+TEST_FILE("system_stm32l4xx.c")
+TEST_FILE("stm32l4xx_it.c")
+TEST_FILE("sysmem.c")
+
+// FreeRTOS dependencies
+TEST_FILE("croutine.c")
+TEST_FILE("event_groups.c")
+TEST_FILE("list.c")
+TEST_FILE("queue.c")
+TEST_FILE("stream_buffer.c")
+TEST_FILE("tasks.c")
+TEST_FILE("timers.c")
+TEST_FILE("port.c")
+TEST_FILE("heap_4.c")
+TEST_FILE("cmsis_os.c")
+TEST_FILE("lptimTick.c")
+TEST_FILE("rtos_util.c")
+
+// HAL dependencies
+TEST_FILE("stm32l4xx_hal.c")
+TEST_FILE("stm32l4xx_hal_msp.c")
+TEST_FILE("stm32l4xx_hal_cortex.c")
+TEST_FILE("stm32l4xx_hal_pwr_ex.c")
+TEST_FILE("stm32l4xx_hal_pwr.c")
+TEST_FILE("stm32l4xx_hal_rcc_ex.c")
+TEST_FILE("stm32l4xx_hal_rcc.c")
+TEST_FILE("stm32l4xx_hal_tim_ex.c")
+TEST_FILE("stm32l4xx_hal_tim.c")
+TEST_FILE("stm32l4xx_hal_timebase_tim.c")
+TEST_FILE("stm32l4xx_hal_dma_ex.c")
+TEST_FILE("stm32l4xx_hal_dma.c")
+TEST_FILE("stm32l4xx_hal_exti.c")
+TEST_FILE("stm32l4xx_hal_flash_ex.c")
+TEST_FILE("stm32l4xx_hal_flash_ramfunc.c")
+TEST_FILE("stm32l4xx_hal_flash.c")
+TEST_FILE("stm32l4xx_hal_lptim.c")
+TEST_FILE("stm32l4xx_hal_gpio.c")
+TEST_FILE("stm32l4xx_hal_i2c_ex.c")
+TEST_FILE("stm32l4xx_hal_i2c.c")
+TEST_FILE("stm32l4xx_hal_spi_ex.c")
+TEST_FILE("stm32l4xx_hal_spi.c")
+TEST_FILE("stm32l4xx_hal_uart_ex.c")
+TEST_FILE("stm32l4xx_hal_uart.c")
+TEST_FILE("dma.c")
+TEST_FILE("lptim.c")
+TEST_FILE("gpio.c")
+TEST_FILE("main.c")
+TEST_FILE("spi.c")
+TEST_FILE("i2c.c")
+TEST_FILE("usart.c")
+
+// Test support dependencies
+TEST_FILE("test_main.c")
+TEST_FILE("itf_clk.c")
+TEST_FILE("itf_io.c")
+TEST_FILE("itf_pwr.c")
+TEST_FILE("itf_bsp.c")
+TEST_FILE("itf_debug.c")
+TEST_FILE("debug_util.c")
+
+// Test dependencies
+TEST_FILE("itf_uart.c")
+TEST_FILE("itf_rtc.c")
+TEST_FILE("rtc_timer.c")
+TEST_FILE("sys_util.c")
+
+/****************************************************************************//*
+ * Constants and macros
+ ******************************************************************************/
+
+/** Duration of the slow handler, about 10 ms. */
+#define SLOW_TICKS      (328u)
+
+/** Maximum lateness of an inline handler, 1 ms. */
+#define INLINE_LATE_MAX (33u)
+
+/****************************************************************************//*
+ * Private data
+ ******************************************************************************/
+
+const char test_file_name[] = __FILE_NAME__;
+
+static rtc_timer_t timer_deferred;
+static rtc_timer_t timer_inline;
+static rtc_timer_t timer_slow;
+
+static SemaphoreHandle_t h_done;
+
+/** Context of the last handler call. */
+static volatile bool in_isr;
+static volatile bool in_worker;
+
+/** Tick count at which the inline handler is expected and called. */
+static volatile uint32_t inline_exp;
+static volatile uint32_t inline_ticks;
+
+/****************************************************************************//*
+ * Private code
+ ******************************************************************************/
+
+static void context_cb(rtc_timer_t * timer)
+{
+    in_isr    = xPortIsInsideInterrupt() != pdFALSE;
+    in_worker = !in_isr && (strcmp(pcTaskGetName(NULL), "TIMER") == 0);
+
+    if (!in_isr)
+    {
+        (void)xSemaphoreGive(h_done);
+    }
+}
+
+static void inline_cb(rtc_timer_t * timer)
+{
+    inline_ticks = itf_rtc_get_ticks();
+}
+
+static void slow_cb(rtc_timer_t * timer)
+{
+    uint32_t start = itf_rtc_get_ticks();
+
+    while ((itf_rtc_get_ticks() - start) < SLOW_TICKS)
+    {
+        // Wait for the handler duration to pass
+    }
+
+    (void)xSemaphoreGive(h_done);
+}
+
+/****************************************************************************//*
+ * Tests
+ ******************************************************************************/
+
+void test_task_timer_init(void)
+{
+    h_done = xSemaphoreCreateBinary();
+    TEST_ASSERT_NOT_NULL(h_done);
+
+    TEST_ASSERT_TRUE(itf_rtc_init());
+    rtc_timer_init();
+    TEST_ASSERT_TRUE(task_timer_init());
+
+    // Tickless timers driven by the RTC alarm
+    itf_rtc_set_alarm_callback(rtc_timer_update);
+    rtc_timer_set_tickless(itf_rtc_get_ticks, itf_rtc_set_alarm,
+                           itf_rtc_stop_alarm);
+}
+
+void test_task_timer_deferred(void)
+{
+    rtc_timer_config(&timer_deferred, 0, context_cb);
+    rtc_timer_start(&timer_deferred, 100);
+
+    TEST_ASSERT_TRUE(xSemaphoreTake(h_done, pdMS_TO_TICKS(1000)) == pdPASS);
+    TEST_ASSERT_FALSE(in_isr);
+    TEST_ASSERT_TRUE(in_worker);
+}
+
+void test_task_timer_inline(void)
+{
+    rtc_timer_config(&timer_inline, 1, context_cb);
+    rtc_timer_set_flags(&timer_inline, RTC_TIMER_FLAG_INLINE);
+    in_isr = false;
+    rtc_timer_start(&timer_inline, 100);
+
+    sys_sleep_msec(10);
+    TEST_ASSERT_TRUE(in_isr);
+    TEST_ASSERT_FALSE(in_worker);
+}
+
+void test_task_timer_slow(void)
+{
+    // A slow deferred handler does not delay the inline ones
+    rtc_timer_config(&timer_slow, 2, slow_cb);
+    rtc_timer_config(&timer_inline, 1, inline_cb);
+    rtc_timer_set_flags(&timer_inline, RTC_TIMER_FLAG_INLINE);
+
+    inline_exp = itf_rtc_get_ticks() + 200u;
+    rtc_timer_start(&timer_slow, 100);
+    rtc_timer_start(&timer_inline, 200);
+
+    TEST_ASSERT_TRUE(xSemaphoreTake(h_done, pdMS_TO_TICKS(1000)) == pdPASS);
+    TEST_PRINTF("Inline handler late: %u ticks", inline_ticks - inline_exp);
+    TEST_ASSERT_TRUE((int32_t)(inline_ticks - inline_exp) >= 0);
+    TEST_ASSERT_LESS_THAN_UINT32(INLINE_LATE_MAX, inline_ticks - inline_exp);
+
+    rtc_timer_set_tickless(NULL, NULL, NULL);
+    rtc_timer_set_worker(NULL);
+}
+
+/******************************** End of file *********************************/
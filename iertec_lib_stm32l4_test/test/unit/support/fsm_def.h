@@ -9,7 +9,9 @@
 #define FSM_DEF_H
 
 // Maximum state hierarchy level
+#ifndef FSM_STATE_LEVEL_MAX
 #define FSM_STATE_LEVEL_MAX  (2)
+#endif
 
 #endif // FSM_DEF_H
 
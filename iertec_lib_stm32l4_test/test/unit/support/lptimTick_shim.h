@@ -0,0 +1,65 @@
+/*******************************************************************************
+ * @file lptimTick_shim.h
+ * @author juanmanuel.fernandez@iertec.com
+ * @date 19 Oct 2026
+ * @brief Shim that redirects the hardware and kernel accesses of lptimTick.c
+ * to the host model lptim_sim.
+ * @ingroup lptim_sim
+ ******************************************************************************/
+
+/**
+ * @addtogroup lptim_sim
+ * @{
+ */
+
+#ifndef LPTIMTICK_SHIM_H
+#define LPTIMTICK_SHIM_H
+
+#include "lptim_sim.h"
+
+/** @cond */
+
+#define configLPTIM_REF_CLOCK_HZ LPTIM_SIM_CLOCK_HZ
+
+#undef  RCC
+#define RCC                    (&lptim_sim_rcc)
+#undef  DBGMCU
+#define DBGMCU                 (&lptim_sim_dbgmcu)
+
+#define LPTIM                  (&lptim_sim_lptim)
+#define LPTIM_IRQn             LPTIM1_IRQn
+#define LPTIM_IRQHandler       lptim_sim_irq_handler
+
+#undef  NVIC_SetPriority
+#define NVIC_SetPriority(I, P) do {} while (0)
+#undef  NVIC_EnableIRQ
+#define NVIC_EnableIRQ(I)      do {} while (0)
+
+#undef  __WFI
+#define __WFI()                lptim_sim_wfi()
+#define __DSB()                do {} while (0)
+#define __ISB()                do {} while (0)
+#define __disable_irq()        lptim_sim_disable_irq()
+#define __enable_irq()         lptim_sim_enable_irq()
+
+#undef  portDISABLE_INTERRUPTS
+#define portDISABLE_INTERRUPTS() lptim_sim_raise_basepri()
+#undef  portENABLE_INTERRUPTS
+#define portENABLE_INTERRUPTS()  lptim_sim_clear_basepri()
+#undef  portYIELD_FROM_ISR
+#define portYIELD_FROM_ISR(X)    (void)(X)
+
+#undef  configPRE_SLEEP_PROCESSING
+#define configPRE_SLEEP_PROCESSING(X)  lptim_sim_pre_sleep()
+#undef  configPOST_SLEEP_PROCESSING
+#define configPOST_SLEEP_PROCESSING(X) do {} while (0)
+#undef  traceTICKS_DROPPED
+#define traceTICKS_DROPPED(X)          lptim_sim_ticks_dropped(X)
+
+/** @endcond */
+
+#endif // LPTIMTICK_SHIM_H
+
+/** @} */
+
+/******************************** End of file *********************************/
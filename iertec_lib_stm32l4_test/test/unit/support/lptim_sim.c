@@ -0,0 +1,502 @@
+/*******************************************************************************
+ * @file lptim_sim.c
+ * @author juanmanuel.fernandez@iertec.com
+ * @date 19 Oct 2026
+ * @brief Host model of the LPTIM used as FreeRTOS tick source, so the tickless
+ * idle code of lptimTick.c can be run by the unit tests.
+ * @ingroup lptim_sim
+ ******************************************************************************/
+
+/**
+ * @addtogroup lptim_sim
+ * @{
+ */
+
+#include "lptim_sim.h"
+#include "test_util.h"
+
+#include "unity.h"
+
+#include <string.h>
+
+/****************************************************************************//*
+ * Constants and macros
+ ******************************************************************************/
+
+/** Value of the auto reload register used by lptimTick.c. */
+#define LPTIM_SIM_ARR        (0xFFFFu)
+
+/** Minimum expected idle time to suppress the ticks, as FreeRTOS does. */
+#define LPTIM_SIM_IDLE_MIN   (2u)
+
+/****************************************************************************//*
+ * Private data types
+ ******************************************************************************/
+
+/** @brief Model state. */
+typedef struct
+{
+    /** Model counters. */
+    lptim_sim_stats_t stats;
+
+    /** Compare value used for the match. */
+    uint16_t cmp_active;
+
+    /** Compare value last written by the code. */
+    uint16_t cmp_written;
+
+    /** Counts left to complete the CMP write in progress, 0 if none. */
+    uint8_t cmp_sync;
+
+    /** Match condition in the current count. */
+    bool match;
+
+    /** CMPM is set in the next count. */
+    bool cmpm_next;
+
+    /** Interrupts masked by PRIMASK. */
+    bool primask;
+
+    /** Kernel interrupts masked by BASEPRI. */
+    bool basepri;
+
+    /** An interrupt handler is running. */
+    bool in_isr;
+
+    /** The external interrupt is pending. */
+    bool ext_pending;
+
+    /** Timer count of the external interrupt. */
+    uint64_t ext_time;
+
+    /** External interrupt handler, NULL if none is scheduled. */
+    lptim_sim_cb_t ext_cb;
+
+    /** The scheduler is suspended by the idle task. */
+    bool suspended;
+
+    /** Kernel tick count, without the pended ticks. */
+    TickType_t tick_count;
+
+    /** Ticks counted while the scheduler was suspended. */
+    TickType_t pended;
+
+    /** Kernel tick count at which the application task is unblocked. */
+    TickType_t unblock;
+
+    /** The application task is ready to run. */
+    bool ready;
+
+    /** Probability in percent of one more count when unmasking. */
+    uint8_t jitter;
+
+    /** State of the jitter pseudo random generator. */
+    uint32_t seed;
+} lptim_sim_t;
+
+/****************************************************************************//*
+ * Private data
+ ******************************************************************************/
+
+LPTIM_TypeDef lptim_sim_lptim;
+RCC_TypeDef lptim_sim_rcc;
+DBGMCU_TypeDef lptim_sim_dbgmcu;
+
+/** Model state. */
+static lptim_sim_t sim;
+
+/****************************************************************************//*
+ * Private code prototypes
+ ******************************************************************************/
+
+/**
+ * @brief Tick timer setup, implemented in lptimTick.c.
+ */
+void vPortSetupTimerInterrupt(void);
+
+/**
+ * @brief Apply the register writes done by the code since the last call.
+ */
+static void lptim_sim_sync(void);
+
+/**
+ * @brief Advance the timer one count.
+ */
+static void lptim_sim_step(void);
+
+/**
+ * @brief Check if there is any interrupt pending.
+ *
+ * @return true if an interrupt is pending, false otherwise.
+ */
+static bool lptim_sim_is_pending(void);
+
+/**
+ * @brief Run the handlers of the pending interrupts that are not masked.
+ */
+static void lptim_sim_dispatch(void);
+
+/**
+ * @brief Model the execution time of the code, adding one count at random.
+ */
+static void lptim_sim_jitter(void);
+
+/**
+ * @brief Process the pended ticks, as xTaskResumeAll does.
+ */
+static void lptim_sim_resume(void);
+
+/****************************************************************************//*
+ * Public code
+ ******************************************************************************/
+
+void
+lptim_sim_init (uint32_t seed, uint8_t jitter)
+{
+    (void)memset(&sim, 0, sizeof(sim));
+    (void)memset(&lptim_sim_lptim, 0, sizeof(lptim_sim_lptim));
+    (void)memset(&lptim_sim_rcc, 0, sizeof(lptim_sim_rcc));
+    (void)memset(&lptim_sim_dbgmcu, 0, sizeof(lptim_sim_dbgmcu));
+
+    sim.seed            = (0u != seed) ? seed : 1u;
+    sim.jitter          = jitter;
+    sim.unblock         = portMAX_DELAY;
+    lptim_sim_rcc.BDCR  = RCC_BDCR_LSERDY;
+    lptim_sim_rcc.CSR   = RCC_CSR_LSIRDY;
+
+    // The timer is started with the interrupts masked
+    sim.primask = true;
+    vPortSetupTimerInterrupt();
+    lptim_sim_sync();
+    sim.cmp_active = sim.cmp_written;
+    sim.primask    = false;
+}
+
+void
+lptim_sim_run (uint32_t counts)
+{
+    lptim_sim_dispatch();
+
+    for (uint32_t i = 0; i < counts; i++)
+    {
+        lptim_sim_step();
+        lptim_sim_dispatch();
+    }
+}
+
+void
+lptim_sim_idle (void)
+{
+    TickType_t expected = sim.unblock - sim.tick_count;
+
+    if (sim.ready)
+    {
+        return;
+    }
+
+    if (expected >= LPTIM_SIM_IDLE_MIN)
+    {
+        sim.suspended = true;
+        vPortSuppressTicksAndSleep(expected);
+        sim.suspended = false;
+        lptim_sim_resume();
+    }
+    else
+    {
+        TickType_t ticks = sim.tick_count;
+
+        // Busy wait until the next tick or event
+        while ((ticks == sim.tick_count) && !sim.ready)
+        {
+            lptim_sim_run(1);
+        }
+    }
+}
+
+void
+lptim_sim_block (TickType_t ticks)
+{
+    sim.unblock = ticks;
+    sim.ready   = (int32_t)(ticks - sim.tick_count) <= 0;
+}
+
+bool
+lptim_sim_is_ready (void)
+{
+    return sim.ready;
+}
+
+void
+lptim_sim_set_ready (void)
+{
+    sim.ready = true;
+}
+
+void
+lptim_sim_set_event (uint64_t time, lptim_sim_cb_t cb)
+{
+    sim.ext_time    = time;
+    sim.ext_cb      = cb;
+    sim.ext_pending = false;
+}
+
+void
+lptim_sim_mask (bool mask)
+{
+    sim.basepri = mask;
+
+    if (!mask)
+    {
+        lptim_sim_dispatch();
+    }
+}
+
+const lptim_sim_stats_t *
+lptim_sim_get_stats (void)
+{
+    return &sim.stats;
+}
+
+void
+lptim_sim_disable_irq (void)
+{
+    lptim_sim_sync();
+    sim.primask = true;
+}
+
+void
+lptim_sim_enable_irq (void)
+{
+    sim.primask = false;
+    lptim_sim_jitter();
+    lptim_sim_dispatch();
+}
+
+void
+lptim_sim_raise_basepri (void)
+{
+    lptim_sim_sync();
+    sim.basepri = true;
+}
+
+void
+lptim_sim_clear_basepri (void)
+{
+    sim.basepri = false;
+    lptim_sim_jitter();
+    lptim_sim_dispatch();
+}
+
+void
+lptim_sim_wfi (void)
+{
+    uint32_t counts = 0;
+
+    lptim_sim_sync();
+
+    // The core wakes up on any pending interrupt, even if it is masked
+    while (!lptim_sim_is_pending())
+    {
+        if (++counts > LPTIM_SIM_SLEEP_MAX)
+        {
+            TEST_FAIL_MESSAGE("No wake up from sleep");
+        }
+
+        lptim_sim_step();
+        sim.stats.sleep_time++;
+    }
+}
+
+void
+lptim_sim_pre_sleep (void)
+{
+    lptim_sim_sync();
+    sim.stats.sleep_count++;
+}
+
+void
+lptim_sim_ticks_dropped (uint32_t ticks)
+{
+    sim.stats.dropped += ticks;
+}
+
+BaseType_t
+xTaskIncrementTick (void)
+{
+    BaseType_t ret = pdFALSE;
+
+    sim.stats.irq_count++;
+    sim.stats.ticks++;
+
+    if (sim.suspended)
+    {
+        sim.pended++;
+    }
+    else
+    {
+        sim.tick_count++;
+
+        if (sim.tick_count == sim.unblock)
+        {
+            sim.ready = true;
+            ret       = pdTRUE;
+        }
+    }
+
+    return ret;
+}
+
+void
+vTaskStepTick (const TickType_t xTicksToJump)
+{
+    // The same check done by the kernel, the idle time must not be overslept
+    TEST_ASSERT_TRUE_MESSAGE((int32_t)(sim.unblock - sim.tick_count)
+                             >= (int32_t)xTicksToJump, "Oversleep");
+
+    sim.tick_count  += xTicksToJump;
+    sim.stats.ticks += xTicksToJump;
+}
+
+eSleepModeStatus
+eTaskConfirmSleepModeStatus (void)
+{
+    return sim.ready ? eAbortSleep : eStandardSleep;
+}
+
+/****************************************************************************//*
+ * Private code
+ ******************************************************************************/
+
+static void
+lptim_sim_sync (void)
+{
+    lptim_sim_lptim.ISR &= ~lptim_sim_lptim.ICR;
+    lptim_sim_lptim.ICR  = 0u;
+
+    if (lptim_sim_lptim.CMP != sim.cmp_written)
+    {
+        // The code must wait for CMPOK before writing CMP again
+        TEST_ASSERT_EQUAL_MESSAGE(0, sim.cmp_sync, "CMP write in progress");
+        TEST_ASSERT_NOT_EQUAL_MESSAGE(LPTIM_SIM_ARR, lptim_sim_lptim.CMP,
+                                      "CMP equal to ARR");
+
+        sim.cmp_written = (uint16_t)lptim_sim_lptim.CMP;
+        sim.cmp_sync    = LPTIM_SIM_CMPOK_DELAY;
+    }
+}
+
+static void
+lptim_sim_step (void)
+{
+    lptim_sim_sync();
+
+    sim.stats.time++;
+    lptim_sim_lptim.CNT = (uint32_t)(sim.stats.time & LPTIM_SIM_ARR);
+
+    if (sim.cmp_sync > 0u)
+    {
+        sim.cmp_sync--;
+
+        if ((LPTIM_SIM_CMPOK_DELAY - LPTIM_SIM_CMP_DELAY) == sim.cmp_sync)
+        {
+            sim.cmp_active = sim.cmp_written;
+        }
+
+        if (0u == sim.cmp_sync)
+        {
+            lptim_sim_lptim.ISR |= LPTIM_ISR_CMPOK;
+        }
+    }
+
+    // CMPM is set one count after the match condition starts
+    if (sim.cmpm_next)
+    {
+        lptim_sim_lptim.ISR |= LPTIM_ISR_CMPM;
+        sim.cmpm_next        = false;
+    }
+
+    bool match = (lptim_sim_lptim.CNT >= sim.cmp_active)
+                 && (lptim_sim_lptim.CNT != LPTIM_SIM_ARR);
+
+    if (match && !sim.match)
+    {
+        sim.cmpm_next = true;
+    }
+
+    sim.match = match;
+
+    if ((NULL != sim.ext_cb) && (sim.stats.time == sim.ext_time))
+    {
+        sim.ext_pending = true;
+    }
+}
+
+static bool
+lptim_sim_is_pending (void)
+{
+    return ((lptim_sim_lptim.ISR & lptim_sim_lptim.IER) != 0u)
+           || sim.ext_pending;
+}
+
+static void
+lptim_sim_dispatch (void)
+{
+    // Both interrupts have the kernel priority, so they do not nest
+    while (!sim.primask && !sim.basepri && !sim.in_isr)
+    {
+        lptim_sim_sync();
+
+        if (sim.ext_pending)
+        {
+            lptim_sim_cb_t cb = sim.ext_cb;
+
+            sim.ext_pending = false;
+            sim.ext_cb      = NULL;
+            sim.in_isr      = true;
+            cb();
+            sim.in_isr      = false;
+        }
+        else if ((lptim_sim_lptim.ISR & lptim_sim_lptim.IER) != 0u)
+        {
+            sim.in_isr = true;
+            lptim_sim_irq_handler();
+            sim.in_isr = false;
+            lptim_sim_sync();
+        }
+        else
+        {
+            break;
+        }
+    }
+}
+
+static void
+lptim_sim_jitter (void)
+{
+    if (sim.jitter > 0u)
+    {
+        if ((test_util_rand(&sim.seed) % 100u) < sim.jitter)
+        {
+            lptim_sim_step();
+        }
+    }
+}
+
+static void
+lptim_sim_resume (void)
+{
+    while (sim.pended > 0u)
+    {
+        sim.pended--;
+        sim.tick_count++;
+
+        if (sim.tick_count == sim.unblock)
+        {
+            sim.ready = true;
+        }
+    }
+}
+
+/** @} */
+
+/******************************** End of file *********************************/
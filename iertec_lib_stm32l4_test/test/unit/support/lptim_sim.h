@@ -0,0 +1,171 @@
+/*******************************************************************************
+ * @file lptim_sim.h
+ * @author juanmanuel.fernandez@iertec.com
+ * @date 19 Oct 2026
+ * @brief Host model of the LPTIM used as FreeRTOS tick source, so the tickless
+ * idle code of lptimTick.c can be run by the unit tests.
+ * @ingroup lptim_sim
+ ******************************************************************************/
+
+/**
+ * @defgroup lptim_sim lptim_sim
+ * @brief Host model of the LPTIM tick source.
+ *
+ * lptimTick.c is built with LPTIM_TICK_SIM defined, only for test_lptimTick,
+ * and then it includes the shim lptimTick_shim.h. The LPTIM, the interrupt
+ * masking, the sleep instructions and the kernel functions used by lptimTick.c
+ * are redirected by the shim to this model, that advances one timer count at a
+ * time. The model reproduces the LPTIM quirks
+ * that lptimTick.c works around:
+ * - The CMP writes take effect after a synchronization delay, and CMPOK is set
+ * one count after the new value is used.
+ * - A CMP write while a previous one is being synchronized is reported as a
+ * test failure.
+ * - The match condition is "CNT >= CMP && CNT != ARR", and CMPM is set one
+ * count after the condition starts.
+ *
+ * The registers are plain memory, so the writes to CMP and ICR are detected
+ * the next time the model runs, before any time elapses.
+ * @{
+ */
+
+#ifndef LPTIM_SIM_H
+#define LPTIM_SIM_H
+
+#include "FreeRTOS.h"
+#include "task.h"
+#include "stm32l4xx.h"
+
+#include <stdint.h>
+#include <stdbool.h>
+
+/** Frequency of the timer clock in Hz. */
+#define LPTIM_SIM_CLOCK_HZ    (32768u)
+
+/** Counts from a CMP write until the new value is used for the match. */
+#define LPTIM_SIM_CMP_DELAY   (2u)
+
+/** Counts from a CMP write until CMPOK is set. */
+#define LPTIM_SIM_CMPOK_DELAY (3u)
+
+/** Maximum number of counts the model sleeps waiting for an interrupt. */
+#define LPTIM_SIM_SLEEP_MAX   (0x20000u)
+
+/** @brief External interrupt callback. */
+typedef void (*lptim_sim_cb_t)(void);
+
+/** @brief Model counters, checked by the tests. */
+typedef struct
+{
+    /** Timer counts elapsed since the initialization. */
+    uint64_t time;
+
+    /** Kernel tick count, including the ticks pending to be processed. */
+    TickType_t ticks;
+
+    /** Number of calls to the pre sleep processing. */
+    uint32_t sleep_count;
+
+    /** Number of counts spent sleeping. */
+    uint64_t sleep_time;
+
+    /** Number of ticks reported as dropped. */
+    uint32_t dropped;
+
+    /** Number of tick interrupts handled. */
+    uint32_t irq_count;
+} lptim_sim_stats_t;
+
+/** LPTIM registers seen by lptimTick.c. */
+extern LPTIM_TypeDef lptim_sim_lptim;
+
+/** RCC registers seen by lptimTick.c. */
+extern RCC_TypeDef lptim_sim_rcc;
+
+/** DBGMCU registers seen by lptimTick.c. */
+extern DBGMCU_TypeDef lptim_sim_dbgmcu;
+
+/**
+ * @brief Reset the model and start the tick, see vPortSetupTimerInterrupt.
+ *
+ * @param[in] seed Seed of the execution time jitter.
+ * @param[in] jitter Probability in percent that the code takes one more count
+ * each time it unmasks the interrupts, 0 to disable the jitter.
+ */
+void lptim_sim_init(uint32_t seed, uint8_t jitter);
+
+/**
+ * @brief Run the application for a number of counts with the interrupts
+ * enabled, serving the pending interrupts.
+ *
+ * @param[in] counts Number of timer counts.
+ */
+void lptim_sim_run(uint32_t counts);
+
+/**
+ * @brief Run the idle task once. The kernel ticks are suppressed if the next
+ * task unblocks in two or more ticks, otherwise it waits for the next tick.
+ */
+void lptim_sim_idle(void);
+
+/**
+ * @brief Block the application task until a kernel tick.
+ *
+ * @param[in] ticks Kernel tick count at which the task is unblocked.
+ */
+void lptim_sim_block(TickType_t ticks);
+
+/**
+ * @brief Check if the application task is ready to run.
+ *
+ * @return true if the task is ready, false otherwise.
+ */
+bool lptim_sim_is_ready(void);
+
+/**
+ * @brief Make the application task ready. It is intended to be called from
+ * the external interrupt callback.
+ */
+void lptim_sim_set_ready(void);
+
+/**
+ * @brief Schedule an external interrupt.
+ *
+ * @param[in] time Timer count at which the interrupt is raised.
+ * @param[in] cb Interrupt handler, or NULL to cancel the interrupt.
+ */
+void lptim_sim_set_event(uint64_t time, lptim_sim_cb_t cb);
+
+/**
+ * @brief Mask the kernel interrupts, as a long critical section does.
+ *
+ * @param[in] mask true to mask the interrupts, false to unmask them.
+ */
+void lptim_sim_mask(bool mask);
+
+/**
+ * @brief Get the model counters.
+ *
+ * @return Model counters.
+ */
+const lptim_sim_stats_t * lptim_sim_get_stats(void);
+
+/** @cond */
+
+// Hooks used by lptimTick.c through lptimTick_shim.h
+void lptim_sim_disable_irq(void);
+void lptim_sim_enable_irq(void);
+void lptim_sim_raise_basepri(void);
+void lptim_sim_clear_basepri(void);
+void lptim_sim_wfi(void);
+void lptim_sim_pre_sleep(void);
+void lptim_sim_ticks_dropped(uint32_t ticks);
+void lptim_sim_irq_handler(void);
+
+/** @endcond */
+
+#endif // LPTIM_SIM_H
+
+/** @} */
+
+/******************************** End of file *********************************/
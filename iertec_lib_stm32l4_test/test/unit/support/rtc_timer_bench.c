@@ -0,0 +1,267 @@
+/*******************************************************************************
+ * @file rtc_timer_bench.c
+ * @author juanmanuel.fernandez@iertec.com
+ * @date 19 Oct 2026
+ * @brief Benchmark of the critical sections of the rtc_timer module.
+ * @ingroup rtc_timer_bench
+ ******************************************************************************/
+
+/**
+ * @addtogroup rtc_timer_bench
+ * @{
+ */
+
+#include "rtc_timer_bench.h"
+#include "rtc_timer.h"
+#include "test_util.h"
+
+#include "unity.h"
+
+/****************************************************************************//*
+ * Constants and macros
+ ******************************************************************************/
+
+/** Number of calls of each operation. */
+#ifdef TEST_TARGET
+#define RTC_TIMER_BENCH_OPS       (2000u)
+#else
+#define RTC_TIMER_BENCH_OPS       (100000u)
+#endif
+
+/** Maximum number of ticks and period of the random starts. */
+#define RTC_TIMER_BENCH_TICKS_MAX (60000u)
+
+/****************************************************************************//*
+ * Private data
+ ******************************************************************************/
+
+/** Benchmark timers. */
+static rtc_timer_t bench_timer[RTC_TIMER_BENCH_MAX];
+
+/** Sum of the times of the calls of each operation. */
+static uint64_t bench_sum[RTC_TIMER_BENCH_OP_COUNT];
+
+/** Names of the operations. */
+static const char * const bench_name[RTC_TIMER_BENCH_OP_COUNT] =
+{
+    "start", "start last", "stop", "next", "tick",
+};
+
+/** State of the pseudo random generator. */
+static uint32_t bench_seed;
+
+/** Simulated tick clock of the tickless mode. */
+static uint32_t bench_now;
+
+/** Tick of the programmed alarm. */
+static uint32_t bench_alarm_tick;
+
+/****************************************************************************//*
+ * Private code prototypes
+ ******************************************************************************/
+
+/**
+ * @brief Get a pseudo random number.
+ *
+ * @param[in] max Upper limit, not included.
+ *
+ * @return Pseudo random number.
+ */
+static uint32_t rtc_timer_bench_rand(uint32_t max);
+
+/**
+ * @brief Add the time of a call to the results of an operation.
+ *
+ * @param[in,out] result Benchmark results.
+ * @param[in] op Operation.
+ * @param[in] start Time at the start of the call.
+ */
+static void rtc_timer_bench_add(rtc_timer_bench_t * result,
+                                rtc_timer_bench_op_t op, uint32_t start);
+
+/**
+ * @brief Get the ticks of the simulated clock.
+ *
+ * @return Tick count.
+ */
+static uint32_t rtc_timer_bench_ticks(void);
+
+/**
+ * @brief Program the simulated alarm.
+ *
+ * @param[in] tick Tick of the alarm.
+ */
+static void rtc_timer_bench_alarm(uint32_t tick);
+
+/**
+ * @brief Cancel the simulated alarm.
+ */
+static void rtc_timer_bench_cancel(void);
+
+/****************************************************************************//*
+ * Public code
+ ******************************************************************************/
+
+void
+rtc_timer_bench_run (uint32_t count, rtc_timer_bench_t * result)
+{
+    uint32_t start;
+    uint32_t index;
+
+    TEST_ASSERT_TRUE((count > 0u) && (count <= RTC_TIMER_BENCH_MAX));
+
+    bench_seed = TEST_UTIL_SEED;
+    bench_now  = 0;
+    *result    = (rtc_timer_bench_t){.count = count};
+
+    for (uint32_t op = 0; op < RTC_TIMER_BENCH_OP_COUNT; op++)
+    {
+        bench_sum[op] = 0;
+    }
+
+    rtc_timer_init();
+    rtc_timer_set_tickless(rtc_timer_bench_ticks, rtc_timer_bench_alarm,
+                           rtc_timer_bench_cancel);
+
+    for (uint32_t i = 0; i < count; i++)
+    {
+        rtc_timer_config(&bench_timer[i], i, NULL);
+        rtc_timer_start(&bench_timer[i],
+                        1u + rtc_timer_bench_rand(RTC_TIMER_BENCH_TICKS_MAX));
+    }
+
+    // The random numbers are drawn out of the measurements
+    for (uint32_t i = 0; i < RTC_TIMER_BENCH_OPS; i++)
+    {
+        uint32_t ticks = 1u + rtc_timer_bench_rand(RTC_TIMER_BENCH_TICKS_MAX);
+
+        index = rtc_timer_bench_rand(count);
+        start = test_util_clock();
+        rtc_timer_start(&bench_timer[index], ticks);
+        rtc_timer_bench_add(result, RTC_TIMER_BENCH_START, start);
+    }
+
+    // The same timer stays at the end of the list
+    for (uint32_t i = 0; i < RTC_TIMER_BENCH_OPS; i++)
+    {
+        start = test_util_clock();
+        rtc_timer_start(&bench_timer[0], RTC_TIMER_BENCH_TICKS_MAX + 1u);
+        rtc_timer_bench_add(result, RTC_TIMER_BENCH_START_LAST, start);
+    }
+
+    // The stopped timer is started again out of the measurement
+    for (uint32_t i = 0; i < RTC_TIMER_BENCH_OPS; i++)
+    {
+        index = rtc_timer_bench_rand(count);
+        start = test_util_clock();
+        rtc_timer_stop(&bench_timer[index]);
+        rtc_timer_bench_add(result, RTC_TIMER_BENCH_STOP, start);
+
+        rtc_timer_start(&bench_timer[index],
+                        1u + rtc_timer_bench_rand(RTC_TIMER_BENCH_TICKS_MAX));
+    }
+
+    // A timer is restarted between the searches, so they are not the same
+    for (uint32_t i = 0; i < RTC_TIMER_BENCH_OPS; i++)
+    {
+        start = test_util_clock();
+        (void)rtc_timer_get_next();
+        rtc_timer_bench_add(result, RTC_TIMER_BENCH_NEXT, start);
+
+        index = rtc_timer_bench_rand(count);
+        rtc_timer_start(&bench_timer[index],
+                        1u + rtc_timer_bench_rand(RTC_TIMER_BENCH_TICKS_MAX));
+    }
+
+    // The periodic timers keep the number of active timers while ticking
+    for (uint32_t i = 0; i < count; i++)
+    {
+        uint32_t ticks  = 1u + rtc_timer_bench_rand(RTC_TIMER_BENCH_TICKS_MAX);
+        uint32_t period = 1u + rtc_timer_bench_rand(RTC_TIMER_BENCH_TICKS_MAX);
+
+        rtc_timer_start_periodic(&bench_timer[i], ticks, period);
+    }
+
+    for (uint32_t i = 0; i < RTC_TIMER_BENCH_OPS; i++)
+    {
+        bench_now = bench_alarm_tick;
+        start     = test_util_clock();
+        rtc_timer_update();
+        rtc_timer_bench_add(result, RTC_TIMER_BENCH_TICK, start);
+    }
+
+    for (uint32_t i = 0; i < count; i++)
+    {
+        rtc_timer_stop(&bench_timer[i]);
+    }
+
+    rtc_timer_set_tickless(NULL, NULL, NULL);
+
+    for (uint32_t op = 0; op < RTC_TIMER_BENCH_OP_COUNT; op++)
+    {
+        result->time[op].mean = (uint32_t)(bench_sum[op]
+                                           / RTC_TIMER_BENCH_OPS);
+    }
+}
+
+void
+rtc_timer_bench_print (const char * name, const rtc_timer_bench_t * result)
+{
+#ifdef TEST_TARGET
+    const char * unit = "cycles";
+#else
+    const char * unit = "ns";
+#endif
+
+    for (uint32_t op = 0; op < RTC_TIMER_BENCH_OP_COUNT; op++)
+    {
+        TEST_PRINTF("%s, %u timers, %s: %u %s mean, %u %s max", name,
+                    result->count, bench_name[op], result->time[op].mean, unit,
+                    result->time[op].max, unit);
+    }
+}
+
+/****************************************************************************//*
+ * Private code
+ ******************************************************************************/
+
+static uint32_t
+rtc_timer_bench_rand (uint32_t max)
+{
+    return test_util_rand(&bench_seed) % max;
+}
+
+static void
+rtc_timer_bench_add (rtc_timer_bench_t * result, rtc_timer_bench_op_t op,
+                     uint32_t start)
+{
+    uint32_t time = test_util_clock() - start;
+
+    bench_sum[op] += time;
+
+    if (time > result->time[op].max)
+    {
+        result->time[op].max = time;
+    }
+}
+
+static uint32_t
+rtc_timer_bench_ticks (void)
+{
+    return bench_now;
+}
+
+static void
+rtc_timer_bench_alarm (uint32_t tick)
+{
+    bench_alarm_tick = tick;
+}
+
+static void
+rtc_timer_bench_cancel (void)
+{
+}
+
+/** @} */
+
+/******************************** End of file *********************************/
@@ -0,0 +1,94 @@
+/*******************************************************************************
+ * @file rtc_timer_bench.h
+ * @author juanmanuel.fernandez@iertec.com
+ * @date 19 Oct 2026
+ * @brief Benchmark of the critical sections of the rtc_timer module.
+ * @ingroup rtc_timer_bench
+ ******************************************************************************/
+
+/**
+ * @defgroup rtc_timer_bench rtc_timer_bench
+ * @brief Benchmark of the critical sections of the rtc_timer module.
+ *
+ * Each operation of the module that runs in a critical section, or in the
+ * tick interrupt, is timed call by call, to give both its mean and its worst
+ * case time. The same workload is used for the sorted list and the timer
+ * wheel, in tickless mode, so the alarm is programmed again as it is done in
+ * the application:
+ * - Start: a random timer is restarted with a random number of ticks.
+ * - Start last: the timer with the latest expiration is restarted beyond all
+ * the others, so the list is walked twice.
+ * - Stop: a random timer is stopped.
+ * - Next: search of the next tick to process, as done before a tickless
+ * sleep. With the timer wheel, the slots are scanned.
+ * - Tick: processing of an alarm, with periodic timers that expire and are
+ * started again, and the next alarm programmed.
+ *
+ * The times are given in ns on the host, and in CPU cycles on the target. On
+ * the host the worst case times include the preemptions of the operating
+ * system, so they are only meaningful on the target.
+ * @{
+ */
+
+#ifndef RTC_TIMER_BENCH_H
+#define RTC_TIMER_BENCH_H
+
+#include <stdint.h>
+
+/** Maximum number of active timers of a benchmark run. */
+#define RTC_TIMER_BENCH_MAX (1000u)
+
+/** @brief Benchmarked operations. */
+typedef enum
+{
+    RTC_TIMER_BENCH_START = 0,
+    RTC_TIMER_BENCH_START_LAST,
+    RTC_TIMER_BENCH_STOP,
+    RTC_TIMER_BENCH_NEXT,
+    RTC_TIMER_BENCH_TICK,
+    RTC_TIMER_BENCH_OP_COUNT,
+} rtc_timer_bench_op_t;
+
+/** @brief Times of an operation. */
+typedef struct
+{
+    /** Mean time of a call. */
+    uint32_t mean;
+
+    /** Worst case time of a call. */
+    uint32_t max;
+} rtc_timer_bench_time_t;
+
+/** @brief Benchmark results of a number of active timers. */
+typedef struct
+{
+    /** Number of active timers. */
+    uint32_t count;
+
+    /** Times of each operation. */
+    rtc_timer_bench_time_t time[RTC_TIMER_BENCH_OP_COUNT];
+} rtc_timer_bench_t;
+
+/**
+ * @brief Run the benchmark with a number of active timers. The timers are
+ * stopped before returning.
+ *
+ * @param[in] count Number of active timers, up to @ref RTC_TIMER_BENCH_MAX.
+ * @param[out] result Benchmark results.
+ */
+void rtc_timer_bench_run(uint32_t count, rtc_timer_bench_t * result);
+
+/**
+ * @brief Print the benchmark results.
+ *
+ * @param[in] name Name of the timer implementation.
+ * @param[in] result Benchmark results.
+ */
+void rtc_timer_bench_print(const char * name,
+                           const rtc_timer_bench_t * result);
+
+#endif // RTC_TIMER_BENCH_H
+
+/** @} */
+
+/******************************** End of file *********************************/
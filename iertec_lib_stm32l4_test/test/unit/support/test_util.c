@@ -0,0 +1,70 @@
+/*******************************************************************************
+ * @file test_util.c
+ * @author juanmanuel.fernandez@iertec.com
+ * @date 19 Oct 2026
+ * @brief Utilities shared by the unit tests.
+ * @ingroup test_util
+ ******************************************************************************/
+
+/**
+ * @addtogroup test_util
+ * @{
+ */
+
+#ifndef TEST_TARGET
+// clock_gettime is not declared in strict C99
+#define _POSIX_C_SOURCE 199309L
+#endif
+
+#include "test_util.h"
+
+#ifdef TEST_TARGET
+#include "stm32l4xx.h"
+#else
+#include <time.h>
+#endif
+
+/****************************************************************************//*
+ * Public code
+ ******************************************************************************/
+
+uint32_t
+test_util_rand (uint32_t * p_seed)
+{
+    *p_seed ^= *p_seed << 13;
+    *p_seed ^= *p_seed >> 17;
+    *p_seed ^= *p_seed << 5;
+
+    return *p_seed;
+}
+
+#ifdef TEST_TARGET
+
+uint32_t
+test_util_clock (void)
+{
+    CoreDebug->DEMCR |= CoreDebug_DEMCR_TRCENA_Msk;
+    DWT->CTRL        |= DWT_CTRL_CYCCNTENA_Msk;
+
+    return DWT->CYCCNT;
+}
+
+#else
+
+uint32_t
+test_util_clock (void)
+{
+    struct timespec now;
+
+    // Some calls are timed one by one, clock() has not enough resolution
+    (void)clock_gettime(CLOCK_MONOTONIC, &now);
+
+    return (uint32_t)(((uint64_t)now.tv_sec * 1000000000u)
+                      + (uint64_t)now.tv_nsec);
+}
+
+#endif // TEST_TARGET
+
+/** @} */
+
+/******************************** End of file *********************************/
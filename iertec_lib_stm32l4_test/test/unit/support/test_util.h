@@ -0,0 +1,50 @@
+/*******************************************************************************
+ * @file test_util.h
+ * @author juanmanuel.fernandez@iertec.com
+ * @date 19 Oct 2026
+ * @brief Utilities shared by the unit tests.
+ * @ingroup test_util
+ ******************************************************************************/
+
+/**
+ * @defgroup test_util test_util
+ * @brief Utilities shared by the unit tests.
+ *
+ * A pseudo random generator, so the random workloads and the simulated
+ * jitters are repeatable, and a clock to measure the execution times of the
+ * benchmarks.
+ * @{
+ */
+
+#ifndef TEST_UTIL_H
+#define TEST_UTIL_H
+
+#include <stdint.h>
+
+/** Seed of the pseudo random generators of the tests. */
+#define TEST_UTIL_SEED (0x1E27EC5u)
+
+/**
+ * @brief Get the next number of a xorshift32 generator. Each user keeps its
+ * own state, so its sequence does not depend on the other users.
+ *
+ * @param[in,out] p_seed State of the generator, not 0. It is initialized with
+ * the seed, usually @ref TEST_UTIL_SEED.
+ *
+ * @return Pseudo random number.
+ */
+uint32_t test_util_rand(uint32_t * p_seed);
+
+/**
+ * @brief Get the time to measure an execution time. It wraps around, so only
+ * the differences are meaningful.
+ *
+ * @return Time in ns on the host, in CPU cycles on the target.
+ */
+uint32_t test_util_clock(void);
+
+#endif // TEST_UTIL_H
+
+/** @} */
+
+/******************************** End of file *********************************/
@@ -0,0 +1,213 @@
+/*******************************************************************************
+ * @file test_energy_util.c
+ * @author juanmanuel.fernandez@iertec.com
+ * @date 19 Oct 2026
+ * @brief Unit test for the module energy_util.
+ ******************************************************************************/
+
+#include "energy_util.h"
+
+#include "unity.h"
+
+#include <string.h>
+
+/****************************************************************************//*
+ * Dependencies
+ ******************************************************************************/
+
+const char test_file_name[] = __FILE_NAME__;
+
+// Test dependencies
+#include "mock_itf_pwr.h"
+
+/****************************************************************************//*
+ * Constants and macros
+ ******************************************************************************/
+
+#define CLOCK_HZ        (32768u)
+#define SEC(X)          ((uint64_t)(X) * CLOCK_HZ)
+
+#define TAG_RADIO       (1u)
+#define TAG_SENSOR      (2u)
+
+#define H_RADIO_TX      (3u)
+#define H_RADIO_RX      (5u)
+#define H_SENSOR        (7u)
+
+#define TRACE_LEN       (5u)
+
+/****************************************************************************//*
+ * Private data
+ ******************************************************************************/
+
+static const energy_util_model_t model =
+{
+    .clock_hz = CLOCK_HZ,
+    .run_ua   = 3000,
+    .level_ua = {1000, 10, 2},
+};
+
+/** Recorded trace of the power statistics, one sample every 10 s. */
+static const energy_util_sample_t trace[TRACE_LEN] =
+{
+    {.run = SEC(0), .residency = {SEC(0), SEC(0), SEC(0)},
+     .active = {SEC(0), SEC(0), SEC(0)}},
+    {.run = SEC(1), .residency = {SEC(1), SEC(0), SEC(8)},
+     .active = {SEC(1), SEC(2), SEC(0)}},
+    {.run = SEC(3), .residency = {SEC(1), SEC(6), SEC(10)},
+     .active = {SEC(1), SEC(8), SEC(0)}},
+    {.run = SEC(4), .residency = {SEC(2), SEC(6), SEC(18)},
+     .active = {SEC(2), SEC(8), SEC(1)}},
+    {.run = SEC(4), .residency = {SEC(2), SEC(6), SEC(28)},
+     .active = {SEC(2), SEC(8), SEC(1)}},
+};
+
+/****************************************************************************//*
+ * Private code
+ ******************************************************************************/
+
+static void register_channels(void)
+{
+    TEST_ASSERT_TRUE(energy_util_register(H_RADIO_TX, TAG_RADIO, 1800));
+    TEST_ASSERT_TRUE(energy_util_register(H_RADIO_RX, TAG_RADIO, 360));
+    TEST_ASSERT_TRUE(energy_util_register(H_SENSOR, TAG_SENSOR, 100));
+}
+
+/****************************************************************************//*
+ * Tests
+ ******************************************************************************/
+
+void setUp(void)
+{
+    energy_util_init(&model);
+}
+
+void test_energy_util_register(void)
+{
+    TEST_ASSERT_FALSE(energy_util_register(H_RADIO_TX, ENERGY_UTIL_TAG_COUNT,
+                                           100));
+
+    for (size_t i = 0; i < ENERGY_UTIL_HANDLE_MAX; i++)
+    {
+        TEST_ASSERT_TRUE(energy_util_register(i, TAG_RADIO, 100));
+    }
+
+    TEST_ASSERT_FALSE(energy_util_register(H_RADIO_TX, TAG_RADIO, 100));
+
+    // The initialization removes the registered peripherals
+    energy_util_init(&model);
+    TEST_ASSERT_TRUE(energy_util_register(H_RADIO_TX, TAG_RADIO, 100));
+}
+
+void test_energy_util_compute(void)
+{
+    energy_util_sample_t start = {0};
+    energy_util_sample_t end = {
+        .run = SEC(36), .residency = {0, 0, SEC(3600)},
+        .active = {SEC(2), SEC(10), SEC(1) / 2}};
+    energy_util_report_t report;
+
+    register_channels();
+    energy_util_compute(&start, &end, &report);
+
+    // 3000 uA * 36 s + 2 uA * 3600 s = 30000 nAh + 2000 nAh
+    TEST_ASSERT_EQUAL_UINT32(SEC(3636), report.window);
+    TEST_ASSERT_EQUAL_UINT32(32000, report.charge[ENERGY_UTIL_TAG_CORE]);
+
+    // 1800 uA * 2 s + 360 uA * 10 s = 1000 nAh + 1000 nAh
+    TEST_ASSERT_EQUAL_UINT32(2000, report.charge[TAG_RADIO]);
+
+    // 100 uA * 0.5 s = 13.9 nAh
+    TEST_ASSERT_EQUAL_UINT32(13, report.charge[TAG_SENSOR]);
+
+    for (size_t i = TAG_SENSOR + 1u; i < ENERGY_UTIL_TAG_COUNT; i++)
+    {
+        TEST_ASSERT_EQUAL_UINT32(0, report.charge[i]);
+    }
+}
+
+void test_energy_util_compute_trace(void)
+{
+    energy_util_report_t total;
+    energy_util_report_t report;
+    uint64_t window = 0;
+    uint64_t charge[ENERGY_UTIL_TAG_COUNT] = {0};
+
+    register_channels();
+    energy_util_compute(&trace[0], &trace[TRACE_LEN - 1u], &total);
+
+    // The windows of the trace add up to the whole trace, except rounding
+    for (size_t i = 1; i < TRACE_LEN; i++)
+    {
+        energy_util_compute(&trace[i - 1u], &trace[i], &report);
+        TEST_ASSERT_EQUAL_UINT32(SEC(10), report.window);
+
+        window += report.window;
+
+        for (size_t j = 0; j < ENERGY_UTIL_TAG_COUNT; j++)
+        {
+            charge[j] += report.charge[j];
+        }
+    }
+
+    TEST_ASSERT_EQUAL_UINT32(total.window, window);
+
+    for (size_t j = 0; j < ENERGY_UTIL_TAG_COUNT; j++)
+    {
+        TEST_ASSERT_UINT32_WITHIN(TRACE_LEN, total.charge[j], charge[j]);
+    }
+
+    // 3000 uA * 4 s + 1000 uA * 2 s + 10 uA * 6 s + 2 uA * 28 s
+    TEST_ASSERT_EQUAL_UINT32(3921, total.charge[ENERGY_UTIL_TAG_CORE]);
+}
+
+void test_energy_util_compute_reset(void)
+{
+    energy_util_report_t report;
+
+    register_channels();
+
+    // A reset of the statistics inside the window is not accounted
+    energy_util_compute(&trace[TRACE_LEN - 1u], &trace[0], &report);
+
+    TEST_ASSERT_EQUAL_UINT32(0, report.window);
+
+    for (size_t j = 0; j < ENERGY_UTIL_TAG_COUNT; j++)
+    {
+        TEST_ASSERT_EQUAL_UINT32(0, report.charge[j]);
+    }
+}
+
+void test_energy_util_report(void)
+{
+    itf_pwr_stats_t stats_start = {
+        .run = SEC(10), .residency = {SEC(5), 0, SEC(100)}};
+    itf_pwr_stats_t stats_end = {
+        .run = SEC(46), .residency = {SEC(5), 0, SEC(3700)}};
+    energy_util_report_t report;
+
+    register_channels();
+
+    itf_pwr_get_stats_ExpectAnyArgs();
+    itf_pwr_get_stats_ReturnThruPtr_stats(&stats_start);
+    itf_pwr_get_active_ExpectAndReturn(H_RADIO_TX, SEC(1));
+    itf_pwr_get_active_ExpectAndReturn(H_RADIO_RX, SEC(1));
+    itf_pwr_get_active_ExpectAndReturn(H_SENSOR, 0);
+    energy_util_start();
+
+    itf_pwr_get_stats_ExpectAnyArgs();
+    itf_pwr_get_stats_ReturnThruPtr_stats(&stats_end);
+    itf_pwr_get_active_ExpectAndReturn(H_RADIO_TX, SEC(3));
+    itf_pwr_get_active_ExpectAndReturn(H_RADIO_RX, SEC(11));
+    itf_pwr_get_active_ExpectAndReturn(H_SENSOR, SEC(1) / 2);
+    energy_util_get_report(&report);
+
+    TEST_ASSERT_EQUAL_UINT32(SEC(3636), report.window);
+    TEST_ASSERT_EQUAL_UINT32(32000, report.charge[ENERGY_UTIL_TAG_CORE]);
+    TEST_ASSERT_EQUAL_UINT32(2000, report.charge[TAG_RADIO]);
+    TEST_ASSERT_EQUAL_UINT32(13, report.charge[TAG_SENSOR]);
+    TEST_ASSERT_EQUAL_UINT32(2,
+                             ENERGY_UTIL_NAH_TO_UAH(report.charge[TAG_RADIO]));
+}
+
+/******************************** End of file *********************************/
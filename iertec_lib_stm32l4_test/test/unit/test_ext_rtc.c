@@ -0,0 +1,251 @@
+/*******************************************************************************
+ * @file test_ext_rtc.c
+ * @author juanmanuel.fernandez@iertec.com
+ * @date 19 Oct 2026
+ * @brief Unit test for the module ext_rtc. The seconds pulses and the
+ * interpolation clock are simulated, so the accuracy of the time inside the
+ * second is checked against the simulated time.
+ ******************************************************************************/
+
+#include "ext_rtc.h"
+#include "test_util.h"
+
+#include "unity.h"
+
+/****************************************************************************//*
+ * Dependencies
+ ******************************************************************************/
+
+const char test_file_name[] = __FILE_NAME__;
+
+// Test dependencies
+TEST_FILE("test_util.c")
+#include "mock_itf_io.h"
+
+/****************************************************************************//*
+ * Constants and macros
+ ******************************************************************************/
+
+/** Interval between the time reads of the simulation (s). */
+#define SIM_STEP        (0.0017)
+
+/** One tick of the nominal interpolation clock (s). */
+#define SIM_TICK        (1.0 / EXT_RTC_INTERP_FREQ)
+
+/****************************************************************************//*
+ * Private data
+ ******************************************************************************/
+
+// Board configuration
+const ext_rtc_config_t ext_rtc_config =
+{
+    .pin_tick = H_ITF_IO_IN_1,
+};
+
+/** Pulse interrupt handler registered by the driver. */
+static itf_io_int_cb_t sim_isr;
+
+/** Simulated time (s). */
+static double sim_time;
+
+/** Frequency of the interpolation clock (Hz). */
+static double sim_freq;
+
+/** Interpolation clock value at the time 0. */
+static uint32_t sim_offset;
+
+/** State of the latency pseudo random generator. */
+static uint32_t sim_seed;
+
+/****************************************************************************//*
+ * Private code
+ ******************************************************************************/
+
+static void stub_itf_io_set_int_cb(h_itf_io_t h_itf_io, itf_io_int_cb_t cb)
+{
+    TEST_ASSERT_EQUAL(H_ITF_IO_IN_1, h_itf_io);
+    sim_isr = cb;
+}
+
+static uint32_t sim_clock(void)
+{
+    return sim_offset + (uint32_t)(uint64_t)(sim_time * sim_freq);
+}
+
+static double sim_latency(double latency_max)
+{
+    uint32_t value = test_util_rand(&sim_seed);
+
+    return latency_max * (double)(value % 1000u) / 1000.0;
+}
+
+static double util_read_time(void)
+{
+    uint32_t seconds;
+    uint32_t fraction;
+
+    ext_rtc_get_time_frac(&seconds, &fraction);
+
+    return (double)seconds + ((double)fraction / 4294967296.0);
+}
+
+/**
+ * Run the simulation, reading the time between the pulses. The pulses arrive
+ * at each whole second of the simulated time, and the external RTC is set so
+ * its time is the simulated one. A lost pulse delays the RTC time one second.
+ *
+ * @param[in] seconds Number of seconds to simulate.
+ * @param[in] latency_max Maximum latency of the pulse interrupts (s).
+ * @param[in] lost Number of the pulse that is lost, 0 if none.
+ *
+ * @return Maximum error of the time read since the second pulse (s).
+ */
+static double util_run(uint32_t seconds, double latency_max, uint32_t lost)
+{
+    double   err_max = 0.0;
+    double   prev    = 0.0;
+    double   missed  = 0.0;
+    double   next    = 1.0 + sim_latency(latency_max);
+    uint32_t pulse   = 1u;
+
+    sim_time = 0.5;
+    ext_rtc_set_time(0, 0);
+
+    while (pulse <= seconds)
+    {
+        if ((sim_time + SIM_STEP) >= next)
+        {
+            sim_time = next;
+
+            if (pulse != lost)
+            {
+                sim_isr();
+            }
+            else
+            {
+                missed = 1.0;
+            }
+
+            pulse++;
+            next = (double)pulse + sim_latency(latency_max);
+        }
+        else
+        {
+            sim_time += SIM_STEP;
+        }
+
+        double read = util_read_time();
+
+        // Monotonic, and never beyond the second of the last pulse
+        TEST_ASSERT_TRUE(read >= prev);
+        TEST_ASSERT_TRUE(read < (double)pulse);
+        prev = read;
+
+        if ((pulse > 2u) && ((pulse - 1u) != lost) && ((pulse - 2u) != lost))
+        {
+            double err = sim_time - missed - read;
+
+            err     = (err < 0.0) ? -err : err;
+            err_max = (err > err_max) ? err : err_max;
+        }
+    }
+
+    return err_max;
+}
+
+/****************************************************************************//*
+ * Tests
+ ******************************************************************************/
+
+void setUp(void)
+{
+    sim_freq   = EXT_RTC_INTERP_FREQ;
+    sim_offset = 0u;
+    sim_seed   = TEST_UTIL_SEED;
+
+    // Each test gets the pulse interrupt handler from the driver
+    sim_isr = NULL;
+    itf_io_set_int_cb_Stub(stub_itf_io_set_int_cb);
+    TEST_ASSERT_TRUE(ext_rtc_init());
+}
+
+void test_ext_rtc_init(void)
+{
+    TEST_ASSERT_NOT_NULL(sim_isr);
+}
+
+void test_ext_rtc_no_clock(void)
+{
+    uint32_t seconds;
+    uint32_t fraction;
+    uint8_t  cseconds;
+
+    ext_rtc_set_clock(NULL);
+    (void)util_run(3, 0.0, 0);
+
+    ext_rtc_get_time_frac(&seconds, &fraction);
+    TEST_ASSERT_EQUAL_UINT32(3, seconds);
+    TEST_ASSERT_EQUAL_UINT32(0, fraction);
+
+    ext_rtc_get_time(&seconds, &cseconds);
+    TEST_ASSERT_EQUAL_UINT32(3, seconds);
+    TEST_ASSERT_EQUAL_UINT8(0, cseconds);
+}
+
+void test_ext_rtc_interp(void)
+{
+    uint32_t seconds;
+    uint8_t  cseconds;
+    double   err;
+
+    ext_rtc_set_clock(sim_clock);
+    err = util_run(10, 0.0, 0);
+
+    TEST_PRINTF("Maximum error: %u us", (unsigned int)(err * 1e6));
+    TEST_ASSERT_TRUE(err <= SIM_TICK);
+
+    sim_time += 0.25;
+    ext_rtc_get_time(&seconds, &cseconds);
+    TEST_ASSERT_EQUAL_UINT32(10, seconds);
+    TEST_ASSERT_EQUAL_UINT8(25, cseconds);
+}
+
+void test_ext_rtc_interp_drift(void)
+{
+    const double PPM[]   = {-200.0, -20.0, 20.0, 200.0};
+    const double LATENCY = 50e-6;
+    const double ERR_MAX = (2.0 * LATENCY) + SIM_TICK;
+    double       err;
+
+    for (size_t i = 0; i < sizeof(PPM) / sizeof(PPM[0]); i++)
+    {
+        ext_rtc_set_clock(sim_clock);
+
+        // The clock wraps around during the simulation
+        sim_freq   = EXT_RTC_INTERP_FREQ * (1.0 + (PPM[i] * 1e-6));
+        sim_offset = 0xFFFF0000u;
+        err        = util_run(20, LATENCY, 0);
+
+        TEST_PRINTF("%d ppm, maximum error: %u us", (int)PPM[i],
+                    (unsigned int)(err * 1e6));
+        TEST_ASSERT_TRUE(err <= ERR_MAX);
+    }
+}
+
+void test_ext_rtc_lost_pulse(void)
+{
+    const double PPM     = 100.0;
+    const double LATENCY = 50e-6;
+    double       err;
+
+    // The time stops at the end of the second of the lost pulse, and the
+    // double second is not used to interpolate
+    ext_rtc_set_clock(sim_clock);
+    sim_freq = EXT_RTC_INTERP_FREQ * (1.0 + (PPM * 1e-6));
+    err      = util_run(20, LATENCY, 10);
+
+    TEST_PRINTF("Maximum error: %u us", (unsigned int)(err * 1e6));
+    TEST_ASSERT_TRUE(err <= ((2.0 * LATENCY) + SIM_TICK));
+}
+
+/******************************** End of file *********************************/
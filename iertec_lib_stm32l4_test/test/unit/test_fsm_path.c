@@ -0,0 +1,462 @@
+/*******************************************************************************
+ * @file test_fsm_path.c
+ * @author juanmanuel.fernandez@iertec.com
+ * @date 19 Oct 2026
+ * @brief Unit test for the module fsm with deep state hierarchies, comparing
+ * the states with ancestor tables, the states without them and the former
+ * algorithms that walked the parent pointers.
+ ******************************************************************************/
+
+#include "fsm.h"
+#include "test_util.h"
+
+#include "unity.h"
+
+#include <string.h>
+
+/****************************************************************************//*
+ * Dependencies
+ ******************************************************************************/
+
+const char test_file_name[] = __FILE_NAME__;
+
+// Test dependencies
+TEST_FILE("test_util.c")
+
+/*******************************************************************************
+ * Constants and macros
+ ******************************************************************************/
+
+/** Depth of the branches of the test state tree. */
+#define TREE_DEPTH  (8u)
+
+#if FSM_STATE_LEVEL_MAX < 8
+#error "FSM_STATE_LEVEL_MAX must be at least the depth of the test tree"
+#endif
+
+/** Number of states of the test state tree, the top level and two branches. */
+#define STATE_COUNT (1u + (2u * TREE_DEPTH))
+
+/** Maximum number of handler calls recorded. */
+#define TRACE_MAX   (64u)
+
+/** Flags of the handler calls recorded, added to the state number. */
+#define TRACE_ENTRY (0x20u)
+#define TRACE_STATE (0x40u)
+#define TRACE_EXIT  (0x80u)
+
+/** Number of operations of each benchmark batch. */
+#ifdef TEST_TARGET
+#define BENCH_OPS   (2000u)
+#else
+#define BENCH_OPS   (1000000u)
+#endif
+
+/** State handlers, recording the calls with the state number N. */
+#define HANDLERS(ID, N)                                                        \
+    static void entry_##ID(fsm_t * const p_fsm)                                \
+    {                                                                          \
+        (void)p_fsm;                                                           \
+        util_trace(TRACE_ENTRY | (N));                                         \
+    }                                                                          \
+    static bool state_##ID(fsm_t * const p_fsm)                                \
+    {                                                                          \
+        (void)p_fsm;                                                           \
+        util_trace(TRACE_STATE | (N));                                         \
+        return ((N) == handled_by);                                            \
+    }                                                                          \
+    static void exit_##ID(fsm_t * const p_fsm)                                 \
+    {                                                                          \
+        (void)p_fsm;                                                           \
+        util_trace(TRACE_EXIT | (N));                                          \
+    }
+
+/** Definition of a state, with its ancestor table if PATH is not NULL. */
+#define STATE(ID, PARENT, LEVEL, PATH)                                         \
+    {                                                                          \
+        .handler_entry = entry_##ID,                                           \
+        .handler_state = state_##ID,                                           \
+        .handler_exit  = exit_##ID,                                            \
+        .p_parent      = PARENT,                                               \
+        .level         = LEVEL,                                                \
+        .p_path        = PATH,                                                 \
+        .name          = #ID,                                                  \
+    }
+
+/** Ancestor table, or NULL if ON is 0. */
+#define PATH(ON, ...)   PATH_##ON(__VA_ARGS__)
+#define PATH_0(...)     NULL
+#define PATH_1(...)     FSM_STATE_PATH(__VA_ARGS__)
+
+/** Branch of TREE_DEPTH states below the top level state R. */
+#define BRANCH(B, A, R, ON)                                                    \
+    {                                                                          \
+        STATE(B##1, &R,    1, PATH(ON, &R)),                                   \
+        STATE(B##2, &A[0], 2, PATH(ON, &R, &A[0])),                            \
+        STATE(B##3, &A[1], 3, PATH(ON, &R, &A[0], &A[1])),                     \
+        STATE(B##4, &A[2], 4, PATH(ON, &R, &A[0], &A[1], &A[2])),              \
+        STATE(B##5, &A[3], 5, PATH(ON, &R, &A[0], &A[1], &A[2], &A[3])),       \
+        STATE(B##6, &A[4], 6, PATH(ON, &R, &A[0], &A[1], &A[2], &A[3],         \
+                                   &A[4])),                                    \
+        STATE(B##7, &A[5], 7, PATH(ON, &R, &A[0], &A[1], &A[2], &A[3],         \
+                                   &A[4], &A[5])),                             \
+        STATE(B##8, &A[6], 8, PATH(ON, &R, &A[0], &A[1], &A[2], &A[3],         \
+                                   &A[4], &A[5], &A[6])),                      \
+    }
+
+/****************************************************************************//*
+ * Private code prototypes
+ ******************************************************************************/
+
+static void util_trace(uint8_t code);
+
+/****************************************************************************//*
+ * Private data
+ ******************************************************************************/
+
+// State tree, defined with and without ancestor tables
+//                +------+------+
+//                |             |
+//                |      r      |
+//                |             |
+//                +----+-+------+
+//                     | |
+//              +------+ +-------+
+//              |                |
+//       +------+------+  +------+------+
+//       |     a1      |  |     b1      |
+//       +------+------+  +------+------+
+//              |                |
+//             ...              ...
+//              |                |
+//       +------+------+  +------+------+
+//       |     a8      |  |     b8      |
+//       +-------------+  +-------------+
+
+/** Number of the state that handles the events. */
+static uint8_t handled_by;
+
+/** Handler calls recorded. */
+static uint8_t trace[TRACE_MAX];
+static size_t  trace_len;
+static bool    trace_on;
+
+HANDLERS(r, 0)
+HANDLERS(a1, 1) HANDLERS(a2, 2) HANDLERS(a3, 3) HANDLERS(a4, 4)
+HANDLERS(a5, 5) HANDLERS(a6, 6) HANDLERS(a7, 7) HANDLERS(a8, 8)
+HANDLERS(b1, 9) HANDLERS(b2, 10) HANDLERS(b3, 11) HANDLERS(b4, 12)
+HANDLERS(b5, 13) HANDLERS(b6, 14) HANDLERS(b7, 15) HANDLERS(b8, 16)
+
+static const fsm_state_t path_r = STATE(r, NULL, 0, NULL);
+static const fsm_state_t path_a[TREE_DEPTH] = BRANCH(a, path_a, path_r, 1);
+static const fsm_state_t path_b[TREE_DEPTH] = BRANCH(b, path_b, path_r, 1);
+
+static const fsm_state_t plain_r = STATE(r, NULL, 0, NULL);
+static const fsm_state_t plain_a[TREE_DEPTH] = BRANCH(a, plain_a, plain_r, 0);
+static const fsm_state_t plain_b[TREE_DEPTH] = BRANCH(b, plain_b, plain_r, 0);
+
+/** States of both trees, indexed by the state number. */
+static const fsm_state_t * path_state[STATE_COUNT];
+static const fsm_state_t * plain_state[STATE_COUNT];
+
+static fsm_t fsm =
+{
+    .name = "PATH",
+};
+
+/****************************************************************************//*
+ * Private code
+ ******************************************************************************/
+
+static void util_trace(uint8_t code)
+{
+    if (trace_on && (trace_len < TRACE_MAX))
+    {
+        trace[trace_len++] = code;
+    }
+}
+
+/**
+ * Reference event processing, walking the parent pointers as the former
+ * algorithm.
+ */
+static bool util_ref_process(fsm_t * const p_fsm, uint32_t events)
+{
+    const fsm_state_t * p_state_path[FSM_STATE_LEVEL_MAX + 1];
+    const fsm_state_t * p_state = p_fsm->p_state;
+    size_t              index   = 0;
+    bool                ret;
+
+    p_fsm->events = events;
+
+    do
+    {
+        p_state_path[index++] = p_state;
+        p_state               = p_state->p_parent;
+    } while (NULL != p_state);
+
+    do
+    {
+        ret = p_state_path[--index]->handler_state(p_fsm);
+    } while (!ret && (index > 0u));
+
+    p_fsm->events = 0;
+
+    return ret;
+}
+
+/**
+ * Reference transition, walking the parent pointers until the common ancestor
+ * as the former algorithm.
+ */
+static void util_ref_traverse(fsm_t * const p_fsm,
+                              const fsm_state_t * p_state_target)
+{
+    const fsm_state_t * p_state_source = p_fsm->p_state;
+    const fsm_state_t * p_state_path[FSM_STATE_LEVEL_MAX + 1];
+    size_t              index          = 0;
+
+    p_fsm->p_state    = p_state_target;
+    p_fsm->tick_count = 0;
+
+    do
+    {
+        while ((NULL != p_state_source)
+               && (p_state_source->level >= p_state_target->level))
+        {
+            p_state_source->handler_exit(p_fsm);
+            p_state_source = p_state_source->p_parent;
+        }
+
+        p_state_path[index++] = p_state_target;
+        p_state_target        = p_state_target->p_parent;
+    } while (p_state_source != p_state_target);
+
+    do
+    {
+        p_state_path[--index]->handler_entry(p_fsm);
+    } while (index > 0u);
+}
+
+/**
+ * Check that the handler calls recorded are the expected ones.
+ *
+ * @param[in] p_exp Expected handler calls.
+ * @param[in] exp_len Number of expected handler calls.
+ */
+static void util_check_trace(const uint8_t * p_exp, size_t exp_len)
+{
+    TEST_ASSERT_EQUAL(exp_len, trace_len);
+    TEST_ASSERT_EQUAL_MEMORY(p_exp, trace, exp_len);
+}
+
+/**
+ * Benchmark the transitions between the states of both branches at a level.
+ *
+ * @param[in] pp_state States of the tree.
+ * @param[in] level Level of the states.
+ * @param[in] b_ref Use the reference algorithm.
+ *
+ * @return Time or cycles of the batch.
+ */
+static uint32_t util_bench_traverse(const fsm_state_t ** pp_state,
+                                    uint8_t level, bool b_ref)
+{
+    const fsm_state_t * p_state_a = pp_state[level];
+    const fsm_state_t * p_state_b = pp_state[TREE_DEPTH + level];
+    uint32_t            start;
+
+    fsm_init(&fsm, p_state_a);
+    start = test_util_clock();
+
+    for (uint32_t i = 0; i < BENCH_OPS; i += 2u)
+    {
+        if (b_ref)
+        {
+            util_ref_traverse(&fsm, p_state_b);
+            util_ref_traverse(&fsm, p_state_a);
+        }
+        else
+        {
+            fsm_traverse(&fsm, p_state_b);
+            fsm_traverse(&fsm, p_state_a);
+        }
+    }
+
+    return test_util_clock() - start;
+}
+
+/**
+ * Benchmark the events processed by the top level state, so all the levels
+ * are visited.
+ *
+ * @param[in] pp_state States of the tree.
+ * @param[in] level Level of the current state.
+ * @param[in] b_ref Use the reference algorithm.
+ *
+ * @return Time or cycles of the batch.
+ */
+static uint32_t util_bench_process(const fsm_state_t ** pp_state,
+                                   uint8_t level, bool b_ref)
+{
+    uint32_t start;
+
+    fsm_init(&fsm, pp_state[level]);
+    handled_by = 0;
+    start      = test_util_clock();
+
+    for (uint32_t i = 0; i < BENCH_OPS; i++)
+    {
+        if (b_ref)
+        {
+            (void)util_ref_process(&fsm, 2u);
+        }
+        else
+        {
+            (void)fsm_process(&fsm, 2u);
+        }
+    }
+
+    return test_util_clock() - start;
+}
+
+/****************************************************************************//*
+ * Tests
+ ******************************************************************************/
+
+void setUp(void)
+{
+    path_state[0]  = &path_r;
+    plain_state[0] = &plain_r;
+
+    for (uint32_t i = 0; i < TREE_DEPTH; i++)
+    {
+        path_state[1u + i]               = &path_a[i];
+        path_state[1u + TREE_DEPTH + i]  = &path_b[i];
+        plain_state[1u + i]              = &plain_a[i];
+        plain_state[1u + TREE_DEPTH + i] = &plain_b[i];
+    }
+
+    handled_by = UINT8_MAX;
+    trace_len  = 0;
+    trace_on   = false;
+}
+
+void test_fsm_path_init(void)
+{
+    const uint8_t exp[] = {TRACE_ENTRY | 0, TRACE_ENTRY | 9, TRACE_ENTRY | 10,
+                           TRACE_ENTRY | 11};
+
+    trace_on = true;
+    fsm_init(&fsm, path_state[11]);
+    util_check_trace(exp, sizeof(exp));
+
+    trace_len = 0;
+    fsm_init(&fsm, plain_state[11]);
+    util_check_trace(exp, sizeof(exp));
+}
+
+void test_fsm_path_process(void)
+{
+    uint8_t exp[TRACE_MAX];
+    size_t  exp_len;
+    bool    exp_ret;
+
+    // Each state, with the events handled at each level and not handled
+    for (uint8_t state = 0; state < STATE_COUNT; state++)
+    {
+        for (uint8_t handler = 0; handler <= STATE_COUNT; handler++)
+        {
+            handled_by = handler;
+
+            fsm_init(&fsm, plain_state[state]);
+            trace_len = 0;
+            trace_on  = true;
+            exp_ret   = util_ref_process(&fsm, 2u);
+            exp_len   = trace_len;
+            memcpy(exp, trace, exp_len);
+
+            trace_len = 0;
+            TEST_ASSERT_EQUAL(exp_ret, fsm_process(&fsm, 2u));
+            util_check_trace(exp, exp_len);
+
+            trace_on  = false;
+            fsm_init(&fsm, path_state[state]);
+            trace_on  = true;
+            trace_len = 0;
+            TEST_ASSERT_EQUAL(exp_ret, fsm_process(&fsm, 2u));
+            util_check_trace(exp, exp_len);
+            TEST_ASSERT_EQUAL(0, fsm.events);
+        }
+    }
+}
+
+void test_fsm_path_traverse(void)
+{
+    uint8_t exp[TRACE_MAX];
+    size_t  exp_len;
+
+    // Each pair of states, including the transitions to the same state, to
+    // the ancestors and to the descendants
+    for (uint8_t source = 0; source < STATE_COUNT; source++)
+    {
+        for (uint8_t target = 0; target < STATE_COUNT; target++)
+        {
+            trace_on  = false;
+            fsm_init(&fsm, plain_state[source]);
+            trace_on  = true;
+            trace_len = 0;
+            util_ref_traverse(&fsm, plain_state[target]);
+            exp_len   = trace_len;
+            memcpy(exp, trace, exp_len);
+
+            trace_on  = false;
+            fsm_init(&fsm, plain_state[source]);
+            trace_on  = true;
+            trace_len = 0;
+            fsm_traverse(&fsm, plain_state[target]);
+            util_check_trace(exp, exp_len);
+            TEST_ASSERT_EQUAL_PTR(plain_state[target], fsm.p_state);
+
+            trace_on  = false;
+            fsm_init(&fsm, path_state[source]);
+            trace_on  = true;
+            trace_len = 0;
+            fsm_traverse(&fsm, path_state[target]);
+            util_check_trace(exp, exp_len);
+            TEST_ASSERT_EQUAL_PTR(path_state[target], fsm.p_state);
+        }
+    }
+}
+
+void test_fsm_path_bench(void)
+{
+    const uint8_t level[] = {4, 6, 8};
+
+    for (size_t i = 0; i < sizeof(level) / sizeof(level[0]); i++)
+    {
+        uint8_t  lvl       = level[i];
+        uint32_t event_ref = util_bench_process(plain_state, lvl, true);
+        uint32_t event_par = util_bench_process(plain_state, lvl, false);
+        uint32_t event_tab = util_bench_process(path_state, lvl, false);
+        uint32_t trans_ref = util_bench_traverse(plain_state, lvl, true);
+        uint32_t trans_par = util_bench_traverse(plain_state, lvl, false);
+        uint32_t trans_tab = util_bench_traverse(path_state, lvl, false);
+
+#ifdef TEST_TARGET
+        TEST_PRINTF("Level %u, cycles per event: %u former, %u parent, "
+#else
+        TEST_PRINTF("Level %u, ns per event: %u former, %u parent, "
+#endif
+                    "%u table, per transition: %u former, %u parent, %u table",
+                    (unsigned int)lvl,
+                    (unsigned int)(event_ref / BENCH_OPS),
+                    (unsigned int)(event_par / BENCH_OPS),
+                    (unsigned int)(event_tab / BENCH_OPS),
+                    (unsigned int)(trans_ref / BENCH_OPS),
+                    (unsigned int)(trans_par / BENCH_OPS),
+                    (unsigned int)(trans_tab / BENCH_OPS));
+    }
+}
+
+/******************************** End of file *********************************/
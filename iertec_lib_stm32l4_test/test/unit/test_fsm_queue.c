@@ -0,0 +1,245 @@
+/*******************************************************************************
+ * @file test_fsm_queue.c
+ * @author juanmanuel.fernandez@iertec.com
+ * @date 19 Oct 2026
+ * @brief Unit test for the module fsm_queue.
+ ******************************************************************************/
+
+#include "fsm_queue.h"
+
+#include "unity.h"
+
+/****************************************************************************//*
+ * Dependencies
+ ******************************************************************************/
+
+const char test_file_name[] = __FILE_NAME__;
+
+// Test dependencies
+TEST_FILE("fsm.c")
+
+/****************************************************************************//*
+ * Constants and macros
+ ******************************************************************************/
+
+/** Number of slots of each ring. */
+#define RING_SIZE   (4u)
+
+/** Maximum number of events recorded. */
+#define RECORD_MAX  (32u)
+
+/** Events of the tests. */
+#define EVENT_A     (2u)
+#define EVENT_B     (4u)
+#define EVENT_POST  (8u)
+
+/** Event recorded when the handler of an EVENT_POST returns. */
+#define EVENT_END   (0x80000000u)
+
+/****************************************************************************//*
+ * Private data
+ ******************************************************************************/
+
+/** Events and data processed by the state machine. */
+static uint32_t record_events[RECORD_MAX];
+static void *   record_data[RECORD_MAX];
+static uint32_t record_count;
+
+/** Number of notifications. */
+static uint32_t notify_count;
+
+/** Data of the tests. */
+static uint8_t data[RECORD_MAX];
+
+static fsm_queue_slot_t slot[FSM_QUEUE_PRIO_COUNT * RING_SIZE];
+
+static fsm_queue_t queue;
+
+/****************************************************************************//*
+ * Private code
+ ******************************************************************************/
+
+static void util_record(uint32_t events, void * p_data)
+{
+    TEST_ASSERT_TRUE(record_count < RECORD_MAX);
+
+    record_events[record_count] = events;
+    record_data[record_count]   = p_data;
+    record_count++;
+}
+
+static bool state_handler(fsm_t * const p_fsm)
+{
+    util_record(p_fsm->events, p_fsm->p_data);
+
+    // Post events from the handler, they are processed after this one
+    if (0u != (p_fsm->events & EVENT_POST))
+    {
+        TEST_ASSERT_TRUE(fsm_queue_post(&queue, EVENT_A, &data[10], 0));
+        TEST_ASSERT_TRUE(fsm_queue_post(&queue, EVENT_B, &data[11], 1));
+        util_record(EVENT_END, NULL);
+    }
+
+    return true;
+}
+
+static void notify(void)
+{
+    notify_count++;
+}
+
+static const fsm_state_t state =
+{
+    .handler_entry = NULL,
+    .handler_state = state_handler,
+    .handler_exit  = NULL,
+    .p_parent      = NULL,
+    .level         = 0,
+    .name          = "QUEUE_STATE",
+};
+
+static fsm_t fsm =
+{
+    .name = "QUEUE",
+};
+
+/****************************************************************************//*
+ * Tests
+ ******************************************************************************/
+
+void setUp(void)
+{
+    fsm_init(&fsm, &state);
+    fsm_queue_init(&queue, &fsm, slot, RING_SIZE, notify);
+
+    record_count = 0;
+    notify_count = 0;
+}
+
+void test_fsm_queue_not_merged(void)
+{
+    // The same event is processed once per post, with its data
+    for (uint32_t i = 0; i < 3u; i++)
+    {
+        TEST_ASSERT_TRUE(fsm_queue_post(&queue, EVENT_A, &data[i], 0));
+    }
+
+    TEST_ASSERT_EQUAL_UINT32(3, notify_count);
+    TEST_ASSERT_EQUAL_UINT32(3, fsm_queue_dispatch(&queue));
+    TEST_ASSERT_EQUAL_UINT32(3, record_count);
+
+    for (uint32_t i = 0; i < 3u; i++)
+    {
+        TEST_ASSERT_EQUAL_UINT32(EVENT_A, record_events[i]);
+        TEST_ASSERT_EQUAL_PTR(&data[i], record_data[i]);
+    }
+
+    // The data is only given while the event is processed
+    TEST_ASSERT_NULL(fsm.p_data);
+    TEST_ASSERT_EQUAL_UINT32(0, fsm.events);
+    TEST_ASSERT_EQUAL_UINT32(0, fsm_queue_dispatch(&queue));
+}
+
+void test_fsm_queue_priority(void)
+{
+    TEST_ASSERT_TRUE(fsm_queue_post(&queue, EVENT_A, &data[0], 0));
+    TEST_ASSERT_TRUE(fsm_queue_post(&queue, EVENT_B, &data[1], 1));
+    TEST_ASSERT_TRUE(fsm_queue_post(&queue, EVENT_A, &data[2], 0));
+    TEST_ASSERT_TRUE(fsm_queue_post(&queue, EVENT_B, &data[3], 1));
+
+    TEST_ASSERT_EQUAL_UINT32(4, fsm_queue_dispatch(&queue));
+
+    // Higher priority first, in order of posting inside the same priority
+    TEST_ASSERT_EQUAL_PTR(&data[1], record_data[0]);
+    TEST_ASSERT_EQUAL_PTR(&data[3], record_data[1]);
+    TEST_ASSERT_EQUAL_PTR(&data[0], record_data[2]);
+    TEST_ASSERT_EQUAL_PTR(&data[2], record_data[3]);
+}
+
+void test_fsm_queue_run_to_completion(void)
+{
+    TEST_ASSERT_TRUE(fsm_queue_post(&queue, EVENT_POST, &data[0], 0));
+    TEST_ASSERT_TRUE(fsm_queue_post(&queue, EVENT_A, &data[1], 0));
+
+    TEST_ASSERT_EQUAL_UINT32(4, fsm_queue_dispatch(&queue));
+    TEST_ASSERT_EQUAL_UINT32(5, record_count);
+
+    // The posted events wait until the handler returns, then the higher
+    // priority event goes before the older ones
+    TEST_ASSERT_EQUAL_UINT32(EVENT_POST, record_events[0]);
+    TEST_ASSERT_EQUAL_UINT32(EVENT_END, record_events[1]);
+    TEST_ASSERT_EQUAL_PTR(&data[11], record_data[2]);
+    TEST_ASSERT_EQUAL_PTR(&data[1], record_data[3]);
+    TEST_ASSERT_EQUAL_PTR(&data[10], record_data[4]);
+}
+
+void test_fsm_queue_full(void)
+{
+    for (uint32_t i = 0; i < RING_SIZE; i++)
+    {
+        TEST_ASSERT_TRUE(fsm_queue_post(&queue, EVENT_A, &data[i], 0));
+    }
+
+    // The other priorities have their own ring
+    TEST_ASSERT_FALSE(fsm_queue_post(&queue, EVENT_A, &data[RING_SIZE], 0));
+    TEST_ASSERT_TRUE(fsm_queue_post(&queue, EVENT_B, &data[RING_SIZE], 1));
+    TEST_ASSERT_EQUAL_UINT32(1, queue.lost);
+    TEST_ASSERT_EQUAL_UINT32(RING_SIZE + 1u, notify_count);
+
+    TEST_ASSERT_EQUAL_UINT32(RING_SIZE + 1u, fsm_queue_dispatch(&queue));
+    TEST_ASSERT_EQUAL_PTR(&data[RING_SIZE - 1u], record_data[RING_SIZE]);
+}
+
+void test_fsm_queue_wrap(void)
+{
+    // Several rounds of the ring, with the positions wrapping around
+    queue.ring[0].head = UINT32_MAX - RING_SIZE;
+    queue.ring[0].tail = UINT32_MAX - RING_SIZE;
+
+    for (uint32_t i = 0; i < RING_SIZE; i++)
+    {
+        queue.ring[0].p_slot[(queue.ring[0].tail + i) & (RING_SIZE - 1u)].seq =
+            queue.ring[0].tail + i;
+    }
+
+    for (uint32_t round = 0; round < 3u; round++)
+    {
+        record_count = 0;
+
+        for (uint32_t i = 0; i < RING_SIZE - 1u; i++)
+        {
+            TEST_ASSERT_TRUE(fsm_queue_post(&queue, EVENT_A, &data[i], 0));
+        }
+
+        TEST_ASSERT_EQUAL_UINT32(RING_SIZE - 1u, fsm_queue_dispatch(&queue));
+        TEST_ASSERT_EQUAL_PTR(&data[RING_SIZE - 2u],
+                              record_data[RING_SIZE - 2u]);
+    }
+
+    TEST_ASSERT_EQUAL_UINT32(0, queue.lost);
+}
+
+void test_fsm_queue_post_interrupted(void)
+{
+    fsm_queue_ring_t * p_ring = &queue.ring[0];
+    fsm_queue_slot_t * p_slot = &p_ring->p_slot[0];
+
+    // A post interrupted after claiming its slot, as done by fsm_queue_post
+    p_ring->tail++;
+
+    // The interrupt posts the next event, it waits for the previous one
+    TEST_ASSERT_TRUE(fsm_queue_post(&queue, EVENT_B, &data[1], 0));
+    TEST_ASSERT_EQUAL_UINT32(0, fsm_queue_dispatch(&queue));
+
+    // The interrupted post completes
+    p_slot->events = EVENT_A;
+    p_slot->p_data = &data[0];
+    p_slot->seq    = 1;
+
+    TEST_ASSERT_EQUAL_UINT32(2, fsm_queue_dispatch(&queue));
+    TEST_ASSERT_EQUAL_UINT32(EVENT_A, record_events[0]);
+    TEST_ASSERT_EQUAL_UINT32(EVENT_B, record_events[1]);
+    TEST_ASSERT_EQUAL_PTR(&data[1], record_data[1]);
+}
+
+/******************************** End of file *********************************/
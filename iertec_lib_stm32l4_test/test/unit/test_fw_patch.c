@@ -0,0 +1,522 @@
+/*******************************************************************************
+ * @file test_fw_patch.c
+ * @author juanmanuel.fernandez@iertec.com
+ * @date 19 Oct 2026
+ * @brief Unit test for the module fw_patch.
+ ******************************************************************************/
+
+#include "fw_patch.h"
+#include "crypt_crc32.h"
+
+#include "unity.h"
+
+#include <stdlib.h>
+#include <string.h>
+
+/****************************************************************************//*
+ * Dependencies
+ ******************************************************************************/
+
+const char test_file_name[] = __FILE_NAME__;
+
+// Test dependencies
+#include "mock_fw_update.h"
+#include "mock_itf_flash.h"
+
+/****************************************************************************//*
+ * Constants and macros
+ ******************************************************************************/
+
+#define OLD_ADDRESS   (0x08008000ul)
+#define IMAGE_SIZE    (24 * 1024)
+#define IMAGE_MAX     (IMAGE_SIZE + 4096)
+#define PATCH_MAX     (IMAGE_MAX * 2)
+
+#define MATCH_BLOCK   (8)
+#define MATCH_MIN     (16)
+#define HASH_SIZE     (4096)
+
+#define CHUNK_MAX     (100)
+
+/****************************************************************************//*
+ * Private data
+ ******************************************************************************/
+
+static uint8_t old_image[IMAGE_MAX + 4];
+static size_t old_size;
+static uint8_t new_image[IMAGE_MAX];
+static size_t new_size;
+static uint8_t patch_data[PATCH_MAX];
+static size_t patch_size;
+
+static uint8_t out_image[IMAGE_MAX];
+static size_t out_size;
+static size_t out_size_exp;
+static bool out_aborted;
+
+static int32_t hash_table[HASH_SIZE];
+
+/****************************************************************************//*
+ * Private code (stubs)
+ ******************************************************************************/
+
+static fw_update_slot_t stub_fw_update_get_slot(void)
+{
+    return FW_UPDATE_SLOT_A;
+}
+
+static uint32_t stub_fw_update_get_slot_address(fw_update_slot_t slot)
+{
+    TEST_ASSERT_EQUAL(FW_UPDATE_SLOT_A, slot);
+
+    return OLD_ADDRESS;
+}
+
+static bool stub_fw_update_begin(size_t size)
+{
+    out_size = 0;
+    out_size_exp = size;
+
+    return size <= IMAGE_MAX;
+}
+
+static bool stub_fw_update_erase_step(void)
+{
+    return true;
+}
+
+static size_t stub_fw_update_get_writable(void)
+{
+    return out_size_exp - out_size;
+}
+
+static bool stub_fw_update_write(const uint8_t * data, size_t length)
+{
+    TEST_ASSERT_TRUE((out_size + length) <= out_size_exp);
+
+    memcpy(&out_image[out_size], data, length);
+    out_size += length;
+
+    return true;
+}
+
+static bool stub_fw_update_finish(uint32_t crc)
+{
+    return (out_size == out_size_exp)
+           && (crypt_crc32(out_image, out_size, CRYPT_CRC32_INIT_VAL) == crc);
+}
+
+static void stub_fw_update_abort(void)
+{
+    out_aborted = true;
+}
+
+static bool stub_itf_flash_read(uint32_t address, uint8_t * data, size_t length)
+{
+    TEST_ASSERT_TRUE(address >= OLD_ADDRESS);
+    TEST_ASSERT_TRUE((address - OLD_ADDRESS + length) <= sizeof(old_image));
+    TEST_ASSERT_EQUAL_UINT32(0, length % 4);
+    TEST_ASSERT_TRUE(length <= FW_PATCH_BUF_SIZE);
+
+    memcpy(data, &old_image[address - OLD_ADDRESS], length);
+
+    return true;
+}
+
+/****************************************************************************//*
+ * Private code (patch generation)
+ ******************************************************************************/
+
+static void util_put_u8(uint8_t value)
+{
+    TEST_ASSERT_TRUE(patch_size < PATCH_MAX);
+    patch_data[patch_size++] = value;
+}
+
+static void util_put_u32(uint32_t value)
+{
+    for (size_t i = 0; i < 4; i++)
+    {
+        util_put_u8((uint8_t)(value >> (i * 8)));
+    }
+}
+
+static void util_put_leb128(uint32_t value)
+{
+    do
+    {
+        uint8_t byte = value & 0x7F;
+
+        value >>= 7;
+        util_put_u8(byte | ((value != 0) ? 0x80 : 0x00));
+    } while (value != 0);
+}
+
+static void util_put_header(void)
+{
+    patch_size = 0;
+    util_put_u32(FW_PATCH_MAGIC);
+    util_put_u32(old_size);
+    util_put_u32(crypt_crc32(old_image, old_size, CRYPT_CRC32_INIT_VAL));
+    util_put_u32(new_size);
+    util_put_u32(crypt_crc32(new_image, new_size, CRYPT_CRC32_INIT_VAL));
+}
+
+static uint32_t util_hash(const uint8_t * data)
+{
+    uint32_t hash = 2166136261ul;
+
+    for (size_t i = 0; i < MATCH_BLOCK; i++)
+    {
+        hash = (hash ^ data[i]) * 16777619ul;
+    }
+
+    return hash % HASH_SIZE;
+}
+
+/**
+ * Emit the literal bytes of the new image, as an add over the old image if
+ * most of the bytes are similar, or as an insert otherwise.
+ */
+static void util_put_literal(size_t new_pos, size_t length, size_t old_pos)
+{
+    size_t equal = 0;
+
+    if (0 == length)
+    {
+        return;
+    }
+
+    if ((old_pos + length) <= old_size)
+    {
+        for (size_t i = 0; i < length; i++)
+        {
+            equal += (old_image[old_pos + i] == new_image[new_pos + i]) ? 1 : 0;
+        }
+    }
+
+    if ((equal * 2) > length)
+    {
+        util_put_u8(FW_PATCH_OP_ADD);
+        util_put_leb128(old_pos);
+        util_put_leb128(length);
+
+        for (size_t i = 0; i < length; i++)
+        {
+            util_put_u8((uint8_t)(new_image[new_pos + i]
+                                  - old_image[old_pos + i]));
+        }
+    }
+    else
+    {
+        util_put_u8(FW_PATCH_OP_INSERT);
+        util_put_leb128(length);
+
+        for (size_t i = 0; i < length; i++)
+        {
+            util_put_u8(new_image[new_pos + i]);
+        }
+    }
+}
+
+/** Greedy block matching diff, enough to produce patches of real image pairs. */
+static void util_make_patch(void)
+{
+    size_t pos = 0;
+    size_t literal = 0;
+    size_t old_next = 0;
+
+    for (size_t i = 0; i < HASH_SIZE; i++)
+    {
+        hash_table[i] = -1;
+    }
+
+    for (size_t i = 0; (i + MATCH_BLOCK) <= old_size; i++)
+    {
+        hash_table[util_hash(&old_image[i])] = (int32_t)i;
+    }
+
+    util_put_header();
+
+    while (pos < new_size)
+    {
+        size_t match_len = 0;
+        size_t match_pos = 0;
+
+        if ((pos + MATCH_BLOCK) <= new_size)
+        {
+            int32_t cand = hash_table[util_hash(&new_image[pos])];
+
+            if (cand >= 0)
+            {
+                while (((cand + match_len) < old_size)
+                       && ((pos + match_len) < new_size)
+                       && (old_image[cand + match_len]
+                           == new_image[pos + match_len]))
+                {
+                    match_len++;
+                }
+
+                match_pos = (size_t)cand;
+            }
+        }
+
+        if (match_len >= MATCH_MIN)
+        {
+            util_put_literal(literal, pos - literal, old_next);
+            util_put_u8(FW_PATCH_OP_COPY);
+            util_put_leb128(match_pos);
+            util_put_leb128(match_len);
+            pos += match_len;
+            literal = pos;
+            old_next = match_pos + match_len;
+        }
+        else
+        {
+            pos++;
+        }
+    }
+
+    util_put_literal(literal, pos - literal, old_next);
+    util_put_u8(FW_PATCH_OP_END);
+}
+
+/****************************************************************************//*
+ * Private code (images)
+ ******************************************************************************/
+
+/** Build an image that looks like code: repeated patterns and address tables. */
+static void util_make_old_image(void)
+{
+    old_size = IMAGE_SIZE;
+
+    for (size_t i = 0; i < old_size; i += 4)
+    {
+        uint32_t word;
+
+        if ((i / 1024) % 4 == 3)
+        {
+            // Address table
+            word = 0x08008000ul + (i * 3);
+        }
+        else
+        {
+            // Instructions
+            word = ((uint32_t)rand() & 0x0000FFFFul) | 0xB5000000ul;
+        }
+
+        memcpy(&old_image[i], &word, 4);
+    }
+}
+
+static void util_apply(size_t chunk_max)
+{
+    size_t offset = 0;
+
+    out_aborted = false;
+    fw_patch_begin();
+
+    while (offset < patch_size)
+    {
+        size_t len = 1 + ((size_t)rand() % chunk_max);
+
+        if (len > (patch_size - offset))
+        {
+            len = patch_size - offset;
+        }
+
+        TEST_ASSERT_TRUE(fw_patch_write(&patch_data[offset], len));
+        offset += len;
+    }
+
+    TEST_ASSERT_TRUE(fw_patch_finish());
+    TEST_ASSERT_EQUAL(new_size, out_size);
+    TEST_ASSERT_EQUAL_MEMORY(new_image, out_image, new_size);
+    TEST_ASSERT_FALSE(out_aborted);
+}
+
+static void util_apply_fail(void)
+{
+    bool ret;
+
+    out_aborted = false;
+    fw_patch_begin();
+    ret = fw_patch_write(patch_data, patch_size);
+    ret = ret && fw_patch_finish();
+
+    TEST_ASSERT_FALSE(ret);
+    TEST_ASSERT_TRUE(out_aborted);
+}
+
+/****************************************************************************//*
+ * Tests
+ ******************************************************************************/
+
+void setUp(void)
+{
+    srand(1);
+
+    fw_update_get_slot_Stub(stub_fw_update_get_slot);
+    fw_update_get_slot_address_Stub(stub_fw_update_get_slot_address);
+    fw_update_begin_Stub(stub_fw_update_begin);
+    fw_update_erase_step_Stub(stub_fw_update_erase_step);
+    fw_update_get_writable_Stub(stub_fw_update_get_writable);
+    fw_update_write_Stub(stub_fw_update_write);
+    fw_update_finish_Stub(stub_fw_update_finish);
+    fw_update_abort_Stub(stub_fw_update_abort);
+    itf_flash_read_Stub(stub_itf_flash_read);
+
+    util_make_old_image();
+}
+
+void test_fw_patch_identical(void)
+{
+    new_size = old_size;
+    memcpy(new_image, old_image, old_size);
+    util_make_patch();
+
+    TEST_ASSERT_LESS_THAN(64, patch_size);
+    util_apply(CHUNK_MAX);
+}
+
+void test_fw_patch_modified(void)
+{
+    size_t src = 0;
+
+    new_size = 0;
+
+    // Changed bytes, inserted and removed functions and relocated addresses
+    while (src < old_size)
+    {
+        size_t block = 512;
+
+        if (block > (old_size - src))
+        {
+            block = old_size - src;
+        }
+
+        memcpy(&new_image[new_size], &old_image[src], block);
+
+        if ((src / 512) % 7 == 1)
+        {
+            new_image[new_size + 100] ^= 0x5A;
+        }
+
+        if ((src / 512) % 11 == 5)
+        {
+            for (size_t i = 0; i < 96; i++)
+            {
+                new_image[new_size + block + i] = (uint8_t)rand();
+            }
+
+            new_size += 96;
+        }
+
+        if ((src / 512) % 4 == 3)
+        {
+            for (size_t i = 0; i < block; i += 4)
+            {
+                new_image[new_size + i] += 0x40;
+            }
+        }
+
+        new_size += block;
+        src += ((src / 512) % 13 == 6) ? (block + 256) : block;
+    }
+
+    util_make_patch();
+
+    TEST_PRINTF("New image: %u bytes, patch: %u bytes", (unsigned)new_size,
+                (unsigned)patch_size);
+    TEST_ASSERT_LESS_THAN(new_size / 2, patch_size);
+    util_apply(CHUNK_MAX);
+    util_apply(1);
+}
+
+void test_fw_patch_unrelated(void)
+{
+    new_size = IMAGE_SIZE - 300;
+
+    for (size_t i = 0; i < new_size; i++)
+    {
+        new_image[i] = (uint8_t)rand();
+    }
+
+    util_make_patch();
+    util_apply(CHUNK_MAX);
+}
+
+void test_fw_patch_bad_magic(void)
+{
+    new_size = old_size;
+    memcpy(new_image, old_image, old_size);
+    util_make_patch();
+    patch_data[0] ^= 0x01;
+
+    util_apply_fail();
+}
+
+void test_fw_patch_other_old_image(void)
+{
+    new_size = old_size;
+    memcpy(new_image, old_image, old_size);
+    util_make_patch();
+    old_image[10] ^= 0x01;
+
+    util_apply_fail();
+}
+
+void test_fw_patch_out_of_range(void)
+{
+    new_size = 64;
+    memcpy(new_image, old_image, new_size);
+    util_put_header();
+    util_put_u8(FW_PATCH_OP_COPY);
+    util_put_leb128(old_size - 8);
+    util_put_leb128(16);
+    util_put_u8(FW_PATCH_OP_END);
+
+    util_apply_fail();
+
+    // Longer than the new image
+    util_put_header();
+    util_put_u8(FW_PATCH_OP_COPY);
+    util_put_leb128(0);
+    util_put_leb128(new_size + 1);
+    util_put_u8(FW_PATCH_OP_END);
+
+    util_apply_fail();
+}
+
+void test_fw_patch_truncated(void)
+{
+    new_size = old_size;
+    memcpy(new_image, old_image, old_size);
+    new_image[1000] ^= 0xFF;
+    util_make_patch();
+    patch_size -= 2;
+
+    util_apply_fail();
+}
+
+void test_fw_patch_bad_op(void)
+{
+    new_size = 8;
+    memcpy(new_image, old_image, new_size);
+    util_put_header();
+    util_put_u8(0x7F);
+
+    util_apply_fail();
+}
+
+void test_fw_patch_data_after_end(void)
+{
+    new_size = old_size;
+    memcpy(new_image, old_image, old_size);
+    util_make_patch();
+    util_put_u8(FW_PATCH_OP_END);
+
+    util_apply_fail();
+}
+
+/******************************** End of file *********************************/
@@ -0,0 +1,450 @@
+/*******************************************************************************
+ * @file test_fw_update.c
+ * @author juanmanuel.fernandez@iertec.com
+ * @date 19 Oct 2026
+ * @brief Unit test for the module fw_update.
+ ******************************************************************************/
+
+#include "fw_update.h"
+#include "crypt_crc32.h"
+
+#include "unity.h"
+#include "assert_test_helper.h"
+
+#include <string.h>
+
+/****************************************************************************//*
+ * Dependencies
+ ******************************************************************************/
+
+const char test_file_name[] = __FILE_NAME__;
+
+// Test dependencies
+#include "mock_itf_flash.h"
+
+/****************************************************************************//*
+ * Constants and macros
+ ******************************************************************************/
+
+#define FLASH_SIM_BASE (FW_UPDATE_SLOT_A_ADDRESS)
+#define FLASH_SIM_SIZE (FW_UPDATE_META_ADDRESS + (FW_UPDATE_PAGE_SIZE * 2) \
+                        - FLASH_SIM_BASE)
+
+#define IMAGE_SIZE     ((FW_UPDATE_PAGE_SIZE * 3) + 100)
+#define RECORD_SIZE    (24)
+
+/****************************************************************************//*
+ * Private data
+ ******************************************************************************/
+
+static uint8_t flash_sim[FLASH_SIM_SIZE];
+static uint8_t flash_backup[FLASH_SIM_SIZE];
+static size_t erase_count;
+static size_t meta_erase_count;
+static size_t meta_write_limit;
+static uint8_t image[IMAGE_SIZE];
+static uint32_t image_crc;
+
+/****************************************************************************//*
+ * Private code
+ ******************************************************************************/
+
+static bool stub_itf_flash_erase(uint32_t address, size_t length)
+{
+    TEST_ASSERT_TRUE(address >= FLASH_SIM_BASE);
+    TEST_ASSERT_TRUE((address - FLASH_SIM_BASE + length) <= FLASH_SIM_SIZE);
+    TEST_ASSERT_EQUAL_UINT32(0, (address - FLASH_SIM_BASE) % FW_UPDATE_PAGE_SIZE);
+
+    memset(&flash_sim[address - FLASH_SIM_BASE], 0xFF, length);
+
+    if (address >= FW_UPDATE_META_ADDRESS)
+    {
+        meta_erase_count++;
+    }
+    else
+    {
+        erase_count++;
+    }
+
+    return true;
+}
+
+static bool stub_itf_flash_write(uint32_t address, const uint8_t * data,
+                                 size_t length)
+{
+    TEST_ASSERT_TRUE(address >= FLASH_SIM_BASE);
+    TEST_ASSERT_TRUE((address - FLASH_SIM_BASE + length) <= FLASH_SIM_SIZE);
+    TEST_ASSERT_EQUAL_UINT32(0, length % 8);
+
+    // Only erased memory can be programmed
+    TEST_ASSERT_EACH_EQUAL_HEX8(0xFF, &flash_sim[address - FLASH_SIM_BASE], length);
+
+    // Power loss before the metadata write
+    if (address >= FW_UPDATE_META_ADDRESS)
+    {
+        if (0 == meta_write_limit)
+        {
+            return false;
+        }
+
+        meta_write_limit--;
+    }
+
+    memcpy(&flash_sim[address - FLASH_SIM_BASE], data, length);
+
+    return true;
+}
+
+static bool stub_itf_flash_read(uint32_t address, uint8_t * data, size_t length)
+{
+    TEST_ASSERT_TRUE(address >= FLASH_SIM_BASE);
+    TEST_ASSERT_TRUE((address - FLASH_SIM_BASE + length) <= FLASH_SIM_SIZE);
+
+    memcpy(data, &flash_sim[address - FLASH_SIM_BASE], length);
+
+    return true;
+}
+
+static void util_erase(size_t length)
+{
+    while (fw_update_get_writable() < length)
+    {
+        TEST_ASSERT_TRUE(fw_update_erase_step());
+    }
+}
+
+static void util_write_image(size_t chunk_max)
+{
+    size_t offset = 0;
+    size_t chunk = 1;
+
+    TEST_ASSERT_TRUE(fw_update_begin(IMAGE_SIZE));
+
+    while (offset < IMAGE_SIZE)
+    {
+        size_t length = IMAGE_SIZE - offset;
+
+        if (length > chunk)
+        {
+            length = chunk;
+        }
+
+        // The pages are erased while the next chunk is received
+        util_erase(length);
+        TEST_ASSERT_TRUE(fw_update_write(&image[offset], length));
+        offset += length;
+        chunk = (chunk % chunk_max) + 1;
+    }
+}
+
+static void util_reboot(fw_update_slot_t slot_exp)
+{
+    fw_update_slot_t slot;
+
+    TEST_ASSERT_TRUE(fw_update_init());
+    TEST_ASSERT_TRUE(fw_update_boot(&slot));
+    TEST_ASSERT_EQUAL(slot_exp, slot);
+    TEST_ASSERT_EQUAL(slot_exp, fw_update_get_slot());
+}
+
+static fw_update_slot_t util_rollback(void)
+{
+    fw_update_slot_t slot = FW_UPDATE_SLOT_COUNT;
+
+    for (size_t i = 0; i <= FW_UPDATE_ATTEMPTS_MAX; i++)
+    {
+        TEST_ASSERT_TRUE(fw_update_init());
+        TEST_ASSERT_TRUE(fw_update_boot(&slot));
+    }
+
+    return slot;
+}
+
+static void util_boot_power_loss(fw_update_slot_t slot_confirmed)
+{
+    fw_update_slot_t slot_before = fw_update_get_slot();
+    fw_update_slot_t slot_after;
+    fw_update_slot_t slot;
+
+    memcpy(flash_backup, flash_sim, sizeof(flash_sim));
+    TEST_ASSERT_TRUE(fw_update_boot(&slot));
+    slot_after = fw_update_get_slot();
+
+    // Cut the power before each metadata write of the boot
+    for (size_t cut = 0; cut < 2; cut++)
+    {
+        memcpy(flash_sim, flash_backup, sizeof(flash_sim));
+        TEST_ASSERT_TRUE(fw_update_init());
+        meta_write_limit = cut;
+        (void)fw_update_boot(&slot);
+        meta_write_limit = SIZE_MAX;
+
+        // The previous or the new record is kept, and the confirmed one
+        TEST_ASSERT_TRUE(fw_update_init());
+        slot = fw_update_get_slot();
+        TEST_ASSERT_TRUE((slot_before == slot) || (slot_after == slot));
+        TEST_ASSERT_EQUAL(slot_confirmed, util_rollback());
+    }
+
+    memcpy(flash_sim, flash_backup, sizeof(flash_sim));
+    TEST_ASSERT_TRUE(fw_update_init());
+    TEST_ASSERT_TRUE(fw_update_boot(&slot));
+}
+
+/****************************************************************************//*
+ * Tests
+ ******************************************************************************/
+
+void setUp(void)
+{
+    memset(flash_sim, 0xFF, sizeof(flash_sim));
+    erase_count = 0;
+    meta_erase_count = 0;
+    meta_write_limit = SIZE_MAX;
+
+    for (size_t i = 0; i < IMAGE_SIZE; i++)
+    {
+        image[i] = (uint8_t)((i * 7) + (i >> 8));
+    }
+
+    image_crc = crypt_crc32(image, IMAGE_SIZE, CRYPT_CRC32_INIT_VAL);
+
+    itf_flash_erase_Stub(stub_itf_flash_erase);
+    itf_flash_write_Stub(stub_itf_flash_write);
+    itf_flash_read_Stub(stub_itf_flash_read);
+
+    TEST_ASSERT_TRUE(fw_update_init());
+}
+
+void test_fw_update_init_empty(void)
+{
+    util_reboot(FW_UPDATE_SLOT_A);
+    TEST_ASSERT_EQUAL_HEX32(FW_UPDATE_SLOT_A_ADDRESS,
+                            fw_update_get_slot_address(FW_UPDATE_SLOT_A));
+    TEST_ASSERT_EQUAL_HEX32(FW_UPDATE_SLOT_B_ADDRESS,
+                            fw_update_get_slot_address(FW_UPDATE_SLOT_B));
+}
+
+void test_fw_update_stream(void)
+{
+    util_write_image(37);
+    TEST_ASSERT_TRUE(fw_update_finish(image_crc));
+
+    TEST_ASSERT_EQUAL_MEMORY(image,
+                             &flash_sim[FW_UPDATE_SLOT_B_ADDRESS - FLASH_SIM_BASE],
+                             IMAGE_SIZE);
+    TEST_ASSERT_EQUAL(FW_UPDATE_SLOT_B, fw_update_get_slot());
+
+    // Only the pages of the image are erased
+    TEST_ASSERT_EQUAL(4, erase_count);
+
+    util_reboot(FW_UPDATE_SLOT_B);
+    TEST_ASSERT_TRUE(fw_update_confirm());
+    util_reboot(FW_UPDATE_SLOT_B);
+}
+
+void test_fw_update_erase_step(void)
+{
+    // Nothing is erased when the update starts
+    TEST_ASSERT_TRUE(fw_update_begin(IMAGE_SIZE));
+    TEST_ASSERT_EQUAL(0, erase_count);
+    TEST_ASSERT_EQUAL(0, fw_update_get_writable());
+
+    TEST_ASSERT_TRUE(fw_update_erase_step());
+    TEST_ASSERT_EQUAL(1, erase_count);
+    TEST_ASSERT_EQUAL(FW_UPDATE_PAGE_SIZE, fw_update_get_writable());
+
+    // The writes only program the erased pages
+    TEST_ASSERT_TRUE(fw_update_write(image, FW_UPDATE_PAGE_SIZE - 3));
+    TEST_ASSERT_EQUAL(3, fw_update_get_writable());
+    TEST_ASSERT_TRUE(fw_update_write(image, 3));
+    TEST_ASSERT_EQUAL(0, fw_update_get_writable());
+    TEST_ASSERT_EQUAL(1, erase_count);
+
+    // The last page is erased, then nothing else
+    for (size_t i = 0; i < 4; i++)
+    {
+        TEST_ASSERT_TRUE(fw_update_erase_step());
+    }
+
+    TEST_ASSERT_EQUAL(4, erase_count);
+    TEST_ASSERT_EQUAL(IMAGE_SIZE - FW_UPDATE_PAGE_SIZE,
+                      fw_update_get_writable());
+
+    // A write beyond the erased pages aborts the update
+    TEST_ASSERT_FALSE(fw_update_write(image, IMAGE_SIZE));
+    TEST_ASSERT_FALSE(fw_update_erase_step());
+    TEST_ASSERT_EQUAL(0, fw_update_get_writable());
+}
+
+void test_fw_update_bad_crc(void)
+{
+    util_write_image(64);
+    TEST_ASSERT_FALSE(fw_update_finish(image_crc ^ 1));
+    util_reboot(FW_UPDATE_SLOT_A);
+}
+
+void test_fw_update_corrupted_flash(void)
+{
+    util_write_image(64);
+    flash_sim[FW_UPDATE_SLOT_B_ADDRESS - FLASH_SIM_BASE + 10] ^= 0x01;
+    TEST_ASSERT_FALSE(fw_update_finish(image_crc));
+    util_reboot(FW_UPDATE_SLOT_A);
+}
+
+void test_fw_update_incomplete(void)
+{
+    TEST_ASSERT_TRUE(fw_update_begin(IMAGE_SIZE));
+    util_erase(IMAGE_SIZE - 1);
+    TEST_ASSERT_TRUE(fw_update_write(image, IMAGE_SIZE - 1));
+    TEST_ASSERT_FALSE(fw_update_finish(image_crc));
+    TEST_ASSERT_FALSE(fw_update_write(image, 1));
+    util_reboot(FW_UPDATE_SLOT_A);
+}
+
+void test_fw_update_size(void)
+{
+    TEST_ASSERT_FALSE(fw_update_begin(0));
+    TEST_ASSERT_FALSE(fw_update_begin(FW_UPDATE_SLOT_SIZE + 1));
+    TEST_ASSERT_FALSE(fw_update_write(image, 1));
+
+    TEST_ASSERT_TRUE(fw_update_begin(8));
+    util_erase(8);
+    TEST_ASSERT_FALSE(fw_update_write(image, 9));
+}
+
+void test_fw_update_abort(void)
+{
+    TEST_ASSERT_TRUE(fw_update_begin(IMAGE_SIZE));
+    fw_update_abort();
+    TEST_ASSERT_FALSE(fw_update_write(image, 8));
+    TEST_ASSERT_FALSE(fw_update_finish(image_crc));
+}
+
+void test_fw_update_rollback(void)
+{
+    util_write_image(64);
+    TEST_ASSERT_TRUE(fw_update_finish(image_crc));
+
+    // A new update can not start until the image is confirmed
+    TEST_ASSERT_FALSE(fw_update_begin(IMAGE_SIZE));
+
+    for (size_t i = 0; i < FW_UPDATE_ATTEMPTS_MAX; i++)
+    {
+        util_reboot(FW_UPDATE_SLOT_B);
+    }
+
+    util_reboot(FW_UPDATE_SLOT_A);
+    util_reboot(FW_UPDATE_SLOT_A);
+}
+
+void test_fw_update_alternate_slots(void)
+{
+    util_write_image(64);
+    TEST_ASSERT_TRUE(fw_update_finish(image_crc));
+    util_reboot(FW_UPDATE_SLOT_B);
+    TEST_ASSERT_TRUE(fw_update_confirm());
+
+    util_write_image(64);
+    TEST_ASSERT_TRUE(fw_update_finish(image_crc));
+    TEST_ASSERT_EQUAL_MEMORY(image,
+                             &flash_sim[FW_UPDATE_SLOT_A_ADDRESS - FLASH_SIM_BASE],
+                             IMAGE_SIZE);
+    util_reboot(FW_UPDATE_SLOT_A);
+
+    // Roll back to the slot B, the last confirmed one
+    for (size_t i = 1; i < FW_UPDATE_ATTEMPTS_MAX; i++)
+    {
+        util_reboot(FW_UPDATE_SLOT_A);
+    }
+
+    util_reboot(FW_UPDATE_SLOT_B);
+}
+
+void test_fw_update_meta_page_full(void)
+{
+    size_t records = FW_UPDATE_PAGE_SIZE / RECORD_SIZE;
+
+    util_write_image(64);
+    TEST_ASSERT_TRUE(fw_update_finish(image_crc));
+    util_reboot(FW_UPDATE_SLOT_B);
+    TEST_ASSERT_TRUE(fw_update_confirm());
+
+    // Fill the metadata page with pending records that are rolled back
+    for (size_t i = 0; i < records; i++)
+    {
+        util_write_image(64);
+        TEST_ASSERT_TRUE(fw_update_finish(image_crc));
+
+        for (size_t j = 0; j <= FW_UPDATE_ATTEMPTS_MAX; j++)
+        {
+            fw_update_slot_t slot;
+
+            TEST_ASSERT_TRUE(fw_update_init());
+            TEST_ASSERT_TRUE(fw_update_boot(&slot));
+        }
+
+        TEST_ASSERT_EQUAL(FW_UPDATE_SLOT_B, fw_update_get_slot());
+    }
+
+    util_reboot(FW_UPDATE_SLOT_B);
+
+    // The records alternate between the two metadata pages
+    TEST_ASSERT_TRUE(meta_erase_count >= 2);
+}
+
+void test_fw_update_meta_power_loss(void)
+{
+    size_t records = FW_UPDATE_PAGE_SIZE / RECORD_SIZE;
+
+    util_write_image(64);
+    TEST_ASSERT_TRUE(fw_update_finish(image_crc));
+    util_reboot(FW_UPDATE_SLOT_B);
+    TEST_ASSERT_TRUE(fw_update_confirm());
+
+    // Boots of pending images until the metadata pages are switched twice
+    for (size_t i = 0; i <= ((2 * records) / (FW_UPDATE_ATTEMPTS_MAX + 2)); i++)
+    {
+        util_write_image(64);
+        TEST_ASSERT_TRUE(fw_update_finish(image_crc));
+
+        for (size_t j = 0; j <= FW_UPDATE_ATTEMPTS_MAX; j++)
+        {
+            util_boot_power_loss(FW_UPDATE_SLOT_B);
+        }
+
+        TEST_ASSERT_EQUAL(FW_UPDATE_SLOT_B, fw_update_get_slot());
+    }
+}
+
+void test_fw_update_meta_default(void)
+{
+    uint32_t magic;
+
+    // Without a confirmed record, the slot A is rolled back to
+    while (meta_erase_count < 1)
+    {
+        util_write_image(64);
+        TEST_ASSERT_TRUE(fw_update_finish(image_crc));
+        TEST_ASSERT_EQUAL(FW_UPDATE_SLOT_A, util_rollback());
+    }
+
+    util_reboot(FW_UPDATE_SLOT_A);
+
+    // The default record is copied complete to the other page
+    memcpy(&magic, &flash_sim[FW_UPDATE_META_ADDRESS + FW_UPDATE_PAGE_SIZE
+                              - FLASH_SIM_BASE], sizeof(magic));
+    TEST_ASSERT_EQUAL_HEX32(0x50555746, magic);
+}
+
+void test_fw_update_torn_record(void)
+{
+    util_write_image(64);
+    TEST_ASSERT_TRUE(fw_update_finish(image_crc));
+
+    // Corrupt the pending record as if the write was interrupted
+    flash_sim[FW_UPDATE_META_ADDRESS - FLASH_SIM_BASE + 8] ^= 0x01;
+    util_reboot(FW_UPDATE_SLOT_A);
+}
+
+/******************************** End of file *********************************/
@@ -0,0 +1,226 @@
+/*******************************************************************************
+ * @file test_lptimTick.c
+ * @author juanmanuel.fernandez@iertec.com
+ * @date 19 Oct 2026
+ * @brief Unit test for the tickless idle of lptimTick.c, run over the LPTIM
+ * model of lptim_sim.
+ ******************************************************************************/
+
+#include "lptim_sim.h"
+#include "test_util.h"
+
+#include "unity.h"
+
+/****************************************************************************//*
+ * Dependencies
+ ******************************************************************************/
+
+const char test_file_name[] = __FILE_NAME__;
+
+// Test dependencies
+TEST_FILE("lptimTick.c")
+TEST_FILE("lptim_sim.c")
+TEST_FILE("test_util.c")
+
+/****************************************************************************//*
+ * Constants and macros
+ ******************************************************************************/
+
+/** Timer counts of a number of ticks, rounded down. */
+#define COUNTS(X)      ((uint64_t)(X) * LPTIM_SIM_CLOCK_HZ / configTICK_RATE_HZ)
+
+/** Timer counts of a tick, rounded up. */
+#define TICK_COUNTS    (COUNTS(1) + 1u)
+
+/** Number of task cycles of the randomized test. */
+#define TEST_CYCLES    (2000u)
+
+/** Probability in percent of an execution time jitter. */
+#define TEST_JITTER    (30u)
+
+/** Maximum number of sleeps of an uninterrupted tickless idle. There is one
+ * for the sleep, and one for each CMP write completion. */
+#define TEST_SLEEP_MAX (3u)
+
+/****************************************************************************//*
+ * Private data
+ ******************************************************************************/
+
+static uint32_t test_seed;
+
+/****************************************************************************//*
+ * Private code
+ ******************************************************************************/
+
+static uint32_t test_rand(uint32_t max)
+{
+    return test_util_rand(&test_seed) % max;
+}
+
+static void wake_cb(void)
+{
+    lptim_sim_set_ready();
+}
+
+static void idle_until_ready(void)
+{
+    while (!lptim_sim_is_ready())
+    {
+        lptim_sim_idle();
+    }
+}
+
+/**
+ * Check that the kernel time follows the timer with no drift. The ticks are
+ * counted one count after their ideal time, so up to one tick of difference
+ * is accepted.
+ */
+static void check_drift(uint32_t dropped)
+{
+    const lptim_sim_stats_t * stats = lptim_sim_get_stats();
+    uint32_t ideal = (uint32_t)(stats->time * configTICK_RATE_HZ
+                                / LPTIM_SIM_CLOCK_HZ);
+
+    TEST_ASSERT_UINT32_WITHIN(1, ideal, stats->ticks + dropped);
+}
+
+/****************************************************************************//*
+ * Tests
+ ******************************************************************************/
+
+void setUp(void)
+{
+    test_seed = TEST_UTIL_SEED;
+    lptim_sim_init(TEST_UTIL_SEED, 0);
+}
+
+void test_lptimTick_tick(void)
+{
+    // Without idle time the tick runs at the exact rate. The last tick is
+    // counted when CMPM is set, one count after the match.
+    lptim_sim_run(LPTIM_SIM_CLOCK_HZ * 10u + 1u);
+
+    TEST_ASSERT_EQUAL_UINT32(10u * configTICK_RATE_HZ,
+                             lptim_sim_get_stats()->ticks);
+    TEST_ASSERT_EQUAL_UINT32(0, lptim_sim_get_stats()->sleep_count);
+    TEST_ASSERT_EQUAL_UINT32(0, lptim_sim_get_stats()->dropped);
+}
+
+void test_lptimTick_idle(void)
+{
+    const lptim_sim_stats_t * stats = lptim_sim_get_stats();
+
+    lptim_sim_block(100);
+    idle_until_ready();
+
+    // The task is unblocked in the right tick, after a few sleeps
+    TEST_ASSERT_EQUAL_UINT32(100, stats->ticks);
+    TEST_ASSERT_UINT32_WITHIN(TICK_COUNTS, COUNTS(100), stats->time);
+    TEST_ASSERT_TRUE(stats->sleep_count <= TEST_SLEEP_MAX);
+    TEST_ASSERT_TRUE(stats->sleep_time > COUNTS(98));
+    check_drift(0);
+}
+
+void test_lptimTick_idle_long(void)
+{
+    const lptim_sim_stats_t * stats = lptim_sim_get_stats();
+
+    // Beyond the timer range the idle time is split
+    lptim_sim_block(5000);
+    idle_until_ready();
+
+    TEST_ASSERT_EQUAL_UINT32(5000, stats->ticks);
+    TEST_ASSERT_UINT32_WITHIN(TICK_COUNTS, COUNTS(5000), stats->time);
+    TEST_ASSERT_TRUE(stats->sleep_count <= 3u * TEST_SLEEP_MAX);
+    check_drift(0);
+}
+
+void test_lptimTick_wake(void)
+{
+    const lptim_sim_stats_t * stats = lptim_sim_get_stats();
+
+    // An interrupt wakes the task up in the middle of the idle time
+    lptim_sim_block(1000);
+    lptim_sim_set_event(COUNTS(400) + 7u, wake_cb);
+    idle_until_ready();
+
+    TEST_ASSERT_UINT32_WITHIN(1, 400, stats->ticks);
+    check_drift(0);
+
+    // The next tick is rescheduled where it would have been
+    lptim_sim_block(1000);
+    idle_until_ready();
+
+    TEST_ASSERT_EQUAL_UINT32(1000, stats->ticks);
+    TEST_ASSERT_UINT32_WITHIN(TICK_COUNTS, COUNTS(1000), stats->time);
+    check_drift(0);
+}
+
+void test_lptimTick_dropped(void)
+{
+    const lptim_sim_stats_t * stats = lptim_sim_get_stats();
+
+    lptim_sim_run(COUNTS(10));
+
+    // A long critical section drops the ticks, and they are reported
+    lptim_sim_mask(true);
+    lptim_sim_run(COUNTS(100));
+    lptim_sim_mask(false);
+
+    TEST_ASSERT_UINT32_WITHIN(1, 99, stats->dropped);
+    check_drift(stats->dropped);
+
+    lptim_sim_block(stats->ticks + 50u);
+    idle_until_ready();
+    check_drift(stats->dropped);
+}
+
+void test_lptimTick_random(void)
+{
+    const lptim_sim_stats_t * stats = lptim_sim_get_stats();
+    uint32_t cycles = 0;
+
+    lptim_sim_init(TEST_UTIL_SEED, TEST_JITTER);
+
+    for (uint32_t i = 0; i < TEST_CYCLES; i++)
+    {
+        uint32_t sleep_count = stats->sleep_count;
+        TickType_t unblock = stats->ticks + 1u + test_rand(i % 10u == 0u
+                                                           ? 3000u : 40u);
+
+        // Some of the idle periods are cut short by an interrupt
+        if (test_rand(4) == 0u)
+        {
+            lptim_sim_set_event(stats->time + 1u
+                                + test_rand(COUNTS(unblock - stats->ticks)),
+                                wake_cb);
+        }
+
+        lptim_sim_block(unblock);
+        idle_until_ready();
+        lptim_sim_set_event(0, NULL);
+        check_drift(0);
+
+        if (stats->ticks == unblock)
+        {
+            cycles++;
+        }
+        else
+        {
+            TEST_ASSERT_TRUE((int32_t)(unblock - stats->ticks) > 0);
+        }
+
+        // The idle time is not fragmented in many sleeps
+        TEST_ASSERT_TRUE(stats->sleep_count - sleep_count
+                         <= 2u * TEST_SLEEP_MAX);
+
+        // The task runs for a while before blocking again
+        lptim_sim_run(test_rand(2u * TICK_COUNTS));
+        check_drift(0);
+    }
+
+    TEST_ASSERT_TRUE(cycles > TEST_CYCLES / 2u);
+    TEST_ASSERT_EQUAL_UINT32(0, stats->dropped);
+}
+
+/******************************** End of file *********************************/
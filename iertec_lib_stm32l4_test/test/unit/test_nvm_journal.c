@@ -0,0 +1,394 @@
+/*******************************************************************************
+ * @file test_nvm_journal.c
+ * @author juanmanuel.fernandez@iertec.com
+ * @date 19 Oct 2026
+ * @brief Unit test for the module nvm_journal.
+ ******************************************************************************/
+
+#include "nvm_journal.h"
+#include "crypt_crc32.h"
+
+#include "unity.h"
+
+#include <stdlib.h>
+#include <string.h>
+
+/****************************************************************************//*
+ * Dependencies
+ ******************************************************************************/
+
+const char test_file_name[] = __FILE_NAME__;
+
+// Test dependencies
+#include "mock_itf_flash.h"
+
+/****************************************************************************//*
+ * Constants and macros
+ ******************************************************************************/
+
+#define FLASH_SIM_BASE   (NVM_JOURNAL_ADDRESS_0)
+#define FLASH_SIM_SIZE   (NVM_JOURNAL_PAGE_SIZE * 2)
+
+#define ID_CALIB         (0)
+#define ID_VERSION       (1)
+#define ID_EXTRA         (2)
+
+#define CALIB_SIZE       (36)
+#define EXTRA_SIZE_MAX   (120)
+
+#define POWER_CUT_SEED   (12345)
+#define POWER_CUT_CYCLES (3000)
+
+/****************************************************************************//*
+ * Private data types
+ ******************************************************************************/
+
+typedef struct
+{
+    uint32_t version;
+    uint8_t  values[CALIB_SIZE - sizeof(uint32_t)];
+} calib_t;
+
+/****************************************************************************//*
+ * Private data
+ ******************************************************************************/
+
+static uint8_t flash_sim[FLASH_SIM_SIZE];
+
+/** Number of FLASH operations until the power is cut, 0 to disable it. */
+static uint32_t power_cut_budget;
+static bool power_off;
+
+/****************************************************************************//*
+ * Private code
+ ******************************************************************************/
+
+static bool util_power_cut(void)
+{
+    if (power_off)
+    {
+        return true;
+    }
+
+    if ((power_cut_budget > 0) && (--power_cut_budget == 0))
+    {
+        power_off = true;
+    }
+
+    return power_off;
+}
+
+static bool stub_itf_flash_erase(uint32_t address, size_t length)
+{
+    TEST_ASSERT_TRUE(address >= FLASH_SIM_BASE);
+    TEST_ASSERT_TRUE((address - FLASH_SIM_BASE + length) <= FLASH_SIM_SIZE);
+
+    if (util_power_cut())
+    {
+        // An interrupted erase leaves some bits set
+        for (size_t i = 0; i < length; i++)
+        {
+            flash_sim[address - FLASH_SIM_BASE + i] |= (uint8_t)rand();
+        }
+
+        return false;
+    }
+
+    memset(&flash_sim[address - FLASH_SIM_BASE], 0xFF, length);
+
+    return true;
+}
+
+static bool stub_itf_flash_write(uint32_t address, const uint8_t * data,
+                                 size_t length)
+{
+    TEST_ASSERT_TRUE(address >= FLASH_SIM_BASE);
+    TEST_ASSERT_TRUE((address - FLASH_SIM_BASE + length) <= FLASH_SIM_SIZE);
+    TEST_ASSERT_EQUAL_UINT32(0, (address - FLASH_SIM_BASE) % 8);
+    TEST_ASSERT_EQUAL_UINT32(0, length % 8);
+
+    for (size_t i = 0; i < length; i += 8)
+    {
+        uint8_t * dword = &flash_sim[address - FLASH_SIM_BASE + i];
+
+        if (util_power_cut())
+        {
+            // An interrupted program leaves some bits cleared
+            for (size_t j = 0; j < 8; j++)
+            {
+                dword[j] &= (uint8_t)rand() | data[i + j];
+            }
+
+            return false;
+        }
+
+        // Only erased memory can be programmed
+        TEST_ASSERT_EACH_EQUAL_HEX8(0xFF, dword, 8);
+        memcpy(dword, &data[i], 8);
+    }
+
+    return true;
+}
+
+static bool stub_itf_flash_read(uint32_t address, uint8_t * data, size_t length)
+{
+    TEST_ASSERT_TRUE(address >= FLASH_SIM_BASE);
+    TEST_ASSERT_TRUE((address - FLASH_SIM_BASE + length) <= FLASH_SIM_SIZE);
+
+    memcpy(data, &flash_sim[address - FLASH_SIM_BASE], length);
+
+    return true;
+}
+
+static void util_reboot(void)
+{
+    power_off = false;
+    power_cut_budget = 0;
+    TEST_ASSERT_TRUE(nvm_journal_init());
+}
+
+static void util_fill_calib(calib_t * calib, uint32_t version)
+{
+    calib->version = version;
+
+    for (size_t i = 0; i < sizeof(calib->values); i++)
+    {
+        calib->values[i] = (uint8_t)(version + i);
+    }
+}
+
+static bool util_update(uint32_t version, size_t extra_len)
+{
+    calib_t calib;
+    uint8_t extra[EXTRA_SIZE_MAX];
+    bool ret;
+
+    util_fill_calib(&calib, version);
+    memset(extra, (uint8_t)version, sizeof(extra));
+
+    ret = nvm_journal_begin();
+    ret = ret && nvm_journal_write(ID_CALIB, (uint8_t *)&calib, sizeof(calib));
+    ret = ret && nvm_journal_write(ID_EXTRA, extra, extra_len);
+    ret = ret && nvm_journal_write(ID_VERSION, (uint8_t *)&version,
+                                   sizeof(version));
+
+    if (ret)
+    {
+        ret = nvm_journal_commit();
+    }
+    else
+    {
+        nvm_journal_rollback();
+    }
+
+    return ret;
+}
+
+static bool util_check(uint32_t * version)
+{
+    calib_t calib;
+    calib_t calib_exp;
+    uint8_t extra[EXTRA_SIZE_MAX];
+    size_t length;
+
+    if (!nvm_journal_read(ID_VERSION, (uint8_t *)version, sizeof(*version),
+                          &length))
+    {
+        // Nothing committed yet, no record must exist
+        TEST_ASSERT_FALSE(nvm_journal_read(ID_CALIB, (uint8_t *)&calib,
+                                           sizeof(calib), NULL));
+        TEST_ASSERT_FALSE(nvm_journal_read(ID_EXTRA, extra, sizeof(extra),
+                                           NULL));
+        return false;
+    }
+
+    TEST_ASSERT_EQUAL(sizeof(*version), length);
+
+    // All the records belong to the same transaction
+    TEST_ASSERT_TRUE(nvm_journal_read(ID_CALIB, (uint8_t *)&calib,
+                                      sizeof(calib), &length));
+    TEST_ASSERT_EQUAL(sizeof(calib), length);
+    util_fill_calib(&calib_exp, *version);
+    TEST_ASSERT_EQUAL_MEMORY(&calib_exp, &calib, sizeof(calib));
+
+    TEST_ASSERT_TRUE(nvm_journal_read(ID_EXTRA, extra, sizeof(extra), &length));
+
+    for (size_t i = 0; i < length; i++)
+    {
+        TEST_ASSERT_EQUAL_HEX8((uint8_t)*version, extra[i]);
+    }
+
+    return true;
+}
+
+/****************************************************************************//*
+ * Tests
+ ******************************************************************************/
+
+void setUp(void)
+{
+    memset(flash_sim, 0xFF, sizeof(flash_sim));
+
+    itf_flash_erase_Stub(stub_itf_flash_erase);
+    itf_flash_write_Stub(stub_itf_flash_write);
+    itf_flash_read_Stub(stub_itf_flash_read);
+
+    util_reboot();
+}
+
+void test_nvm_journal_empty(void)
+{
+    uint8_t data[8];
+    uint32_t version;
+
+    TEST_ASSERT_FALSE(nvm_journal_read(ID_CALIB, data, sizeof(data), NULL));
+    TEST_ASSERT_FALSE(util_check(&version));
+    util_reboot();
+    TEST_ASSERT_FALSE(util_check(&version));
+}
+
+void test_nvm_journal_commit(void)
+{
+    uint32_t version = 0;
+
+    TEST_ASSERT_TRUE(util_update(1, 5));
+    TEST_ASSERT_TRUE(util_check(&version));
+    TEST_ASSERT_EQUAL_UINT32(1, version);
+
+    util_reboot();
+    TEST_ASSERT_TRUE(util_check(&version));
+    TEST_ASSERT_EQUAL_UINT32(1, version);
+}
+
+void test_nvm_journal_rollback(void)
+{
+    uint32_t version = 1;
+    uint32_t version_read = 0;
+
+    TEST_ASSERT_TRUE(util_update(1, 8));
+
+    version = 2;
+    TEST_ASSERT_TRUE(nvm_journal_begin());
+    TEST_ASSERT_TRUE(nvm_journal_write(ID_VERSION, (uint8_t *)&version,
+                                       sizeof(version)));
+    nvm_journal_rollback();
+
+    TEST_ASSERT_TRUE(util_check(&version_read));
+    TEST_ASSERT_EQUAL_UINT32(1, version_read);
+
+    util_reboot();
+    TEST_ASSERT_TRUE(util_check(&version_read));
+    TEST_ASSERT_EQUAL_UINT32(1, version_read);
+
+    TEST_ASSERT_TRUE(util_update(3, 0));
+    util_reboot();
+    TEST_ASSERT_TRUE(util_check(&version_read));
+    TEST_ASSERT_EQUAL_UINT32(3, version_read);
+}
+
+void test_nvm_journal_uncommitted_reboot(void)
+{
+    uint32_t version = 2;
+    uint32_t version_read = 0;
+
+    TEST_ASSERT_TRUE(util_update(1, 8));
+
+    TEST_ASSERT_TRUE(nvm_journal_begin());
+    TEST_ASSERT_TRUE(nvm_journal_write(ID_VERSION, (uint8_t *)&version,
+                                       sizeof(version)));
+
+    util_reboot();
+    TEST_ASSERT_TRUE(util_check(&version_read));
+    TEST_ASSERT_EQUAL_UINT32(1, version_read);
+}
+
+void test_nvm_journal_invalid(void)
+{
+    uint8_t data[NVM_JOURNAL_DATA_MAX + 1] = {0};
+
+    TEST_ASSERT_FALSE(nvm_journal_write(ID_CALIB, data, 1));
+    TEST_ASSERT_FALSE(nvm_journal_commit());
+
+    TEST_ASSERT_TRUE(nvm_journal_begin());
+    TEST_ASSERT_FALSE(nvm_journal_begin());
+    TEST_ASSERT_FALSE(nvm_journal_write(NVM_JOURNAL_ID_MAX, data, 1));
+    TEST_ASSERT_FALSE(nvm_journal_write(ID_CALIB, NULL, 1));
+    TEST_ASSERT_FALSE(nvm_journal_write(ID_CALIB, data, sizeof(data)));
+    TEST_ASSERT_TRUE(nvm_journal_write(ID_CALIB, data, NVM_JOURNAL_DATA_MAX));
+    TEST_ASSERT_TRUE(nvm_journal_commit());
+
+    TEST_ASSERT_FALSE(nvm_journal_read(ID_CALIB, data, NVM_JOURNAL_DATA_MAX - 1,
+                                       NULL));
+    TEST_ASSERT_TRUE(nvm_journal_read(ID_CALIB, data, NVM_JOURNAL_DATA_MAX,
+                                      NULL));
+}
+
+void test_nvm_journal_compaction(void)
+{
+    uint32_t version = 0;
+
+    // Several times the capacity of a page
+    for (uint32_t i = 1; i <= 200; i++)
+    {
+        TEST_ASSERT_TRUE(util_update(i, i % EXTRA_SIZE_MAX));
+        TEST_ASSERT_TRUE(util_check(&version));
+        TEST_ASSERT_EQUAL_UINT32(i, version);
+    }
+
+    util_reboot();
+    TEST_ASSERT_TRUE(util_check(&version));
+    TEST_ASSERT_EQUAL_UINT32(200, version);
+}
+
+void test_nvm_journal_power_cut(void)
+{
+    uint32_t version = 0;
+    uint32_t version_read = 0;
+    uint32_t cuts = 0;
+
+    srand(POWER_CUT_SEED);
+
+    for (uint32_t cycle = 1; cycle <= POWER_CUT_CYCLES; cycle++)
+    {
+        // Cut the power at a random FLASH operation of the update
+        power_cut_budget = (rand() % 4 == 0) ? 0 : (1 + (rand() % 40));
+
+        bool ret = util_update(cycle, rand() % EXTRA_SIZE_MAX);
+
+        if (power_off)
+        {
+            cuts++;
+        }
+        else
+        {
+            TEST_ASSERT_TRUE(ret);
+        }
+
+        util_reboot();
+
+        bool found = util_check(&version_read);
+
+        if (ret)
+        {
+            TEST_ASSERT_TRUE(found);
+            TEST_ASSERT_EQUAL_UINT32(cycle, version_read);
+        }
+        else if (found)
+        {
+            // The commit can reach the FLASH even if the power was cut later
+            TEST_ASSERT_TRUE((version_read == version)
+                             || (version_read == cycle));
+        }
+        else
+        {
+            TEST_ASSERT_EQUAL_UINT32(0, version);
+        }
+
+        version = found ? version_read : 0;
+    }
+
+    TEST_PRINTF("Power cuts: %u", cuts);
+    TEST_ASSERT_GREATER_THAN_UINT32(POWER_CUT_CYCLES / 4, cuts);
+}
+
+/******************************** End of file *********************************/
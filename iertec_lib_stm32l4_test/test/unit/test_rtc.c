@@ -6,6 +6,7 @@
  ******************************************************************************/
 
 #include "rtc.h"
+#include "test_util.h"
 
 #include "unity.h"
 
@@ -38,7 +39,24 @@ const char test_file_name[] = __FILE_NAME__;
 //TEST_FILE("test_main.c")
 
 // Test dependencies
+TEST_FILE("test_util.c")
 #include "mock_itf_rtc.h"
+#include "mock_sys_util.h"
+#include "mock_portmacro.h"
+
+/*******************************************************************************
+ * Constants and macros
+ ******************************************************************************/
+
+/** Number of days from 1/1/2001 to 1/1/2100. */
+#define DAYS_2001_2099 (36159)
+
+/** Number of conversions of each benchmark batch. */
+#ifdef TEST_TARGET
+#define BENCH_OPS (2000u)
+#else
+#define BENCH_OPS (1000000u)
+#endif
 
 /*******************************************************************************
  * Private data
@@ -46,6 +64,8 @@ const char test_file_name[] = __FILE_NAME__;
 
 static uint32_t stub_seconds;
 static uint8_t stub_cseconds;
+static uint32_t stub_fraction;
+static uint32_t rand_seed;
 
 /*******************************************************************************
  * Private code
@@ -63,6 +83,113 @@ static void stub_itf_rtc_get_time(uint32_t *seconds, uint8_t *cseconds)
     *cseconds = stub_cseconds;
 }
 
+static void stub_itf_rtc_get_time_frac(uint32_t *seconds, uint32_t *fraction)
+{
+    *seconds = stub_seconds;
+    *fraction = stub_fraction;
+}
+
+/**
+ * Reference conversion from timestamp to date/time in calendar format, with
+ * the quadrennium division and the month search of the former implementation.
+ * It is valid until 2099.
+ */
+static void util_ref_timestamp_to_datetime(datetime_t *datetime,
+                                           uint32_t timestamp)
+{
+    static const uint32_t days_until_month[2][13] =
+    {
+        {0, 0, 31, 59, 90, 120, 151, 181, 212, 243, 273, 304, 334},
+        {0, 0, 31, 60, 91, 121, 152, 182, 213, 244, 274, 305, 335},
+    };
+    uint32_t year_quadrennium;
+    uint32_t day_julian;
+    uint32_t year;
+    uint32_t i;
+
+    year = (timestamp / 126230400) * 4;
+    timestamp %= 126230400;
+    year_quadrennium = timestamp / 31536000;
+
+    if (year_quadrennium == 4)
+    {
+        year_quadrennium = 3;
+    }
+
+    year += year_quadrennium;
+    timestamp -= year_quadrennium * 31536000;
+    day_julian = timestamp / 86400 + 1;
+    timestamp %= 86400;
+
+    for (i = 12; day_julian <= days_until_month[year % 4 == 3][i]; i--)
+    {
+        // Get the month through the Julian day
+    }
+
+    datetime->year = (year + 1) % 100;
+    datetime->month = i;
+    datetime->day = day_julian - days_until_month[year % 4 == 3][i];
+    datetime->hour = timestamp / 3600;
+    datetime->minutes = (timestamp % 3600) / 60;
+    datetime->seconds = timestamp % 60;
+}
+
+static void util_check_datetime(uint32_t timestamp)
+{
+    const datetime_t base = {.year = 1, .month = 1, .day = 1};
+    datetime_t time_exp;
+    datetime_t time_get;
+
+    util_ref_timestamp_to_datetime(&time_exp, timestamp);
+    stub_seconds = timestamp;
+    rtc_get_datetime(&time_get);
+
+    TEST_ASSERT_EQUAL_UINT8(time_exp.year, time_get.year);
+    TEST_ASSERT_EQUAL_UINT8(time_exp.month, time_get.month);
+    TEST_ASSERT_EQUAL_UINT8(time_exp.day, time_get.day);
+    TEST_ASSERT_EQUAL_UINT8(time_exp.hour, time_get.hour);
+    TEST_ASSERT_EQUAL_UINT8(time_exp.minutes, time_get.minutes);
+    TEST_ASSERT_EQUAL_UINT8(time_exp.seconds, time_get.seconds);
+
+    // The inverse conversion gives the same timestamp
+    TEST_ASSERT_EQUAL_INT64(timestamp,
+                            rtc_compare_datetime(&time_get, false,
+                                                 &base, false));
+}
+
+/**
+ * Check the local time of a time zone at an UTC time.
+ *
+ * @param[in] tz Time zone string.
+ * @param[in] time_utc UTC time.
+ * @param[in] time_exp Expected local time, with its deviation from UTC.
+ */
+static void util_check_tz(const char *tz, const datetime_t *time_utc,
+                          const datetime_t *time_exp)
+{
+    datetime_t time_get;
+
+    itf_rtc_set_time_Stub(stub_itf_rtc_set_time);
+    itf_rtc_get_time_Stub(stub_itf_rtc_get_time);
+
+    TEST_ASSERT_TRUE(rtc_set_tz(tz));
+    TEST_ASSERT_TRUE(rtc_set_datetime(time_utc, false));
+    rtc_get_datetime(&time_get);
+
+    TEST_ASSERT_EQUAL_UINT8(time_exp->year, time_get.year);
+    TEST_ASSERT_EQUAL_UINT8(time_exp->month, time_get.month);
+    TEST_ASSERT_EQUAL_UINT8(time_exp->day, time_get.day);
+    TEST_ASSERT_EQUAL_UINT8(time_exp->hour, time_get.hour);
+    TEST_ASSERT_EQUAL_UINT8(time_exp->minutes, time_get.minutes);
+    TEST_ASSERT_EQUAL_UINT8(time_exp->seconds, time_get.seconds);
+    TEST_ASSERT_EQUAL_INT8(time_exp->delta_hour, time_get.delta_hour);
+    TEST_ASSERT_EQUAL_INT8(time_exp->delta_minutes, time_get.delta_minutes);
+
+    // The local time gives back the UTC time
+    TEST_ASSERT_EQUAL_INT64(0, rtc_compare_datetime(&time_get, true,
+                                                    time_utc, false));
+}
+
 static void util_stub_seconds_increment(uint32_t seconds)
 {
     stub_seconds += seconds;
@@ -98,6 +225,13 @@ void setUp(void)
 {
     stub_seconds = 0;
     stub_cseconds = 0;
+    stub_fraction = 0;
+    rand_seed = TEST_UTIL_SEED;
+
+    vPortEnterCritical_Ignore();
+    vPortExitCritical_Ignore();
+
+    rtc_set_tz(NULL);
 }
 
 void test_rtc_set_and_get_timestamp(void)
@@ -164,6 +298,366 @@ void test_rtc_epoch_time(void)
     TEST_ASSERT_EQUAL_UINT8(0, centiseconds_get);
 }
 
+void test_rtc_timestamp_sub(void)
+{
+    const uint32_t FRACTION[] = {0x00000000, 0x00000001, 0x40000000,
+                                 0x80000000, 0xFFFFFFFF};
+    const uint32_t MSEC_EXP[] = {0, 0, 250, 500, 999};
+    const uint32_t USEC_EXP[] = {0, 0, 250000, 500000, 999999};
+    uint32_t timestamp;
+    uint32_t fraction;
+    uint32_t subseconds;
+
+    itf_rtc_get_time_frac_Stub(stub_itf_rtc_get_time_frac);
+    stub_seconds = 1000;
+
+    for (size_t i = 0; i < sizeof(FRACTION) / sizeof(FRACTION[0]); i++)
+    {
+        stub_fraction = FRACTION[i];
+
+        rtc_get_timestamp_frac(&timestamp, &fraction);
+        TEST_ASSERT_EQUAL_UINT32(1000, timestamp);
+        TEST_ASSERT_EQUAL_HEX32(FRACTION[i], fraction);
+
+        rtc_get_timestamp_sub(&timestamp, &subseconds, RTC_RES_MSEC);
+        TEST_ASSERT_EQUAL_UINT32(1000, timestamp);
+        TEST_ASSERT_EQUAL_UINT32(MSEC_EXP[i], subseconds);
+
+        rtc_get_timestamp_sub(&timestamp, &subseconds, RTC_RES_USEC);
+        TEST_ASSERT_EQUAL_UINT32(USEC_EXP[i], subseconds);
+
+        // Resolutions that are not a power of 10
+        rtc_get_timestamp_sub(&timestamp, &subseconds, 1024);
+        TEST_ASSERT_EQUAL_UINT32(FRACTION[i] >> 22, subseconds);
+    }
+}
+
+void test_rtc_datetime_2001_2099(void)
+{
+    const datetime_t time_set = {.year = 1, .month = 1, .day = 1};
+
+    itf_rtc_set_time_Stub(stub_itf_rtc_set_time);
+    itf_rtc_get_time_Stub(stub_itf_rtc_get_time);
+    rtc_set_datetime(&time_set, false);
+
+    // Each day at its first and last second and at a random time
+    for (uint32_t day = 0; day < DAYS_2001_2099; day++)
+    {
+        util_check_datetime(day * 86400);
+        util_check_datetime(day * 86400
+                            + test_util_rand(&rand_seed) % 86400);
+        util_check_datetime(day * 86400 + 86399);
+    }
+
+    // Random timestamps, so the cached date is not the previous day
+    for (uint32_t i = 0; i < DAYS_2001_2099; i++)
+    {
+        util_check_datetime(test_util_rand(&rand_seed)
+                            % (DAYS_2001_2099 * 86400));
+    }
+}
+
+void test_rtc_datetime_leap_year(void)
+{
+    const datetime_t time_2096 = {.year = 96, .month = 2, .day = 29};
+    const datetime_t time_2100 = {.year = 0, .month = 2, .day = 29};
+    datetime_t time_get;
+
+    itf_rtc_set_time_Stub(stub_itf_rtc_set_time);
+    itf_rtc_get_time_Stub(stub_itf_rtc_get_time);
+
+    TEST_ASSERT_TRUE(rtc_set_datetime(&time_2096, false));
+
+    // 2100 is not a leap year
+    TEST_ASSERT_FALSE(rtc_set_datetime(&time_2100, false));
+
+    stub_seconds += (366 + 3 * 365) * 86400;
+    rtc_get_datetime(&time_get);
+    TEST_ASSERT_EQUAL_UINT8(0, time_get.year);
+    TEST_ASSERT_EQUAL_UINT8(3, time_get.month);
+    TEST_ASSERT_EQUAL_UINT8(1, time_get.day);
+}
+
+void test_rtc_datetime_bench(void)
+{
+    const datetime_t time_set = {.year = 21, .month = 9, .day = 12};
+    static uint32_t timestamp[BENCH_OPS];
+    datetime_t time_get;
+    uint32_t start;
+    uint32_t time_ref;
+    uint32_t time_seq;
+    uint32_t time_rand;
+
+    itf_rtc_set_time_Stub(stub_itf_rtc_set_time);
+    itf_rtc_get_time_Stub(stub_itf_rtc_get_time);
+    rtc_set_datetime(&time_set, false);
+
+    for (uint32_t i = 0; i < BENCH_OPS; i++)
+    {
+        timestamp[i] = test_util_rand(&rand_seed)
+                       % (DAYS_2001_2099 * 86400);
+    }
+
+    // Former conversion of random timestamps
+    start = test_util_clock();
+
+    for (uint32_t i = 0; i < BENCH_OPS; i++)
+    {
+        util_ref_timestamp_to_datetime(&time_get, timestamp[i]);
+    }
+
+    time_ref = test_util_clock() - start;
+
+    // Consecutive seconds, as the time read for each log line
+    start = test_util_clock();
+
+    for (uint32_t i = 0; i < BENCH_OPS; i++)
+    {
+        stub_seconds++;
+        rtc_get_datetime(&time_get);
+    }
+
+    time_seq = test_util_clock() - start;
+
+    // Random timestamps, converting the date each time
+    start = test_util_clock();
+
+    for (uint32_t i = 0; i < BENCH_OPS; i++)
+    {
+        stub_seconds = timestamp[i];
+        rtc_get_datetime(&time_get);
+    }
+
+    time_rand = test_util_clock() - start;
+
+#ifdef TEST_TARGET
+    TEST_PRINTF("Cycles per conversion: %u former, %u consecutive, %u random",
+#else
+    TEST_PRINTF("ns per conversion: %u former, %u consecutive, %u random",
+#endif
+                (unsigned int)(time_ref / BENCH_OPS),
+                (unsigned int)(time_seq / BENCH_OPS),
+                (unsigned int)(time_rand / BENCH_OPS));
+}
+
+void test_rtc_delta_minutes(void)
+{
+    datetime_t time_set = {.year = 21, .month = 9, .day = 12,
+                           .hour = 3, .minutes = 10, .seconds = 0,
+                           .delta_hour = -3, .delta_minutes = -30};
+    datetime_t time_exp = {.year = 21, .month = 9, .day = 12,
+                           .hour = 3, .minutes = 10, .seconds = 0,
+                           .delta_hour = -3, .delta_minutes = -30};
+    datetime_t time_utc = {.year = 21, .month = 9, .day = 12,
+                           .hour = 6, .minutes = 40, .seconds = 0};
+
+    util_set_inc_get_time(&time_set, &time_exp, 0);
+    TEST_ASSERT_EQUAL_INT64(0, rtc_compare_datetime(&time_set, true,
+                                                    &time_utc, false));
+
+    time_set.delta_minutes = 60;
+    TEST_ASSERT_FALSE(rtc_set_datetime(&time_set, true));
+}
+
+void test_rtc_tz_transitions(void)
+{
+    // Expected values from the IANA time zone database
+    const struct
+    {
+        const char *tz;
+        datetime_t utc;
+        datetime_t local;
+    } TZ[] =
+    {
+        // Europe/Madrid
+        {"CET-1CEST,M3.5.0,M10.5.0/3",
+         {.year = 21, .month = 3, .day = 28, .hour = 0, .minutes = 59,
+          .seconds = 59},
+         {.year = 21, .month = 3, .day = 28, .hour = 1, .minutes = 59,
+          .seconds = 59, .delta_hour = 1}},
+        {"CET-1CEST,M3.5.0,M10.5.0/3",
+         {.year = 21, .month = 3, .day = 28, .hour = 1},
+         {.year = 21, .month = 3, .day = 28, .hour = 3, .delta_hour = 2}},
+        {"CET-1CEST,M3.5.0,M10.5.0/3",
+         {.year = 21, .month = 10, .day = 31, .hour = 0, .minutes = 59,
+          .seconds = 59},
+         {.year = 21, .month = 10, .day = 31, .hour = 2, .minutes = 59,
+          .seconds = 59, .delta_hour = 2}},
+        {"CET-1CEST,M3.5.0,M10.5.0/3",
+         {.year = 21, .month = 10, .day = 31, .hour = 1},
+         {.year = 21, .month = 10, .day = 31, .hour = 2, .delta_hour = 1}},
+        // America/New_York, with the default rules
+        {"EST5EDT",
+         {.year = 21, .month = 3, .day = 14, .hour = 6, .minutes = 59,
+          .seconds = 59},
+         {.year = 21, .month = 3, .day = 14, .hour = 1, .minutes = 59,
+          .seconds = 59, .delta_hour = -5}},
+        {"EST5EDT,M3.2.0,M11.1.0",
+         {.year = 21, .month = 3, .day = 14, .hour = 7},
+         {.year = 21, .month = 3, .day = 14, .hour = 3, .delta_hour = -4}},
+        {"EST5EDT,M3.2.0,M11.1.0",
+         {.year = 21, .month = 11, .day = 7, .hour = 5, .minutes = 59,
+          .seconds = 59},
+         {.year = 21, .month = 11, .day = 7, .hour = 1, .minutes = 59,
+          .seconds = 59, .delta_hour = -4}},
+        {"EST5EDT",
+         {.year = 21, .month = 11, .day = 7, .hour = 6},
+         {.year = 21, .month = 11, .day = 7, .hour = 1, .delta_hour = -5}},
+        // Australia/Sydney, daylight saving time across the year end
+        {"AEST-10AEDT,M10.1.0,M4.1.0/3",
+         {.year = 21, .month = 4, .day = 3, .hour = 15, .minutes = 59,
+          .seconds = 59},
+         {.year = 21, .month = 4, .day = 4, .hour = 2, .minutes = 59,
+          .seconds = 59, .delta_hour = 11}},
+        {"AEST-10AEDT,M10.1.0,M4.1.0/3",
+         {.year = 21, .month = 4, .day = 3, .hour = 16},
+         {.year = 21, .month = 4, .day = 4, .hour = 2, .delta_hour = 10}},
+        {"AEST-10AEDT,M10.1.0,M4.1.0/3",
+         {.year = 21, .month = 10, .day = 2, .hour = 15, .minutes = 59,
+          .seconds = 59},
+         {.year = 21, .month = 10, .day = 3, .hour = 1, .minutes = 59,
+          .seconds = 59, .delta_hour = 10}},
+        {"AEST-10AEDT,M10.1.0,M4.1.0/3",
+         {.year = 21, .month = 10, .day = 2, .hour = 16},
+         {.year = 21, .month = 10, .day = 3, .hour = 3, .delta_hour = 11}},
+        {"AEST-10AEDT,M10.1.0,M4.1.0/3",
+         {.year = 21, .month = 12, .day = 31, .hour = 13},
+         {.year = 22, .month = 1, .day = 1, .hour = 0, .delta_hour = 11}},
+        // America/St_Johns, half hour deviation
+        {"NST3:30NDT,M3.2.0,M11.1.0",
+         {.year = 24, .month = 3, .day = 10, .hour = 5, .minutes = 29,
+          .seconds = 59},
+         {.year = 24, .month = 3, .day = 10, .hour = 1, .minutes = 59,
+          .seconds = 59, .delta_hour = -3, .delta_minutes = -30}},
+        {"NST3:30NDT,M3.2.0,M11.1.0",
+         {.year = 24, .month = 3, .day = 10, .hour = 5, .minutes = 30},
+         {.year = 24, .month = 3, .day = 10, .hour = 3, .delta_hour = -2,
+          .delta_minutes = -30}},
+        {"NST3:30NDT,M3.2.0,M11.1.0",
+         {.year = 24, .month = 11, .day = 3, .hour = 4, .minutes = 30},
+         {.year = 24, .month = 11, .day = 3, .hour = 1, .delta_hour = -3,
+          .delta_minutes = -30}},
+        // America/Nuuk, negative rule times
+        {"<-02>2<-01>,M3.5.0/-1,M10.5.0/0",
+         {.year = 30, .month = 3, .day = 31, .hour = 0, .minutes = 59,
+          .seconds = 59},
+         {.year = 30, .month = 3, .day = 30, .hour = 22, .minutes = 59,
+          .seconds = 59, .delta_hour = -2}},
+        {"<-02>2<-01>,M3.5.0/-1,M10.5.0/0",
+         {.year = 30, .month = 3, .day = 31, .hour = 1},
+         {.year = 30, .month = 3, .day = 31, .hour = 0, .delta_hour = -1}},
+        {"<-02>2<-01>,M3.5.0/-1,M10.5.0/0",
+         {.year = 30, .month = 10, .day = 27, .hour = 0, .minutes = 59,
+          .seconds = 59},
+         {.year = 30, .month = 10, .day = 26, .hour = 23, .minutes = 59,
+          .seconds = 59, .delta_hour = -1}},
+        {"<-02>2<-01>,M3.5.0/-1,M10.5.0/0",
+         {.year = 30, .month = 10, .day = 27, .hour = 1},
+         {.year = 30, .month = 10, .day = 26, .hour = 23, .delta_hour = -2}},
+        // Asia/Kathmandu, without daylight saving time
+        {"<+0545>-5:45",
+         {.year = 30, .month = 7, .day = 1},
+         {.year = 30, .month = 7, .day = 1, .hour = 5, .minutes = 45,
+          .delta_hour = 5, .delta_minutes = 45}},
+        // Julian day and day of the year rules in a leap year
+        {"AAA3BBB,J60,300",
+         {.year = 24, .month = 3, .day = 1, .hour = 4, .minutes = 59,
+          .seconds = 59},
+         {.year = 24, .month = 3, .day = 1, .hour = 1, .minutes = 59,
+          .seconds = 59, .delta_hour = -3}},
+        {"AAA3BBB,J60,300",
+         {.year = 24, .month = 3, .day = 1, .hour = 5},
+         {.year = 24, .month = 3, .day = 1, .hour = 3, .delta_hour = -2}},
+        {"AAA3BBB,J60,300",
+         {.year = 24, .month = 10, .day = 27, .hour = 3, .minutes = 59,
+          .seconds = 59},
+         {.year = 24, .month = 10, .day = 27, .hour = 1, .minutes = 59,
+          .seconds = 59, .delta_hour = -2}},
+        {"AAA3BBB,J60,300",
+         {.year = 24, .month = 10, .day = 27, .hour = 4},
+         {.year = 24, .month = 10, .day = 27, .hour = 1, .delta_hour = -3}},
+    };
+
+    for (size_t i = 0; i < sizeof(TZ) / sizeof(TZ[0]); i++)
+    {
+        util_check_tz(TZ[i].tz, &TZ[i].utc, &TZ[i].local);
+    }
+}
+
+void test_rtc_tz_local(void)
+{
+    // Skipped local time, taken after the transition
+    datetime_t time_gap = {.year = 21, .month = 3, .day = 28,
+                           .hour = 2, .minutes = 30};
+    datetime_t time_gap_exp = {.year = 21, .month = 3, .day = 28,
+                               .hour = 3, .minutes = 30, .delta_hour = 2};
+    // Repeated local time, taken as its first occurrence
+    datetime_t time_rep = {.year = 21, .month = 10, .day = 31,
+                           .hour = 2, .minutes = 30, .delta_hour = 5};
+    datetime_t time_rep_exp = {.year = 21, .month = 10, .day = 31,
+                               .hour = 2, .minutes = 30, .delta_hour = 2};
+    datetime_t time_get;
+
+    itf_rtc_set_time_Stub(stub_itf_rtc_set_time);
+    itf_rtc_get_time_Stub(stub_itf_rtc_get_time);
+    TEST_ASSERT_TRUE(rtc_set_tz("CET-1CEST,M3.5.0,M10.5.0/3"));
+
+    // The deviation of the local time is ignored
+    TEST_ASSERT_TRUE(rtc_set_datetime(&time_gap, true));
+    rtc_get_datetime(&time_get);
+    TEST_ASSERT_EQUAL_UINT8(time_gap_exp.hour, time_get.hour);
+    TEST_ASSERT_EQUAL_UINT8(time_gap_exp.minutes, time_get.minutes);
+    TEST_ASSERT_EQUAL_INT8(time_gap_exp.delta_hour, time_get.delta_hour);
+
+    TEST_ASSERT_TRUE(rtc_set_datetime(&time_rep, true));
+    rtc_get_datetime(&time_get);
+    TEST_ASSERT_EQUAL_UINT8(time_rep_exp.hour, time_get.hour);
+    TEST_ASSERT_EQUAL_UINT8(time_rep_exp.minutes, time_get.minutes);
+    TEST_ASSERT_EQUAL_INT8(time_rep_exp.delta_hour, time_get.delta_hour);
+
+    // One hour later, the repeated time in standard time
+    util_stub_seconds_increment(3600);
+    rtc_get_datetime(&time_get);
+    TEST_ASSERT_EQUAL_UINT8(2, time_get.hour);
+    TEST_ASSERT_EQUAL_UINT8(30, time_get.minutes);
+    TEST_ASSERT_EQUAL_INT8(1, time_get.delta_hour);
+
+    // Without time zone, the fixed deviation is used again
+    TEST_ASSERT_TRUE(rtc_set_tz(NULL));
+    rtc_get_datetime(&time_get);
+    TEST_ASSERT_EQUAL_INT8(5, time_get.delta_hour);
+}
+
+void test_rtc_tz_invalid(void)
+{
+    const char *TZ_INVALID[] =
+    {
+        "CE-1",
+        "CET",
+        "CET-25",
+        "CET-1:60",
+        "<+05-5",
+        "<+05>",
+        "CET-1CEST,M3.5.0",
+        "CET-1CEST,M13.5.0,M10.5.0",
+        "CET-1CEST,M3.6.0,M10.5.0",
+        "CET-1CEST,M3.5.7,M10.5.0",
+        "CET-1CEST,J0,M10.5.0",
+        "CET-1CEST,366,M10.5.0",
+        "CET-1CEST,M3.5.0/168,M10.5.0",
+        "CET-1CEST,M3.5.0,M10.5.0/3x",
+        "CET-1CEST-3,",
+    };
+
+    for (size_t i = 0; i < sizeof(TZ_INVALID) / sizeof(TZ_INVALID[0]); i++)
+    {
+        TEST_ASSERT_FALSE_MESSAGE(rtc_set_tz(TZ_INVALID[i]), TZ_INVALID[i]);
+    }
+
+    TEST_ASSERT_TRUE(rtc_set_tz("UTC0"));
+    TEST_ASSERT_TRUE(rtc_set_tz(""));
+}
+
 void test_rtc_compare_datetime(void)
 {
     int64_t ret;
@@ -0,0 +1,288 @@
+/*******************************************************************************
+ * @file test_rtc_sync.c
+ * @author juanmanuel.fernandez@iertec.com
+ * @date 19 Oct 2026
+ * @brief Unit test for the module rtc_sync. The tick clock is simulated with a
+ * frequency error, and the disciplined time is checked against the simulated
+ * time.
+ ******************************************************************************/
+
+#include "rtc_sync.h"
+#include "test_util.h"
+
+#include "unity.h"
+
+/****************************************************************************//*
+ * Dependencies
+ ******************************************************************************/
+
+const char test_file_name[] = __FILE_NAME__;
+
+// Test dependencies
+TEST_FILE("test_util.c")
+#include "mock_sys_util.h"
+#include "mock_portmacro.h"
+
+/****************************************************************************//*
+ * Constants and macros
+ ******************************************************************************/
+
+/** Source time at the simulation start (s). */
+#define SIM_BASE        (1000.0)
+
+/** Interval between the time reads of the simulation (s). */
+#define SIM_STEP        (10.0)
+
+/****************************************************************************//*
+ * Private data
+ ******************************************************************************/
+
+/** Simulated time (s). */
+static double sim_time;
+
+/** Offset of the source time from the simulated time (s). */
+static double sim_src;
+
+/** Frequency error of the tick clock (ppm). */
+static double sim_ppm;
+
+/** State of the source jitter pseudo random generator. */
+static uint32_t sim_seed;
+
+/** Last time read, to check that it is monotonic (s). */
+static double sim_last;
+
+/****************************************************************************//*
+ * Private code
+ ******************************************************************************/
+
+static uint64_t sim_clock(void)
+{
+    return (uint64_t)(sim_time * RTC_SYNC_CLK_FREQ * (1.0 + (sim_ppm * 1e-6)));
+}
+
+static double sim_jitter(double jitter_max)
+{
+    uint32_t value = test_util_rand(&sim_seed);
+
+    return jitter_max * (((double)(value % 2001u) / 1000.0) - 1.0);
+}
+
+/**
+ * Give the source time as synchronization point.
+ *
+ * @param[in] jitter Error of the source time (s).
+ * @param[in] precision_usec Precision given with the point.
+ *
+ * @return Return value of @ref rtc_sync_set_time.
+ */
+static bool util_sync(double jitter, uint32_t precision_usec)
+{
+    double   time      = SIM_BASE + sim_time + sim_src + jitter;
+    uint32_t timestamp = (uint32_t)time;
+    uint32_t fraction  = (uint32_t)((time - timestamp) * 4294967296.0);
+
+    return rtc_sync_set_time(timestamp, fraction, precision_usec);
+}
+
+/**
+ * Read the disciplined time, checking that it is monotonic.
+ *
+ * @return Error of the disciplined time from the source time (s).
+ */
+static double util_read(void)
+{
+    uint32_t timestamp;
+    uint32_t fraction;
+    double   time;
+
+    rtc_sync_get_time(&timestamp, &fraction);
+    time = (double)timestamp + ((double)fraction / 4294967296.0);
+
+    TEST_ASSERT_TRUE(time >= sim_last);
+    sim_last = time;
+
+    return time - (SIM_BASE + sim_time + sim_src);
+}
+
+/**
+ * Run the simulation, reading the time at each step and checking that the
+ * error is inside the estimated bound.
+ *
+ * @param[in] seconds Time to simulate (s).
+ *
+ * @return Maximum absolute error of the time read (s).
+ */
+static double util_run(double seconds)
+{
+    double end     = sim_time + seconds;
+    double err_max = 0.0;
+
+    while (sim_time < end)
+    {
+        sim_time += SIM_STEP;
+
+        double err = util_read();
+
+        err     = (err < 0.0) ? -err : err;
+        TEST_ASSERT_TRUE((err * 1e6) <= ((double)rtc_sync_get_error() + 1.0));
+        err_max = (err > err_max) ? err : err_max;
+    }
+
+    return err_max;
+}
+
+/****************************************************************************//*
+ * Tests
+ ******************************************************************************/
+
+void setUp(void)
+{
+    vPortEnterCritical_Ignore();
+    vPortExitCritical_Ignore();
+
+    sim_time = 0.0;
+    sim_src  = 0.0;
+    sim_ppm  = 0.0;
+    sim_seed = TEST_UTIL_SEED;
+    sim_last = 0.0;
+
+    rtc_sync_init(sim_clock);
+}
+
+void test_rtc_sync_first_step(void)
+{
+    TEST_ASSERT_EQUAL_UINT32(UINT32_MAX, rtc_sync_get_error());
+
+    // The first point steps the time, even with a small offset
+    sim_time = 0.5;
+    TEST_ASSERT_TRUE(util_sync(0.0, 1000));
+    TEST_ASSERT_DOUBLE_WITHIN(1e-6, 0.0, util_read());
+    TEST_ASSERT_EQUAL_UINT32(1000, rtc_sync_get_error());
+
+    // The error bound grows with the maximum frequency error
+    TEST_ASSERT_TRUE(util_run(100.0) < 1e-6);
+    TEST_ASSERT_UINT32_WITHIN(2, 1000 + (100 * RTC_SYNC_FREQ_MAX_PPM),
+                              rtc_sync_get_error());
+}
+
+void test_rtc_sync_slew(void)
+{
+    const double OFFSET[]  = {0.1, -0.1, 0.0005};
+    const double SLEW_TIME = 0.1 / (RTC_SYNC_SLEW_PPM * 1e-6);
+
+    TEST_ASSERT_TRUE(util_sync(0.0, 0));
+
+    for (size_t i = 0; i < sizeof(OFFSET) / sizeof(OFFSET[0]); i++)
+    {
+        double start;
+        double err;
+
+        // The offset is not stepped
+        sim_time += 10.0;
+        sim_src  += OFFSET[i];
+        start     = sim_time;
+        TEST_ASSERT_FALSE(util_sync(0.0, 0));
+        err = util_read();
+        TEST_ASSERT_DOUBLE_WITHIN(1e-6, -OFFSET[i], err);
+
+        // The error and its bound are reduced at the slew rate, and the bound
+        // includes the drift until the frequency error is estimated
+        sim_time += SLEW_TIME / 4.0;
+        err       = util_read();
+
+        if ((OFFSET[i] > 0.01) || (OFFSET[i] < -0.01))
+        {
+            TEST_ASSERT_DOUBLE_WITHIN(1e-5, -OFFSET[i] * 0.75, err);
+            TEST_ASSERT_UINT32_WITHIN(10, 75000 + (uint32_t)(
+                                          (sim_time - start)
+                                          * RTC_SYNC_FREQ_MAX_PPM),
+                                      rtc_sync_get_error());
+        }
+
+        // Monotonic during the slew, and the offset is cancelled at its end
+        (void)util_run(SLEW_TIME);
+        TEST_ASSERT_DOUBLE_WITHIN(1e-6, 0.0, util_read());
+        TEST_ASSERT_UINT32_WITHIN(10, (uint32_t)((sim_time - start)
+                                                 * RTC_SYNC_FREQ_MAX_PPM),
+                                  rtc_sync_get_error());
+    }
+}
+
+void test_rtc_sync_step(void)
+{
+    const double STEP[] = {RTC_SYNC_STEP_MSEC * 1e-3,
+                           -1.5 * RTC_SYNC_STEP_MSEC * 1e-3};
+
+    TEST_ASSERT_TRUE(util_sync(0.0, 0));
+
+    for (size_t i = 0; i < sizeof(STEP) / sizeof(STEP[0]); i++)
+    {
+        sim_time += 10.0;
+        sim_src  += STEP[i];
+        TEST_ASSERT_TRUE(util_sync(0.0, 0));
+
+        // The time goes back on a negative step
+        sim_last = 0.0;
+        TEST_ASSERT_DOUBLE_WITHIN(1e-6, 0.0, util_read());
+    }
+}
+
+void test_rtc_sync_drift(void)
+{
+    const double   PPM[]     = {-50.0, 5.0, 40.0};
+    const double   INTERVAL  = 3600.0;
+    const double   JITTER    = 0.001;
+    const uint32_t PRECISION = 1000;
+
+    for (size_t i = 0; i < sizeof(PPM) / sizeof(PPM[0]); i++)
+    {
+        double err_max = 0.0;
+
+        setUp();
+        sim_ppm = PPM[i];
+        TEST_ASSERT_TRUE(util_sync(sim_jitter(JITTER), PRECISION));
+
+        // A day with a synchronization point each hour
+        for (uint32_t hour = 1; hour <= 24; hour++)
+        {
+            double err = util_run(INTERVAL);
+
+            // The estimation converges after some hours
+            if (hour > 3)
+            {
+                err_max = (err > err_max) ? err : err_max;
+            }
+
+            TEST_ASSERT_FALSE(util_sync(sim_jitter(JITTER), PRECISION));
+        }
+
+        TEST_PRINTF("%d ppm: estimated %d ppb, maximum error %u us",
+                    (int)PPM[i], (int)rtc_sync_get_freq(),
+                    (unsigned int)(err_max * 1e6));
+
+        // The error is the jitter of the source plus a small drift, instead of
+        // the drift of an hour without discipline
+        TEST_ASSERT_INT32_WITHIN(1000, (int32_t)(-PPM[i] * 1000.0),
+                                 rtc_sync_get_freq());
+        TEST_ASSERT_TRUE(err_max < (4.0 * JITTER));
+    }
+}
+
+void test_rtc_sync_long_gap(void)
+{
+    sim_ppm = 20.0;
+    TEST_ASSERT_TRUE(util_sync(0.0, 0));
+
+    sim_time += RTC_SYNC_INTERVAL_MIN;
+    TEST_ASSERT_FALSE(util_sync(0.0, 0));
+    // One tick in the interval is about 50 ppb
+    TEST_ASSERT_INT32_WITHIN(100, -20000, rtc_sync_get_freq());
+
+    // Days without reading the time, the error is the one of the frequency
+    // estimation
+    sim_time += 3.0 * 86400.0;
+    TEST_ASSERT_DOUBLE_WITHIN(3.0 * 86400.0 * 100e-9, 0.0, util_read());
+}
+
+/******************************** End of file *********************************/
@@ -6,6 +6,8 @@
  ******************************************************************************/
 
 #include "rtc_timer.h"
+#include "rtc_timer_bench.h"
+#include "test_util.h"
 
 #include "unity.h"
 #include "assert_test_helper.h"
@@ -36,6 +38,10 @@ const char test_file_name[] = __FILE_NAME__;
 //// Test support dependencies
 //TEST_FILE("test_main.c")
 
+// Test dependencies
+TEST_FILE("rtc_timer_bench.c")
+TEST_FILE("test_util.c")
+
 #include "mock_sys_util.h"
 #include "mock_portmacro.h"
 
@@ -46,6 +52,21 @@ const char test_file_name[] = __FILE_NAME__;
 #define TIMER_COUNT      (5)
 #define EXP_TIMER_ID_MAX (10)
 
+/** Number of periodic jobs of the coalescing simulation. */
+#define SIM_JOB_COUNT    (6)
+
+/** Simulated time in ticks, 60 s at 1 kHz. */
+#define SIM_TICKS        (60000u)
+
+/** Number of active timers of each benchmark run. */
+#define BENCH_COUNT      (3u)
+
+/** Period, maximum wake up lateness and maximum handler duration of the drift
+ * simulation. */
+#define DRIFT_PERIOD     (50u)
+#define DRIFT_LATE       (120u)
+#define DRIFT_HANDLER    (10u)
+
 /****************************************************************************//*
  * Private data
  ******************************************************************************/
@@ -55,11 +76,68 @@ static uint32_t exp_timer_id[EXP_TIMER_ID_MAX];
 static size_t exp_timer_idx = 0;
 static size_t exp_timer_count = 0;
 
+/** Period, phase and slack of the simulated jobs, at unrelated periods and
+ * phases, with a slack of a fourth of the period. */
+static const uint32_t sim_job[SIM_JOB_COUNT][3] =
+{
+    {100,  3,   25},
+    {250,  71,  62},
+    {333,  150, 83},
+    {500,  17,  125},
+    {1000, 499, 250},
+    {70,   41,  17},
+};
+
+static rtc_timer_t sim_timer[SIM_JOB_COUNT];
+static uint32_t sim_nominal[SIM_JOB_COUNT];
+static uint32_t sim_runs[SIM_JOB_COUNT];
+static bool sim_slack;
+static uint32_t sim_now;
+static bool sim_wake;
+
+/** Alarm programmed by the tickless mode. */
+static bool sim_alarm_on;
+static uint32_t sim_alarm_tick;
+
+static const uint32_t bench_count[BENCH_COUNT] = {10, 100, 1000};
+
+/** Tick counts of the periodic timer expirations. */
+static uint32_t periodic_tick[EXP_TIMER_ID_MAX];
+static size_t periodic_count;
+
+/** Ideal first expiration, number of handler calls and maximum distance to the
+ * ideal expiration of the drift simulation. */
+static uint32_t drift_base;
+static uint32_t drift_calls;
+static uint32_t drift_max;
+static uint32_t drift_seed;
+
+/** Handler calls of the worker test, in order, and where they were called. */
+static uint32_t worker_id[EXP_TIMER_ID_MAX];
+static bool worker_in_tick[EXP_TIMER_ID_MAX];
+static size_t worker_count;
+static uint32_t worker_notify;
+static bool in_tick;
+
 /****************************************************************************//*
  * Private code prototypes
  ******************************************************************************/
 
 static void timer_cb(rtc_timer_t * timer);
+static void sim_cb(rtc_timer_t * timer);
+static uint32_t sim_clock(void);
+static void sim_alarm(uint32_t tick);
+static void sim_cancel(void);
+static void sim_update(void);
+static uint32_t simulate(bool slack, bool tickless);
+static void periodic_cb(rtc_timer_t * timer);
+static void drift_cb(rtc_timer_t * timer);
+static void drift_rearm_cb(rtc_timer_t * timer);
+static uint32_t drift_rand(uint32_t max);
+static uint32_t drift(bool periodic);
+static void worker_cb(rtc_timer_t * timer);
+static void worker_notify_cb(void);
+static void worker_tick(uint32_t ticks);
 
 /****************************************************************************//*
  * Tests
@@ -74,6 +152,8 @@ void test_rtc_timer_assert(void)
 {
     TEST_ASSERT_FAIL_ASSERT(rtc_timer_config(NULL, 0, 0));
     TEST_ASSERT_FAIL_ASSERT(rtc_timer_start(NULL, 0));
+    TEST_ASSERT_FAIL_ASSERT(rtc_timer_start_slack(NULL, 0, 0));
+    TEST_ASSERT_FAIL_ASSERT(rtc_timer_start_periodic(NULL, 0, 1));
     TEST_ASSERT_FAIL_ASSERT(rtc_timer_stop(NULL));
 }
 
@@ -470,6 +550,277 @@ void test_rtc_timer_start_and_restart_multi(void)
     TEST_ASSERT_EQUAL(exp_timer_count, exp_timer_idx);
 }
 
+void test_rtc_timer_start_slack(void)
+{
+    uint32_t ticks;
+
+    exp_timer_count = 0;
+    exp_timer_idx = 0;
+
+    vPortEnterCritical_Ignore();
+    vPortExitCritical_Ignore();
+
+    // Timer 1 tolerance window starts before the expiration of timer 0, timer
+    // 2 window starts later
+    rtc_timer_start(&timer[0], 10);
+    rtc_timer_start_slack(&timer[1], 5, 10);
+    rtc_timer_start_slack(&timer[2], 11, 5);
+
+    for (ticks = 1; ticks < 10; ticks++)
+    {
+        rtc_timer_tick();
+    }
+
+    exp_timer_id[exp_timer_count++] = 0;
+    exp_timer_id[exp_timer_count++] = 1;
+    rtc_timer_tick();
+    TEST_ASSERT_EQUAL(exp_timer_count, exp_timer_idx);
+    TEST_ASSERT_FALSE(timer[1].active);
+    TEST_ASSERT_TRUE(timer[2].active);
+
+    // Without other expirations the timer expires at the end of its window
+    for (ticks = 11; ticks < 16; ticks++)
+    {
+        rtc_timer_tick();
+    }
+
+    exp_timer_id[exp_timer_count++] = 2;
+    rtc_timer_tick();
+    TEST_ASSERT_EQUAL(exp_timer_count, exp_timer_idx);
+}
+
+void test_rtc_timer_slack_coalesce(void)
+{
+    vPortEnterCritical_Ignore();
+    vPortExitCritical_Ignore();
+
+    uint32_t plain    = simulate(false, false);
+    uint32_t coalesce = simulate(true, false);
+
+    TEST_PRINTF("Wake ups: %u plain, %u coalesced", plain, coalesce);
+
+    // The same work is done with a 40 % less wake ups
+    TEST_ASSERT_TRUE(coalesce * 10u < plain * 6u);
+}
+
+void test_rtc_timer_tickless(void)
+{
+    vPortEnterCritical_Ignore();
+    vPortExitCritical_Ignore();
+
+    // The alarm wakes up only at the ticks with expirations of the periodic
+    // mode, with and without coalescing
+    TEST_ASSERT_EQUAL(simulate(false, false), simulate(false, true));
+    TEST_ASSERT_EQUAL(simulate(true, false), simulate(true, true));
+}
+
+void test_rtc_timer_tickless_catch_up(void)
+{
+    vPortEnterCritical_Ignore();
+    vPortExitCritical_Ignore();
+
+    exp_timer_count = 0;
+    exp_timer_idx   = 0;
+
+    rtc_timer_init();
+    sim_now = 1000;
+    rtc_timer_set_tickless(sim_clock, sim_alarm, sim_cancel);
+    TEST_ASSERT_FALSE(sim_alarm_on);
+    TEST_ASSERT_EQUAL(RTC_TIMER_NEXT_NONE, rtc_timer_get_next());
+
+    for (size_t i = 0; i < TIMER_COUNT; i++)
+    {
+        rtc_timer_config(&timer[i], i, timer_cb);
+    }
+
+    rtc_timer_start(&timer[0], 30);
+    TEST_ASSERT_TRUE(sim_alarm_on);
+    TEST_ASSERT_EQUAL(1030, sim_alarm_tick);
+
+    // A timer started between updates is counted from the clock
+    sim_now = 1005;
+    rtc_timer_start(&timer[1], 10);
+    TEST_ASSERT_EQUAL(1015, sim_alarm_tick);
+    rtc_timer_start(&timer[2], 20);
+    rtc_timer_start(&timer[3], 100);
+    TEST_ASSERT_EQUAL(1015, sim_alarm_tick);
+
+    // A late wake up processes all the expirations in order
+    sim_now = 1040;
+    exp_timer_id[exp_timer_count++] = 1;
+    exp_timer_id[exp_timer_count++] = 2;
+    exp_timer_id[exp_timer_count++] = 0;
+    sim_update();
+    TEST_ASSERT_EQUAL(exp_timer_count, exp_timer_idx);
+    TEST_ASSERT_TRUE(sim_alarm_on);
+    TEST_ASSERT_EQUAL(1105, sim_alarm_tick);
+
+    // An early wake up has no effect
+    sim_update();
+    TEST_ASSERT_EQUAL(exp_timer_count, exp_timer_idx);
+    TEST_ASSERT_EQUAL(65, rtc_timer_get_next());
+
+    // The alarm is cancelled when there are no timers left
+    sim_now = 1105;
+    exp_timer_id[exp_timer_count++] = 3;
+    sim_update();
+    TEST_ASSERT_EQUAL(exp_timer_count, exp_timer_idx);
+    TEST_ASSERT_FALSE(sim_alarm_on);
+
+    // Back to the periodic mode
+    rtc_timer_set_tickless(NULL, NULL, NULL);
+    rtc_timer_start(&timer[4], 2);
+    rtc_timer_tick();
+    exp_timer_id[exp_timer_count++] = 4;
+    rtc_timer_tick();
+    TEST_ASSERT_EQUAL(exp_timer_count, exp_timer_idx);
+}
+
+void test_rtc_timer_periodic(void)
+{
+    vPortEnterCritical_Ignore();
+    vPortExitCritical_Ignore();
+
+    rtc_timer_init();
+    rtc_timer_config(&timer[0], 0, periodic_cb);
+    periodic_count = 0;
+
+    TEST_ASSERT_FAIL_ASSERT(rtc_timer_start_periodic(&timer[0], 3, 0));
+
+    // The expirations keep the phase, until the handler stops the timer
+    rtc_timer_start_periodic(&timer[0], 3, 7);
+
+    for (uint32_t ticks = 1; ticks <= 100u; ticks++)
+    {
+        sim_now = ticks;
+        rtc_timer_tick();
+    }
+
+    TEST_ASSERT_EQUAL(EXP_TIMER_ID_MAX, periodic_count);
+    TEST_ASSERT_FALSE(timer[0].active);
+    TEST_ASSERT_EQUAL(0, timer[0].missed);
+
+    for (size_t i = 0; i < EXP_TIMER_ID_MAX; i++)
+    {
+        TEST_ASSERT_EQUAL(3u + (i * 7u), periodic_tick[i]);
+    }
+
+    // A one-shot start makes it a one-shot timer again
+    periodic_count = 0;
+    rtc_timer_start_periodic(&timer[0], 3, 7);
+    rtc_timer_start(&timer[0], 3);
+
+    for (uint32_t ticks = 1; ticks <= 100u; ticks++)
+    {
+        sim_now = ticks;
+        rtc_timer_tick();
+    }
+
+    TEST_ASSERT_EQUAL(1, periodic_count);
+}
+
+void test_rtc_timer_periodic_drift(void)
+{
+    vPortEnterCritical_Ignore();
+    vPortExitCritical_Ignore();
+
+    uint32_t periodic = drift(true);
+    uint32_t rearm    = drift(false);
+
+    TEST_PRINTF("Drift: %u periodic, %u re-armed", periodic, rearm);
+
+    // The periodic timer is never further from its ideal expiration than one
+    // late wake up and one handler, the re-armed one accumulates them
+    TEST_ASSERT_TRUE(periodic <= (DRIFT_LATE + DRIFT_HANDLER));
+    TEST_ASSERT_TRUE(rearm > (100u * DRIFT_PERIOD));
+}
+
+void test_rtc_timer_worker(void)
+{
+    vPortEnterCritical_Ignore();
+    vPortExitCritical_Ignore();
+
+    rtc_timer_init();
+    rtc_timer_set_worker(worker_notify_cb);
+    worker_count  = 0;
+    worker_notify = 0;
+
+    for (size_t i = 0; i < TIMER_COUNT; i++)
+    {
+        rtc_timer_config(&timer[i], i, worker_cb);
+    }
+
+    // The inline handlers are called from the tick, the others are deferred
+    rtc_timer_set_flags(&timer[1], RTC_TIMER_FLAG_INLINE);
+    rtc_timer_start(&timer[0], 5);
+    rtc_timer_start(&timer[1], 5);
+    worker_tick(5);
+    TEST_ASSERT_EQUAL(1, worker_notify);
+    TEST_ASSERT_EQUAL(1, worker_count);
+    TEST_ASSERT_EQUAL(1, worker_id[0]);
+    TEST_ASSERT_TRUE(worker_in_tick[0]);
+
+    rtc_timer_run_deferred();
+    TEST_ASSERT_EQUAL(2, worker_count);
+    TEST_ASSERT_EQUAL(0, worker_id[1]);
+    TEST_ASSERT_FALSE(worker_in_tick[1]);
+
+    // The deferred handlers are called in expiration order, except the ones
+    // of the stopped or restarted timers
+    worker_count = 0;
+    rtc_timer_start(&timer[2], 1);
+    rtc_timer_start(&timer[3], 2);
+    rtc_timer_start(&timer[4], 3);
+    rtc_timer_start(&timer[0], 3);
+    worker_tick(3);
+    rtc_timer_stop(&timer[0]);
+    TEST_ASSERT_EQUAL(4, worker_notify);
+    TEST_ASSERT_EQUAL(0, worker_count);
+
+    rtc_timer_run_deferred();
+    TEST_ASSERT_EQUAL(3, worker_count);
+    TEST_ASSERT_EQUAL(2, worker_id[0]);
+    TEST_ASSERT_EQUAL(3, worker_id[1]);
+    TEST_ASSERT_EQUAL(4, worker_id[2]);
+
+    rtc_timer_run_deferred();
+    TEST_ASSERT_EQUAL(3, worker_count);
+
+    // A periodic timer keeps its phase in the tick context, the expirations
+    // whose handler has not been called yet are missed
+    worker_count = 0;
+    rtc_timer_start_periodic(&timer[2], 1, 2);
+    worker_tick(5);
+    rtc_timer_run_deferred();
+    TEST_ASSERT_EQUAL(1, worker_count);
+    TEST_ASSERT_EQUAL(2, timer[2].missed);
+    TEST_ASSERT_TRUE(timer[2].active);
+
+    worker_tick(2);
+    rtc_timer_run_deferred();
+    TEST_ASSERT_EQUAL(2, worker_count);
+    TEST_ASSERT_EQUAL(2, timer[2].missed);
+
+    rtc_timer_stop(&timer[2]);
+    rtc_timer_set_worker(NULL);
+}
+
+void test_rtc_timer_bench(void)
+{
+    rtc_timer_bench_t result;
+
+    vPortEnterCritical_Ignore();
+    vPortExitCritical_Ignore();
+
+    // The critical sections grow with the number of active timers, compare
+    // with test_rtc_timer_wheel
+    for (uint32_t i = 0; i < BENCH_COUNT; i++)
+    {
+        rtc_timer_bench_run(bench_count[i], &result);
+        rtc_timer_bench_print("List", &result);
+    }
+}
+
 /****************************************************************************//*
  * Private code
  ******************************************************************************/
@@ -484,4 +835,248 @@ static void timer_cb(rtc_timer_t * timer)
     exp_timer_idx++;
 }
 
+static void sim_cb(rtc_timer_t * timer)
+{
+    uint32_t job   = timer->id;
+    uint32_t slack = sim_slack ? sim_job[job][2] : 0u;
+
+    // Each run is inside its tolerance window
+    TEST_ASSERT_TRUE(sim_now - sim_nominal[job] <= slack);
+
+    sim_wake = true;
+    sim_runs[job]++;
+
+    // The next period is kept from the nominal time, so there is no drift
+    sim_nominal[job] += sim_job[job][0];
+    rtc_timer_start_slack(timer, sim_nominal[job] - sim_now, slack);
+}
+
+static uint32_t sim_clock(void)
+{
+    return sim_now;
+}
+
+static void sim_alarm(uint32_t tick)
+{
+    // The alarm is never in the past
+    TEST_ASSERT_TRUE((int32_t)(tick - sim_now) > 0);
+
+    sim_alarm_on   = true;
+    sim_alarm_tick = tick;
+}
+
+static void sim_cancel(void)
+{
+    sim_alarm_on = false;
+}
+
+/**
+ * Fire the alarm if its tick is reached, it is a one-shot alarm, and update
+ * the timers as the alarm handler does.
+ */
+static void sim_update(void)
+{
+    if (sim_alarm_on && ((int32_t)(sim_now - sim_alarm_tick) >= 0))
+    {
+        sim_alarm_on = false;
+    }
+
+    rtc_timer_update();
+}
+
+/**
+ * Run the periodic jobs, with the wake ups coalesced or not, and count the
+ * ticks with at least one expiration. In tickless mode the time jumps to each
+ * alarm, and every wake up must have an expiration.
+ */
+static uint32_t simulate(bool slack, bool tickless)
+{
+    uint32_t wakes = 0;
+
+    rtc_timer_init();
+    sim_slack    = slack;
+    sim_now      = 0;
+    sim_alarm_on = false;
+
+    if (tickless)
+    {
+        rtc_timer_set_tickless(sim_clock, sim_alarm, sim_cancel);
+    }
+
+    for (size_t j = 0; j < SIM_JOB_COUNT; j++)
+    {
+        sim_nominal[j] = sim_job[j][1];
+        sim_runs[j]    = 0;
+        rtc_timer_config(&sim_timer[j], j, sim_cb);
+        rtc_timer_start_slack(&sim_timer[j], sim_nominal[j],
+                              slack ? sim_job[j][2] : 0u);
+    }
+
+    while (!tickless && (sim_now < SIM_TICKS))
+    {
+        sim_now++;
+        sim_wake = false;
+        rtc_timer_tick();
+
+        if (sim_wake)
+        {
+            wakes++;
+        }
+    }
+
+    while (tickless && sim_alarm_on && (sim_alarm_tick <= SIM_TICKS))
+    {
+        sim_now  = sim_alarm_tick;
+        sim_wake = false;
+        sim_update();
+        TEST_ASSERT_TRUE(sim_wake);
+        wakes++;
+    }
+
+    for (size_t j = 0; j < SIM_JOB_COUNT; j++)
+    {
+        TEST_ASSERT_UINT32_WITHIN(1, SIM_TICKS / sim_job[j][0], sim_runs[j]);
+        rtc_timer_stop(&sim_timer[j]);
+    }
+
+    rtc_timer_set_tickless(NULL, NULL, NULL);
+
+    return wakes;
+}
+
+static void periodic_cb(rtc_timer_t * timer)
+{
+    periodic_tick[periodic_count++] = sim_now;
+
+    if (EXP_TIMER_ID_MAX == periodic_count)
+    {
+        rtc_timer_stop(timer);
+    }
+}
+
+static void drift_cb(rtc_timer_t * timer)
+{
+    // Index of the expiration, counting the skipped ones
+    uint32_t ideal = drift_base + ((drift_calls + timer->missed)
+                                   * DRIFT_PERIOD);
+
+    TEST_ASSERT_TRUE((int32_t)(sim_now - ideal) >= 0);
+
+    if ((sim_now - ideal) > drift_max)
+    {
+        drift_max = sim_now - ideal;
+    }
+
+    drift_calls++;
+
+    // The handler takes some time
+    sim_now += drift_rand(DRIFT_HANDLER);
+}
+
+static void drift_rearm_cb(rtc_timer_t * timer)
+{
+    uint32_t ideal = drift_base + (drift_calls * DRIFT_PERIOD);
+
+    drift_max = sim_now - ideal;
+    drift_calls++;
+    sim_now  += drift_rand(DRIFT_HANDLER);
+
+    // The timer is started again from the handler
+    rtc_timer_start(timer, DRIFT_PERIOD);
+}
+
+static uint32_t drift_rand(uint32_t max)
+{
+    return test_util_rand(&drift_seed) % (max + 1u);
+}
+
+/**
+ * Run a timer with the same period in tickless mode, with late wake ups and
+ * handlers that take some time, either as a periodic timer or started again
+ * from its handler.
+ *
+ * @return Maximum distance of the periodic timer expirations to the ideal
+ * ones, or the final distance of the re-armed timer.
+ */
+static uint32_t drift(bool periodic)
+{
+    rtc_timer_init();
+    sim_now      = 0;
+    sim_alarm_on = false;
+    drift_base   = DRIFT_PERIOD;
+    drift_calls  = 0;
+    drift_max    = 0;
+    drift_seed   = TEST_UTIL_SEED;
+
+    rtc_timer_set_tickless(sim_clock, sim_alarm, sim_cancel);
+    rtc_timer_config(&timer[0], 0, periodic ? drift_cb : drift_rearm_cb);
+
+    if (periodic)
+    {
+        rtc_timer_start_periodic(&timer[0], DRIFT_PERIOD, DRIFT_PERIOD);
+    }
+    else
+    {
+        rtc_timer_start(&timer[0], DRIFT_PERIOD);
+    }
+
+    while (sim_alarm_on && (sim_alarm_tick <= SIM_TICKS))
+    {
+        // Mostly punctual wake ups, some of them later than a period. The
+        // handlers may have moved the clock beyond the alarm
+        if ((int32_t)(sim_alarm_tick - sim_now) > 0)
+        {
+            sim_now = sim_alarm_tick;
+        }
+
+        if (drift_rand(4) == 0u)
+        {
+            sim_now += drift_rand(DRIFT_LATE);
+        }
+
+        sim_update();
+    }
+
+    if (periodic)
+    {
+        // Every period has been run or counted as missed
+        TEST_ASSERT_TRUE(timer[0].missed > 0u);
+        TEST_ASSERT_UINT32_WITHIN(1, SIM_TICKS / DRIFT_PERIOD,
+                                  drift_calls + timer[0].missed);
+    }
+
+    rtc_timer_stop(&timer[0]);
+    rtc_timer_set_tickless(NULL, NULL, NULL);
+
+    return drift_max;
+}
+
+static void worker_cb(rtc_timer_t * timer)
+{
+    TEST_ASSERT_TRUE(worker_count < EXP_TIMER_ID_MAX);
+
+    worker_id[worker_count]      = timer->id;
+    worker_in_tick[worker_count] = in_tick;
+    worker_count++;
+}
+
+static void worker_notify_cb(void)
+{
+    TEST_ASSERT_TRUE(in_tick);
+
+    worker_notify++;
+}
+
+static void worker_tick(uint32_t ticks)
+{
+    in_tick = true;
+
+    for (uint32_t i = 0; i < ticks; i++)
+    {
+        rtc_timer_tick();
+    }
+
+    in_tick = false;
+}
+
 /******************************** End of file *********************************/
@@ -0,0 +1,249 @@
+/*******************************************************************************
+ * @file test_rtc_timer_stats.c
+ * @author juanmanuel.fernandez@iertec.com
+ * @date 19 Oct 2026
+ * @brief Unit test for the module rtc_timer built with the timer statistics.
+ ******************************************************************************/
+
+#include "rtc_timer.h"
+
+#include "unity.h"
+
+/****************************************************************************//*
+ * Dependencies
+ ******************************************************************************/
+
+const char test_file_name[] = __FILE_NAME__;
+
+// Test dependencies
+#include "mock_sys_util.h"
+#include "mock_portmacro.h"
+
+/****************************************************************************//*
+ * Constants and macros
+ ******************************************************************************/
+
+/** Number of timers of the tests. */
+#define TIMER_COUNT     (4u)
+
+/** Duration of the handlers, in units of the statistics clock. */
+#define HANDLER_RUN     (7u)
+
+/****************************************************************************//*
+ * Private data
+ ******************************************************************************/
+
+static rtc_timer_t timer[TIMER_COUNT];
+
+/** Tick count of the tickless clock. */
+static uint32_t clock_now;
+
+/** Count of the statistics clock. */
+static uint32_t stats_now;
+
+/** Number of worker notifications. */
+static uint32_t notify_count;
+
+/****************************************************************************//*
+ * Private code prototypes
+ ******************************************************************************/
+
+static void timer_cb(rtc_timer_t * timer);
+static uint32_t clock_get(void);
+static uint32_t stats_clock_get(void);
+static void alarm_set(uint32_t tick);
+static void alarm_cancel(void);
+static void notify(void);
+static void ticks(uint32_t count);
+
+/****************************************************************************//*
+ * Tests
+ ******************************************************************************/
+
+void setUp(void)
+{
+    vPortEnterCritical_Ignore();
+    vPortExitCritical_Ignore();
+
+    rtc_timer_init();
+
+    for (uint32_t i = 0; i < TIMER_COUNT; i++)
+    {
+        rtc_timer_config(&timer[i], i, timer_cb);
+    }
+
+    clock_now    = 0;
+    stats_now    = 0;
+    notify_count = 0;
+}
+
+void test_rtc_timer_stats_expire(void)
+{
+    rtc_timer_stats_t stats;
+
+    // 3 timers expire in the same tick, and one later
+    rtc_timer_start(&timer[0], 5);
+    rtc_timer_start(&timer[1], 5);
+    rtc_timer_start(&timer[2], 5);
+    rtc_timer_start(&timer[3], 10);
+
+    rtc_timer_stats_get(&stats);
+    TEST_ASSERT_EQUAL_UINT32(4, stats.active);
+    TEST_ASSERT_EQUAL_UINT32(4, stats.active_max);
+
+    // A stopped timer is not active anymore
+    rtc_timer_stop(&timer[3]);
+    rtc_timer_start(&timer[3], 10);
+    ticks(10);
+
+    rtc_timer_stats_get(&stats);
+    TEST_ASSERT_EQUAL_UINT32(0, stats.active);
+    TEST_ASSERT_EQUAL_UINT32(4, stats.active_max);
+    TEST_ASSERT_EQUAL_UINT32(2, stats.ticks);
+    TEST_ASSERT_EQUAL_UINT32(4, stats.expired);
+    TEST_ASSERT_EQUAL_UINT32(3, stats.expired_max);
+
+    // The periodic ticks are processed on time
+    TEST_ASSERT_EQUAL_UINT32(4, stats.late_hist[0]);
+    TEST_ASSERT_EQUAL_UINT32(0, stats.late_max);
+    TEST_ASSERT_EQUAL_UINT32(1, timer[0].stats.calls);
+
+    // The reset keeps the active timers
+    rtc_timer_start(&timer[0], 5);
+    rtc_timer_stats_reset();
+    rtc_timer_stats_get(&stats);
+    TEST_ASSERT_EQUAL_UINT32(1, stats.active);
+    TEST_ASSERT_EQUAL_UINT32(1, stats.active_max);
+    TEST_ASSERT_EQUAL_UINT32(0, stats.expired);
+    TEST_ASSERT_EQUAL_UINT32(0, stats.late_hist[0]);
+}
+
+void test_rtc_timer_stats_late(void)
+{
+    rtc_timer_stats_t stats;
+
+    rtc_timer_set_tickless(clock_get, alarm_set, alarm_cancel);
+    rtc_timer_stats_set_clock(stats_clock_get);
+
+    // The wake up is 15 ticks late
+    rtc_timer_start(&timer[0], 10);
+    rtc_timer_start_periodic(&timer[1], 2, 20);
+    clock_now = 25;
+    rtc_timer_update();
+
+    TEST_ASSERT_EQUAL_UINT32(1, timer[0].stats.calls);
+    TEST_ASSERT_EQUAL_UINT32(15, timer[0].stats.late_max);
+    TEST_ASSERT_EQUAL_UINT32(15, timer[0].stats.late_sum);
+    TEST_ASSERT_EQUAL_UINT32(HANDLER_RUN, timer[0].stats.run_max);
+
+    // The periodic timer missed the expiration at 22, it is only called once
+    TEST_ASSERT_EQUAL_UINT32(1, timer[1].stats.calls);
+    TEST_ASSERT_EQUAL_UINT32(23, timer[1].stats.late_max);
+    TEST_ASSERT_EQUAL_UINT32(1, timer[1].missed);
+
+    // Now on time
+    clock_now = 42;
+    rtc_timer_update();
+    TEST_ASSERT_EQUAL_UINT32(2, timer[1].stats.calls);
+    TEST_ASSERT_EQUAL_UINT32(23, timer[1].stats.late_sum);
+
+    rtc_timer_stats_get(&stats);
+    TEST_ASSERT_EQUAL_UINT32(23, stats.late_max);
+    TEST_ASSERT_EQUAL_UINT32(HANDLER_RUN, stats.run_max);
+    TEST_ASSERT_EQUAL_UINT32(1, stats.late_hist[0]);
+    TEST_ASSERT_EQUAL_UINT32(1, stats.late_hist[4]);
+    TEST_ASSERT_EQUAL_UINT32(1, stats.late_hist[5]);
+
+    rtc_timer_stats_print(&timer[1]);
+}
+
+void test_rtc_timer_stats_hist_last(void)
+{
+    rtc_timer_stats_t stats;
+
+    rtc_timer_set_tickless(clock_get, alarm_set, alarm_cancel);
+
+    // The later calls are counted in the last bin
+    rtc_timer_start(&timer[0], 1);
+    clock_now = 100000;
+    rtc_timer_update();
+
+    rtc_timer_stats_get(&stats);
+    TEST_ASSERT_EQUAL_UINT32(1, stats.late_hist[RTC_TIMER_STATS_BINS - 1u]);
+    TEST_ASSERT_EQUAL_UINT32(99999, stats.late_max);
+}
+
+void test_rtc_timer_stats_deferred(void)
+{
+    rtc_timer_stats_t stats;
+
+    // The deferred handler waits 3 ticks for the worker
+    rtc_timer_set_worker(notify);
+    rtc_timer_start(&timer[0], 5);
+    ticks(8);
+
+    TEST_ASSERT_EQUAL_UINT32(1, notify_count);
+    TEST_ASSERT_EQUAL_UINT32(0, timer[0].stats.calls);
+
+    rtc_timer_run_deferred();
+
+    TEST_ASSERT_EQUAL_UINT32(1, timer[0].stats.calls);
+    TEST_ASSERT_EQUAL_UINT32(3, timer[0].stats.late_max);
+
+    // The inline handlers are on time
+    rtc_timer_set_flags(&timer[1], RTC_TIMER_FLAG_INLINE);
+    rtc_timer_start(&timer[1], 5);
+    ticks(5);
+
+    TEST_ASSERT_EQUAL_UINT32(1, timer[1].stats.calls);
+    TEST_ASSERT_EQUAL_UINT32(0, timer[1].stats.late_max);
+
+    rtc_timer_stats_get(&stats);
+    TEST_ASSERT_EQUAL_UINT32(1, stats.late_hist[0]);
+    TEST_ASSERT_EQUAL_UINT32(1, stats.late_hist[2]);
+}
+
+/****************************************************************************//*
+ * Private code
+ ******************************************************************************/
+
+static void timer_cb(rtc_timer_t * timer)
+{
+    (void)timer;
+
+    stats_now += HANDLER_RUN;
+}
+
+static uint32_t clock_get(void)
+{
+    return clock_now;
+}
+
+static uint32_t stats_clock_get(void)
+{
+    return stats_now;
+}
+
+static void alarm_set(uint32_t tick)
+{
+    (void)tick;
+}
+
+static void alarm_cancel(void)
+{
+}
+
+static void notify(void)
+{
+    notify_count++;
+}
+
+static void ticks(uint32_t count)
+{
+    for (uint32_t i = 0; i < count; i++)
+    {
+        rtc_timer_tick();
+    }
+}
+
+/******************************** End of file *********************************/
@@ -0,0 +1,462 @@
+/*******************************************************************************
+ * @file test_rtc_timer_wheel.c
+ * @author juanmanuel.fernandez@iertec.com
+ * @date 19 Oct 2026
+ * @brief Unit test for the module rtc_timer built with the timer wheel. The
+ * wheel is reduced to 4 levels of 16 slots, so the timers beyond its range are
+ * tested in a short time.
+ ******************************************************************************/
+
+#include "rtc_timer.h"
+#include "rtc_timer_bench.h"
+#include "test_util.h"
+
+#include "unity.h"
+
+/****************************************************************************//*
+ * Dependencies
+ ******************************************************************************/
+
+const char test_file_name[] = __FILE_NAME__;
+
+// Test dependencies
+TEST_FILE("rtc_timer_bench.c")
+TEST_FILE("test_util.c")
+
+#include "mock_sys_util.h"
+#include "mock_portmacro.h"
+
+/****************************************************************************//*
+ * Constants and macros
+ ******************************************************************************/
+
+/** Number of timers of the tests. */
+#define TIMER_COUNT       (32u)
+
+/** Number of ticks of the randomized test. */
+#define TEST_TICKS        (100000u)
+
+/** Maximum lateness of the wake ups of the catch up test. */
+#define LATE_MAX          (3000u)
+
+/** Number of active timers of each benchmark run. */
+#define BENCH_COUNT       (3u)
+
+/****************************************************************************//*
+ * Private data
+ ******************************************************************************/
+
+static rtc_timer_t timer[TIMER_COUNT];
+
+/** Expected earliest and latest expiration of each timer. */
+static uint32_t exp_first[TIMER_COUNT];
+static uint32_t exp_last[TIMER_COUNT];
+
+/** Tick of the last expiration of each timer, 0 if none. */
+static uint32_t exp_tick[TIMER_COUNT];
+
+/** Ticks elapsed since the test start. */
+static uint32_t now;
+
+/** Number of expirations in the current tick. */
+static uint32_t exp_count;
+
+/** Order of the last expiration of each timer. */
+static uint32_t exp_seq[TIMER_COUNT];
+
+/** Number of expirations since the test start. */
+static uint32_t exp_total;
+
+/** The time jumps beyond the expirations, so they are late. */
+static bool late;
+
+/** Alarm programmed by the tickless mode. */
+static bool alarm_on;
+static uint32_t alarm_tick;
+
+static uint32_t test_seed;
+
+static const uint32_t bench_count[BENCH_COUNT] = {10, 100, 1000};
+
+/****************************************************************************//*
+ * Private code prototypes
+ ******************************************************************************/
+
+static void timer_cb(rtc_timer_t * timer);
+static uint32_t test_rand(uint32_t max);
+static void start(uint32_t id, uint32_t ticks, uint32_t slack);
+static void tick(void);
+static uint32_t clock_get(void);
+static void alarm_set(uint32_t tick);
+static void alarm_cancel(void);
+static uint32_t wake(void);
+
+/****************************************************************************//*
+ * Tests
+ ******************************************************************************/
+
+void setUp(void)
+{
+    vPortEnterCritical_Ignore();
+    vPortExitCritical_Ignore();
+
+    rtc_timer_init();
+
+    for (uint32_t i = 0; i < TIMER_COUNT; i++)
+    {
+        rtc_timer_config(&timer[i], i, timer_cb);
+        exp_tick[i] = 0;
+    }
+
+    now       = 0;
+    test_seed = TEST_UTIL_SEED;
+    exp_total = 0;
+    late      = false;
+    alarm_on  = false;
+}
+
+void test_rtc_timer_wheel_levels(void)
+{
+    // Timers at the limits of each level, and beyond the wheel range
+    static const uint32_t ticks[] =
+    {
+        1, 15, 16, 17, 255, 256, 257, 4095, 4096, 4097, 65535, 65536, 65537,
+        200000,
+    };
+    const uint32_t count = sizeof(ticks) / sizeof(ticks[0]);
+
+    for (uint32_t i = 0; i < count; i++)
+    {
+        start(i, ticks[i], 0);
+    }
+
+    while (now < ticks[count - 1u])
+    {
+        tick();
+    }
+
+    for (uint32_t i = 0; i < count; i++)
+    {
+        TEST_ASSERT_EQUAL_UINT32(ticks[i], exp_tick[i]);
+        TEST_ASSERT_FALSE(timer[i].active);
+    }
+}
+
+void test_rtc_timer_wheel_stop(void)
+{
+    // Timers in the same slot, stopped at the head, middle and tail
+    for (uint32_t i = 0; i < 5u; i++)
+    {
+        start(i, 300, 0);
+    }
+
+    rtc_timer_stop(&timer[0]);
+    rtc_timer_stop(&timer[2]);
+    rtc_timer_stop(&timer[4]);
+    rtc_timer_stop(&timer[4]);
+
+    // Restarted timers are moved to their new slot
+    start(3, 20, 0);
+
+    while (now < 300u)
+    {
+        tick();
+    }
+
+    TEST_ASSERT_EQUAL_UINT32(0, exp_tick[0]);
+    TEST_ASSERT_EQUAL_UINT32(300, exp_tick[1]);
+    TEST_ASSERT_EQUAL_UINT32(0, exp_tick[2]);
+    TEST_ASSERT_EQUAL_UINT32(20, exp_tick[3]);
+    TEST_ASSERT_EQUAL_UINT32(0, exp_tick[4]);
+}
+
+void test_rtc_timer_wheel_slack(void)
+{
+    // Timer 1 tolerance window starts before the expiration of timer 0, timer
+    // 2 window starts later
+    start(0, 10, 0);
+    start(1, 5, 10);
+    start(2, 11, 5);
+
+    while (now < 16u)
+    {
+        tick();
+    }
+
+    TEST_ASSERT_EQUAL_UINT32(10, exp_tick[0]);
+    TEST_ASSERT_EQUAL_UINT32(10, exp_tick[1]);
+    TEST_ASSERT_EQUAL_UINT32(16, exp_tick[2]);
+
+    // Stopping the timer with the earliest window end may advance the
+    // expiration of the other open windows, but it stays inside them
+    start(0, 10, 5);
+    start(1, 8, 10);
+    start(2, 1000, 0);
+
+    while (now < 27u)
+    {
+        tick();
+    }
+
+    rtc_timer_stop(&timer[0]);
+
+    while (now < 34u)
+    {
+        tick();
+    }
+
+    TEST_ASSERT_EQUAL_UINT32(10, exp_tick[0]);
+    TEST_ASSERT_EQUAL_UINT32(31, exp_tick[1]);
+    TEST_ASSERT_TRUE(timer[2].active);
+}
+
+void test_rtc_timer_wheel_random(void)
+{
+    for (uint32_t i = 0; i < TEST_TICKS; i++)
+    {
+        uint32_t id = test_rand(TIMER_COUNT);
+
+        // Random starts and stops, mostly short, some beyond the wheel range
+        if (test_rand(4) == 0u)
+        {
+            rtc_timer_stop(&timer[id]);
+        }
+        else if (test_rand(2) == 0u)
+        {
+            uint32_t ticks = 1u + test_rand(test_rand(50) == 0u ? 80000u
+                                                                : 300u);
+
+            start(id, ticks, test_rand(2) == 0u ? 0u : test_rand(40));
+        }
+
+        tick();
+
+        for (uint32_t j = 0; j < TIMER_COUNT; j++)
+        {
+            if (timer[j].active)
+            {
+                // No timer is overdue, and the timers whose window has
+                // started share the expirations of the others
+                TEST_ASSERT_TRUE((int32_t)(exp_last[j] - now) > 0);
+                TEST_ASSERT_TRUE((exp_count == 0u)
+                                 || ((int32_t)(exp_first[j] - now) > 0));
+            }
+        }
+    }
+}
+
+void test_rtc_timer_wheel_periodic(void)
+{
+    // Periods resolved in different levels keep their phase
+    rtc_timer_start_periodic(&timer[0], 5, 3);
+    rtc_timer_start_periodic(&timer[1], 1, 300);
+    rtc_timer_start_periodic(&timer[2], 4000, 5000);
+
+    for (uint32_t i = 0; i < 3u; i++)
+    {
+        exp_first[i] = 0;
+        exp_last[i]  = INT32_MAX;
+    }
+
+    while (now < 30000u)
+    {
+        tick();
+
+        TEST_ASSERT_TRUE(timer[0].active && timer[1].active
+                         && timer[2].active);
+    }
+
+    TEST_ASSERT_EQUAL_UINT32(29999u, exp_tick[0]);
+    TEST_ASSERT_EQUAL_UINT32(29701u, exp_tick[1]);
+    TEST_ASSERT_EQUAL_UINT32(29000u, exp_tick[2]);
+    TEST_ASSERT_EQUAL_UINT32(9999u + 100u + 6u, exp_total);
+}
+
+void test_rtc_timer_wheel_tickless(void)
+{
+    static const uint32_t ticks[] =
+    {
+        1, 15, 16, 17, 255, 256, 257, 4095, 4096, 4097, 65535, 65536, 65537,
+        200000,
+    };
+    const uint32_t count = sizeof(ticks) / sizeof(ticks[0]);
+    uint32_t       wakes = 0;
+
+    now = 500;
+    rtc_timer_set_tickless(clock_get, alarm_set, alarm_cancel);
+
+    for (uint32_t i = 0; i < count; i++)
+    {
+        start(i, ticks[i], 0);
+    }
+
+    // The wake ups are the expirations and the moves between levels, far
+    // less than the ticks
+    while (alarm_on)
+    {
+        now = alarm_tick;
+        (void)wake();
+        wakes++;
+    }
+
+    TEST_ASSERT_TRUE(wakes < (count * RTC_TIMER_WHEEL_LEVELS) + 4u);
+
+    for (uint32_t i = 0; i < count; i++)
+    {
+        TEST_ASSERT_EQUAL_UINT32(500u + ticks[i], exp_tick[i]);
+    }
+
+    // Tolerance windows share the wake ups
+    start(0, 10, 0);
+    start(1, 5, 10);
+    start(2, 40, 20);
+    start(3, 50, 0);
+
+    while (alarm_on)
+    {
+        now = alarm_tick;
+        (void)wake();
+    }
+
+    TEST_ASSERT_EQUAL_UINT32(exp_tick[0], exp_tick[1]);
+    TEST_ASSERT_EQUAL_UINT32(exp_tick[3], exp_tick[2]);
+
+    rtc_timer_set_tickless(NULL, NULL, NULL);
+}
+
+void test_rtc_timer_wheel_tickless_catch_up(void)
+{
+    uint32_t order[TIMER_COUNT];
+
+    now  = 0xFFFFF000u;
+    late = true;
+    rtc_timer_set_tickless(clock_get, alarm_set, alarm_cancel);
+
+    // Distinct expirations, the clock wraps around during the test
+    for (uint32_t i = 0; i < TIMER_COUNT; i++)
+    {
+        start(i, 1u + ((i * 7919u) % 30000u), 0);
+    }
+
+    // The time jumps past several expirations at each wake up
+    while (alarm_on)
+    {
+        now = alarm_tick + test_rand(LATE_MAX);
+        (void)wake();
+    }
+
+    TEST_ASSERT_EQUAL_UINT32(TIMER_COUNT, exp_total);
+
+    // Each timer expires once, at the wake up that follows it
+    for (uint32_t i = 0; i < TIMER_COUNT; i++)
+    {
+        TEST_ASSERT_FALSE(timer[i].active);
+        TEST_ASSERT_TRUE((exp_tick[i] - exp_first[i]) < LATE_MAX);
+        order[exp_seq[i] - 1u] = i;
+    }
+
+    // The handlers are called in expiration order
+    for (uint32_t i = 1; i < TIMER_COUNT; i++)
+    {
+        TEST_ASSERT_TRUE((int32_t)(exp_first[order[i]]
+                                   - exp_first[order[i - 1u]]) > 0);
+    }
+
+    rtc_timer_set_tickless(NULL, NULL, NULL);
+}
+
+void test_rtc_timer_wheel_bench(void)
+{
+    rtc_timer_bench_t    result[BENCH_COUNT];
+    rtc_timer_bench_op_t op = RTC_TIMER_BENCH_START_LAST;
+
+    for (uint32_t i = 0; i < BENCH_COUNT; i++)
+    {
+        rtc_timer_bench_run(bench_count[i], &result[i]);
+        rtc_timer_bench_print("Wheel", &result[i]);
+    }
+
+    // The restarts do not depend on the number of active timers
+    TEST_ASSERT_TRUE(result[BENCH_COUNT - 1u].time[op].mean
+                     < (4u * result[0].time[op].mean) + 100u);
+}
+
+/****************************************************************************//*
+ * Private code
+ ******************************************************************************/
+
+static void timer_cb(rtc_timer_t * t)
+{
+    uint32_t id = t->id;
+
+    TEST_ASSERT_TRUE(id < TIMER_COUNT);
+    TEST_ASSERT_FALSE(t->active);
+
+    // Each expiration is inside its tolerance window, or after it if the wake
+    // up is late
+    TEST_ASSERT_TRUE((int32_t)(now - exp_first[id]) >= 0);
+    TEST_ASSERT_TRUE(late || ((int32_t)(exp_last[id] - now) >= 0));
+
+    exp_tick[id] = now;
+    exp_seq[id]  = ++exp_total;
+    exp_count++;
+}
+
+static uint32_t test_rand(uint32_t max)
+{
+    return test_util_rand(&test_seed) % max;
+}
+
+static void start(uint32_t id, uint32_t ticks, uint32_t slack)
+{
+    exp_first[id] = now + ticks;
+    exp_last[id]  = now + ticks + slack;
+    rtc_timer_start_slack(&timer[id], ticks, slack);
+}
+
+static void tick(void)
+{
+    now++;
+    exp_count = 0;
+    rtc_timer_tick();
+}
+
+static uint32_t clock_get(void)
+{
+    return now;
+}
+
+static void alarm_set(uint32_t tick)
+{
+    // The alarm is never in the past
+    TEST_ASSERT_TRUE((int32_t)(tick - now) > 0);
+
+    alarm_on   = true;
+    alarm_tick = tick;
+}
+
+static void alarm_cancel(void)
+{
+    alarm_on = false;
+}
+
+/**
+ * Fire the alarm if its tick is reached, it is a one-shot alarm, and update
+ * the timers as the alarm handler does.
+ *
+ * @return Number of expirations.
+ */
+static uint32_t wake(void)
+{
+    if (alarm_on && ((int32_t)(now - alarm_tick) >= 0))
+    {
+        alarm_on = false;
+    }
+
+    exp_count = 0;
+    rtc_timer_update();
+
+    return exp_count;
+}
+
+/******************************** End of file *********************************/
@@ -0,0 +1,134 @@
+/*******************************************************************************
+ * @file test_rtc_use_sync.c
+ * @author juanmanuel.fernandez@iertec.com
+ * @date 19 Oct 2026
+ * @brief Unit test for the module rtc built with RTC_USE_SYNC, so the time is
+ * kept by rtc_sync over a simulated tick clock.
+ ******************************************************************************/
+
+#include "rtc.h"
+#include "rtc_sync.h"
+
+#include "unity.h"
+
+/****************************************************************************//*
+ * Dependencies
+ ******************************************************************************/
+
+const char test_file_name[] = __FILE_NAME__;
+
+// Test dependencies
+#include "mock_sys_util.h"
+#include "mock_portmacro.h"
+
+/****************************************************************************//*
+ * Private data
+ ******************************************************************************/
+
+/** Tick count of the simulated clock. */
+static uint64_t sim_ticks;
+
+/****************************************************************************//*
+ * Private code
+ ******************************************************************************/
+
+static uint64_t sim_clock(void)
+{
+    return sim_ticks;
+}
+
+/**
+ * Advance the simulated clock.
+ *
+ * @param[in] cseconds Centiseconds to advance.
+ */
+static void util_advance(uint32_t cseconds)
+{
+    sim_ticks += ((uint64_t)cseconds * RTC_SYNC_CLK_FREQ) / 100u;
+}
+
+/****************************************************************************//*
+ * Tests
+ ******************************************************************************/
+
+void setUp(void)
+{
+    vPortEnterCritical_Ignore();
+    vPortExitCritical_Ignore();
+
+    sim_ticks = 0;
+    rtc_sync_init(sim_clock);
+    rtc_set_tz(NULL);
+}
+
+void test_rtc_use_sync_timestamp(void)
+{
+    uint32_t timestamp;
+    uint32_t fraction;
+    uint8_t  cseconds;
+
+    // The first time set steps the disciplined clock
+    rtc_set_timestamp(1000);
+    TEST_ASSERT_EQUAL_UINT32(1000000, rtc_sync_get_error());
+
+    util_advance(250);
+    rtc_get_timestamp(&timestamp, &cseconds);
+    TEST_ASSERT_EQUAL_UINT32(1002, timestamp);
+    TEST_ASSERT_EQUAL_UINT8(50, cseconds);
+
+    rtc_get_timestamp_frac(&timestamp, &fraction);
+    TEST_ASSERT_EQUAL_UINT32(1002, timestamp);
+    TEST_ASSERT_UINT32_WITHIN(1u << 20, 0x80000000u, fraction);
+}
+
+void test_rtc_use_sync_datetime(void)
+{
+    datetime_t time_set = {.year = 21, .month = 9, .day = 12,
+                           .hour = 23, .minutes = 59, .seconds = 58,
+                           .cseconds = 20};
+    datetime_t time_get;
+
+    TEST_ASSERT_TRUE(rtc_set_datetime(&time_set, false));
+
+    // The centiseconds are given to rtc_sync with their precision
+    TEST_ASSERT_EQUAL_UINT32(10000, rtc_sync_get_error());
+
+    util_advance(190);
+    rtc_get_datetime(&time_get);
+    TEST_ASSERT_EQUAL_UINT8(21, time_get.year);
+    TEST_ASSERT_EQUAL_UINT8(9, time_get.month);
+    TEST_ASSERT_EQUAL_UINT8(13, time_get.day);
+    TEST_ASSERT_EQUAL_UINT8(0, time_get.hour);
+    TEST_ASSERT_EQUAL_UINT8(0, time_get.minutes);
+    TEST_ASSERT_EQUAL_UINT8(0, time_get.seconds);
+    TEST_ASSERT_UINT8_WITHIN(1, 10, time_get.cseconds);
+}
+
+void test_rtc_use_sync_slew(void)
+{
+    datetime_t time_set = {.year = 21, .month = 9, .day = 12,
+                           .hour = 10, .minutes = 0, .seconds = 0};
+    datetime_t time_get;
+
+    TEST_ASSERT_TRUE(rtc_set_datetime(&time_set, false));
+    util_advance(1000);
+
+    // Half a second ahead, the offset is slewed instead of stepped
+    time_set.seconds  = 10;
+    time_set.cseconds = 50;
+    TEST_ASSERT_TRUE(rtc_set_datetime(&time_set, false));
+
+    rtc_get_datetime(&time_get);
+    TEST_ASSERT_EQUAL_UINT8(10, time_get.seconds);
+    TEST_ASSERT_EQUAL_UINT8(0, time_get.cseconds);
+
+    // The offset is cancelled at the end of the slew, 1000 s at 500 ppm
+    util_advance(100000u + 100u);
+    rtc_get_datetime(&time_get);
+    TEST_ASSERT_EQUAL_UINT8(10, time_get.hour);
+    TEST_ASSERT_EQUAL_UINT8(16, time_get.minutes);
+    TEST_ASSERT_EQUAL_UINT8(51, time_get.seconds);
+    TEST_ASSERT_UINT8_WITHIN(1, 50, time_get.cseconds);
+}
+
+/******************************** End of file *********************************/
@@ -0,0 +1,220 @@
+/*******************************************************************************
+ * @file test_sys_util.c
+ * @author juanmanuel.fernandez@iertec.com
+ * @date 19 Oct 2026
+ * @brief Unit test for the module sys_util, the periodic sleeps with a slack
+ * window run over a simulated scheduler.
+ ******************************************************************************/
+
+#include "sys_util.h"
+
+#include "unity.h"
+
+/****************************************************************************//*
+ * Dependencies
+ ******************************************************************************/
+
+const char test_file_name[] = __FILE_NAME__;
+
+// Test dependencies
+#include "mock_task.h"
+#include "mock_itf_rtc.h"
+#include "mock_stm32l4xx_hal_rcc.h"
+#include "mock_stm32l4xx_hal_cortex.h"
+
+/****************************************************************************//*
+ * Constants and macros
+ ******************************************************************************/
+
+/** Number of simulated tasks. */
+#define TASK_COUNT   (2u)
+
+/** Simulated tasks. */
+#define TASK_A       (0u)
+#define TASK_B       (1u)
+
+/** Period and slack of the sleeps. */
+#define PERIOD_MSEC  (100u)
+#define SLACK_MSEC   (20u)
+
+/****************************************************************************//*
+ * Private data
+ ******************************************************************************/
+
+/** Pending notifications of the simulated tasks, their address is the task
+ * handle. */
+static uint32_t sim_notify[TASK_COUNT];
+
+/** Running task. */
+static uint32_t sim_task;
+
+/** Tick count of the simulated scheduler. */
+static TickType_t sim_ticks;
+
+/** Number of waits for a notification. */
+static uint32_t sim_take_count;
+
+/** Task run once when the scheduler is resumed, NULL if none. */
+static void (* sim_preempt)(void);
+
+/** Wake up time of the task B. */
+static TickType_t task_b_wake;
+
+/****************************************************************************//*
+ * Private code
+ ******************************************************************************/
+
+static TickType_t stub_xTaskGetTickCount(void)
+{
+    return sim_ticks;
+}
+
+static TaskHandle_t stub_xTaskGetCurrentTaskHandle(void)
+{
+    return (TaskHandle_t)&sim_notify[sim_task];
+}
+
+static BaseType_t stub_xTaskResumeAll(void)
+{
+    void (* preempt)(void) = sim_preempt;
+
+    // Another task runs before the current one goes to sleep
+    sim_preempt = NULL;
+
+    if (NULL != preempt)
+    {
+        preempt();
+    }
+
+    return pdFALSE;
+}
+
+static uint32_t stub_ulTaskNotifyTake(BaseType_t clear, TickType_t ticks)
+{
+    uint32_t value = sim_notify[sim_task];
+
+    TEST_ASSERT_EQUAL(pdTRUE, clear);
+    sim_take_count++;
+
+    // Without a pending notification the wait times out
+    if (0u == value)
+    {
+        sim_ticks += ticks;
+    }
+
+    sim_notify[sim_task] = 0;
+
+    return value;
+}
+
+static BaseType_t stub_xTaskGenericNotify(TaskHandle_t task, uint32_t value,
+                                          eNotifyAction action,
+                                          uint32_t * p_prev)
+{
+    TEST_ASSERT_EQUAL(eIncrement, action);
+    TEST_ASSERT_NULL(p_prev);
+
+    (*(uint32_t *)task)++;
+
+    return pdPASS;
+}
+
+/**
+ * Run the task B, it wakes up at its nominal time without slack and shares
+ * its wake up.
+ */
+static void util_task_b(void)
+{
+    uint32_t prev = task_b_wake - SYS_MSEC_TO_TICKS(PERIOD_MSEC);
+
+    sim_task  = TASK_B;
+    sim_ticks = task_b_wake;
+    sys_sleep_until_msec_slack(&prev, PERIOD_MSEC, 0);
+    TEST_ASSERT_EQUAL_UINT32(task_b_wake, prev);
+    sim_task  = TASK_A;
+}
+
+/****************************************************************************//*
+ * Tests
+ ******************************************************************************/
+
+void setUp(void)
+{
+    xTaskGetTickCount_Stub(stub_xTaskGetTickCount);
+    xTaskGetCurrentTaskHandle_Stub(stub_xTaskGetCurrentTaskHandle);
+    xTaskResumeAll_Stub(stub_xTaskResumeAll);
+    ulTaskNotifyTake_Stub(stub_ulTaskNotifyTake);
+    xTaskGenericNotify_Stub(stub_xTaskGenericNotify);
+    vTaskSuspendAll_Ignore();
+
+    sim_notify[TASK_A] = 0;
+    sim_notify[TASK_B] = 0;
+    sim_task           = TASK_A;
+    sim_ticks          = 0;
+    sim_take_count     = 0;
+    sim_preempt        = NULL;
+}
+
+void test_sys_util_slack_alone(void)
+{
+    uint32_t prev;
+
+    sys_sleep_until_msec_slack(&prev, 0, 0);
+    TEST_ASSERT_EQUAL_UINT32(0, prev);
+
+    // Nobody wakes the task, it sleeps until the end of its window
+    for (uint32_t i = 1; i <= 3u; i++)
+    {
+        sys_sleep_until_msec_slack(&prev, PERIOD_MSEC, SLACK_MSEC);
+        TEST_ASSERT_EQUAL_UINT32(SYS_MSEC_TO_TICKS(i * PERIOD_MSEC), prev);
+        TEST_ASSERT_EQUAL_UINT32(SYS_MSEC_TO_TICKS((i * PERIOD_MSEC)
+                                                   + SLACK_MSEC), sim_ticks);
+    }
+
+    TEST_ASSERT_EQUAL_UINT32(3, sim_take_count);
+}
+
+void test_sys_util_slack_shared(void)
+{
+    uint32_t prev = 0;
+
+    // The task B wakes up inside the window of the task A, before the task A
+    // blocks. The wake up is latched and the task A does not sleep
+    task_b_wake = SYS_MSEC_TO_TICKS(PERIOD_MSEC + 5u);
+    sim_preempt = util_task_b;
+
+    sys_sleep_until_msec_slack(&prev, PERIOD_MSEC, SLACK_MSEC);
+    TEST_ASSERT_EQUAL_UINT32(SYS_MSEC_TO_TICKS(PERIOD_MSEC), prev);
+    TEST_ASSERT_EQUAL_UINT32(task_b_wake, sim_ticks);
+    TEST_ASSERT_EQUAL_UINT32(1, sim_take_count);
+    TEST_ASSERT_EQUAL_UINT32(0, sim_notify[TASK_A]);
+}
+
+void test_sys_util_slack_not_started(void)
+{
+    uint32_t prev = 0;
+
+    // The task B wakes up before the window of the task A has started
+    task_b_wake = SYS_MSEC_TO_TICKS(PERIOD_MSEC - 5u);
+    sim_preempt = util_task_b;
+
+    sys_sleep_until_msec_slack(&prev, PERIOD_MSEC, SLACK_MSEC);
+    TEST_ASSERT_EQUAL_UINT32(SYS_MSEC_TO_TICKS(PERIOD_MSEC), prev);
+    TEST_ASSERT_EQUAL_UINT32(SYS_MSEC_TO_TICKS(PERIOD_MSEC + SLACK_MSEC),
+                             sim_ticks);
+}
+
+void test_sys_util_slack_stale(void)
+{
+    uint32_t prev = 0;
+
+    // A notification left from a previous sleep does not wake the task
+    sim_notify[TASK_A] = 1;
+
+    sys_sleep_until_msec_slack(&prev, PERIOD_MSEC, SLACK_MSEC);
+    TEST_ASSERT_EQUAL_UINT32(SYS_MSEC_TO_TICKS(PERIOD_MSEC + SLACK_MSEC),
+                             sim_ticks);
+    TEST_ASSERT_EQUAL_UINT32(2, sim_take_count);
+}
+
+/******************************** End of file *********************************/
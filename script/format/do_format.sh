@@ -13,8 +13,12 @@ uncrustify --replace --no-backup -l C -c uncrustify.cfg \
 ../../$PROJECT_NAME/lib/iertec_lib_stm32l4/crypt/*.c \
 ../../$PROJECT_NAME/lib/iertec_lib_stm32l4/fsm/*.h \
 ../../$PROJECT_NAME/lib/iertec_lib_stm32l4/fsm/*.c \
+../../$PROJECT_NAME/lib/iertec_lib_stm32l4/fw/*.h \
+../../$PROJECT_NAME/lib/iertec_lib_stm32l4/fw/*.c \
 ../../$PROJECT_NAME/lib/iertec_lib_stm32l4/itf/*.h \
 ../../$PROJECT_NAME/lib/iertec_lib_stm32l4/itf/*.c \
+../../$PROJECT_NAME/lib/iertec_lib_stm32l4/nvm/*.h \
+../../$PROJECT_NAME/lib/iertec_lib_stm32l4/nvm/*.c \
 ../../$PROJECT_NAME/lib/iertec_lib_stm32l4/rtc/*.h \
 ../../$PROJECT_NAME/lib/iertec_lib_stm32l4/rtc/*.c \
 ../../$PROJECT_NAME/lib/iertec_lib_stm32l4/rtos/*.h \